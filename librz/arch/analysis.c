@@ -9,6 +9,7 @@
 #include <rz_util/rz_path.h>
 #include <rz_arch.h>
 #include <rz_lib.h>
+#include "analysis_private.h"
 
 /**
  * \brief Returns the default size byte width of memory access operations.
@@ -159,6 +160,7 @@ RZ_API RzAnalysis *rz_analysis_free(RzAnalysis *a) {
 
 	plugin_fini(a);
 
+	rz_analysis_op_cache_fini(a);
 	rz_hash_free(a->hash);
 	rz_analysis_il_vm_cleanup(a);
 	rz_list_free(a->fcns);
@@ -175,8 +177,7 @@ RZ_API RzAnalysis *rz_analysis_free(RzAnalysis *a) {
 	rz_platform_target_free(a->arch_target);
 	rz_platform_target_index_free(a->platform_target);
 	rz_reg_free(a->reg);
-	ht_up_free(a->ht_xrefs_from);
-	ht_up_free(a->ht_xrefs_to);
+	rz_analysis_xrefs_fini(a);
 	rz_list_free(a->leaddrs);
 	rz_type_db_free(a->typedb);
 	sdb_free(a->sdb);
@@ -227,6 +228,7 @@ RZ_API bool rz_analysis_use(RzAnalysis *analysis, const char *name) {
 			continue;
 		}
 		plugin_fini(analysis);
+		rz_analysis_op_cache_invalidate(analysis);
 		analysis->cur = h;
 		if (h->init && !h->init(&analysis->plugin_data)) {
 			RZ_LOG_ERROR("analysis plugin '%s' failed to initialize.\n", h->name);
@@ -293,6 +295,7 @@ static bool analysis_set_os(RzAnalysis *analysis, const char *os) {
 	}
 	free(analysis->os);
 	analysis->os = rz_str_dup(os);
+	rz_analysis_op_cache_invalidate(analysis);
 	char *types_dir = rz_path_system(RZ_SDB_TYPES);
 	rz_type_db_set_os(analysis->typedb, os);
 	rz_type_db_reload(analysis->typedb, types_dir);
@@ -374,6 +377,7 @@ RZ_API void rz_analysis_set_cpu(RzAnalysis *analysis, const char *cpu) {
 	}
 	free(analysis->cpu);
 	analysis->cpu = rz_str_dup(cpu);
+	rz_analysis_op_cache_invalidate(analysis);
 	int v = rz_analysis_archinfo(analysis, RZ_ANALYSIS_ARCHINFO_TEXT_ALIGN);
 	if (v != -1) {
 		analysis->pcalign = v;
@@ -390,6 +394,9 @@ RZ_API void rz_analysis_set_cpu(RzAnalysis *analysis, const char *cpu) {
 }
 
 RZ_API int rz_analysis_set_big_endian(RzAnalysis *analysis, int bigend) {
+	if (analysis->big_endian != bigend) {
+		rz_analysis_op_cache_invalidate(analysis);
+	}
 	analysis->big_endian = bigend;
 	if (analysis->reg) {
 		analysis->reg->big_endian = bigend;
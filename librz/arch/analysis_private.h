@@ -6,4 +6,11 @@
 
 #include <rz_analysis.h>
 
+/* op_cache.c */
+RZ_IPI bool rz_analysis_op_cache_get(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RZ_OUT RzAnalysisOp *op, ut64 addr, RZ_NONNULL const ut8 *data, ut64 len, RzAnalysisOpMask mask, RZ_NONNULL RZ_OUT int *ret);
+RZ_IPI void rz_analysis_op_cache_put(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const RzAnalysisOp *op, ut64 addr, RZ_NONNULL const ut8 *data, ut64 len, RzAnalysisOpMask mask, int ret);
+
+/* xrefs.c */
+RZ_IPI void rz_analysis_xrefs_fini(RzAnalysis *analysis);
+
 #endif // RZ_ANALYSIS_PRIVATE_H
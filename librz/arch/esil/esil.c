@@ -117,6 +117,9 @@ RZ_API bool rz_analysis_esil_set_op(RzAnalysisEsil *esil, const char *op, RzAnal
 			free(eop);
 			return false;
 		}
+		// the compiled expressions may contain the new operation as a value
+		ht_sp_free(esil->parse_cache);
+		esil->parse_cache = NULL;
 	}
 	eop->push = push;
 	eop->pop = pop;
@@ -160,6 +163,8 @@ RZ_API void rz_analysis_esil_free(RzAnalysisEsil *esil) {
 	}
 	ht_sp_free(esil->ops);
 	esil->ops = NULL;
+	ht_sp_free(esil->parse_cache);
+	esil->parse_cache = NULL;
 	rz_analysis_esil_interrupts_fini(esil);
 	rz_analysis_esil_sources_fini(esil);
 	sdb_free(esil->stats);
@@ -2722,20 +2727,28 @@ static bool esil_set_delay_slot(RzAnalysisEsil *esil) {
 	return ret;
 }
 
-static bool iscommand(RzAnalysisEsil *esil, const char *word, RzAnalysisEsilOp **op) {
-	RzAnalysisEsilOp *eop = ht_sp_find(esil->ops, word, NULL);
-	if (eop) {
-		*op = eop;
-		return true;
+typedef enum {
+	ESIL_WORD_PUSH, ///< value pushed on the stack
+	ESIL_WORD_OP, ///< registered operation
+	ESIL_WORD_ELSE, ///< "}{"
+	ESIL_WORD_END, ///< "}"
+} EsilWordKind;
+
+static EsilWordKind word_kind(RzAnalysisEsil *esil, const char *word, RzAnalysisEsilOp **op) {
+	if (!strcmp(word, "}{")) {
+		return ESIL_WORD_ELSE;
 	}
-	return false;
+	if (!strcmp(word, "}")) {
+		return ESIL_WORD_END;
+	}
+	*op = ht_sp_find(esil->ops, word, NULL);
+	return *op ? ESIL_WORD_OP : ESIL_WORD_PUSH;
 }
 
-static bool runword(RzAnalysisEsil *esil, const char *word) {
-	RzAnalysisEsilOp *op = NULL;
-	if (!word) {
-		return false;
-	}
+/**
+ * Runs a word whose kind (and operation, for ESIL_WORD_OP) has already been resolved.
+ */
+static bool runword_resolved(RzAnalysisEsil *esil, const char *word, EsilWordKind kind, RzAnalysisEsilOp *op) {
 	esil->parse_goto_count--;
 	if (esil->parse_goto_count < 1) {
 		ESIL_LOG("ESIL infinite loop detected\n");
@@ -2744,7 +2757,7 @@ static bool runword(RzAnalysisEsil *esil, const char *word) {
 		return false;
 	}
 
-	if (!strcmp(word, "}{")) {
+	if (kind == ESIL_WORD_ELSE) {
 		if (esil->skip == 1) {
 			esil->skip = 0;
 		} else if (esil->skip == 0) { // this isn't perfect, but should work for valid esil
@@ -2752,7 +2765,7 @@ static bool runword(RzAnalysisEsil *esil, const char *word) {
 		}
 		return true;
 	}
-	if (!strcmp(word, "}")) {
+	if (kind == ESIL_WORD_END) {
 		if (esil->skip) {
 			esil->skip--;
 		}
@@ -2762,24 +2775,22 @@ static bool runword(RzAnalysisEsil *esil, const char *word) {
 		return true;
 	}
 
-	if (iscommand(esil, word, &op)) {
+	if (kind == ESIL_WORD_OP) {
 		// run action
-		if (op) {
-			if (esil->cb.hook_command) {
-				if (esil->cb.hook_command(esil, word)) {
-					return 1; // XXX cannot return != 1
-				}
+		if (esil->cb.hook_command) {
+			if (esil->cb.hook_command(esil, word)) {
+				return 1; // XXX cannot return != 1
 			}
-			rz_strbuf_set(&esil->current_opstr, word);
-			// so this is basically just sharing what's the operation with the operation
-			// useful for wrappers
-			const bool ret = op->code(esil);
-			rz_strbuf_fini(&esil->current_opstr);
-			if (!ret) {
-				ESIL_LOG("%s returned 0\n", word);
-			}
-			return ret;
 		}
+		rz_strbuf_set(&esil->current_opstr, word);
+		// so this is basically just sharing what's the operation with the operation
+		// useful for wrappers
+		const bool ret = op->code(esil);
+		rz_strbuf_fini(&esil->current_opstr);
+		if (!ret) {
+			ESIL_LOG("%s returned 0\n", word);
+		}
+		return ret;
 	}
 	if (!*word || *word == ',') {
 		// skip empty words
@@ -2795,6 +2806,15 @@ static bool runword(RzAnalysisEsil *esil, const char *word) {
 	return true;
 }
 
+static bool runword(RzAnalysisEsil *esil, const char *word) {
+	if (!word) {
+		return false;
+	}
+	RzAnalysisEsilOp *op = NULL;
+	EsilWordKind kind = word_kind(esil, word, &op);
+	return runword_resolved(esil, word, kind, op);
+}
+
 static const char *gotoWord(const char *str, int n) {
 	const char *ostr = str;
 	int count = 0;
@@ -2858,24 +2878,15 @@ static bool __stepOut(RzAnalysisEsil *esil, const char *cmd) {
 	return ret;
 }
 
-RZ_API bool rz_analysis_esil_parse(RzAnalysisEsil *esil, const char *str) {
+/**
+ * Parses and runs \p str character by character.
+ */
+static bool parse_string(RzAnalysisEsil *esil, const char *str) {
 	int wordi = 0;
 	int dorunword;
 	char word[64];
 	const char *ostr = str;
-	rz_return_val_if_fail(esil && RZ_STR_ISNOTEMPTY(str), 0);
-
-	if (__stepOut(esil, esil->cmd_step)) {
-		(void)__stepOut(esil, esil->cmd_step_out);
-		return true;
-	}
 	const char *hashbang = strstr(str, "#!");
-	esil->trap = 0;
-	if (esil->cmd && esil->cmd_todo) {
-		if (!strncmp(str, "TODO", 4)) {
-			esil->cmd(esil, esil->cmd_todo, esil->address, 0);
-		}
-	}
 loop:
 	esil->repeat = 0;
 	esil->skip = 0;
@@ -2896,7 +2907,6 @@ repeat:
 		}
 		if (wordi > 62) {
 			ESIL_LOG("Invalid esil string\n");
-			__stepOut(esil, esil->cmd_step_out);
 			return -1;
 		}
 		dorunword = 0;
@@ -2911,7 +2921,6 @@ repeat:
 		if (dorunword) {
 			if (*word) {
 				if (!runword(esil, word)) {
-					__stepOut(esil, esil->cmd_step_out);
 					return 0;
 				}
 				word[wordi] = ',';
@@ -2919,12 +2928,10 @@ repeat:
 				switch (evalWord(esil, ostr, &str)) {
 				case 0: goto loop;
 				case 1:
-					__stepOut(esil, esil->cmd_step_out);
 					return 0;
 				case 2: continue;
 				}
 				if (dorunword == 1) {
-					__stepOut(esil, esil->cmd_step_out);
 					return 0;
 				}
 			}
@@ -2940,21 +2947,264 @@ repeat:
 	word[wordi] = 0;
 	if (*word) {
 		if (!runword(esil, word)) {
-			__stepOut(esil, esil->cmd_step_out);
 			return 0;
 		}
 		switch (evalWord(esil, ostr, &str)) {
 		case 0: goto loop;
 		case 1:
-			__stepOut(esil, esil->cmd_step_out);
 			return 0;
 		case 2: goto repeat;
 		}
 	}
-	__stepOut(esil, esil->cmd_step_out);
 	return 1;
 }
 
+/**
+ * \name Compiled expressions
+ *
+ * Emulation runs the same expressions over and over, so every expression
+ * is split into words only once, with the operations already looked up,
+ * and then run from the list of words by program_run(), which behaves
+ * exactly like parse_string().
+ * Expressions whose splitting depends on the way parse_string() scans the
+ * characters (containing "#!", two separators in a row or too long words)
+ * are still run by parse_string().
+ * @{
+ */
+
+#define ESIL_PARSE_CACHE_MAX (1 << 14)
+
+typedef struct {
+	const char *word;
+	EsilWordKind kind;
+	RzAnalysisEsilOp *op; ///< for ESIL_WORD_OP
+	ut32 start; ///< offset of the word in the expression
+	ut32 end; ///< offset of the separator after the word
+	bool semicolon; ///< the word is followed by ';'
+} EsilToken;
+
+typedef struct {
+	char *str; ///< the expression
+	char *words; ///< copy of the expression with the separators replaced by '\0'
+	RzVector /*<EsilToken>*/ tokens;
+	RzVector /*<ut32>*/ targets; ///< index of the token starting the n-th comma separated word (for GOTO)
+	ut32 refs;
+	bool fallback; ///< run by parse_string()
+} EsilProgram;
+
+static void program_unref(void *p) {
+	EsilProgram *prog = p;
+	if (!prog || --prog->refs) {
+		return;
+	}
+	free(prog->str);
+	free(prog->words);
+	rz_vector_fini(&prog->tokens);
+	rz_vector_fini(&prog->targets);
+	free(prog);
+}
+
+static inline bool is_separator(char c) {
+	return c == ',' || c == ';';
+}
+
+static bool program_add_token(RzAnalysisEsil *esil, EsilProgram *prog, size_t start, size_t end, bool semicolon) {
+	EsilToken *tok = rz_vector_push(&prog->tokens, NULL);
+	if (!tok) {
+		return false;
+	}
+	prog->words[end] = '\0';
+	tok->word = prog->words + start;
+	tok->op = NULL;
+	tok->kind = word_kind(esil, tok->word, &tok->op);
+	tok->start = start;
+	tok->end = end;
+	tok->semicolon = semicolon;
+	return true;
+}
+
+/**
+ * Splits \p str into words the same way parse_string() does.
+ */
+static bool program_split(RzAnalysisEsil *esil, EsilProgram *prog) {
+	const char *str = prog->str;
+	size_t i = 0, start = 0, wordi = 0;
+	while (str[i]) {
+		if (wordi > 62) {
+			return false;
+		}
+		if (is_separator(str[i])) {
+			if (is_separator(str[i + 1])) {
+				return false;
+			}
+			if (wordi && !program_add_token(esil, prog, start, i, str[i] == ';')) {
+				return false;
+			}
+			wordi = 0;
+			i++;
+			start = i;
+			if (!str[i]) {
+				break;
+			}
+		} else if (!wordi) {
+			start = i;
+		}
+		wordi++;
+		i++;
+	}
+	if (wordi && !program_add_token(esil, prog, start, i, false)) {
+		return false;
+	}
+
+	// GOTO n continues at the n-th comma separated word, see gotoWord()
+	EsilToken *tokens = prog->tokens.a;
+	size_t n_tokens = rz_vector_len(&prog->tokens);
+	size_t t = 0;
+	for (i = 0; str[i]; i++) {
+		if (i && (str[i - 1] != ',')) {
+			continue;
+		}
+		while (t < n_tokens && tokens[t].start < i) {
+			t++;
+		}
+		ut32 target = t;
+		if (t == n_tokens || tokens[t].start != i || !rz_vector_push(&prog->targets, &target)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static EsilProgram *program_compile(RzAnalysisEsil *esil, const char *str) {
+	EsilProgram *prog = RZ_NEW0(EsilProgram);
+	if (!prog) {
+		return NULL;
+	}
+	prog->refs = 1;
+	rz_vector_init(&prog->tokens, sizeof(EsilToken), NULL, NULL);
+	rz_vector_init(&prog->targets, sizeof(ut32), NULL, NULL);
+	if (strlen(str) >= UT32_MAX || strstr(str, "#!")) {
+		prog->fallback = true;
+		return prog;
+	}
+	prog->str = rz_str_dup(str);
+	prog->words = rz_str_dup(str);
+	if (!prog->str || !prog->words) {
+		program_unref(prog);
+		return NULL;
+	}
+	if (!program_split(esil, prog)) {
+		free(prog->words);
+		prog->words = NULL;
+		rz_vector_clear(&prog->tokens);
+		rz_vector_clear(&prog->targets);
+		prog->fallback = true;
+	}
+	return prog;
+}
+
+/**
+ * Returns the compiled \p str with a new reference or NULL if it must be
+ * run by parse_string().
+ */
+static EsilProgram *program_get(RzAnalysisEsil *esil, const char *str) {
+	EsilProgram *prog = esil->parse_cache ? ht_sp_find(esil->parse_cache, str, NULL) : NULL;
+	if (!prog) {
+		if (esil->parse_cache && esil->parse_cache->count >= ESIL_PARSE_CACHE_MAX) {
+			ht_sp_free(esil->parse_cache);
+			esil->parse_cache = NULL;
+		}
+		if (!esil->parse_cache && !(esil->parse_cache = ht_sp_new(HT_STR_DUP, NULL, program_unref))) {
+			return NULL;
+		}
+		prog = program_compile(esil, str);
+		if (!prog) {
+			return NULL;
+		}
+		if (!ht_sp_insert(esil->parse_cache, str, prog)) {
+			program_unref(prog);
+			return NULL;
+		}
+	}
+	if (prog->fallback) {
+		return NULL;
+	}
+	prog->refs++;
+	return prog;
+}
+
+/**
+ * Same as parse_string(), for compiled expressions.
+ */
+static bool program_run(RzAnalysisEsil *esil, EsilProgram *prog) {
+	const EsilToken *tokens = prog->tokens.a;
+	const ut32 n_tokens = rz_vector_len(&prog->tokens);
+	const ut32 *targets = prog->targets.a;
+	const ut32 n_targets = rz_vector_len(&prog->targets);
+loop:
+	esil->repeat = 0;
+	esil->skip = 0;
+	esil->parse_goto = -1;
+	esil->parse_stop = 0;
+	esil->parse_goto_count = esil->analysis ? esil->analysis->esil_goto_limit : RZ_ANALYSIS_ESIL_GOTO_LIMIT;
+	for (ut32 i = 0; i < n_tokens;) {
+		const EsilToken *tok = &tokens[i];
+		if (!runword_resolved(esil, tok->word, tok->kind, tok->op)) {
+			return false;
+		}
+		if (esil->repeat) {
+			goto loop;
+		}
+		if (esil->parse_goto != -1) {
+			if (esil->parse_goto < 0 || (ut32)esil->parse_goto >= n_targets) {
+				ESIL_LOG("Cannot find word %d\n", esil->parse_goto);
+				return false;
+			}
+			i = targets[esil->parse_goto];
+			esil->parse_goto = -1;
+			continue;
+		}
+		if (esil->parse_stop) {
+			if (esil->parse_stop == 2) {
+				RZ_LOG_DEBUG("[esil at 0x%08" PFMT64x "] TODO: %s\n", esil->address, prog->str[tok->end] ? prog->str + tok->end + 1 : "");
+			}
+			return false;
+		}
+		if (tok->semicolon) {
+			return false;
+		}
+		i++;
+	}
+	return true;
+}
+
+/// @}
+
+RZ_API bool rz_analysis_esil_parse(RzAnalysisEsil *esil, const char *str) {
+	rz_return_val_if_fail(esil && RZ_STR_ISNOTEMPTY(str), 0);
+
+	if (__stepOut(esil, esil->cmd_step)) {
+		(void)__stepOut(esil, esil->cmd_step_out);
+		return true;
+	}
+	esil->trap = 0;
+	if (esil->cmd && esil->cmd_todo) {
+		if (!strncmp(str, "TODO", 4)) {
+			esil->cmd(esil, esil->cmd_todo, esil->address, 0);
+		}
+	}
+	bool ret;
+	EsilProgram *prog = program_get(esil, str);
+	if (prog) {
+		ret = program_run(esil, prog);
+		program_unref(prog);
+	} else {
+		ret = parse_string(esil, str);
+	}
+	__stepOut(esil, esil->cmd_step_out);
+	return ret;
+}
+
 RZ_API bool rz_analysis_esil_runword(RzAnalysisEsil *esil, const char *word) {
 	(void)runword(esil, word);
 	// for some reasons this is called twice in the original code from condret.
@@ -79,6 +79,7 @@ void rz_analysis_hint_storage_fini(RzAnalysis *a) {
 }
 
 RZ_API void rz_analysis_hint_clear(RzAnalysis *a) {
+	rz_analysis_op_cache_invalidate(a);
 	rz_analysis_hint_storage_fini(a);
 	rz_analysis_hint_storage_init(a);
 }
@@ -99,6 +100,7 @@ static bool addr_hint_range_delete_cb(void *user, const ut64 key, const void *va
 }
 
 RZ_API void rz_analysis_hint_del(RzAnalysis *a, ut64 addr, ut64 size) {
+	rz_analysis_op_cache_invalidate_range(a, addr, RZ_MAX(size, 1));
 	if (size <= 1) {
 		// only single address
 		ht_up_delete(a->addr_hints, addr);
@@ -138,6 +140,7 @@ static void unset_addr_hint_record(RzAnalysis *analysis, RzAnalysisAddrHintType
 	if (!records) {
 		return;
 	}
+	rz_analysis_op_cache_invalidate_range(analysis, addr, 1);
 	size_t i;
 	for (i = 0; i < records->len; i++) {
 		RzAnalysisAddrHintRecord *record = rz_vector_index_ptr(records, i);
@@ -151,6 +154,8 @@ static void unset_addr_hint_record(RzAnalysis *analysis, RzAnalysisAddrHintType
 
 // create or return the existing addr hint record of the given type at addr
 static RzAnalysisAddrHintRecord *ensure_addr_hint_record(RzAnalysis *analysis, RzAnalysisAddrHintType type, ut64 addr) {
+	// some plugins look at the hints while decoding
+	rz_analysis_op_cache_invalidate_range(analysis, addr, 1);
 	RzVector *records = ht_up_find(analysis->addr_hints, addr, NULL);
 	if (!records) {
 		records = rz_vector_new(sizeof(RzAnalysisAddrHintRecord), addr_hint_record_fini, NULL);
@@ -277,6 +282,7 @@ RZ_API void rz_analysis_hint_set_arch(RzAnalysis *a, ut64 addr, RZ_NULLABLE cons
 	if (!record) {
 		return;
 	}
+	// the cached ops are keyed on the plugin and the bits, they don't need to be dropped
 	free(record->arch);
 	record->arch = rz_str_dup(arch);
 }
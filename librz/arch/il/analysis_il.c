@@ -126,6 +126,7 @@ RZ_API void rz_analysis_il_vm_free(RZ_NULLABLE RzAnalysisILVM *vm) {
 	if (!vm) {
 		return;
 	}
+	ht_up_free(vm->bytecode);
 	rz_il_vm_free(vm->vm);
 	rz_il_reg_binding_free(vm->reg_binding);
 	rz_buf_free(vm->io_buf);
@@ -240,6 +241,75 @@ static void il_events(RzILVM *vm, RzStrBuf *sb) {
 	}
 }
 
+#define IL_BYTECODE_CACHE_MAX (1 << 16)
+
+/**
+ * An op lifted and compiled to bytecode. Only the ops of the plugins
+ * declaring RzAnalysisPlugin.cacheable are kept: a cached op is executed
+ * without calling the lifter, so a lifter keeping some state between the
+ * instructions (like hexagon) would miss it. An op is reused only if
+ * nothing which could change the lifting happened since (same conditions
+ * as for the op cache, see op_cache.c, with any dropped range dropping
+ * all the compiled ops).
+ */
+typedef struct {
+	ut64 gen; ///< RzAnalysisOpCache.gen when lifted
+	ut64 range_gen; ///< RzAnalysisOpCache.range_gen when lifted
+	const RzAnalysisPlugin *plugin;
+	int bits;
+	int size; ///< size of the op
+	ut32 n_bytes;
+	ut8 bytes[RZ_ANALYSIS_OP_CACHE_BYTES];
+	RzILBytecode *bc; ///< NULL if the op could not be compiled
+} RzAnalysisILBytecodeEntry;
+
+static void bytecode_entry_free(void *e) {
+	RzAnalysisILBytecodeEntry *entry = e;
+	if (!entry) {
+		return;
+	}
+	rz_il_bytecode_free(entry->bc);
+	free(entry);
+}
+
+static RzAnalysisILBytecodeEntry *bytecode_get(RzAnalysis *analysis, RzAnalysisILVM *vm, ut64 addr, const ut8 *code) {
+	if (!vm->bytecode || !analysis->cur->cacheable) {
+		return NULL;
+	}
+	RzAnalysisILBytecodeEntry *entry = ht_up_find(vm->bytecode, addr, NULL);
+	if (!entry || entry->gen != analysis->opcache.gen || entry->range_gen != analysis->opcache.range_gen || entry->plugin != analysis->cur ||
+		entry->bits != analysis->bits || memcmp(entry->bytes, code, entry->n_bytes)) {
+		return NULL;
+	}
+	return entry;
+}
+
+static void bytecode_put(RzAnalysis *analysis, RzAnalysisILVM *vm, ut64 addr, const ut8 *code, RzAnalysisOp *op) {
+	if (!analysis->cur->cacheable) {
+		return;
+	}
+	if (vm->bytecode && vm->bytecode->count >= IL_BYTECODE_CACHE_MAX) {
+		ht_up_free(vm->bytecode);
+		vm->bytecode = NULL;
+	}
+	if (!vm->bytecode && !(vm->bytecode = ht_up_new(NULL, bytecode_entry_free))) {
+		return;
+	}
+	RzAnalysisILBytecodeEntry *entry = RZ_NEW0(RzAnalysisILBytecodeEntry);
+	if (!entry) {
+		return;
+	}
+	entry->gen = analysis->opcache.gen;
+	entry->range_gen = analysis->opcache.range_gen;
+	entry->plugin = analysis->cur;
+	entry->bits = analysis->bits;
+	entry->size = op->size;
+	entry->n_bytes = RZ_MIN(RZ_MAX(op->size, 1), RZ_ANALYSIS_OP_CACHE_BYTES);
+	memcpy(entry->bytes, code, entry->n_bytes);
+	entry->bc = rz_il_bytecode_compile(vm->vm, op->il_op);
+	ht_up_update(vm->bytecode, addr, entry);
+}
+
 static RzAnalysisILStepResult analysis_il_vm_step_while(
 	RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RzAnalysisILVM *vm, RZ_NULLABLE RzReg *reg,
 	bool with_events, RZ_NONNULL RzAnalysisILVMCondCallback cond, RZ_NULLABLE void *user) {
@@ -258,14 +328,28 @@ static RzAnalysisILStepResult analysis_il_vm_step_while(
 	RzAnalysisILStepResult res = RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS;
 	while (cond(vm, user)) {
 		ut64 addr = rz_bv_to_ut64(vm->vm->pc);
-		ut8 code[32] = { 0 };
+		ut8 code[RZ_ANALYSIS_OP_CACHE_BYTES] = { 0 };
 		analysis->read_at(analysis, addr, code, sizeof(code));
+		if (!with_events) {
+			// ops executed again are run from their bytecode without lifting them
+			RzAnalysisILBytecodeEntry *entry = bytecode_get(analysis, vm, addr, code);
+			if (entry && entry->bc && rz_il_bytecode_bind(vm->vm, entry->bc)) {
+				if (!rz_il_vm_step_bytecode(vm->vm, entry->bc, addr + (entry->size > 0 ? entry->size : 1))) {
+					res = RZ_ANALYSIS_IL_STEP_IL_RUNTIME_ERROR;
+					break;
+				}
+				continue;
+			}
+		}
 		int r = rz_analysis_op(analysis, &op, addr, code, sizeof(code), RZ_ANALYSIS_OP_MASK_IL | RZ_ANALYSIS_OP_MASK_HINT | RZ_ANALYSIS_OP_MASK_DISASM);
 
 		if (r < 0 || !op.il_op) {
 			res = RZ_ANALYSIS_IL_STEP_INVALID_OP;
 			break;
 		}
+		if (!with_events) {
+			bytecode_put(analysis, vm, addr, code, &op);
+		}
 		if (!rz_il_vm_step(vm->vm, op.il_op, addr + (op.size > 0 ? op.size : 1))) {
 			res = RZ_ANALYSIS_IL_STEP_IL_RUNTIME_ERROR;
 			break;
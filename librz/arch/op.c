@@ -5,6 +5,7 @@
 #include <rz_analysis.h>
 #include <rz_util.h>
 #include <rz_list.h>
+#include "analysis_private.h"
 
 RZ_API RzAnalysisOp *rz_analysis_op_new(void) {
 	RzAnalysisOp *op = RZ_NEW(RzAnalysisOp);
@@ -125,14 +126,17 @@ RZ_API int rz_analysis_op(RZ_NONNULL RzAnalysis *analysis, RZ_OUT RzAnalysisOp *
 			op->size = 1;
 			return -1;
 		}
-		ret = analysis->cur->op(analysis, op, addr, data, len, mask);
-		if (ret < 1) {
-			op->type = RZ_ANALYSIS_OP_TYPE_ILL;
-		}
-		op->addr = addr;
-		/* consider at least 1 byte to be part of the opcode */
-		if (op->nopcode < 1) {
-			op->nopcode = 1;
+		if (!rz_analysis_op_cache_get(analysis, op, addr, data, len, mask, &ret)) {
+			ret = analysis->cur->op(analysis, op, addr, data, len, mask);
+			if (ret < 1) {
+				op->type = RZ_ANALYSIS_OP_TYPE_ILL;
+			}
+			op->addr = addr;
+			/* consider at least 1 byte to be part of the opcode */
+			if (op->nopcode < 1) {
+				op->nopcode = 1;
+			}
+			rz_analysis_op_cache_put(analysis, op, addr, data, len, mask, ret);
 		}
 	} else if (!memcmp(data, "\xff\xff\xff\xff", RZ_MIN(4, len))) {
 		op->type = RZ_ANALYSIS_OP_TYPE_ILL;
@@ -0,0 +1,260 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file op_cache.c
+ * Cache of the ops decoded by rz_analysis_op().
+ *
+ * The same instructions are decoded over and over by the function analysis,
+ * the disassembler and the emulation, so the decoded ops are kept in a
+ * direct mapped table indexed by address. Only the plugins declaring
+ * RzAnalysisPlugin.cacheable are cached: the others keep some state between
+ * the decoded instructions (e.g. the hexagon packets) and the same bytes can
+ * decode to different ops. An entry is reused only when it was decoded from
+ * the same bytes, with the same plugin, bits, segment granularity and global
+ * pointer, with a mask containing the requested one and when nothing which
+ * could change the decoding happened in the meantime (see
+ * rz_analysis_op_cache_invalidate() and rz_analysis_op_cache_invalidate_range()).
+ * Hints are applied after the lookup, so the cached ops never contain them.
+ * Ops carrying IL or switch info are never cached since they can't be copied,
+ * neither are the direct calls, whose decoding can depend on the bytes at
+ * their target (e.g. the get-pc thunks of x86) and not only on their own.
+ */
+
+#include "analysis_private.h"
+
+#define OP_CACHE_MASK_IGNORED (RZ_ANALYSIS_OP_MASK_HINT)
+
+struct rz_analysis_op_cache_entry_t {
+	bool valid;
+	ut64 addr;
+	ut64 gen; ///< RzAnalysisOpCache.gen when decoded
+	ut64 reg_gen; ///< RzReg.profile_gen when decoded, ops point to the reg items
+	const RzAnalysisPlugin *plugin;
+	int bits;
+	int seggrn;
+	ut64 gp;
+	RzAnalysisOpMask mask;
+	int ret; ///< value returned by the plugin
+	ut32 n_bytes;
+	ut8 bytes[RZ_ANALYSIS_OP_CACHE_BYTES];
+	RzAnalysisOp op;
+};
+
+static inline size_t entry_index(const RzAnalysisOpCache *cache, ut64 addr) {
+	ut64 h = addr ^ (addr >> 17);
+	return (size_t)(h & (cache->size - 1));
+}
+
+static inline bool is_cacheable(const RzAnalysis *analysis, RzAnalysisOpMask mask) {
+	return analysis->opcache.size && analysis->cur && analysis->cur->cacheable && !(mask & RZ_ANALYSIS_OP_MASK_IL);
+}
+
+static bool op_copy(RzAnalysisOp *dst, const RzAnalysisOp *src) {
+	*dst = *src;
+	dst->mnemonic = NULL;
+	dst->src[0] = dst->src[1] = dst->src[2] = NULL;
+	dst->dst = NULL;
+	dst->access = NULL;
+	dst->il_op = NULL;
+	dst->switch_op = NULL;
+	rz_strbuf_init(&dst->esil);
+	rz_strbuf_init(&dst->opex);
+	if (src->mnemonic && !(dst->mnemonic = rz_str_dup(src->mnemonic))) {
+		goto fail;
+	}
+	for (size_t i = 0; i < 3; i++) {
+		if (src->src[i] && !(dst->src[i] = rz_analysis_value_copy(src->src[i]))) {
+			goto fail;
+		}
+	}
+	if (src->dst && !(dst->dst = rz_analysis_value_copy(src->dst))) {
+		goto fail;
+	}
+	if (src->access) {
+		dst->access = rz_list_newf((RzListFree)rz_analysis_value_free);
+		if (!dst->access) {
+			goto fail;
+		}
+		RzListIter *it;
+		RzAnalysisValue *val;
+		rz_list_foreach (src->access, it, val) {
+			RzAnalysisValue *copy = rz_analysis_value_copy(val);
+			if (!copy || !rz_list_append(dst->access, copy)) {
+				rz_analysis_value_free(copy);
+				goto fail;
+			}
+		}
+	}
+	if (!rz_strbuf_copy(&dst->esil, (RzStrBuf *)&src->esil) ||
+		!rz_strbuf_copy(&dst->opex, (RzStrBuf *)&src->opex)) {
+		goto fail;
+	}
+	return true;
+fail:
+	rz_analysis_op_fini(dst);
+	return false;
+}
+
+static void entry_fini(RzAnalysisOpCacheEntry *entry) {
+	if (entry->valid) {
+		rz_analysis_op_fini(&entry->op);
+		entry->valid = false;
+	}
+}
+
+/**
+ * \brief Looks for a cached op decoded from \p data at \p addr
+ *
+ * \param analysis  The RzAnalysis
+ * \param op        The op to fill, it must be initialized (and empty)
+ * \param addr      The address of the op
+ * \param data      The bytes at \p addr
+ * \param len       The length of \p data
+ * \param mask      The requested mask
+ * \param ret       Where to store the value returned by the plugin when decoding the op
+ *
+ * \return true if \p op was filled from the cache
+ */
+RZ_IPI bool rz_analysis_op_cache_get(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL RZ_OUT RzAnalysisOp *op, ut64 addr, RZ_NONNULL const ut8 *data, ut64 len, RzAnalysisOpMask mask, RZ_NONNULL RZ_OUT int *ret) {
+	RzAnalysisOpCache *cache = &analysis->opcache;
+	if (!is_cacheable(analysis, mask)) {
+		return false;
+	}
+	if (!cache->entries) {
+		cache->misses++;
+		return false;
+	}
+	RzAnalysisOpCacheEntry *entry = &cache->entries[entry_index(cache, addr)];
+	mask &= ~OP_CACHE_MASK_IGNORED;
+	ut32 n_bytes = RZ_MIN(len, RZ_ANALYSIS_OP_CACHE_BYTES);
+	if (!entry->valid || entry->addr != addr || entry->gen != cache->gen ||
+		entry->plugin != analysis->cur || entry->bits != analysis->bits ||
+		entry->seggrn != analysis->seggrn || entry->gp != analysis->gp ||
+		entry->reg_gen != analysis->reg->profile_gen || (entry->mask & mask) != mask ||
+		entry->n_bytes != n_bytes || memcmp(entry->bytes, data, n_bytes)) {
+		cache->misses++;
+		return false;
+	}
+	if (!op_copy(op, &entry->op)) {
+		rz_analysis_op_init(op);
+		return false;
+	}
+	cache->hits++;
+	*ret = entry->ret;
+	return true;
+}
+
+/**
+ * \brief Stores an op just decoded by the plugin into the cache
+ */
+RZ_IPI void rz_analysis_op_cache_put(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const RzAnalysisOp *op, ut64 addr, RZ_NONNULL const ut8 *data, ut64 len, RzAnalysisOpMask mask, int ret) {
+	RzAnalysisOpCache *cache = &analysis->opcache;
+	if (!is_cacheable(analysis, mask) || op->il_op || op->switch_op ||
+		(op->type & RZ_ANALYSIS_OP_TYPE_MASK) == RZ_ANALYSIS_OP_TYPE_CALL) {
+		return;
+	}
+	if (!cache->entries) {
+		cache->entries = RZ_NEWS0(RzAnalysisOpCacheEntry, cache->size);
+		if (!cache->entries) {
+			return;
+		}
+	}
+	RzAnalysisOpCacheEntry *entry = &cache->entries[entry_index(cache, addr)];
+	entry_fini(entry);
+	if (!op_copy(&entry->op, op)) {
+		return;
+	}
+	entry->valid = true;
+	entry->addr = addr;
+	entry->gen = cache->gen;
+	entry->reg_gen = analysis->reg->profile_gen;
+	entry->plugin = analysis->cur;
+	entry->bits = analysis->bits;
+	entry->seggrn = analysis->seggrn;
+	entry->gp = analysis->gp;
+	entry->mask = mask & ~OP_CACHE_MASK_IGNORED;
+	entry->ret = ret;
+	entry->n_bytes = RZ_MIN(len, RZ_ANALYSIS_OP_CACHE_BYTES);
+	memcpy(entry->bytes, data, entry->n_bytes);
+}
+
+/**
+ * \brief Marks all the cached ops as stale.
+ *
+ * Must be called whenever something which is not part of the cache key
+ * and which can change the result of rz_analysis_op() changes, like the
+ * cpu, the endianness or the hints.
+ */
+RZ_API void rz_analysis_op_cache_invalidate(RZ_NONNULL RzAnalysis *analysis) {
+	rz_return_if_fail(analysis);
+	analysis->opcache.gen++;
+}
+
+/**
+ * \brief Drops the cached ops decoded at an address of [\p addr, \p addr + \p size).
+ *
+ * Must be called when something which can change the decoding of the
+ * instructions of a known range changes, like the hints at an address.
+ */
+RZ_API void rz_analysis_op_cache_invalidate_range(RZ_NONNULL RzAnalysis *analysis, ut64 addr, ut64 size) {
+	rz_return_if_fail(analysis);
+	RzAnalysisOpCache *cache = &analysis->opcache;
+	cache->range_gen++;
+	if (!cache->entries || !size) {
+		return;
+	}
+	const ut64 last = addr + size - 1 < addr ? UT64_MAX : addr + size - 1;
+	if (size < cache->size) {
+		for (ut64 a = addr;; a++) {
+			RzAnalysisOpCacheEntry *entry = &cache->entries[entry_index(cache, a)];
+			if (entry->valid && entry->addr == a) {
+				entry_fini(entry);
+			}
+			if (a == last) {
+				break;
+			}
+		}
+		return;
+	}
+	for (size_t i = 0; i < cache->size; i++) {
+		RzAnalysisOpCacheEntry *entry = &cache->entries[i];
+		if (entry->valid && entry->addr >= addr && entry->addr <= last) {
+			entry_fini(entry);
+		}
+	}
+}
+
+/**
+ * \brief Sets the number of cached ops (0 disables the cache).
+ *
+ * \p size is rounded up to the next power of 2.
+ */
+RZ_API void rz_analysis_op_cache_set_size(RZ_NONNULL RzAnalysis *analysis, size_t size) {
+	rz_return_if_fail(analysis);
+	RzAnalysisOpCache *cache = &analysis->opcache;
+	size_t n = 1;
+	while (n < size && n < SIZE_MAX / 2) {
+		n <<= 1;
+	}
+	n = size ? n : 0;
+	if (n == cache->size) {
+		return;
+	}
+	rz_analysis_op_cache_fini(analysis);
+	cache->size = n;
+}
+
+/**
+ * \brief Frees all the cached ops
+ */
+RZ_API void rz_analysis_op_cache_fini(RZ_NONNULL RzAnalysis *analysis) {
+	rz_return_if_fail(analysis);
+	RzAnalysisOpCache *cache = &analysis->opcache;
+	if (cache->entries) {
+		for (size_t i = 0; i < cache->size; i++) {
+			entry_fini(&cache->entries[i]);
+		}
+		RZ_FREE(cache->entries);
+	}
+	cache->gen++;
+}
@@ -3732,6 +3732,7 @@ RzAnalysisPlugin rz_analysis_plugin_x86_cs = {
 	.license = "BSD",
 	.arch = "x86",
 	.bits = 16 | 32 | 64,
+	.cacheable = true,
 	.op = &analyze_op,
 	.preludes = analysis_preludes,
 	.archinfo = archinfo,
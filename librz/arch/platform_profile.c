@@ -149,7 +149,10 @@ static bool sdb_load_arch_profile(RzPlatformTarget *t, Sdb *sdb) {
 }
 
 static bool sdb_load_arch_profile_by_path(RZ_NONNULL RzPlatformTarget *t, const char *path) {
-	Sdb *db = sdb_new(0, path, 0);
+	Sdb *db = sdb_new_readonly(path);
+	if (!db) {
+		return false;
+	}
 	bool result = sdb_load_arch_profile(t, db);
 	sdb_close(db);
 	sdb_free(db);
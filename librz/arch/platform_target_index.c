@@ -96,7 +96,7 @@ static bool sdb_load_arch_platform_by_path(RZ_NONNULL RzPlatformTargetIndex *t,
 	if (!path) {
 		return false;
 	}
-	Sdb *db = sdb_new(0, path, 0);
+	Sdb *db = sdb_new_readonly(path);
 	if (!db) {
 		return false;
 	}
@@ -1409,38 +1409,51 @@ RZ_API bool rz_serialize_analysis_function_noreturn_load(RZ_NONNULL Sdb *db, RZ_
 	return true;
 }
 
-static bool store_xref_cb(void *j, const ut64 k, const void *v) {
-	const RzAnalysisXRef *xref = v;
-	pj_o(j);
-	pj_kn(j, "to", k);
-	if (xref->type != RZ_ANALYSIS_XREF_TYPE_NULL) {
-		char type[2] = { xref->type, '\0' };
-		pj_ks(j, "type", type);
-	}
-	pj_end(j);
-	return true;
-}
-
-static bool store_xrefs_list_cb(void *db, const ut64 k, const void *v) {
+static void store_xrefs_list(Sdb *db, ut64 from, PJ *j) {
 	char key[0x20];
-	if (snprintf(key, sizeof(key), "0x%" PFMT64x, k) < 0) {
-		return false;
-	}
-	PJ *j = pj_new();
-	if (!j) {
-		return false;
-	}
-	pj_a(j);
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach(ht, store_xref_cb, j);
 	pj_end(j);
+	if (snprintf(key, sizeof(key), "0x%" PFMT64x, from) < 0) {
+		return;
+	}
 	sdb_set(db, key, pj_string(j));
-	pj_free(j);
-	return true;
 }
 
 RZ_API void rz_serialize_analysis_xrefs_save(RZ_NONNULL Sdb *db, RZ_NONNULL RzAnalysis *analysis) {
-	ht_up_foreach(analysis->ht_xrefs_from, store_xrefs_list_cb, db);
+	RzIterator *it = rz_analysis_xrefs_iter(analysis);
+	if (!it) {
+		return;
+	}
+	// the xrefs are sorted by source, so each list is complete when the source changes
+	PJ *j = NULL;
+	ut64 from = 0;
+	RzAnalysisXRef *xref;
+	rz_iterator_foreach(it, xref) {
+		if (j && xref->from != from) {
+			store_xrefs_list(db, from, j);
+			pj_free(j);
+			j = NULL;
+		}
+		if (!j) {
+			j = pj_new();
+			if (!j) {
+				break;
+			}
+			from = xref->from;
+			pj_a(j);
+		}
+		pj_o(j);
+		pj_kn(j, "to", xref->to);
+		if (xref->type != RZ_ANALYSIS_XREF_TYPE_NULL) {
+			char type[2] = { xref->type, '\0' };
+			pj_ks(j, "type", type);
+		}
+		pj_end(j);
+	}
+	if (j) {
+		store_xrefs_list(db, from, j);
+		pj_free(j);
+	}
+	rz_iterator_free(it);
 }
 
 static bool xrefs_load_cb(void *user, const SdbKv *kv) {
@@ -5,6 +5,7 @@
 #include <rz_analysis.h>
 #include <rz_util.h>
 #include <rz_diff.h>
+#include <rz_util/ht_su.h>
 
 /** \file similarity.c
  *
@@ -17,12 +18,49 @@
  * If two signatures are of the same size, memcmp is used to perform
  * a fast compare which speeds up the computation and skips the levenshtein
  * distance calculation which is more expensive to perform.
+ *
+ * When matching lists, the bytes of list B are read only once and a MinHash
+ * of their 4-byte shingles is indexed with LSH (bands of MATCH_LSH_ROWS
+ * rows). Each element of list A is then compared only against the
+ * MATCH_CANDIDATES elements of B sharing most bands with it (plus the
+ * function with the same name), instead of against the whole list B.
+ * The elements without any candidate above RZ_ANALYSIS_SIMILARITY_THRESHOLD
+ * are compared also against the MATCH_FALLBACK_CANDIDATES elements of B
+ * closest in size, since the similarity can't exceed the ratio between the
+ * two sizes. Their closest match is thus searched among a bounded set of
+ * elements and not among the whole list B.
  */
 
 #define iob_read_at(addr, buf, size) (analysis->iob.read_at(analysis->iob.io, addr, buf, size))
 
+#define MATCH_MINHASH_SIZE      32
+#define MATCH_LSH_ROWS          2
+#define MATCH_LSH_BANDS         (MATCH_MINHASH_SIZE / MATCH_LSH_ROWS)
+#define MATCH_LSH_MAX_BUCKET    4096
+#define MATCH_CANDIDATES          64
+#define MATCH_FALLBACK_CANDIDATES (4 * MATCH_CANDIDATES)
+#define MATCH_LSH_KEY_CMP(x, y)   ((x) < (y).key ? -1 : ((x) > (y).key))
+#define MATCH_SIZE_KEY_CMP(x, y)  ((x) < (y).size ? -1 : ((x) > (y).size))
+
 typedef ut8 *(*AllocateBuffer)(RzAnalysis *analysis, void *data, ut8 **buffer, ut32 *buf_sz);
 
+typedef struct match_entry_t {
+	void *ptr; ///< RzAnalysisBlock or RzAnalysisFunction
+	ut8 *buf;
+	ut32 size;
+	ut32 minhash[MATCH_MINHASH_SIZE];
+} MatchEntry;
+
+typedef struct lsh_key_t {
+	ut64 key; ///< hash of the band and of its rows
+	ut32 entry; ///< index in entries_b
+} LshKey;
+
+typedef struct size_key_t {
+	ut32 size;
+	ut32 entry; ///< index in entries_b
+} SizeKey;
+
 typedef struct shared_context_t {
 	const RzList /*<void *>*/ *list_b;
 	RzThreadQueue *queue;
@@ -34,6 +72,11 @@ typedef struct shared_context_t {
 	RzAnalysis *analysis_a;
 	RzAnalysis *analysis_b;
 	RzAtomicBool *loop;
+	MatchEntry *entries_b; ///< bytes and signatures of list_b, read once
+	size_t n_entries_b;
+	RzVector /*<LshKey>*/ lsh; ///< LSH band keys of entries_b, sorted by key
+	RzVector /*<SizeKey>*/ sizes; ///< sizes of entries_b, sorted by size
+	HtSU /*<char *, ut64>*/ *names_b; ///< index of the named functions of list_b
 } SharedContext;
 
 typedef struct match_ui_info_t {
@@ -69,13 +112,23 @@ static bool shared_context_init(SharedContext *context, RzAnalysis *analysis_a,
 	context->analysis_a = analysis_a;
 	context->analysis_b = analysis_b;
 	context->loop = loop;
+	rz_vector_init(&context->lsh, sizeof(LshKey), NULL, NULL);
+	rz_vector_init(&context->sizes, sizeof(SizeKey), NULL, NULL);
 	return true;
 }
 
 static void shared_context_fini(SharedContext *context) {
+	for (size_t i = 0; i < context->n_entries_b; i++) {
+		free(context->entries_b[i].buf);
+	}
+	free(context->entries_b);
+	rz_vector_fini(&context->lsh);
+	rz_vector_fini(&context->sizes);
+	ht_su_free(context->names_b);
 	rz_th_queue_free(context->queue);
 	rz_th_queue_free(context->matches);
 	rz_th_queue_free(context->unmatch);
+	rz_atomic_bool_free(context->loop);
 	rz_th_lock_free(context->lock_a);
 	if (context->lock_a != context->lock_b) {
 		rz_th_lock_free(context->lock_b);
@@ -160,6 +213,244 @@ static double calculate_similarity(const ut8 *buf_a, ut32 size_a, const ut8 *buf
 	return similarity;
 }
 
+static inline ut32 minhash_mix(ut32 x) {
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+/**
+ * Computes the MinHash signature of the 4-byte shingles of the buffer;
+ * every hash function is the base hash of the shingle mixed with a seed.
+ */
+static void minhash_compute(const ut8 *buf, ut32 size, ut32 *minhash) {
+	for (ut32 i = 0; i < MATCH_MINHASH_SIZE; i++) {
+		minhash[i] = UT32_MAX;
+	}
+	ut32 n_shingles = size > 4 ? size - 3 : 1;
+	for (ut32 i = 0; i < n_shingles; i++) {
+		ut8 shingle[4] = { 0 };
+		memcpy(shingle, buf + i, RZ_MIN(4, size - i));
+		ut32 base = rz_read_le32(shingle) * 0x9E3779B1U;
+		for (ut32 j = 0; j < MATCH_MINHASH_SIZE; j++) {
+			ut32 h = minhash_mix(base ^ (0x85ebca6bU * (j + 1)));
+			if (h < minhash[j]) {
+				minhash[j] = h;
+			}
+		}
+	}
+}
+
+static inline ut64 lsh_band_key(const ut32 *minhash, ut32 band) {
+	ut64 key = band + 1;
+	for (ut32 i = 0; i < MATCH_LSH_ROWS; i++) {
+		key = (key * 0x100000001B3ULL) ^ minhash[band * MATCH_LSH_ROWS + i];
+	}
+	return key;
+}
+
+static int lsh_key_cmp(const void *a, const void *b, void *user) {
+	const LshKey *ka = a;
+	const LshKey *kb = b;
+	if (ka->key != kb->key) {
+		return ka->key < kb->key ? -1 : 1;
+	}
+	return ka->entry < kb->entry ? -1 : (ka->entry > kb->entry);
+}
+
+static int size_key_cmp(const void *a, const void *b, void *user) {
+	const SizeKey *ka = a;
+	const SizeKey *kb = b;
+	if (ka->size != kb->size) {
+		return ka->size < kb->size ? -1 : 1;
+	}
+	return ka->entry < kb->entry ? -1 : (ka->entry > kb->entry);
+}
+
+static bool is_named_function(const RzAnalysisFunction *fcn) {
+	return RZ_STR_ISNOTEMPTY(fcn->name) && strncmp(fcn->name, "fcn.", strlen("fcn."));
+}
+
+/**
+ * Reads once the bytes of every element of list B and, when the list is
+ * bigger than the amount of candidates, indexes their MinHash signatures.
+ */
+static bool shared_context_load_b(SharedContext *context, bool functions) {
+	size_t n_b = rz_list_length(context->list_b);
+	if (!n_b) {
+		return true;
+	}
+	context->entries_b = RZ_NEWS0(MatchEntry, n_b);
+	if (!context->entries_b) {
+		return false;
+	}
+	context->n_entries_b = n_b;
+	if (functions && !(context->names_b = ht_su_new(HT_STR_CONST))) {
+		return false;
+	}
+
+	bool use_lsh = n_b > MATCH_CANDIDATES;
+	if (use_lsh && (!rz_vector_reserve(&context->lsh, n_b * MATCH_LSH_BANDS) || !rz_vector_reserve(&context->sizes, n_b))) {
+		return false;
+	}
+
+	size_t i = 0;
+	void *ptr;
+	RzListIter *iter;
+	rz_list_foreach (context->list_b, iter, ptr) {
+		MatchEntry *entry = &context->entries_b[i];
+		entry->ptr = ptr;
+		if (!context->alloc(context->analysis_b, ptr, &entry->buf, &entry->size)) {
+			entry->buf = NULL;
+			if (functions) {
+				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for function %s (B)\n", ((RzAnalysisFunction *)ptr)->name);
+			} else {
+				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for block 0x%08" PFMT64x " (B)\n", ((RzAnalysisBlock *)ptr)->addr);
+			}
+			i++;
+			continue;
+		}
+		if (functions && is_named_function(ptr)) {
+			ht_su_insert(context->names_b, ((RzAnalysisFunction *)ptr)->name, i);
+		}
+		if (use_lsh) {
+			minhash_compute(entry->buf, entry->size, entry->minhash);
+			for (ut32 band = 0; band < MATCH_LSH_BANDS; band++) {
+				LshKey key = { .key = lsh_band_key(entry->minhash, band), .entry = (ut32)i };
+				rz_vector_push(&context->lsh, &key);
+			}
+			SizeKey size = { .size = entry->size, .entry = (ut32)i };
+			rz_vector_push(&context->sizes, &size);
+		}
+		i++;
+	}
+	if (use_lsh) {
+		rz_vector_sort(&context->lsh, lsh_key_cmp, false, NULL);
+		rz_vector_sort(&context->sizes, size_key_cmp, false, NULL);
+	}
+	return true;
+}
+
+typedef struct match_candidates_t {
+	ut8 *hits; ///< number of bands shared with each entry of B
+	RzVector /*<ut32>*/ touched; ///< entries of B with at least one shared band
+} MatchCandidates;
+
+static int candidate_hits_cmp(const void *a, const void *b, void *user) {
+	const ut8 *hits = user;
+	ut32 ea = *(const ut32 *)a;
+	ut32 eb = *(const ut32 *)b;
+	if (hits[ea] != hits[eb]) {
+		return hits[ea] > hits[eb] ? -1 : 1;
+	}
+	return ea < eb ? -1 : (ea > eb);
+}
+
+static int candidate_index_cmp(const void *a, const void *b, void *user) {
+	ut32 ea = *(const ut32 *)a;
+	ut32 eb = *(const ut32 *)b;
+	return ea < eb ? -1 : (ea > eb);
+}
+
+/**
+ * Fills cands->touched with the entries of B to compare against the given
+ * buffer, in the same order of list B: all of them for small lists,
+ * otherwise the best LSH candidates and the function with the same name.
+ */
+static void match_candidates_find(SharedContext *shared, MatchCandidates *cands, const ut8 *buf, ut32 size, const char *name) {
+	rz_vector_clear(&cands->touched);
+	if (!shared->n_entries_b) {
+		return;
+	} else if (shared->n_entries_b <= MATCH_CANDIDATES) {
+		for (ut32 i = 0; i < shared->n_entries_b; i++) {
+			rz_vector_push(&cands->touched, &i);
+		}
+		return;
+	}
+
+	ut32 minhash[MATCH_MINHASH_SIZE];
+	minhash_compute(buf, size, minhash);
+	const LshKey *keys = shared->lsh.a;
+	size_t n_keys = rz_vector_len(&shared->lsh);
+	for (ut32 band = 0; band < MATCH_LSH_BANDS; band++) {
+		ut64 key = lsh_band_key(minhash, band);
+		size_t k;
+		rz_array_lower_bound(keys, n_keys, key, k, MATCH_LSH_KEY_CMP);
+		for (size_t n = 0; k < n_keys && keys[k].key == key && n < MATCH_LSH_MAX_BUCKET; k++, n++) {
+			ut32 entry = keys[k].entry;
+			if (!cands->hits[entry]++) {
+				rz_vector_push(&cands->touched, &entry);
+			}
+		}
+	}
+
+	if (rz_vector_len(&cands->touched) > 1) {
+		rz_vector_sort(&cands->touched, candidate_hits_cmp, false, cands->hits);
+	}
+	ut32 *entry;
+	rz_vector_foreach (&cands->touched, entry) {
+		cands->hits[*entry] = 0;
+	}
+	if (rz_vector_len(&cands->touched) > MATCH_CANDIDATES) {
+		rz_vector_remove_range(&cands->touched, MATCH_CANDIDATES, rz_vector_len(&cands->touched) - MATCH_CANDIDATES, NULL);
+	}
+
+	bool found = false;
+	ut64 named = name && shared->names_b ? ht_su_find(shared->names_b, name, &found) : 0;
+	if (found) {
+		ut32 e = (ut32)named;
+		bool present = false;
+		rz_vector_foreach (&cands->touched, entry) {
+			if (*entry == e) {
+				present = true;
+				break;
+			}
+		}
+		if (!present) {
+			rz_vector_push(&cands->touched, &e);
+		}
+	}
+	if (rz_vector_len(&cands->touched) > 1) {
+		rz_vector_sort(&cands->touched, candidate_index_cmp, false, NULL);
+	}
+}
+
+/**
+ * Adds to cands->touched the MATCH_FALLBACK_CANDIDATES entries of B closest
+ * in size to the given one which are not there yet, keeping the order of list B.
+ */
+static void match_candidates_fallback(SharedContext *shared, MatchCandidates *cands, ut32 size) {
+	ut32 *entry;
+	rz_vector_foreach (&cands->touched, entry) {
+		cands->hits[*entry] = 1;
+	}
+	const SizeKey *keys = shared->sizes.a;
+	size_t n_keys = rz_vector_len(&shared->sizes);
+	size_t hi;
+	rz_array_lower_bound(keys, n_keys, size, hi, MATCH_SIZE_KEY_CMP);
+	size_t lo = hi;
+	for (size_t n = 0; n < MATCH_FALLBACK_CANDIDATES && (lo || hi < n_keys); n++) {
+		ut32 e;
+		if (hi < n_keys && (!lo || keys[hi].size - size <= size - keys[lo - 1].size)) {
+			e = keys[hi++].entry;
+		} else {
+			e = keys[--lo].entry;
+		}
+		if (!cands->hits[e]) {
+			rz_vector_push(&cands->touched, &e);
+		}
+	}
+	rz_vector_foreach (&cands->touched, entry) {
+		cands->hits[*entry] = 0;
+	}
+	if (rz_vector_len(&cands->touched) > 1) {
+		rz_vector_sort(&cands->touched, candidate_index_cmp, false, NULL);
+	}
+}
+
 static double analysis_similarity_generic(RzAnalysis *analysis_a, void *ptr_a, RzAnalysis *analysis_b, void *ptr_b, AllocateBuffer callback_new) {
 	ut8 *buf_a = NULL, *buf_b = NULL;
 	ut32 size_a = 0, size_b = 0;
@@ -269,7 +560,7 @@ static void *match_thread_ui(MatchUIInfo *ui_info) {
 	return NULL;
 }
 
-static RZ_OWN RzAnalysisMatchResult *analysis_match_result_new(RZ_NONNULL RzAnalysisMatchOpt *opt, RZ_NONNULL RzList /*<void *>*/ *list_a, RZ_NONNULL RzList /*<void *>*/ *list_b, RzThreadFunction thread_cb, AllocateBuffer alloc_cb) {
+static RZ_OWN RzAnalysisMatchResult *analysis_match_result_new(RZ_NONNULL RzAnalysisMatchOpt *opt, RZ_NONNULL RzList /*<void *>*/ *list_a, RZ_NONNULL RzList /*<void *>*/ *list_b, RzThreadFunction thread_cb, AllocateBuffer alloc_cb, bool load_b, bool functions) {
 	size_t pool_size = 1;
 	RzListIter *iter;
 	RzAnalysisMatchPair *pair = NULL;
@@ -281,7 +572,8 @@ static RZ_OWN RzAnalysisMatchResult *analysis_match_result_new(RZ_NONNULL RzAnal
 	SharedContext shared = { 0 };
 	MatchUIInfo ui_info = { 0 };
 
-	if (!unmatch_a || !unmatch_b || !pool || !shared_context_init(&shared, opt->analysis_a, opt->analysis_b, list_a, list_b, alloc_cb)) {
+	if (!unmatch_a || !unmatch_b || !pool || !shared_context_init(&shared, opt->analysis_a, opt->analysis_b, list_a, list_b, alloc_cb) ||
+		(load_b && !shared_context_load_b(&shared, functions))) {
 		RZ_LOG_ERROR("analysis_match: cannot initialize search context\n");
 		goto fail;
 	}
@@ -362,52 +654,106 @@ RZ_API void rz_analysis_match_result_free(RZ_NULLABLE RzAnalysisMatchResult *res
 	free(result);
 }
 
-static void *analysis_match_basic_blocks(SharedContext *shared) {
-	double max_similarity = 0.0, calc_similarity = 0.0;
-	const RzListIter *iter = NULL;
-	RzAnalysisBlock *bb_a = NULL, *bb_b = NULL, *match = NULL;
-	RzAnalysisMatchPair *pair = NULL;
-	ut32 size_a = 0, size_b = 0;
-	ut8 *buf_a = NULL, *buf_b = NULL;
+static bool function_name_cmp(RzAnalysisFunction *fcn_a, RzAnalysisFunction *fcn_b) {
+	if (RZ_STR_ISEMPTY(fcn_b->name) ||
+		!strncmp(fcn_b->name, "fcn.", strlen("fcn.")) ||
+		RZ_STR_ISEMPTY(fcn_a->name) ||
+		!strncmp(fcn_a->name, "fcn.", strlen("fcn."))) {
+		return false;
+	}
+
+	return !strcmp(fcn_a->name, fcn_b->name);
+}
 
-	while (rz_atomic_bool_get(shared->loop) && (bb_a = rz_th_queue_pop(shared->queue, false))) {
-		if (!shared_context_alloc_a(shared, bb_a, &buf_a, &size_a)) {
-			RZ_LOG_ERROR("analysis_match: cannot allocate buffer for block 0x%08" PFMT64x " (A)\n", bb_a->addr);
-			rz_th_queue_push(shared->unmatch, bb_a, true);
+/**
+ * Finds the best match of the buffer among the given entries of B, in the
+ * order of list B.
+ */
+static void *match_best_entry(SharedContext *shared, void *ptr_a, const ut8 *buf_a, ut32 size_a, bool functions, const ut32 *idx, size_t n, double *similarity) {
+	void *match = NULL;
+	double max_similarity = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		const MatchEntry *entry = &shared->entries_b[idx[i]];
+		if (!rz_atomic_bool_get(shared->loop)) {
+			break;
+		} else if (!entry->buf) {
 			continue;
 		}
 
-		match = NULL;
-		max_similarity = 0.0;
-		rz_list_foreach (shared->list_b, iter, bb_b) {
-			if (!rz_atomic_bool_get(shared->loop)) {
-				break;
-			} else if (!shared_context_alloc_b(shared, bb_b, &buf_b, &size_b)) {
-				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for block 0x%08" PFMT64x " (B)\n", bb_b->addr);
-				continue;
-			}
+		double calc_similarity = calculate_similarity(buf_a, size_a, entry->buf, entry->size);
 
-			calc_similarity = calculate_similarity(buf_a, size_a, buf_b, size_b);
-			free(buf_b);
-
-			if (calc_similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD && calc_similarity <= max_similarity) {
-				continue;
-			}
+		if (functions && function_name_cmp(ptr_a, entry->ptr)) {
 			max_similarity = calc_similarity;
-			match = bb_b;
-			if (max_similarity >= 1.0) {
-				break;
+			match = entry->ptr;
+			break;
+		} else if (calc_similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD && calc_similarity <= max_similarity) {
+			continue;
+		}
+		max_similarity = calc_similarity;
+		match = entry->ptr;
+		if (max_similarity >= 1.0) {
+			break;
+		}
+	}
+	*similarity = max_similarity;
+	return match;
+}
+
+/**
+ * Matches every element of the queue (list A) against its candidates of
+ * list B; the names are compared only when matching functions.
+ *
+ * When none of the candidates is similar enough, the element is compared
+ * also against the elements of B closest in size, so the elements without a
+ * counterpart still get a close match without scanning the whole list B.
+ */
+static void analysis_match_entries(SharedContext *shared, bool functions) {
+	double max_similarity = 0.0;
+	void *ptr_a = NULL, *match = NULL;
+	RzAnalysisMatchPair *pair = NULL;
+	ut32 size_a = 0;
+	ut8 *buf_a = NULL;
+	MatchCandidates cands = { 0 };
+	rz_vector_init(&cands.touched, sizeof(ut32), NULL, NULL);
+	if (shared->n_entries_b && !(cands.hits = calloc(shared->n_entries_b, sizeof(ut8)))) {
+		RZ_LOG_ERROR("analysis_match: cannot allocate candidates\n");
+		return;
+	}
+
+	while (rz_atomic_bool_get(shared->loop) && (ptr_a = rz_th_queue_pop(shared->queue, false))) {
+		if (!shared_context_alloc_a(shared, ptr_a, &buf_a, &size_a)) {
+			if (functions) {
+				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for function %s (A)\n", ((RzAnalysisFunction *)ptr_a)->name);
+			} else {
+				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for block 0x%08" PFMT64x " (A)\n", ((RzAnalysisBlock *)ptr_a)->addr);
 			}
+			rz_th_queue_push(shared->unmatch, ptr_a, true);
+			continue;
+		}
+
+		const char *name = functions && is_named_function(ptr_a) ? ((RzAnalysisFunction *)ptr_a)->name : NULL;
+		match_candidates_find(shared, &cands, buf_a, size_a, name);
+
+		match = match_best_entry(shared, ptr_a, buf_a, size_a, functions, cands.touched.a, rz_vector_len(&cands.touched), &max_similarity);
+		if (shared->n_entries_b > MATCH_CANDIDATES && max_similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD) {
+			match_candidates_fallback(shared, &cands, size_a);
+			match = match_best_entry(shared, ptr_a, buf_a, size_a, functions, cands.touched.a, rz_vector_len(&cands.touched), &max_similarity);
 		}
 		free(buf_a);
 
-		if (match && (pair = match_pair_new(bb_a, match, max_similarity))) {
+		if (match && (pair = match_pair_new(ptr_a, match, max_similarity))) {
 			rz_th_queue_push(shared->matches, pair, true);
 			continue;
 		}
-		rz_th_queue_push(shared->unmatch, bb_a, true);
+		rz_th_queue_push(shared->unmatch, ptr_a, true);
 	}
 
+	free(cands.hits);
+	rz_vector_fini(&cands.touched);
+}
+
+static void *analysis_match_basic_blocks(SharedContext *shared) {
+	analysis_match_entries(shared, false);
 	return NULL;
 }
 
@@ -443,73 +789,14 @@ RZ_API RZ_OWN RzAnalysisMatchResult *rz_analysis_match_basic_blocks(RZ_NONNULL R
 		rz_list_append(list_b, *it);
 	}
 
-	RzAnalysisMatchResult *res = analysis_match_result_new(opt, list_a, list_b, (RzThreadFunction)analysis_match_basic_blocks, (AllocateBuffer)basic_block_data_new);
+	RzAnalysisMatchResult *res = analysis_match_result_new(opt, list_a, list_b, (RzThreadFunction)analysis_match_basic_blocks, (AllocateBuffer)basic_block_data_new, true, false);
 	rz_list_free(list_a);
 	rz_list_free(list_b);
 	return res;
 }
 
-static bool function_name_cmp(RzAnalysisFunction *fcn_a, RzAnalysisFunction *fcn_b) {
-	if (RZ_STR_ISEMPTY(fcn_b->name) ||
-		!strncmp(fcn_b->name, "fcn.", strlen("fcn.")) ||
-		RZ_STR_ISEMPTY(fcn_a->name) ||
-		!strncmp(fcn_a->name, "fcn.", strlen("fcn."))) {
-		return false;
-	}
-
-	return !strcmp(fcn_a->name, fcn_b->name);
-}
-
 static void *analysis_match_functions(SharedContext *shared) {
-	double max_similarity = 0.0, calc_similarity = 0.0;
-	const RzListIter *iter = NULL;
-	RzAnalysisFunction *fcn_a = NULL, *fcn_b = NULL, *match = NULL;
-	RzAnalysisMatchPair *pair = NULL;
-	ut32 size_a = 0, size_b = 0;
-	ut8 *buf_a = NULL, *buf_b = NULL;
-
-	while (rz_atomic_bool_get(shared->loop) && (fcn_a = rz_th_queue_pop(shared->queue, false))) {
-		if (!shared_context_alloc_a(shared, fcn_a, &buf_a, &size_a)) {
-			RZ_LOG_ERROR("analysis_match: cannot allocate buffer for function %s (A)\n", fcn_a->name);
-			rz_th_queue_push(shared->unmatch, fcn_a, true);
-			continue;
-		}
-
-		match = NULL;
-		max_similarity = 0.0;
-		rz_list_foreach (shared->list_b, iter, fcn_b) {
-			if (!rz_atomic_bool_get(shared->loop)) {
-				break;
-			} else if (!shared_context_alloc_b(shared, fcn_b, &buf_b, &size_b)) {
-				RZ_LOG_ERROR("analysis_match: cannot allocate buffer for function %s (B)\n", fcn_b->name);
-				continue;
-			}
-
-			calc_similarity = calculate_similarity(buf_a, size_a, buf_b, size_b);
-			free(buf_b);
-
-			if (function_name_cmp(fcn_a, fcn_b)) {
-				max_similarity = calc_similarity;
-				match = fcn_b;
-				break;
-			} else if (calc_similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD && calc_similarity <= max_similarity) {
-				continue;
-			}
-			max_similarity = calc_similarity;
-			match = fcn_b;
-			if (max_similarity >= 1.0) {
-				break;
-			}
-		}
-		free(buf_a);
-
-		if (match && (pair = match_pair_new(fcn_a, match, max_similarity))) {
-			rz_th_queue_push(shared->matches, pair, true);
-			continue;
-		}
-		rz_th_queue_push(shared->unmatch, fcn_a, true);
-	}
-
+	analysis_match_entries(shared, true);
 	return NULL;
 }
 
@@ -559,9 +846,9 @@ static void *analysis_match_one_function(SharedContext *shared) {
 RZ_API RZ_OWN RzAnalysisMatchResult *rz_analysis_match_functions(RzList /*<RzAnalysisFunction *>*/ *list_a, RzList /*<RzAnalysisFunction *>*/ *list_b, RZ_NONNULL RzAnalysisMatchOpt *opt) {
 	rz_return_val_if_fail(opt && opt->analysis_a && opt->analysis_b && list_a && list_b, NULL);
 	if (rz_list_length(list_a) == 1) {
-		return analysis_match_result_new(opt, list_b, list_a, (RzThreadFunction)analysis_match_one_function, (AllocateBuffer)function_data_new);
+		return analysis_match_result_new(opt, list_b, list_a, (RzThreadFunction)analysis_match_one_function, (AllocateBuffer)function_data_new, false, true);
 	}
-	return analysis_match_result_new(opt, list_a, list_b, (RzThreadFunction)analysis_match_functions, (AllocateBuffer)function_data_new);
+	return analysis_match_result_new(opt, list_a, list_b, (RzThreadFunction)analysis_match_functions, (AllocateBuffer)function_data_new, true, true);
 }
 
 /**
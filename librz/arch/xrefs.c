@@ -6,107 +6,334 @@
 
 #include <rz_analysis.h>
 #include <rz_cons.h>
+#include "analysis_private.h"
 
 /*
-DICT
-====
+ * The xrefs are kept twice, once sorted by (from, to) and once sorted by
+ * (to, from), so that both directions can be looked up with a binary
+ * search and listed in order without sorting.
+ *
+ * Each of the two indexes is a set of sorted runs (a Bentley-Saxe
+ * structure): runs[0] is a small buffer receiving the single inserts with
+ * an insertion sort. When it is full it is merged with runs[1], the result
+ * with runs[2] if it is not empty and so on, so every run is roughly twice
+ * as large as the previous one and each xref is moved O(log n) times.
+ * Lookups binary search every run and listings merge the runs on the fly.
+ *
+ * Only one type is kept for a (from, to) pair, setting the same pair again
+ * replaces the type.
+ */
 
-refs 10->20 C 16->10 J 20->10 C
+#define XREFS_BUF_SIZE 256
+#define XREFS_LEVELS   48
 
-xrefs 20->[10 C] 10 -> [16 J, 20 C]
+typedef struct {
+	RzAnalysisXRef *xrefs;
+	size_t len;
+	size_t cap;
+} XRefRun;
 
-10 : call 20 16 : jmp 10 20 : call 10
-*/
-// TODO: is it possible to have multiple type for the same (from, to) pair?
-//       if it is, things need to be adjusted
+typedef struct {
+	bool by_to; ///< sorted by (to, from) instead of (from, to)
+	XRefRun runs[XREFS_LEVELS];
+} XRefIndex;
 
-static RzAnalysisXRef *rz_analysis_xref_new(ut64 from, ut64 to, ut64 type) {
-	RzAnalysisXRef *xref = RZ_NEW(RzAnalysisXRef);
-	if (xref) {
-		xref->from = from;
-		xref->to = to;
-		xref->type = (type == -1) ? RZ_ANALYSIS_XREF_TYPE_CODE : type;
+struct rz_analysis_xrefs_t {
+	XRefIndex from; ///< sorted by (from, to)
+	XRefIndex to; ///< sorted by (to, from)
+	ut64 count;
+};
+
+static inline ut64 key_hi(const XRefIndex *idx, const RzAnalysisXRef *xref) {
+	return idx->by_to ? xref->to : xref->from;
+}
+
+static inline ut64 key_lo(const XRefIndex *idx, const RzAnalysisXRef *xref) {
+	return idx->by_to ? xref->from : xref->to;
+}
+
+static inline int key_cmp(const XRefIndex *idx, const RzAnalysisXRef *xref, ut64 hi, ut64 lo) {
+	ut64 xhi = key_hi(idx, xref);
+	if (xhi != hi) {
+		return xhi < hi ? -1 : 1;
 	}
-	return xref;
+	ut64 xlo = key_lo(idx, xref);
+	if (xlo != lo) {
+		return xlo < lo ? -1 : 1;
+	}
+	return 0;
 }
 
-static void rz_analysis_xref_free(RzAnalysisXRef *xref) {
-	free(xref);
+static inline int xref_cmp(const XRefIndex *idx, const RzAnalysisXRef *a, const RzAnalysisXRef *b) {
+	return key_cmp(idx, a, key_hi(idx, b), key_lo(idx, b));
 }
 
-RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xref_list_new() {
-	return rz_list_newf((RzListFree)free);
+/**
+ * \brief Returns the index of the first xref of \p run not lower than (hi, lo)
+ */
+static size_t run_lower_bound(const XRefIndex *idx, const XRefRun *run, ut64 hi, ut64 lo) {
+	size_t l = 0, r = run->len;
+	while (l < r) {
+		size_t m = l + (r - l) / 2;
+		if (key_cmp(idx, &run->xrefs[m], hi, lo) < 0) {
+			l = m + 1;
+		} else {
+			r = m;
+		}
+	}
+	return l;
 }
 
-static bool appendRef(void *u, const ut64 k, const void *v) {
-	RzList *list = (RzList *)u;
-	RzAnalysisXRef *xref = (RzAnalysisXRef *)v;
-	RzAnalysisXRef *cloned = rz_analysis_xref_new(xref->from, xref->to, xref->type);
-	if (cloned) {
-		rz_list_append(list, cloned);
-		return true;
+/**
+ * \brief Returns the index of the first xref of \p run whose high key is greater than \p hi
+ */
+static size_t run_upper_bound(const XRefIndex *idx, const XRefRun *run, ut64 hi) {
+	if (hi == UT64_MAX) {
+		return run->len;
+	}
+	return run_lower_bound(idx, run, hi + 1, 0);
+}
+
+static RzAnalysisXRef *index_find(XRefIndex *idx, ut64 hi, ut64 lo, size_t *level, size_t *pos) {
+	for (size_t i = 0; i < XREFS_LEVELS; i++) {
+		XRefRun *run = &idx->runs[i];
+		if (!run->len) {
+			continue;
+		}
+		size_t p = run_lower_bound(idx, run, hi, lo);
+		if (p < run->len && !key_cmp(idx, &run->xrefs[p], hi, lo)) {
+			if (level) {
+				*level = i;
+			}
+			if (pos) {
+				*pos = p;
+			}
+			return &run->xrefs[p];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Merges the sorted \p carry into \p run, from the back to do it in place
+ */
+static bool run_merge(const XRefIndex *idx, XRefRun *run, const RzAnalysisXRef *carry, size_t carry_len) {
+	size_t total = run->len + carry_len;
+	if (total > run->cap) {
+		RzAnalysisXRef *tmp = realloc(run->xrefs, total * sizeof(RzAnalysisXRef));
+		if (!tmp) {
+			return false;
+		}
+		run->xrefs = tmp;
+		run->cap = total;
+	}
+	size_t i = run->len, j = carry_len, k = total;
+	while (j) {
+		if (i && xref_cmp(idx, &run->xrefs[i - 1], &carry[j - 1]) > 0) {
+			run->xrefs[--k] = run->xrefs[--i];
+		} else {
+			run->xrefs[--k] = carry[--j];
+		}
+	}
+	run->len = total;
+	return true;
+}
+
+/**
+ * \brief Pushes the sorted run \p carry, which is taken over, starting at \p level
+ */
+static bool index_push_run(XRefIndex *idx, XRefRun carry, size_t level) {
+	for (size_t i = level; i < XREFS_LEVELS; i++) {
+		XRefRun *run = &idx->runs[i];
+		if (!run->len) {
+			free(run->xrefs);
+			*run = carry;
+			return true;
+		}
+		if (!run_merge(idx, run, carry.xrefs, carry.len)) {
+			if (i == level) {
+				return false;
+			}
+			// the previous level has been emptied into carry
+			idx->runs[i - 1] = carry;
+			return true;
+		}
+		free(carry.xrefs);
+		carry = *run;
+		*run = (XRefRun){ 0 };
 	}
+	rz_warn_if_reached();
 	return false;
 }
 
-static bool mylistrefs_cb(void *list, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach(ht, appendRef, list);
+static bool index_flush_buffer(XRefIndex *idx) {
+	XRefRun carry = idx->runs[0];
+	idx->runs[0] = (XRefRun){ 0 };
+	if (!index_push_run(idx, carry, 1)) {
+		idx->runs[0] = carry;
+		return false;
+	}
 	return true;
 }
 
-static int ref_cmp(const RzAnalysisXRef *a, const RzAnalysisXRef *b, void *user) {
-	if (a->from < b->from) {
-		return -1;
+static bool index_insert(XRefIndex *idx, const RzAnalysisXRef *xref) {
+	XRefRun *buf = &idx->runs[0];
+	if (buf->len == XREFS_BUF_SIZE && !index_flush_buffer(idx)) {
+		return false;
+	}
+	if (!buf->xrefs) {
+		buf->xrefs = RZ_NEWS(RzAnalysisXRef, XREFS_BUF_SIZE);
+		if (!buf->xrefs) {
+			return false;
+		}
+		buf->cap = XREFS_BUF_SIZE;
 	}
-	if (a->from > b->from) {
-		return 1;
+	size_t p = run_lower_bound(idx, buf, key_hi(idx, xref), key_lo(idx, xref));
+	memmove(&buf->xrefs[p + 1], &buf->xrefs[p], (buf->len - p) * sizeof(RzAnalysisXRef));
+	buf->xrefs[p] = *xref;
+	buf->len++;
+	if (buf->len == XREFS_BUF_SIZE) {
+		// a failure just leaves the buffer full until the next insert
+		(void)index_flush_buffer(idx);
 	}
-	if (a->to < b->to) {
-		return -1;
+	return true;
+}
+
+static bool index_delete(XRefIndex *idx, ut64 hi, ut64 lo) {
+	size_t level, pos;
+	if (!index_find(idx, hi, lo, &level, &pos)) {
+		return false;
 	}
-	if (a->to > b->to) {
-		return 1;
+	XRefRun *run = &idx->runs[level];
+	memmove(&run->xrefs[pos], &run->xrefs[pos + 1], (run->len - pos - 1) * sizeof(RzAnalysisXRef));
+	run->len--;
+	if (!run->len && level) {
+		RZ_FREE(run->xrefs);
+		run->cap = 0;
+	}
+	return true;
+}
+
+static void index_fini(XRefIndex *idx) {
+	for (size_t i = 0; i < XREFS_LEVELS; i++) {
+		free(idx->runs[i].xrefs);
+		idx->runs[i] = (XRefRun){ 0 };
+	}
+}
+
+static int xref_cmp_from(const void *a, const void *b) {
+	const RzAnalysisXRef *x = a, *y = b;
+	if (x->from != y->from) {
+		return x->from < y->from ? -1 : 1;
+	}
+	if (x->to != y->to) {
+		return x->to < y->to ? -1 : 1;
 	}
 	return 0;
 }
 
-static void sortxrefs(RzList /*<RzAnalysisXRef *>*/ *list) {
-	rz_list_sort(list, (RzListComparator)ref_cmp, NULL);
+static int xref_cmp_to(const void *a, const void *b) {
+	const RzAnalysisXRef *x = a, *y = b;
+	if (x->to != y->to) {
+		return x->to < y->to ? -1 : 1;
+	}
+	if (x->from != y->from) {
+		return x->from < y->from ? -1 : 1;
+	}
+	return 0;
 }
 
-static void listxrefs(HtUP *m, ut64 addr, RzList /*<RzAnalysisXRef *>*/ *list) {
-	if (addr == UT64_MAX) {
-		ht_up_foreach(m, mylistrefs_cb, list);
-	} else {
-		HtUP *d = ht_up_find(m, addr, NULL);
-		if (d) {
-			ht_up_foreach(d, appendRef, list);
+typedef struct {
+	const XRefIndex *idx;
+	size_t pos[XREFS_LEVELS];
+	size_t end[XREFS_LEVELS];
+} XRefIter;
+
+static void *xref_iter_next(RzIterator *it) {
+	XRefIter *iter = it->u;
+	const RzAnalysisXRef *best = NULL;
+	size_t best_level = 0;
+	for (size_t i = 0; i < XREFS_LEVELS; i++) {
+		if (iter->pos[i] >= iter->end[i]) {
+			continue;
 		}
+		const RzAnalysisXRef *xref = &iter->idx->runs[i].xrefs[iter->pos[i]];
+		if (!best || xref_cmp(iter->idx, xref, best) < 0) {
+			best = xref;
+			best_level = i;
+		}
+	}
+	if (!best) {
+		return NULL;
 	}
+	iter->pos[best_level]++;
+	return (void *)best;
 }
 
-static bool set_xref(HtUP *m, RzAnalysisXRef *xref, bool from2to) {
-	ut64 key1 = from2to ? xref->from : xref->to;
-	HtUP *ht = ht_up_find(m, key1, NULL);
-	if (!ht) {
-		// RzAnalysis::ht_xrefs_to is responsible for releasing of pointers.
-		HtUPFreeValue cb = from2to ? NULL : (HtUPFreeValue)rz_analysis_xref_free;
-		ht = ht_up_new(NULL, cb);
-		if (!ht) {
-			return false;
+/**
+ * \brief Iterates the xrefs of \p idx whose high key is \p hi, or all of them if \p hi is UT64_MAX
+ */
+static RzIterator *index_iter(const XRefIndex *idx, ut64 hi) {
+	XRefIter *iter = RZ_NEW0(XRefIter);
+	if (!iter) {
+		return NULL;
+	}
+	iter->idx = idx;
+	for (size_t i = 0; i < XREFS_LEVELS; i++) {
+		const XRefRun *run = &idx->runs[i];
+		if (!run->len) {
+			continue;
 		}
-		if (!ht_up_insert(m, key1, ht)) {
-			return false;
+		if (hi == UT64_MAX) {
+			iter->end[i] = run->len;
+			continue;
 		}
+		iter->pos[i] = run_lower_bound(idx, run, hi, 0);
+		iter->end[i] = run_upper_bound(idx, run, hi);
 	}
-	ut64 key2 = from2to ? xref->to : xref->from;
-	return ht_up_update(ht, key2, xref);
+	return rz_iterator_new(xref_iter_next, NULL, free, iter);
 }
 
-// Set a cross reference from FROM to TO.
-RZ_API bool rz_analysis_xrefs_set(RzAnalysis *analysis, ut64 from, ut64 to, RzAnalysisXRefType type) {
-	if (!analysis || from == to) {
+static RzAnalysisXRef *rz_analysis_xref_new(ut64 from, ut64 to, ut64 type) {
+	RzAnalysisXRef *xref = RZ_NEW(RzAnalysisXRef);
+	if (xref) {
+		xref->from = from;
+		xref->to = to;
+		xref->type = (type == -1) ? RZ_ANALYSIS_XREF_TYPE_CODE : type;
+	}
+	return xref;
+}
+
+RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xref_list_new() {
+	return rz_list_newf((RzListFree)free);
+}
+
+static int ref_cmp(const RzAnalysisXRef *a, const RzAnalysisXRef *b, void *user) {
+	return xref_cmp_from(a, b);
+}
+
+static void sortxrefs(RzList /*<RzAnalysisXRef *>*/ *list) {
+	rz_list_sort(list, (RzListComparator)ref_cmp, NULL);
+}
+
+static void listxrefs(const XRefIndex *idx, ut64 addr, RzList /*<RzAnalysisXRef *>*/ *list) {
+	RzIterator *it = index_iter(idx, addr);
+	if (!it) {
+		return;
+	}
+	RzAnalysisXRef *xref;
+	rz_iterator_foreach(it, xref) {
+		RzAnalysisXRef *cloned = rz_analysis_xref_new(xref->from, xref->to, xref->type);
+		if (!cloned || !rz_list_append(list, cloned)) {
+			free(cloned);
+			break;
+		}
+	}
+	rz_iterator_free(it);
+}
+
+static bool xrefs_valid(RzAnalysis *analysis, ut64 from, ut64 to) {
+	if (from == to) {
 		return false;
 	}
 	if (analysis->iob.is_valid_offset) {
@@ -117,36 +344,157 @@ RZ_API bool rz_analysis_xrefs_set(RzAnalysis *analysis, ut64 from, ut64 to, RzAn
 			return false;
 		}
 	}
-	RzAnalysisXRef *xref = rz_analysis_xref_new(from, to, type);
+	return true;
+}
+
+typedef struct {
+	RzAnalysisXRef xref;
+	size_t pos; ///< position in the input of rz_analysis_xrefs_set_bulk()
+} BulkXRef;
+
+static int bulk_cmp(const void *a, const void *b) {
+	const BulkXRef *x = a, *y = b;
+	int r = xref_cmp_from(&x->xref, &y->xref);
+	if (r) {
+		return r;
+	}
+	return x->pos < y->pos ? -1 : (x->pos > y->pos ? 1 : 0);
+}
+
+/**
+ * \brief Updates the type of the xref (from, to) if it is already known
+ */
+static bool xrefs_update(RzAnalysisXRefs *xrefs, ut64 from, ut64 to, RzAnalysisXRefType type) {
+	RzAnalysisXRef *xref = index_find(&xrefs->from, from, to, NULL, NULL);
 	if (!xref) {
 		return false;
 	}
-	if (!set_xref(analysis->ht_xrefs_from, xref, true)) {
-		// Pointer isn't added to <ht_xrefs_from> so we have to release it
-		rz_analysis_xref_free(xref);
+	xref->type = type;
+	xref = index_find(&xrefs->to, to, from, NULL, NULL);
+	if (xref) {
+		xref->type = type;
+	}
+	return true;
+}
+
+// Set a cross reference from FROM to TO.
+RZ_API bool rz_analysis_xrefs_set(RzAnalysis *analysis, ut64 from, ut64 to, RzAnalysisXRefType type) {
+	if (!analysis || !analysis->xrefs || !xrefs_valid(analysis, from, to)) {
+		return false;
+	}
+	RzAnalysisXRefs *xrefs = analysis->xrefs;
+	RzAnalysisXRef xref = {
+		.from = from,
+		.to = to,
+		.type = ((int)type == -1) ? RZ_ANALYSIS_XREF_TYPE_CODE : type,
+	};
+	if (xrefs_update(xrefs, from, to, xref.type)) {
+		return true;
+	}
+	if (!index_insert(&xrefs->from, &xref)) {
 		return false;
 	}
-	if (!set_xref(analysis->ht_xrefs_to, xref, false)) {
-		// Delete the entry in <ht_xrefs_from>
-		rz_analysis_xrefs_deln(analysis, from, to, type);
-		// Pointer isn't added to <ht_xrefs_to> so we have to release it
-		rz_analysis_xref_free(xref);
+	if (!index_insert(&xrefs->to, &xref)) {
+		index_delete(&xrefs->from, from, to);
 		return false;
 	}
+	xrefs->count++;
 	return true;
 }
 
+/**
+ * \brief Sets many xrefs at once.
+ *
+ * Equivalent to calling rz_analysis_xrefs_set() on each element of \p xrefs
+ * in order, but the new xrefs are sorted and added as a single run instead
+ * of one by one, which is much faster for large amounts of xrefs.
+ *
+ * \param analysis RzAnalysis instance
+ * \param xrefs    The xrefs to set
+ * \param n        The number of elements of \p xrefs
+ * \return The number of xrefs which have been set or updated
+ */
+RZ_API size_t rz_analysis_xrefs_set_bulk(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const RzAnalysisXRef *xrefs, size_t n) {
+	rz_return_val_if_fail(analysis && analysis->xrefs && (xrefs || !n), 0);
+	if (!n) {
+		return 0;
+	}
+	RzAnalysisXRefs *store = analysis->xrefs;
+	BulkXRef *bulk = RZ_NEWS(BulkXRef, n);
+	if (!bulk) {
+		return 0;
+	}
+	size_t len = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (!xrefs_valid(analysis, xrefs[i].from, xrefs[i].to)) {
+			continue;
+		}
+		bulk[len].xref = xrefs[i];
+		if ((int)bulk[len].xref.type == -1) {
+			bulk[len].xref.type = RZ_ANALYSIS_XREF_TYPE_CODE;
+		}
+		bulk[len].pos = i;
+		len++;
+	}
+	qsort(bulk, len, sizeof(BulkXRef), bulk_cmp);
+
+	RzAnalysisXRef *run_from = len ? RZ_NEWS(RzAnalysisXRef, len) : NULL;
+	if (len && !run_from) {
+		free(bulk);
+		return 0;
+	}
+	size_t set = 0, n_new = 0;
+	for (size_t i = 0; i < len; i++) {
+		// only the last of the duplicates counts, like with sequential sets
+		if (i + 1 < len && !xref_cmp_from(&bulk[i].xref, &bulk[i + 1].xref)) {
+			continue;
+		}
+		const RzAnalysisXRef *xref = &bulk[i].xref;
+		set++;
+		if (!xrefs_update(store, xref->from, xref->to, xref->type)) {
+			run_from[n_new++] = *xref;
+		}
+	}
+	free(bulk);
+	if (!n_new) {
+		free(run_from);
+		return set;
+	}
+
+	RzAnalysisXRef *run_to = RZ_NEWS(RzAnalysisXRef, n_new);
+	if (!run_to) {
+		free(run_from);
+		return set - n_new;
+	}
+	memcpy(run_to, run_from, n_new * sizeof(RzAnalysisXRef));
+	qsort(run_to, n_new, sizeof(RzAnalysisXRef), xref_cmp_to);
+	XRefRun from_run = { run_from, n_new, n_new };
+	if (!index_push_run(&store->from, from_run, 1)) {
+		free(run_from);
+		free(run_to);
+		return set - n_new;
+	}
+	XRefRun to_run = { run_to, n_new, n_new };
+	if (!index_push_run(&store->to, to_run, 1)) {
+		for (size_t i = 0; i < n_new; i++) {
+			index_delete(&store->from, run_to[i].from, run_to[i].to);
+		}
+		free(run_to);
+		return set - n_new;
+	}
+	store->count += n_new;
+	return set;
+}
+
 RZ_API bool rz_analysis_xrefs_deln(RzAnalysis *analysis, ut64 from, ut64 to, RzAnalysisXRefType type) {
-	if (!analysis) {
+	if (!analysis || !analysis->xrefs) {
 		return false;
 	}
-	HtUP *ht1 = ht_up_find(analysis->ht_xrefs_from, from, NULL);
-	if (ht1) {
-		ht_up_delete(ht1, to);
-	}
-	HtUP *ht2 = ht_up_find(analysis->ht_xrefs_to, to, NULL);
-	if (ht2) {
-		ht_up_delete(ht2, from);
+	RzAnalysisXRefs *xrefs = analysis->xrefs;
+	bool deleted = index_delete(&xrefs->from, from, to);
+	deleted |= index_delete(&xrefs->to, to, from);
+	if (deleted && xrefs->count) {
+		xrefs->count--;
 	}
 	return true;
 }
@@ -166,8 +514,8 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_to(RzAnalysis
 	if (!list) {
 		return NULL;
 	}
-	listxrefs(analysis->ht_xrefs_to, addr, list);
-	sortxrefs(list);
+	// all the xrefs are listed with UT64_MAX, keep the (from, to) order for them
+	listxrefs(addr == UT64_MAX ? &analysis->xrefs->from : &analysis->xrefs->to, addr, list);
 	if (rz_list_empty(list)) {
 		rz_list_free(list);
 		list = NULL;
@@ -180,8 +528,7 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_from(RzAnalys
 	if (!list) {
 		return NULL;
 	}
-	listxrefs(analysis->ht_xrefs_from, addr, list);
-	sortxrefs(list);
+	listxrefs(&analysis->xrefs->from, addr, list);
 	if (rz_list_empty(list)) {
 		rz_list_free(list);
 		list = NULL;
@@ -198,12 +545,69 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_list(RzAnalysis *
 	rz_return_val_if_fail(analysis, NULL);
 	RzList *list = rz_analysis_xref_list_new();
 	if (list) {
-		listxrefs(analysis->ht_xrefs_from, UT64_MAX, list);
-		sortxrefs(list);
+		listxrefs(&analysis->xrefs->from, UT64_MAX, list);
 	}
 	return list;
 }
 
+/**
+ * \brief Iterates the xrefs pointing to \p addr, sorted by source address.
+ *
+ * The yielded xrefs are borrowed from the store: they must not be modified
+ * and the iterator must be freed before setting or deleting any xref.
+ *
+ * \param analysis RzAnalysis instance
+ * \param addr     The destination address
+ * \return RzIterator yielding RzAnalysisXRef *
+ */
+RZ_API RZ_OWN RzIterator *rz_analysis_xrefs_get_to_iter(RZ_NONNULL RzAnalysis *analysis, ut64 addr) {
+	rz_return_val_if_fail(analysis && analysis->xrefs && addr != UT64_MAX, NULL);
+	return index_iter(&analysis->xrefs->to, addr);
+}
+
+/**
+ * \brief Iterates the xrefs from \p addr, sorted by destination address.
+ *
+ * Same restrictions as rz_analysis_xrefs_get_to_iter().
+ *
+ * \param analysis RzAnalysis instance
+ * \param addr     The source address
+ * \return RzIterator yielding RzAnalysisXRef *
+ */
+RZ_API RZ_OWN RzIterator *rz_analysis_xrefs_get_from_iter(RZ_NONNULL RzAnalysis *analysis, ut64 addr) {
+	rz_return_val_if_fail(analysis && analysis->xrefs && addr != UT64_MAX, NULL);
+	return index_iter(&analysis->xrefs->from, addr);
+}
+
+/**
+ * \brief Iterates all the xrefs, sorted by (from, to).
+ *
+ * Same restrictions as rz_analysis_xrefs_get_to_iter().
+ *
+ * \param analysis RzAnalysis instance
+ * \return RzIterator yielding RzAnalysisXRef *
+ */
+RZ_API RZ_OWN RzIterator *rz_analysis_xrefs_iter(RZ_NONNULL RzAnalysis *analysis) {
+	rz_return_val_if_fail(analysis && analysis->xrefs, NULL);
+	return index_iter(&analysis->xrefs->from, UT64_MAX);
+}
+
+/**
+ * \brief Returns the number of bytes allocated to store the xrefs
+ */
+RZ_API ut64 rz_analysis_xrefs_memory_usage(RZ_NONNULL RzAnalysis *analysis) {
+	rz_return_val_if_fail(analysis, 0);
+	RzAnalysisXRefs *xrefs = analysis->xrefs;
+	if (!xrefs) {
+		return 0;
+	}
+	ut64 size = sizeof(RzAnalysisXRefs);
+	for (size_t i = 0; i < XREFS_LEVELS; i++) {
+		size += (xrefs->from.runs[i].cap + xrefs->to.runs[i].cap) * sizeof(RzAnalysisXRef);
+	}
+	return size;
+}
+
 RZ_API const char *rz_analysis_xrefs_type_tostring(RzAnalysisXRefType type) {
 	switch (type) {
 	case RZ_ANALYSIS_XREF_TYPE_CODE:
@@ -234,39 +638,29 @@ RZ_API RzAnalysisXRefType rz_analysis_xrefs_type(char ch) {
 }
 
 RZ_API bool rz_analysis_xrefs_init(RzAnalysis *analysis) {
-	ht_up_free(analysis->ht_xrefs_from);
-	analysis->ht_xrefs_from = NULL;
-	ht_up_free(analysis->ht_xrefs_to);
-	analysis->ht_xrefs_to = NULL;
-
-	HtUP *tmp = ht_up_new(NULL, (HtUPFreeValue)ht_up_free);
-	if (!tmp) {
+	rz_analysis_xrefs_fini(analysis);
+	analysis->xrefs = RZ_NEW0(RzAnalysisXRefs);
+	if (!analysis->xrefs) {
 		return false;
 	}
-	analysis->ht_xrefs_from = tmp;
-
-	tmp = ht_up_new(NULL, (HtUPFreeValue)ht_up_free);
-	if (!tmp) {
-		ht_up_free(analysis->ht_xrefs_from);
-		analysis->ht_xrefs_from = NULL;
-		return false;
-	}
-	analysis->ht_xrefs_to = tmp;
+	analysis->xrefs->to.by_to = true;
 	return true;
 }
 
-static bool count_cb(void *user, const ut64 k, const void *v) {
-	(*(ut64 *)user) += ((HtUP *)v)->count;
-	return true;
+RZ_IPI void rz_analysis_xrefs_fini(RzAnalysis *analysis) {
+	if (!analysis->xrefs) {
+		return;
+	}
+	index_fini(&analysis->xrefs->from);
+	index_fini(&analysis->xrefs->to);
+	RZ_FREE(analysis->xrefs);
 }
 
 RZ_API ut64 rz_analysis_xrefs_count(RzAnalysis *analysis) {
-	ut64 ret = 0;
-	ht_up_foreach(analysis->ht_xrefs_to, count_cb, &ret);
-	return ret;
+	return analysis->xrefs ? analysis->xrefs->count : 0;
 }
 
-static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFunction *fcn, HtUP *ht) {
+static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFunction *fcn, const XRefIndex *idx) {
 	void **it;
 	RzAnalysisBlock *bb;
 	RzList *list = rz_analysis_xref_list_new();
@@ -277,7 +671,7 @@ static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFuncti
 		bb = (RzAnalysisBlock *)*it;
 		for (size_t i = 0; i < bb->ninstr; i++) {
 			ut64 at = bb->addr + rz_analysis_block_get_op_offset(bb, i);
-			listxrefs(ht, at, list);
+			listxrefs(idx, at, list);
 		}
 	}
 	sortxrefs(list);
@@ -286,12 +680,12 @@ static RZ_OWN RzList /*<RzAnalysisXRef *>*/ *fcn_get_refs(const RzAnalysisFuncti
 
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_from(const RzAnalysisFunction *fcn) {
 	rz_return_val_if_fail(fcn, NULL);
-	return fcn_get_refs(fcn, fcn->analysis->ht_xrefs_from);
+	return fcn_get_refs(fcn, &fcn->analysis->xrefs->from);
 }
 
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_to(const RzAnalysisFunction *fcn) {
 	rz_return_val_if_fail(fcn, NULL);
-	return fcn_get_refs(fcn, fcn->analysis->ht_xrefs_to);
+	return fcn_get_refs(fcn, &fcn->analysis->xrefs->to);
 }
 
 RZ_API const char *rz_analysis_ref_type_tostring(RzAnalysisXRefType t) {
@@ -241,6 +241,7 @@ RZ_API RzBinFile *rz_bin_reload(RzBin *bin, RzBinFile *bf, ut64 baseaddr) {
 	bool elf_load_sections = bf->o ? bf->o->opts.elf_load_sections : false;
 	bool elf_checks_sections = bf->o ? bf->o->opts.elf_checks_sections : false;
 	bool elf_checks_segments = bf->o ? bf->o->opts.elf_checks_segments : false;
+	bool lazy = bf->o ? bf->o->opts.lazy : false;
 
 	RzBinOptions opt;
 	rz_bin_options_init(&opt, bf->fd, baseaddr, bf->loadaddr, patch_relocs);
@@ -248,6 +249,7 @@ RZ_API RzBinFile *rz_bin_reload(RzBin *bin, RzBinFile *bf, ut64 baseaddr) {
 	opt.obj_opts.elf_checks_sections = elf_checks_sections;
 	opt.obj_opts.elf_checks_segments = elf_checks_segments;
 	opt.obj_opts.big_endian = big_endian;
+	opt.obj_opts.lazy = lazy;
 	opt.filename = bf->file;
 	rz_buf_seek(bf->buf, 0, RZ_BUF_SET);
 	RzBinFile *nbf = rz_bin_open_buf(bin, bf->buf, &opt);
@@ -4,6 +4,7 @@
 
 #include <rz_bin.h>
 #include <rz_util.h>
+#include "i/private.h"
 
 #define skip_prefix_s(s, p) \
 	do { \
@@ -32,8 +33,216 @@ static const char *get_mangled_name(const char *mangled) {
 #undef skip_prefix_s
 #undef skip_prefix_n
 
-RZ_IPI bool rz_bin_demangle_symbol(RzBinSymbol *bsym, const RzDemanglerPlugin *plugin, RzDemanglerFlag flags, bool force) {
-	if (!plugin || (bsym->dname && !force)) {
+/**
+ * The demangled names shared by the symbols, imports and relocs of an
+ * object: each mangled name is demangled only once and the names which
+ * are not in the cache yet are demangled in parallel.
+ *
+ * Only the static demanglers are run in parallel, the plugins added with
+ * rz_demangler_plugin_add() are always run on the calling thread.
+ */
+struct rz_bin_demangle_cache_t {
+	const RzDemanglerPlugin *plugin;
+	RzDemanglerFlag flags;
+	bool parallel; ///< the plugin can be run by several threads at once
+	HtSP /*<const char *, char *>*/ *names; ///< mangled name -> demangled name or NULL
+};
+
+#define DEMANGLE_BATCH_SIZE   256
+#define DEMANGLE_PARALLEL_MIN (4 * DEMANGLE_BATCH_SIZE)
+
+typedef struct {
+	const char *mangled;
+	char *demangled;
+} DemangleJob;
+
+typedef struct {
+	DemangleJob *jobs;
+	size_t count;
+} DemangleBatch;
+
+RZ_IPI RZ_OWN RzBinDemangleCache *rz_bin_demangle_cache_new(RZ_NULLABLE const RzDemanglerPlugin *plugin, RzDemanglerFlag flags) {
+	if (!plugin) {
+		return NULL;
+	}
+	RzBinDemangleCache *cache = RZ_NEW0(RzBinDemangleCache);
+	if (!cache) {
+		return NULL;
+	}
+	// the keys are borrowed from the names of the symbols and imports
+	cache->names = ht_sp_new(HT_STR_CONST, NULL, free);
+	if (!cache->names) {
+		free(cache);
+		return NULL;
+	}
+	cache->plugin = plugin;
+	cache->flags = flags;
+	cache->parallel = rz_demangler_plugin_is_static(plugin);
+	return cache;
+}
+
+RZ_IPI void rz_bin_demangle_cache_free(RZ_NULLABLE RzBinDemangleCache *cache) {
+	if (!cache) {
+		return;
+	}
+	ht_sp_free(cache->names);
+	free(cache);
+}
+
+static void demangle_batch_run(DemangleBatch *batch, RzBinDemangleCache *cache) {
+	for (size_t i = 0; i < batch->count; i++) {
+		DemangleJob *job = &batch->jobs[i];
+		job->demangled = cache->plugin->demangle(job->mangled, cache->flags);
+	}
+}
+
+static void demangle_jobs(RzBinDemangleCache *cache, DemangleJob *jobs, size_t count) {
+	DemangleBatch single = { jobs, count };
+	if (count < DEMANGLE_PARALLEL_MIN || !cache->parallel) {
+		demangle_batch_run(&single, cache);
+		return;
+	}
+
+	size_t n_batches = (count + DEMANGLE_BATCH_SIZE - 1) / DEMANGLE_BATCH_SIZE;
+	DemangleBatch *batches = RZ_NEWS(DemangleBatch, n_batches);
+	RzPVector *tasks = rz_pvector_new(NULL);
+	if (!batches || !tasks || !rz_pvector_reserve(tasks, n_batches)) {
+		goto serial;
+	}
+	for (size_t i = 0; i < n_batches; i++) {
+		batches[i].jobs = jobs + i * DEMANGLE_BATCH_SIZE;
+		batches[i].count = RZ_MIN(DEMANGLE_BATCH_SIZE, count - i * DEMANGLE_BATCH_SIZE);
+		rz_pvector_push(tasks, &batches[i]);
+	}
+	const size_t n_threads = RZ_MIN((size_t)rz_th_max_threads(RZ_THREAD_N_CORES_ALL_AVAILABLE), n_batches);
+	if (!rz_th_iterate_pvector(tasks, (RzThreadIterator)demangle_batch_run, n_threads, cache)) {
+		// demangle what the threads did not
+		for (size_t i = 0; i < count; i++) {
+			if (!jobs[i].demangled) {
+				jobs[i].demangled = cache->plugin->demangle(jobs[i].mangled, cache->flags);
+			}
+		}
+	}
+	rz_pvector_free(tasks);
+	free(batches);
+	return;
+
+serial:
+	rz_pvector_free(tasks);
+	free(batches);
+	demangle_batch_run(&single, cache);
+}
+
+/**
+ * Demangles the given names which are not in the cache yet and adds them.
+ */
+static void demangle_cache_prefetch(RzBinDemangleCache *cache, RzPVector /*<const char *>*/ *names) {
+	size_t count = rz_pvector_len(names);
+	if (!count) {
+		return;
+	}
+	DemangleJob *jobs = RZ_NEWS0(DemangleJob, count);
+	if (!jobs) {
+		return;
+	}
+	size_t n_jobs = 0;
+	void **it;
+	rz_pvector_foreach (names, it) {
+		const char *mangled = get_mangled_name(*it);
+		bool found = false;
+		if (!mangled) {
+			continue;
+		}
+		ht_sp_find(cache->names, mangled, &found);
+		if (found) {
+			continue;
+		}
+		// reserve the entry, so duplicated names are demangled once
+		ht_sp_insert(cache->names, mangled, NULL);
+		jobs[n_jobs++].mangled = mangled;
+	}
+
+	demangle_jobs(cache, jobs, n_jobs);
+	for (size_t i = 0; i < n_jobs; i++) {
+		ht_sp_update(cache->names, jobs[i].mangled, jobs[i].demangled);
+	}
+	free(jobs);
+}
+
+/**
+ * \brief Demangles in parallel the names of the symbols which will be demangled later
+ */
+RZ_IPI void rz_bin_demangle_cache_prefetch_symbols(RZ_NULLABLE RzBinDemangleCache *cache, RZ_NONNULL RzBinSymbol **symbols, size_t count, bool force) {
+	if (!cache || !count) {
+		return;
+	}
+	RzPVector names;
+	rz_pvector_init(&names, NULL);
+	for (size_t i = 0; i < count; i++) {
+		RzBinSymbol *bsym = symbols[i];
+		if (bsym && bsym->name && (force || !bsym->dname)) {
+			rz_pvector_push(&names, bsym->name);
+		}
+	}
+	demangle_cache_prefetch(cache, &names);
+	rz_pvector_fini(&names);
+}
+
+/**
+ * \brief Demangles in parallel the names of the imports which will be demangled later
+ */
+RZ_IPI void rz_bin_demangle_cache_prefetch_imports(RZ_NULLABLE RzBinDemangleCache *cache, RZ_NONNULL RzBinImport **imports, size_t count, bool force) {
+	if (!cache || !count) {
+		return;
+	}
+	RzPVector names;
+	rz_pvector_init(&names, NULL);
+	for (size_t i = 0; i < count; i++) {
+		RzBinImport *import = imports[i];
+		if (import && import->name && (force || !import->dname)) {
+			rz_pvector_push(&names, import->name);
+		}
+	}
+	demangle_cache_prefetch(cache, &names);
+	rz_pvector_fini(&names);
+}
+
+/**
+ * \brief Demangles in parallel the names of the imports and symbols of the relocs
+ */
+RZ_IPI void rz_bin_demangle_cache_prefetch_relocs(RZ_NULLABLE RzBinDemangleCache *cache, RZ_NONNULL RzBinReloc **relocs, size_t count, bool force) {
+	if (!cache || !count) {
+		return;
+	}
+	RzPVector names;
+	rz_pvector_init(&names, NULL);
+	for (size_t i = 0; i < count; i++) {
+		RzBinReloc *reloc = relocs[i];
+		if (!reloc) {
+			continue;
+		}
+		if (reloc->import && reloc->import->name && (force || !reloc->import->dname)) {
+			rz_pvector_push(&names, reloc->import->name);
+		}
+		if (reloc->symbol && reloc->symbol->name && (force || !reloc->symbol->dname)) {
+			rz_pvector_push(&names, reloc->symbol->name);
+		}
+	}
+	demangle_cache_prefetch(cache, &names);
+	rz_pvector_fini(&names);
+}
+
+static char *demangle_cache_get(RzBinDemangleCache *cache, const char *mangled) {
+	bool found = false;
+	const char *demangled = ht_sp_find(cache->names, mangled, &found);
+	if (found) {
+		return rz_str_dup(demangled);
+	}
+	return cache->plugin->demangle(mangled, cache->flags);
+}
+
+RZ_IPI bool rz_bin_demangle_symbol(RzBinSymbol *bsym, RZ_NULLABLE RzBinDemangleCache *cache, bool force) {
+	if (!cache || (bsym->dname && !force)) {
 		return false;
 	}
 
@@ -43,12 +252,12 @@ RZ_IPI bool rz_bin_demangle_symbol(RzBinSymbol *bsym, const RzDemanglerPlugin *p
 	}
 
 	free(bsym->dname);
-	bsym->dname = plugin->demangle(mangled, flags);
+	bsym->dname = demangle_cache_get(cache, mangled);
 	return bsym->dname != NULL;
 }
 
-RZ_IPI bool rz_bin_demangle_import(RzBinImport *import, const RzDemanglerPlugin *plugin, RzDemanglerFlag flags, bool force) {
-	if (!plugin || (import->dname && !force)) {
+RZ_IPI bool rz_bin_demangle_import(RzBinImport *import, RZ_NULLABLE RzBinDemangleCache *cache, bool force) {
+	if (!cache || (import->dname && !force)) {
 		return false;
 	}
 
@@ -57,7 +266,7 @@ RZ_IPI bool rz_bin_demangle_import(RzBinImport *import, const RzDemanglerPlugin
 		return false;
 	}
 
-	char *demangled = plugin->demangle(mangled, flags);
+	char *demangled = demangle_cache_get(cache, mangled);
 	if (!demangled) {
 		return false;
 	}
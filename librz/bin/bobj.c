@@ -210,6 +210,7 @@ RZ_IPI void rz_bin_object_free(RzBinObject *o) {
 	for (ut32 i = 0; i < RZ_BIN_SPECIAL_SYMBOL_LAST; i++) {
 		free(o->binsym[i]);
 	}
+	rz_th_lock_free(o->lazy_lock);
 	free(o);
 }
 
@@ -505,6 +506,7 @@ RZ_IPI RzBinObject *rz_bin_object_new(RzBinFile *bf, RzBinPlugin *plugin, RzBinO
 	o->regstate = NULL;
 	o->baddr_shift = 0;
 	o->plugin = plugin;
+	o->bf = bf;
 
 	if (plugin && plugin->load_buffer) {
 		if (!plugin->load_buffer(bf, o, bf->buf, bf->sdb)) {
@@ -672,6 +674,7 @@ RZ_API RZ_BORROW const RzPVector /*<RzBinAddr *>*/ *rz_bin_object_get_entries(RZ
  */
 RZ_API const RzPVector /*<RzBinField *>*/ *rz_bin_object_get_fields(RZ_NONNULL RzBinObject *obj) {
 	rz_return_val_if_fail(obj, NULL);
+	rz_bin_object_load_lazy(obj, RZ_BIN_OBJECT_LAZY_FIELDS);
 	return obj->fields;
 }
 
@@ -761,6 +764,7 @@ RZ_API const RzPVector /*<RzBinClass *>*/ *rz_bin_object_get_classes(RZ_NONNULL
  */
 RZ_API const RzPVector /*<RzBinString *>*/ *rz_bin_object_get_strings(RZ_NONNULL RzBinObject *obj) {
 	rz_return_val_if_fail(obj, NULL);
+	rz_bin_object_load_lazy(obj, RZ_BIN_OBJECT_LAZY_STRINGS);
 	if (!obj->strings) {
 		return NULL;
 	}
@@ -796,6 +800,7 @@ RZ_API const RzPVector /*<RzBinResource *>*/ *rz_bin_object_get_resources(RZ_NON
  */
 RZ_API RZ_BORROW RzBinString *rz_bin_object_get_string_at(RZ_NONNULL RzBinObject *obj, ut64 address, bool is_va) {
 	rz_return_val_if_fail(obj, false);
+	rz_bin_object_load_lazy(obj, RZ_BIN_OBJECT_LAZY_STRINGS);
 	if (!obj->strings) {
 		return NULL;
 	}
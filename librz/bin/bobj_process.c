@@ -135,6 +135,28 @@ RZ_IPI void rz_bin_process_swift(RzBinObject *o, char *classname, char *demangle
 }
 #endif /* WITH_SWIFT_DEMANGLER */
 
+/**
+ * \brief Loads the lazy \p items (RzBinObjectLazyItem bits) of \p o which are still pending
+ *
+ * The lock is recursive and the pending bits are cleared before loading, so
+ * a plugin which reads the object while loading does not load it twice.
+ */
+RZ_IPI void rz_bin_object_load_lazy(RzBinObject *o, ut32 items) {
+	if (!o->lazy_lock) {
+		return;
+	}
+	rz_th_lock_enter(o->lazy_lock);
+	ut32 pending = o->lazy_pending & items;
+	o->lazy_pending &= ~pending;
+	if (pending & RZ_BIN_OBJECT_LAZY_STRINGS) {
+		rz_bin_set_and_process_strings(o->bf, o);
+	}
+	if (pending & RZ_BIN_OBJECT_LAZY_FIELDS) {
+		rz_bin_set_and_process_fields(o->bf, o);
+	}
+	rz_th_lock_leave(o->lazy_lock);
+}
+
 /**
  * \brief      Reset and initialize the data of the given RzBinObject using the defined RzBinPlugin
  *
@@ -153,8 +175,15 @@ RZ_API bool rz_bin_object_process_plugin_data(RZ_NONNULL RzBinFile *bf, RZ_NONNU
 	rz_bin_set_imports_from_plugin(bf, o);
 	rz_bin_set_symbols_from_plugin(bf, o);
 	rz_bin_set_and_process_sections(bf, o);
-	rz_bin_set_and_process_strings(bf, o);
-	rz_bin_set_and_process_fields(bf, o);
+	if (o->opts.lazy && (o->lazy_lock || (o->lazy_lock = rz_th_lock_new(true)))) {
+		// loaded by the getters on the first request
+		rz_th_lock_enter(o->lazy_lock);
+		o->lazy_pending = RZ_BIN_OBJECT_LAZY_STRINGS | RZ_BIN_OBJECT_LAZY_FIELDS;
+		rz_th_lock_leave(o->lazy_lock);
+	} else {
+		rz_bin_set_and_process_strings(bf, o);
+		rz_bin_set_and_process_fields(bf, o);
+	}
 	rz_bin_set_and_process_classes(bf, o);
 
 	// we need to detect the language of the binary
@@ -186,9 +215,12 @@ RZ_API bool rz_bin_object_process_plugin_data(RZ_NONNULL RzBinFile *bf, RZ_NONNU
 	if (bf->rbin->demangle) {
 		demangler = rz_bin_process_get_demangler_plugin_from_lang(bf->rbin, o->lang);
 	}
-	rz_bin_process_symbols(bf, o, demangler, flags);
-	rz_bin_process_imports(bf, o, demangler, flags);
-	rz_bin_set_and_process_relocs(bf, o, demangler, flags);
+	// the names shared by symbols, imports and relocs are demangled once
+	RzBinDemangleCache *cache = rz_bin_demangle_cache_new(demangler, flags);
+	rz_bin_process_symbols(bf, o, cache);
+	rz_bin_process_imports(bf, o, cache);
+	rz_bin_set_and_process_relocs(bf, o, cache);
+	rz_bin_demangle_cache_free(cache);
 
 	return true;
 }
@@ -198,7 +230,14 @@ RZ_API bool rz_bin_object_process_plugin_data(RZ_NONNULL RzBinFile *bf, RZ_NONNU
  */
 RZ_API bool rz_bin_object_reset_strings(RZ_NONNULL RzBin *bin, RZ_NONNULL RzBinFile *bf, RZ_NONNULL RzBinObject *obj) {
 	rz_return_val_if_fail(bin && bf && obj, false);
-	rz_bin_set_and_process_strings(bf, obj);
+	if (obj->lazy_lock) {
+		rz_th_lock_enter(obj->lazy_lock);
+		obj->lazy_pending &= ~RZ_BIN_OBJECT_LAZY_STRINGS;
+		rz_bin_set_and_process_strings(bf, obj);
+		rz_th_lock_leave(obj->lazy_lock);
+	} else {
+		rz_bin_set_and_process_strings(bf, obj);
+	}
 	return obj->strings != NULL;
 }
 
@@ -230,8 +269,10 @@ RZ_API void rz_bin_demangle_with_flags(RZ_NONNULL RzBin *bin, RzDemanglerFlag fl
 		}
 		RzBinObject *o = bf->o;
 		const RzDemanglerPlugin *demangler = rz_bin_process_get_demangler_plugin_from_lang(bin, o->lang);
-		rz_bin_demangle_relocs_with_flags(o, demangler, flags);
-		rz_bin_demangle_imports_with_flags(o, demangler, flags);
-		rz_bin_demangle_symbols_with_flags(o, demangler, flags);
+		RzBinDemangleCache *cache = rz_bin_demangle_cache_new(demangler, flags);
+		rz_bin_demangle_relocs_with_flags(o, cache);
+		rz_bin_demangle_imports_with_flags(o, cache);
+		rz_bin_demangle_symbols_with_flags(o, cache);
+		rz_bin_demangle_cache_free(cache);
 	}
 }
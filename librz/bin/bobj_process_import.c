@@ -38,12 +38,13 @@ RZ_IPI void rz_bin_set_imports_from_plugin(RzBinFile *bf, RzBinObject *o) {
 	}
 }
 
-RZ_IPI void rz_bin_process_imports(RzBinFile *bf, RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags) {
-	if (!demangler || rz_pvector_len(o->imports) < 1) {
+RZ_IPI void rz_bin_process_imports(RzBinFile *bf, RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache) {
+	if (!cache || rz_pvector_len(o->imports) < 1) {
 		return;
 	}
 
 	RzBinProcessLanguage language_cb = rz_bin_process_language_import(o);
+	rz_bin_demangle_cache_prefetch_imports(cache, (RzBinImport **)rz_pvector_data(o->imports), rz_pvector_len(o->imports), false);
 
 	void **it;
 	RzBinImport *element;
@@ -54,7 +55,7 @@ RZ_IPI void rz_bin_process_imports(RzBinFile *bf, RzBinObject *o, const RzDemang
 		}
 
 		// demangle the import
-		if (!rz_bin_demangle_import(element, demangler, flags, false) ||
+		if (!rz_bin_demangle_import(element, cache, false) ||
 			!language_cb) {
 			continue;
 		}
@@ -66,7 +67,9 @@ RZ_IPI void rz_bin_process_imports(RzBinFile *bf, RzBinObject *o, const RzDemang
 	}
 }
 
-RZ_IPI void rz_bin_demangle_imports_with_flags(RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags) {
+RZ_IPI void rz_bin_demangle_imports_with_flags(RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache) {
+	rz_bin_demangle_cache_prefetch_imports(cache, (RzBinImport **)rz_pvector_data(o->imports), rz_pvector_len(o->imports), true);
+
 	void **it;
 	RzBinImport *element;
 	rz_pvector_foreach (o->imports, it) {
@@ -75,6 +78,6 @@ RZ_IPI void rz_bin_demangle_imports_with_flags(RzBinObject *o, const RzDemangler
 			continue;
 		}
 
-		rz_bin_demangle_import(element, demangler, flags, true);
+		rz_bin_demangle_import(element, cache, true);
 	}
 }
@@ -6,27 +6,26 @@
 
 static void process_handle_reloc(RzBinReloc *reloc,
 	RzBinObject *o,
-	const RzDemanglerPlugin *demangler,
-	RzDemanglerFlag flags,
+	RzBinDemangleCache *cache,
 	RzBinProcessLanguage imp_cb,
 	RzBinProcessLanguage sym_cb) {
 	// rebase physical address
 	reloc->paddr += o->opts.loadaddr;
 
-	if (!demangler) {
+	if (!cache) {
 		return;
 	}
 
-	if (reloc->import && rz_bin_demangle_import(reloc->import, demangler, flags, false) && imp_cb) {
+	if (reloc->import && rz_bin_demangle_import(reloc->import, cache, false) && imp_cb) {
 		imp_cb(o, reloc->import);
 	}
 
-	if (reloc->symbol && rz_bin_demangle_symbol(reloc->symbol, demangler, flags, false) && sym_cb) {
+	if (reloc->symbol && rz_bin_demangle_symbol(reloc->symbol, cache, false) && sym_cb) {
 		sym_cb(o, reloc->symbol);
 	}
 }
 
-RZ_IPI void rz_bin_set_and_process_relocs(RzBinFile *bf, RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags) {
+RZ_IPI void rz_bin_set_and_process_relocs(RzBinFile *bf, RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache) {
 	RzBin *bin = bf->rbin;
 	RzBinPlugin *plugin = o->plugin;
 	RzPVector *relocs = NULL;
@@ -39,25 +38,27 @@ RZ_IPI void rz_bin_set_and_process_relocs(RzBinFile *bf, RzBinObject *o, const R
 
 	RzBinProcessLanguage imp_cb = rz_bin_process_language_import(o);
 	RzBinProcessLanguage sym_cb = rz_bin_process_language_symbol(o);
+	rz_bin_demangle_cache_prefetch_relocs(cache, (RzBinReloc **)rz_pvector_data(relocs), rz_pvector_len(relocs), false);
 
 	void **it;
 	RzBinReloc *element;
 	rz_pvector_foreach (relocs, it) {
 		element = *it;
-		process_handle_reloc(element, o, demangler, flags, imp_cb, sym_cb);
+		process_handle_reloc(element, o, cache, imp_cb, sym_cb);
 	}
 
 	o->relocs = rz_bin_reloc_storage_new(relocs);
 }
 
-RZ_IPI void rz_bin_demangle_relocs_with_flags(RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags) {
+RZ_IPI void rz_bin_demangle_relocs_with_flags(RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache) {
+	rz_bin_demangle_cache_prefetch_relocs(cache, o->relocs->relocs, o->relocs->relocs_count, true);
 	for (size_t i = 0; i < o->relocs->relocs_count; ++i) {
 		RzBinReloc *reloc = o->relocs->relocs[i];
 		if (reloc->import) {
-			rz_bin_demangle_import(reloc->import, demangler, flags, true);
+			rz_bin_demangle_import(reloc->import, cache, true);
 		}
 		if (reloc->symbol) {
-			rz_bin_demangle_symbol(reloc->symbol, demangler, flags, true);
+			rz_bin_demangle_symbol(reloc->symbol, cache, true);
 		}
 	}
 }
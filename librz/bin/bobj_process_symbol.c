@@ -62,7 +62,7 @@ RZ_IPI RzBinProcessLanguage rz_bin_process_language_symbol(RzBinObject *o) {
 	}
 }
 
-static void process_handle_symbol(RzBinSymbol *symbol, RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags, RzBinProcessLanguage language_cb) {
+static void process_handle_symbol(RzBinSymbol *symbol, RzBinObject *o, RzBinDemangleCache *cache, RzBinProcessLanguage language_cb) {
 	// rebase physical address
 	symbol->paddr += o->opts.loadaddr;
 
@@ -78,7 +78,7 @@ static void process_handle_symbol(RzBinSymbol *symbol, RzBinObject *o, const RzD
 	}
 
 	// demangle the symbol
-	if (!rz_bin_demangle_symbol(symbol, demangler, flags, false) ||
+	if (!rz_bin_demangle_symbol(symbol, cache, false) ||
 		!language_cb) {
 		return;
 	}
@@ -89,7 +89,7 @@ static void process_handle_symbol(RzBinSymbol *symbol, RzBinObject *o, const RzD
 	language_cb(o, symbol);
 }
 
-RZ_IPI void rz_bin_process_symbols(RzBinFile *bf, RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags) {
+RZ_IPI void rz_bin_process_symbols(RzBinFile *bf, RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache) {
 	if (rz_pvector_len(o->symbols) < 1) {
 		return;
 	}
@@ -98,12 +98,13 @@ RZ_IPI void rz_bin_process_symbols(RzBinFile *bf, RzBinObject *o, const RzDemang
 	o->import_name_symbols = ht_sp_new(HT_STR_DUP, NULL, NULL);
 
 	RzBinProcessLanguage language_cb = rz_bin_process_language_symbol(o);
+	rz_bin_demangle_cache_prefetch_symbols(cache, (RzBinSymbol **)rz_pvector_data(o->symbols), rz_pvector_len(o->symbols), false);
 
 	void **it;
 	RzBinSymbol *element;
 	rz_pvector_foreach (o->symbols, it) {
 		element = *it;
-		process_handle_symbol(element, o, demangler, flags, language_cb);
+		process_handle_symbol(element, o, cache, language_cb);
 	}
 }
 
@@ -116,11 +117,13 @@ RZ_IPI void rz_bin_set_symbols_from_plugin(RzBinFile *bf, RzBinObject *o) {
 	}
 }
 
-RZ_IPI void rz_bin_demangle_symbols_with_flags(RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags) {
+RZ_IPI void rz_bin_demangle_symbols_with_flags(RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache) {
+	rz_bin_demangle_cache_prefetch_symbols(cache, (RzBinSymbol **)rz_pvector_data(o->symbols), rz_pvector_len(o->symbols), true);
+
 	void **it;
 	RzBinSymbol *element;
 	rz_pvector_foreach (o->symbols, it) {
 		element = *it;
-		rz_bin_demangle_symbol(element, demangler, flags, true);
+		rz_bin_demangle_symbol(element, cache, true);
 	}
 }
@@ -6,11 +6,31 @@
 #include <rz_bin_dwarf.h>
 #include "dwarf_private.h"
 
+/**
+ * Below this .debug_info size the units are parsed on the calling thread,
+ * the cost of spawning the workers would exceed the parsing time.
+ */
+#define DEBUG_INFO_PARALLEL_MIN_SIZE (1 << 20)
+
 typedef struct {
 	RzBinDwarfInfo *info;
 	RzBinDWARF *dw;
 } DebugInfoContext;
 
+/**
+ * The DIEs of each unit are parsed independently of the other units, thus
+ * every task owns a private cursor over .debug_info and records what must be
+ * added to the shared tables of RzBinDwarfInfo, which are only filled once
+ * all the units are parsed.
+ */
+typedef struct {
+	DebugInfoContext *ctx;
+	RzBinDwarfCompUnit *unit;
+	const RzBinDwarfAbbrevTable *tbl;
+	RzBinEndianReader R;
+	RzVector /*<ut64>*/ locations; ///< offsets of the DW_AT_location values of the unit
+} CUTask;
+
 static void Die_fini(RzBinDwarfDie *die) {
 	if (!die) {
 		return;
@@ -78,10 +98,10 @@ static void apply_attr_opt(DebugInfoContext *ctx, RzBinDwarfCompUnit *cu, RzBinD
 }
 
 static bool CU_attrs_parse(
-	DebugInfoContext *ctx,
+	CUTask *task,
 	RzBinDwarfDie *die,
-	RzBinDwarfCompUnit *cu,
 	RzBinDwarfAbbrevDecl *abbrev_decl) {
+	RzBinDwarfCompUnit *cu = task->unit;
 
 	RZ_LOG_DEBUG("0x%" PFMT64x ":\t%s%s [%" PFMT64d "] %s\n",
 		die->offset, rz_str_indent(die->depth), rz_bin_dwarf_tag(die->tag),
@@ -90,14 +110,14 @@ static bool CU_attrs_parse(
 	rz_vector_foreach (&abbrev_decl->defs, spec) {
 		RzBinDwarfAttr attr = { 0 };
 		AttrOption opt = {
-			.dw = ctx->dw,
+			.dw = task->ctx->dw,
 			.implicit_const = spec->special,
 			.form = spec->form,
 			.at = spec->at,
 			.unit_offset = cu->offset,
 			.encoding = &cu->hdr.encoding,
 		};
-		if (!RzBinDwarfAttr_parse(ctx->info->R, &attr, &opt)) {
+		if (!RzBinDwarfAttr_parse(&task->R, &attr, &opt)) {
 			RZ_LOG_ERROR("DWARF: failed attr: 0x%" PFMT64x " %s [%s]\n",
 				die->offset, rz_bin_dwarf_attr(spec->at), rz_bin_dwarf_form(spec->form));
 			continue;
@@ -113,8 +133,7 @@ static bool CU_attrs_parse(
 				attr.value.kind == RzBinDwarfAttr_UConstant ||
 				attr.value.kind == RzBinDwarfAttr_SecOffset) {
 				ut64 offset = rz_bin_dwarf_attr_udata(&attr);
-				ht_up_insert(ctx->info->location_encoding,
-					offset, &cu->hdr.encoding);
+				rz_vector_push(&task->locations, &offset);
 			}
 		}
 		default:
@@ -124,22 +143,32 @@ static bool CU_attrs_parse(
 		rz_vector_push(&die->attrs, &attr);
 	}
 
-	if (die->tag == DW_TAG_compile_unit ||
-		die->tag == DW_TAG_skeleton_unit) {
-		apply_attr_opt(ctx, cu, die, DW_AT_str_offsets_base);
-		apply_attr_opt(ctx, cu, die, DW_AT_addr_base);
-		apply_attr_opt(ctx, cu, die, DW_AT_GNU_addr_base);
-		apply_attr_opt(ctx, cu, die, DW_AT_GNU_ranges_base);
-		apply_attr_opt(ctx, cu, die, DW_AT_loclists_base);
-		apply_attr_opt(ctx, cu, die, DW_AT_rnglists_base);
-		RzBinDwarfAttr *attr;
-		rz_vector_foreach (&die->attrs, attr) {
-			CU_attr_apply(ctx, cu, attr);
-		}
-	}
 	return true;
 }
 
+/**
+ * \brief Applies the attributes of the unit DIE to \p cu
+ *
+ * Resolving them may read other shared sections, thus this is done once the
+ * DIEs of all the units are parsed.
+ */
+static void CU_root_apply(DebugInfoContext *ctx, RzBinDwarfCompUnit *cu) {
+	RzBinDwarfDie *die = rz_vector_head(&cu->dies);
+	if (!die || !(die->tag == DW_TAG_compile_unit || die->tag == DW_TAG_skeleton_unit)) {
+		return;
+	}
+	apply_attr_opt(ctx, cu, die, DW_AT_str_offsets_base);
+	apply_attr_opt(ctx, cu, die, DW_AT_addr_base);
+	apply_attr_opt(ctx, cu, die, DW_AT_GNU_addr_base);
+	apply_attr_opt(ctx, cu, die, DW_AT_GNU_ranges_base);
+	apply_attr_opt(ctx, cu, die, DW_AT_loclists_base);
+	apply_attr_opt(ctx, cu, die, DW_AT_rnglists_base);
+	RzBinDwarfAttr *attr;
+	rz_vector_foreach (&die->attrs, attr) {
+		CU_attr_apply(ctx, cu, attr);
+	}
+}
+
 /**
  * \brief Initializes a RzBinDwarfCompUnit
  * \param unit The RzBinDwarfCompUnit to initialize
@@ -167,12 +196,10 @@ static inline ut64 CU_next(RzBinDwarfCompUnit *unit) {
 /**
  * \brief Reads throught comp_unit buffer and parses all its DIEntries*
  */
-static bool CU_dies_parse(
-	DebugInfoContext *ctx,
-	RzBinDwarfCompUnit *unit,
-	const RzBinDwarfAbbrevTable *tbl) {
+static bool CU_dies_parse(CUTask *task) {
 	st64 depth = 0;
-	RzBinEndianReader *R = ctx->info->R;
+	RzBinDwarfCompUnit *unit = task->unit;
+	RzBinEndianReader *R = &task->R;
 	while (true) {
 		ut64 offset = R_tell(R);
 		if (offset >= CU_next(unit)) {
@@ -205,7 +232,7 @@ static bool CU_dies_parse(
 			}
 		}
 
-		RzBinDwarfAbbrevDecl *abbrev_decl = rz_bin_dwarf_abbrev_get(tbl, die.abbrev_code);
+		RzBinDwarfAbbrevDecl *abbrev_decl = rz_bin_dwarf_abbrev_get(task->tbl, die.abbrev_code);
 		if (!abbrev_decl) {
 			break;
 		}
@@ -221,7 +248,7 @@ static bool CU_dies_parse(
 			if (die.has_children) {
 				depth++;
 			}
-			GOTO_IF_FAIL(CU_attrs_parse(ctx, &die, unit, abbrev_decl), err);
+			GOTO_IF_FAIL(CU_attrs_parse(task, &die, abbrev_decl), err);
 		}
 		rz_vector_push(&unit->dies, &die);
 	}
@@ -277,10 +304,25 @@ static bool CU_Hdr_parse(DebugInfoContext *ctx, RzBinDwarfCompUnit *cu) {
 	return true;
 }
 
+static void CU_task_run(CUTask *task, void *user) {
+	CU_dies_parse(task);
+}
+
+static void CU_task_free(CUTask *task) {
+	if (!task) {
+		return;
+	}
+	rz_vector_fini(&task->locations);
+	free(task);
+}
+
 /**
- * \brief Parses whole .debug_info section
+ * \brief Indexes the unit headers of .debug_info
+ *
+ * Only the headers are read, the DIEs are skipped by seeking to the next
+ * unit, so this pass is cheap even for huge sections.
  */
-static bool CU_parse_all(DebugInfoContext *ctx) {
+static bool CU_index_all(DebugInfoContext *ctx) {
 	RzBinEndianReader *buffer = ctx->info->R;
 	ut64 index = 0;
 	while (true) {
@@ -293,31 +335,95 @@ static bool CU_parse_all(DebugInfoContext *ctx) {
 			.offset = offset,
 		};
 		if (CU_init(&unit) < 0) {
-			goto cleanup;
+			return false;
 		}
 		if (!CU_Hdr_parse(ctx, &unit)) {
 			break;
 		}
 		if (unit.hdr.length > R_size(buffer)) {
-			goto cleanup;
+			return false;
 		}
-
-		RzBinDwarfAbbrevTable *tbl = ht_up_find(
-			ctx->dw->abbrev->by_offset, unit.hdr.abbrev_offset, NULL);
-		if (!tbl) {
-			goto cleanup;
+		if (!ht_up_find(ctx->dw->abbrev->by_offset, unit.hdr.abbrev_offset, NULL)) {
+			return false;
 		}
 
 		RZ_LOG_DEBUG("0x%" PFMT64x ":\tcompile unit length = 0x%" PFMT64x ", abbr_offset: 0x%" PFMT64x "\n",
 			unit.offset, unit.hdr.length, unit.hdr.abbrev_offset);
-		CU_dies_parse(ctx, &unit, tbl);
-		ctx->info->die_count += rz_vector_len(&unit.dies);
 		unit.index = index++;
-		rz_vector_push(&ctx->info->units, &unit);
+		if (!rz_vector_push(&ctx->info->units, &unit)) {
+			return false;
+		}
+		R_seek(buffer, (st64)CU_next(&unit), SEEK_SET);
 	}
 	return true;
+}
+
+/**
+ * \brief Parses whole .debug_info section
+ *
+ * The unit headers are indexed first, then the DIEs of the units are parsed
+ * in parallel when the section is big enough. The shared tables are filled
+ * afterwards following the order of the units, hence the result does not
+ * depend on how the units were scheduled.
+ *
+ * The DIEs of every unit are still all materialized here and the types and
+ * functions of all the units are built afterwards by dwarf_process.c, since
+ * the DIEs of the other units are looked up directly through die_by_offset.
+ */
+static bool CU_parse_all(DebugInfoContext *ctx) {
+	RET_FALSE_IF_FAIL(CU_index_all(ctx));
+	size_t n_units = rz_vector_len(&ctx->info->units);
+	if (!n_units) {
+		return true;
+	}
+	RzPVector *tasks = rz_pvector_new_with_len((RzPVectorFree)CU_task_free, n_units);
+	RET_FALSE_IF_FAIL(tasks);
+
+	bool ret = false;
+	for (size_t i = 0; i < n_units; i++) {
+		RzBinDwarfCompUnit *unit = rz_vector_index_ptr(&ctx->info->units, i);
+		CUTask *task = RZ_NEW0(CUTask);
+		if (!task) {
+			goto cleanup;
+		}
+		rz_pvector_set(tasks, i, task);
+		task->ctx = ctx;
+		task->unit = unit;
+		task->tbl = ht_up_find(ctx->dw->abbrev->by_offset, unit->hdr.abbrev_offset, NULL);
+		rz_vector_init(&task->locations, sizeof(ut64), NULL, NULL);
+		R_clone(ctx->info->R, &task->R);
+		task->R.owned = false;
+		// DIEs start right after the header
+		R_seek(&task->R, (st64)(unit->offset + unit->hdr.header_size + (unit->hdr.encoding.is_64bit ? 12 : 4)), SEEK_SET);
+	}
+
+	if (n_units > 1 && R_size(ctx->info->R) >= DEBUG_INFO_PARALLEL_MIN_SIZE) {
+		const size_t n_threads = RZ_MIN((size_t)rz_th_max_threads(RZ_THREAD_N_CORES_ALL_AVAILABLE), n_units);
+		if (!rz_th_iterate_pvector(tasks, (RzThreadIterator)CU_task_run, n_threads, NULL)) {
+			goto cleanup;
+		}
+	} else {
+		void **it;
+		rz_pvector_foreach (tasks, it) {
+			CU_task_run(*it, NULL);
+		}
+	}
+
+	void **it;
+	rz_pvector_foreach (tasks, it) {
+		CUTask *task = *it;
+		RzBinDwarfCompUnit *unit = task->unit;
+		CU_root_apply(ctx, unit);
+		ut64 *location;
+		rz_vector_foreach (&task->locations, location) {
+			ht_up_insert(ctx->info->location_encoding, *location, &unit->hdr.encoding);
+		}
+		ctx->info->die_count += rz_vector_len(&unit->dies);
+	}
+	ret = true;
 cleanup:
-	return false;
+	rz_pvector_free(tasks);
+	return ret;
 }
 
 RZ_API RZ_BORROW RzBinDwarfAttr *rz_bin_dwarf_die_get_attr(
@@ -34,8 +34,14 @@ RZ_IPI RzBinFile *rz_bin_file_new_from_buffer(RzBin *bin, const char *file, RzBu
 
 RZ_IPI void rz_bin_string_decode_base64(RZ_NONNULL RzBinString *bstr);
 
-RZ_IPI bool rz_bin_demangle_symbol(RzBinSymbol *bsym, const RzDemanglerPlugin *plugin, RzDemanglerFlag flags, bool force);
-RZ_IPI bool rz_bin_demangle_import(RzBinImport *import, const RzDemanglerPlugin *plugin, RzDemanglerFlag flags, bool force);
+typedef struct rz_bin_demangle_cache_t RzBinDemangleCache;
+RZ_IPI RZ_OWN RzBinDemangleCache *rz_bin_demangle_cache_new(RZ_NULLABLE const RzDemanglerPlugin *plugin, RzDemanglerFlag flags);
+RZ_IPI void rz_bin_demangle_cache_free(RZ_NULLABLE RzBinDemangleCache *cache);
+RZ_IPI void rz_bin_demangle_cache_prefetch_symbols(RZ_NULLABLE RzBinDemangleCache *cache, RZ_NONNULL RzBinSymbol **symbols, size_t count, bool force);
+RZ_IPI void rz_bin_demangle_cache_prefetch_imports(RZ_NULLABLE RzBinDemangleCache *cache, RZ_NONNULL RzBinImport **imports, size_t count, bool force);
+RZ_IPI void rz_bin_demangle_cache_prefetch_relocs(RZ_NULLABLE RzBinDemangleCache *cache, RZ_NONNULL RzBinReloc **relocs, size_t count, bool force);
+RZ_IPI bool rz_bin_demangle_symbol(RzBinSymbol *bsym, RZ_NULLABLE RzBinDemangleCache *cache, bool force);
+RZ_IPI bool rz_bin_demangle_import(RzBinImport *import, RZ_NULLABLE RzBinDemangleCache *cache, bool force);
 
 RZ_IPI int rz_bin_compare_class(RzBinClass *a, RzBinClass *b);
 RZ_IPI int rz_bin_compare_method(RzBinSymbol *a, RzBinSymbol *b);
@@ -50,6 +56,7 @@ RZ_IPI void rz_bin_process_swift(RzBinObject *o, char *classname, char *demangle
 
 RZ_IPI const RzDemanglerPlugin *rz_bin_process_get_demangler_plugin_from_lang(RzBin *bin, RzBinLanguage language);
 
+RZ_IPI void rz_bin_object_load_lazy(RzBinObject *o, ut32 items);
 RZ_IPI void rz_bin_set_and_process_classes(RzBinFile *bf, RzBinObject *o);
 RZ_IPI void rz_bin_set_and_process_entries(RzBinFile *bf, RzBinObject *o);
 RZ_IPI void rz_bin_set_and_process_fields(RzBinFile *bf, RzBinObject *o);
@@ -59,13 +66,13 @@ RZ_IPI void rz_bin_set_and_process_sections(RzBinFile *bf, RzBinObject *o);
 RZ_IPI void rz_bin_set_and_process_strings(RzBinFile *bf, RzBinObject *o);
 RZ_IPI void rz_bin_set_imports_from_plugin(RzBinFile *bf, RzBinObject *o);
 RZ_IPI void rz_bin_set_symbols_from_plugin(RzBinFile *bf, RzBinObject *o);
-RZ_IPI void rz_bin_set_and_process_relocs(RzBinFile *bf, RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags);
-RZ_IPI void rz_bin_process_imports(RzBinFile *bf, RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags);
-RZ_IPI void rz_bin_process_symbols(RzBinFile *bf, RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags);
+RZ_IPI void rz_bin_set_and_process_relocs(RzBinFile *bf, RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache);
+RZ_IPI void rz_bin_process_imports(RzBinFile *bf, RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache);
+RZ_IPI void rz_bin_process_symbols(RzBinFile *bf, RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache);
 
-RZ_IPI void rz_bin_demangle_relocs_with_flags(RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags);
-RZ_IPI void rz_bin_demangle_imports_with_flags(RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags);
-RZ_IPI void rz_bin_demangle_symbols_with_flags(RzBinObject *o, const RzDemanglerPlugin *demangler, RzDemanglerFlag flags);
+RZ_IPI void rz_bin_demangle_relocs_with_flags(RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache);
+RZ_IPI void rz_bin_demangle_imports_with_flags(RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache);
+RZ_IPI void rz_bin_demangle_symbols_with_flags(RzBinObject *o, RZ_NULLABLE RzBinDemangleCache *cache);
 
 RZ_IPI RzBinProcessLanguage rz_bin_process_language_symbol(RzBinObject *o);
 RZ_IPI RzBinProcessLanguage rz_bin_process_language_import(RzBinObject *o);
@@ -11,6 +11,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include "cons_private.h"
 
 #define COUNT_LINES 1
 #define CTX(x)      I.context->x
@@ -687,7 +688,8 @@ RZ_API RzCons *rz_cons_free(void) {
 	return NULL;
 }
 
-#define MOAR (4096 * 8)
+#define MOAR              (4096 * 8)
+#define CONS_STREAM_CHUNK (64 * 1024)
 static bool palloc(int moar) {
 	void *temp;
 	if (moar <= 0) {
@@ -815,8 +817,12 @@ RZ_API void rz_cons_reset(void) {
 		(CTX(buffer))[0] = '\0';
 	}
 	CTX(buffer_len) = 0;
-	I.lines = 0;
-	cons_grep_reset(&CTX(grep));
+	// a grep parsed by rz_cons_grep_stream_begin() lasts until the command ends
+	if (!CTX(stream_grep)) {
+		I.lines = 0;
+		cons_grep_reset(&CTX(grep));
+		CTX(streamed) = false;
+	}
 	CTX(pageable) = true;
 	ctx_rowcol_calc_reset();
 }
@@ -964,8 +970,112 @@ RZ_API void rz_cons_echo(const char *msg) {
 	}
 }
 
-RZ_API void rz_cons_flush(void) {
+static void cons_tee_write(const char *buf, size_t len) {
 	const char *tee = I.teefile;
+	if (!tee || !*tee) {
+		return;
+	}
+	FILE *d = rz_sys_fopen(tee, "a+");
+	if (d) {
+		if (len != fwrite(buf, 1, len, d)) {
+			eprintf("rz_cons_flush: fwrite: error (%s)\n", tee);
+		}
+		fclose(d);
+	} else {
+		eprintf("Cannot write on '%s'\n", tee);
+	}
+}
+
+static bool cons_grep_enabled(void) {
+	return I.filter || CTX(grep).nstrings > 0 || CTX(grep).tokens_used || CTX(grep).less || CTX(grep).json;
+}
+
+/**
+ * Returns true if the output can be written out before the command producing
+ * it has finished: it must go straight to the output fd, without pagers,
+ * prompts or filters needing the whole buffer.
+ */
+RZ_IPI bool rz_cons_can_stream(void) {
+	if (!I.stream || I.null || I.is_html || CTX(noflush) || CTX(stream_hold) > 0 || !rz_cons_context_is_main()) {
+		return false;
+	}
+	if ((CTX(cons_stack) && !rz_stack_is_empty(CTX(cons_stack))) || RZ_STR_ISNOTEMPTY(I.highlight)) {
+		return false;
+	}
+	if (cons_grep_enabled() && !CTX(stream_grep)) {
+		return false;
+	}
+	// rz_cons_flush() may page the output or ask before printing it
+	return !rz_cons_is_interactive() || !rz_cons_isatty();
+}
+
+static void cons_stream_write_lines(char *buf, size_t len, bool all) {
+	size_t end = len;
+	if (!all) {
+		const char *nl = rz_str_rchr(buf, buf + len - 1, '\n');
+		if (!nl) {
+			return;
+		}
+		end = nl - buf + 1;
+	}
+	if (cons_grep_enabled()) {
+		RzStrBuf ob;
+		rz_strbuf_init(&ob);
+		if (rz_cons_grep_lines(buf, (int)end, &ob) && !CTX(grep).counter) {
+			cons_tee_write(rz_strbuf_get(&ob), rz_strbuf_length(&ob));
+			__cons_write(rz_strbuf_get(&ob), rz_strbuf_length(&ob));
+		}
+		rz_strbuf_fini(&ob);
+	} else {
+		cons_tee_write(buf, end);
+		__cons_write(buf, end);
+	}
+	memmove(buf, buf + end, len - end + 1);
+	CTX(buffer_len) = len - end;
+	CTX(streamed) = true;
+	ctx_rowcol_calc_reset();
+}
+
+/**
+ * Writes out the complete lines of the buffer (or the whole buffer if \p all)
+ * through the grep and keeps the rest for later.
+ */
+static void cons_stream_write(bool all) {
+	char *buf = CTX(buffer);
+	size_t len = CTX(buffer_len);
+	if (buf && len) {
+		cons_stream_write_lines(buf, len, all);
+	}
+	// the output may end right where the previous chunk was written out
+	if (all && cons_grep_enabled() && CTX(grep).counter) {
+		char cnt[32];
+		rz_strf(cnt, "%d\n", I.lines);
+		cons_tee_write(cnt, strlen(cnt));
+		__cons_write(cnt, strlen(cnt));
+		if (I.num) {
+			I.num->value = I.lines;
+		}
+	}
+}
+
+/**
+ * \brief Writes out the output accumulated so far if it is big enough
+ *
+ * Commands producing huge listings call this whenever the buffer ends with
+ * a complete line of output. If the output goes to a file, a pipe or a
+ * non-interactive terminal, the complete lines are filtered through the
+ * grep (see rz_cons_grep_stream_begin()) and written out, so that the
+ * buffer stays small and the output appears while it is produced.
+ * Otherwise nothing happens and the output is written by rz_cons_flush().
+ */
+RZ_API void rz_cons_stream_flush(void) {
+	if (CTX(buffer_len) < CONS_STREAM_CHUNK || !rz_cons_can_stream()) {
+		return;
+	}
+	cons_stream_write(false);
+}
+
+RZ_API void rz_cons_flush(void) {
 	if (CTX(noflush)) {
 		return;
 	}
@@ -973,6 +1083,17 @@ RZ_API void rz_cons_flush(void) {
 		rz_cons_reset();
 		return;
 	}
+	if (CTX(stream_grep) && rz_cons_can_stream()) {
+		// the command is still running, the last line may be incomplete
+		cons_stream_write(false);
+		return;
+	}
+	if (CTX(streamed)) {
+		cons_stream_write(true);
+		CTX(lastLength) = 0;
+		rz_cons_reset();
+		return;
+	}
 	if (lastMatters() && !CTX(lastMode)) {
 		// snapshot of the output
 		if (CTX(buffer_len) > CTX(lastLength)) {
@@ -1024,17 +1145,7 @@ RZ_API void rz_cons_flush(void) {
 			rz_cons_set_raw(true);
 		}
 	}
-	if (tee && *tee) {
-		FILE *d = rz_sys_fopen(tee, "a+");
-		if (d) {
-			if (CTX(buffer_len) != fwrite(CTX(buffer), 1, CTX(buffer_len), d)) {
-				eprintf("rz_cons_flush: fwrite: error (%s)\n", tee);
-			}
-			fclose(d);
-		} else {
-			eprintf("Cannot write on '%s'\n", tee);
-		}
-	}
+	cons_tee_write(CTX(buffer), CTX(buffer_len));
 	rz_cons_highlight(I.highlight);
 
 	// is_html must be a filter, not a write endpoint
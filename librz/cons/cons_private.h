@@ -0,0 +1,13 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef CONS_PRIVATE_H
+#define CONS_PRIVATE_H
+
+/* cons.c */
+RZ_IPI bool rz_cons_can_stream(void);
+
+/* grep.c */
+RZ_IPI bool rz_cons_grep_lines(RZ_NONNULL const char *buf, int len, RZ_NONNULL RzStrBuf *ob);
+
+#endif
@@ -5,6 +5,7 @@
 #include <rz_cons.h>
 #include <rz_util/rz_print.h>
 #include <sdb.h>
+#include "cons_private.h"
 
 #define I(x) rz_cons_singleton()->x
 
@@ -68,21 +69,23 @@ RZ_API void rz_cons_grep_help(void) {
 
 #define RZ_CONS_GREP_BUFSIZE 4096
 
-static void parse_grep_expression(const char *str) {
+/**
+ * Parses \p str into \p grep, returns false if the help has been requested.
+ */
+static bool parse_grep(RzConsGrep *grep, const char *str) {
 	static char buf[RZ_CONS_GREP_BUFSIZE];
 	int wlen, len, is_range, num_is_parsed, fail = 0;
 	char *ptr, *optr, *ptr2, *ptr3, *end_ptr = NULL, last;
 	ut64 range_begin, range_end;
 
 	if (!str || !*str) {
-		return;
+		return true;
 	}
 	RzCons *cons = rz_cons_singleton();
-	RzConsGrep *grep = &cons->context->grep;
 	grep->sorted_column = 0;
 	bool first = true;
 
-	// setup cons->context->grep.icase according to cons->grep_icase
+	// setup grep->icase according to cons->grep_icase
 	if (cons->grep_icase == RZ_CONS_SEARCH_CASE_SMART) {
 		// smartcase - when the search term is all lowercase, ignore the case,
 		// instead if the search term is uppercase or a mix, do a case-sensitive search.
@@ -96,9 +99,9 @@ static void parse_grep_expression(const char *str) {
 			grep_str++;
 		}
 
-		cons->context->grep.icase = has_upper ? RZ_CONS_SEARCH_CASE_SENSITIVE : RZ_CONS_SEARCH_CASE_INSENSITIVE;
+		grep->icase = has_upper ? RZ_CONS_SEARCH_CASE_SENSITIVE : RZ_CONS_SEARCH_CASE_INSENSITIVE;
 	} else {
-		cons->context->grep.icase = cons->grep_icase;
+		grep->icase = cons->grep_icase;
 	}
 
 	while (*str) {
@@ -110,7 +113,7 @@ static void parse_grep_expression(const char *str) {
 				} else {
 					grep->less = 1;
 				}
-				return;
+				return true;
 			}
 			str++;
 			break;
@@ -142,7 +145,7 @@ static void parse_grep_expression(const char *str) {
 				} else {
 					free(jsonPath);
 				}
-				return;
+				return true;
 			}
 			str++;
 			break;
@@ -194,9 +197,7 @@ static void parse_grep_expression(const char *str) {
 				grep->charCounter = true;
 				str++;
 			} else if (*str == '?') {
-				cons->filter = true;
-				rz_cons_grep_help();
-				return;
+				return false;
 			}
 			break;
 		default:
@@ -209,7 +210,7 @@ while_end:
 	len = strlen(str) - 1;
 	if (len > RZ_CONS_GREP_BUFSIZE - 1) {
 		eprintf("rz_cons_grep: too long!\n");
-		return;
+		return true;
 	}
 	if (len > 0 && str[len] == '?') {
 		grep->counter = 1;
@@ -346,6 +347,15 @@ while_end:
 		grep->nstrings++;
 		grep->strings[0][0] = 0;
 	}
+	return true;
+}
+
+static void parse_grep_expression(const char *str) {
+	RzCons *cons = rz_cons_singleton();
+	if (!parse_grep(&cons->context->grep, str)) {
+		cons->filter = true;
+		rz_cons_grep_help();
+	}
 }
 
 // Finds and returns next intgerp expression,
@@ -442,6 +452,76 @@ RZ_API void rz_cons_grep_process(RZ_OWN char *grep) {
 	free(grep);
 }
 
+static bool grep_is_streamable(const RzConsGrep *grep) {
+	if (grep->json || grep->less || grep->hud || grep->zoom || grep->sort != -1 || grep->charCounter) {
+		return false;
+	}
+	// negative line numbers need the whole output and ranges of lines are
+	// tracked across lines by rz_cons_grep_lines()
+	return grep->range_line == 2 || (!grep->range_line && grep->line >= 0);
+}
+
+/**
+ * \brief Parses the grep expression before running the command it filters
+ *
+ * If the grep can be applied one line at a time and the output can be
+ * streamed, the grep is parsed right away, so that rz_cons_stream_flush()
+ * can filter and write out the output while the command is running.
+ * Otherwise streaming is suspended until rz_cons_grep_stream_end() and the
+ * caller processes the grep after the command as usual.
+ *
+ * \param grep The grep expression, without the leading `~`
+ * \return true if the grep has been parsed, false if the caller still has to
+ *         pass it to rz_cons_grep_process() after the command
+ */
+RZ_API bool rz_cons_grep_stream_begin(RZ_NONNULL const char *grep) {
+	rz_return_val_if_fail(grep, false);
+	RzCons *cons = rz_cons_singleton();
+	RzConsContext *ctx = cons->context;
+	if (ctx->stream_grep || ctx->grep.nstrings || !rz_cons_can_stream()) {
+		ctx->stream_hold++;
+		return false;
+	}
+	RzConsGrep parsed = { 0 };
+	parsed.line = -1;
+	parsed.sort = -1;
+	parsed.sorted_column = -1;
+	char *str = rz_str_dup(grep);
+	if (!str) {
+		ctx->stream_hold++;
+		return false;
+	}
+	rz_str_trim_tail(str);
+	bool ok = parse_grep(&parsed, str) && grep_is_streamable(&parsed);
+	free(str);
+	if (!ok) {
+		free(parsed.str);
+		free(parsed.json_path);
+		ctx->stream_hold++;
+		return false;
+	}
+	free(ctx->grep.str);
+	free(ctx->grep.json_path);
+	memcpy(&ctx->grep, &parsed, sizeof(RzConsGrep));
+	cons->lines = 0;
+	ctx->stream_grep = true;
+	return true;
+}
+
+/**
+ * \brief Ends the command started by rz_cons_grep_stream_begin()
+ *
+ * \param parsed The value returned by rz_cons_grep_stream_begin()
+ */
+RZ_API void rz_cons_grep_stream_end(bool parsed) {
+	RzConsContext *ctx = rz_cons_singleton()->context;
+	if (parsed) {
+		ctx->stream_grep = false;
+	} else if (ctx->stream_hold > 0) {
+		ctx->stream_hold--;
+	}
+}
+
 static int cmp(const void *a, const void *b, void *user) {
 	char *da = NULL;
 	char *db = NULL;
@@ -478,6 +558,90 @@ static int cmp(const void *a, const void *b, void *user) {
 	return strcmp(a, b);
 }
 
+/**
+ * Appends to \p ob the lines of \p buf matching the current grep.
+ * Text following the last newline is ignored. cons->lines is not reset, so
+ * that the output can be filtered one chunk of lines at a time.
+ */
+RZ_IPI bool rz_cons_grep_lines(RZ_NONNULL const char *buf, int len, RZ_NONNULL RzStrBuf *ob) {
+	RzCons *cons = rz_cons_singleton();
+	RzConsGrep *grep = &cons->context->grep;
+	bool is_range_line_grep_only = grep->range_line != 2 && !*grep->str;
+	const char *in = buf;
+	int ret, l, tl;
+	bool show = false;
+	while ((int)(size_t)(in - buf) < len) {
+		char *p = strchr(in, '\n');
+		if (!p) {
+			break;
+		}
+		l = p - in;
+		if ((!l && is_range_line_grep_only) || l > 0) {
+			char *tline = rz_str_ndup(in, l);
+			if (cons->grep_color) {
+				tl = l;
+			} else {
+				tl = rz_str_ansi_filter(tline, NULL, NULL, l);
+			}
+			if (tl < 0) {
+				ret = -1;
+			} else {
+				ret = rz_cons_grep_line(tline, tl);
+				if (!grep->range_line) {
+					if (grep->line == cons->lines) {
+						show = true;
+					}
+				} else if (grep->range_line == 1) {
+					if (grep->f_line == cons->lines) {
+						show = true;
+					}
+					if (grep->l_line == cons->lines) {
+						show = false;
+					}
+				} else {
+					show = true;
+				}
+			}
+			if ((!ret && is_range_line_grep_only) || ret > 0) {
+				if (show) {
+					char *str = rz_str_ndup(tline, ret);
+					if (cons->grep_highlight) {
+						int i;
+						for (i = 0; i < grep->nstrings; i++) {
+							char *newstr = rz_str_newf(Color_INVERT "%s" Color_RESET, grep->strings[i]);
+							if (str && newstr) {
+								if (grep->icase) {
+									str = rz_str_replace_icase(str, grep->strings[i], newstr, 1, 1);
+								} else {
+									str = rz_str_replace(str, grep->strings[i], newstr, 1);
+								}
+							}
+							free(newstr);
+						}
+					}
+					if (str) {
+						rz_strbuf_append(ob, str);
+						rz_strbuf_append(ob, "\n");
+					}
+					free(str);
+				}
+				if (!grep->range_line) {
+					show = false;
+				}
+				cons->lines++;
+			} else if (ret < 0) {
+				free(tline);
+				return false;
+			}
+			free(tline);
+			in += l + 1;
+		} else {
+			in++;
+		}
+	}
+	return true;
+}
+
 RZ_API void rz_cons_grepbuf(void) {
 	RzCons *cons = rz_cons_singleton();
 	cons->context->row = 0;
@@ -487,8 +651,7 @@ RZ_API void rz_cons_grepbuf(void) {
 	const int len = cons->context->buffer_len;
 	RzConsGrep *grep = &cons->context->grep;
 	const char *in = buf;
-	int ret, total_lines = 0, l = 0, tl = 0;
-	bool show = false;
+	int total_lines = 0, l = 0;
 	if (cons->filter) {
 		cons->context->buffer_len = 0;
 		RZ_FREE(cons->context->buffer);
@@ -637,76 +800,9 @@ RZ_API void rz_cons_grepbuf(void) {
 			grep->l_line = total_lines + grep->l_line;
 		}
 	}
-	bool is_range_line_grep_only = grep->range_line != 2 && !*grep->str;
-	in = buf;
-	while ((int)(size_t)(in - buf) < len) {
-		char *p = strchr(in, '\n');
-		if (!p) {
-			break;
-		}
-		l = p - in;
-		if ((!l && is_range_line_grep_only) || l > 0) {
-			char *tline = rz_str_ndup(in, l);
-			if (cons->grep_color) {
-				tl = l;
-			} else {
-				tl = rz_str_ansi_filter(tline, NULL, NULL, l);
-			}
-			if (tl < 0) {
-				ret = -1;
-			} else {
-				ret = rz_cons_grep_line(tline, tl);
-				if (!grep->range_line) {
-					if (grep->line == cons->lines) {
-						show = true;
-					}
-				} else if (grep->range_line == 1) {
-					if (grep->f_line == cons->lines) {
-						show = true;
-					}
-					if (grep->l_line == cons->lines) {
-						show = false;
-					}
-				} else {
-					show = true;
-				}
-			}
-			if ((!ret && is_range_line_grep_only) || ret > 0) {
-				if (show) {
-					char *str = rz_str_ndup(tline, ret);
-					if (cons->grep_highlight) {
-						int i;
-						for (i = 0; i < grep->nstrings; i++) {
-							char *newstr = rz_str_newf(Color_INVERT "%s" Color_RESET, grep->strings[i]);
-							if (str && newstr) {
-								if (grep->icase) {
-									str = rz_str_replace_icase(str, grep->strings[i], newstr, 1, 1);
-								} else {
-									str = rz_str_replace(str, grep->strings[i], newstr, 1);
-								}
-							}
-							free(newstr);
-						}
-					}
-					if (str) {
-						rz_strbuf_append(ob, str);
-						rz_strbuf_append(ob, "\n");
-					}
-					free(str);
-				}
-				if (!grep->range_line) {
-					show = false;
-				}
-				cons->lines++;
-			} else if (ret < 0) {
-				free(tline);
-				return;
-			}
-			free(tline);
-			in += l + 1;
-		} else {
-			in++;
-		}
+	if (!rz_cons_grep_lines(buf, len, ob)) {
+		rz_strbuf_free(ob);
+		return;
 	}
 
 	cons->context->buffer_len = rz_strbuf_length(ob);
@@ -2145,8 +2145,9 @@ static bool is_valid_xref(RzCore *core, ut64 xref_to, RzAnalysisXRefType type, i
  * \param xref_to    The target address of the xref.
  * \param type       The xref type.
  * \param can_search When true, search and set the new string.
+ * \param xrefs      The batch of xrefs to set once the search is over.
  */
-static void set_new_xref(RzCore *core, ut64 xref_from, ut64 xref_to, RzAnalysisXRefType type, bool can_search) {
+static void set_new_xref(RzCore *core, ut64 xref_from, ut64 xref_to, RzAnalysisXRefType type, bool can_search, RzVector /*<RzAnalysisXRef>*/ *xrefs) {
 	size_t length = 0;
 	char *string = NULL;
 	RzStrEnc encoding = 0;
@@ -2160,9 +2161,9 @@ static void set_new_xref(RzCore *core, ut64 xref_from, ut64 xref_to, RzAnalysisX
 		free(flagname);
 		free(string);
 	}
-	// Add to SDB
 	if (xref_to) {
-		rz_analysis_xrefs_set(core->analysis, xref_from, xref_to, type);
+		RzAnalysisXRef xref = { xref_from, xref_to, type };
+		rz_vector_push(xrefs, &xref);
 	}
 }
 
@@ -2207,6 +2208,10 @@ RZ_API int rz_core_analysis_search_xrefs(RZ_NONNULL RzCore *core, ut64 from, ut6
 		return -1;
 	}
 
+	// the xrefs are set all at once at the end, which is much faster than one by one
+	RzVector xrefs;
+	rz_vector_init(&xrefs, sizeof(RzAnalysisXRef), NULL, NULL);
+
 	rz_cons_break_push(NULL, NULL);
 
 	at = from;
@@ -2238,7 +2243,7 @@ RZ_API int rz_core_analysis_search_xrefs(RZ_NONNULL RzCore *core, ut64 from, ut6
 			// find references
 			if ((st64)op.val > asm_sub_varmin && op.val != UT64_MAX && op.val != UT32_MAX) {
 				if (is_valid_xref(core, op.val, RZ_ANALYSIS_XREF_TYPE_DATA, cfg_debug)) {
-					set_new_xref(core, op.addr, op.val, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string);
+					set_new_xref(core, op.addr, op.val, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string, &xrefs);
 					count++;
 				}
 			}
@@ -2246,7 +2251,7 @@ RZ_API int rz_core_analysis_search_xrefs(RZ_NONNULL RzCore *core, ut64 from, ut6
 				st64 aval = op.analysis_vals[i].imm;
 				if (aval > asm_sub_varmin && aval != UT64_MAX && aval != UT32_MAX) {
 					if (is_valid_xref(core, aval, RZ_ANALYSIS_XREF_TYPE_DATA, cfg_debug)) {
-						set_new_xref(core, op.addr, aval, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string);
+						set_new_xref(core, op.addr, aval, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string, &xrefs);
 						count++;
 					}
 				}
@@ -2254,35 +2259,35 @@ RZ_API int rz_core_analysis_search_xrefs(RZ_NONNULL RzCore *core, ut64 from, ut6
 			// find references
 			if (op.ptr && op.ptr != UT64_MAX && op.ptr != UT32_MAX) {
 				if (is_valid_xref(core, op.ptr, RZ_ANALYSIS_XREF_TYPE_DATA, cfg_debug)) {
-					set_new_xref(core, op.addr, op.ptr, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string);
+					set_new_xref(core, op.addr, op.ptr, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string, &xrefs);
 					count++;
 				}
 			}
 			// find references
 			if (op.addr > 512 && op.disp > 512 && op.disp && op.disp != UT64_MAX) {
 				if (is_valid_xref(core, op.disp, RZ_ANALYSIS_XREF_TYPE_DATA, cfg_debug)) {
-					set_new_xref(core, op.addr, op.disp, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string);
+					set_new_xref(core, op.addr, op.disp, RZ_ANALYSIS_XREF_TYPE_DATA, can_search_string, &xrefs);
 					count++;
 				}
 			}
 			switch (op.type) {
 			case RZ_ANALYSIS_OP_TYPE_JMP:
 				if (is_valid_xref(core, op.jump, RZ_ANALYSIS_XREF_TYPE_CODE, cfg_debug)) {
-					set_new_xref(core, op.addr, op.jump, RZ_ANALYSIS_XREF_TYPE_CODE, can_search_string);
+					set_new_xref(core, op.addr, op.jump, RZ_ANALYSIS_XREF_TYPE_CODE, can_search_string, &xrefs);
 					count++;
 				}
 				break;
 			case RZ_ANALYSIS_OP_TYPE_CJMP:
 				if (rz_config_get_b(core->config, "analysis.jmp.cref") &&
 					is_valid_xref(core, op.jump, RZ_ANALYSIS_XREF_TYPE_CODE, cfg_debug)) {
-					set_new_xref(core, op.addr, op.jump, RZ_ANALYSIS_XREF_TYPE_CODE, can_search_string);
+					set_new_xref(core, op.addr, op.jump, RZ_ANALYSIS_XREF_TYPE_CODE, can_search_string, &xrefs);
 					count++;
 				}
 				break;
 			case RZ_ANALYSIS_OP_TYPE_CALL:
 			case RZ_ANALYSIS_OP_TYPE_CCALL:
 				if (is_valid_xref(core, op.jump, RZ_ANALYSIS_XREF_TYPE_CALL, cfg_debug)) {
-					set_new_xref(core, op.addr, op.jump, RZ_ANALYSIS_XREF_TYPE_CALL, can_search_string);
+					set_new_xref(core, op.addr, op.jump, RZ_ANALYSIS_XREF_TYPE_CALL, can_search_string, &xrefs);
 					count++;
 				}
 				break;
@@ -2294,7 +2299,7 @@ RZ_API int rz_core_analysis_search_xrefs(RZ_NONNULL RzCore *core, ut64 from, ut6
 			case RZ_ANALYSIS_OP_TYPE_UCJMP:
 				count++;
 				if (is_valid_xref(core, op.ptr, RZ_ANALYSIS_XREF_TYPE_CODE, cfg_debug)) {
-					set_new_xref(core, op.addr, op.ptr, RZ_ANALYSIS_XREF_TYPE_CODE, can_search_string);
+					set_new_xref(core, op.addr, op.ptr, RZ_ANALYSIS_XREF_TYPE_CODE, can_search_string, &xrefs);
 					count++;
 				}
 				break;
@@ -2304,7 +2309,7 @@ RZ_API int rz_core_analysis_search_xrefs(RZ_NONNULL RzCore *core, ut64 from, ut6
 			case RZ_ANALYSIS_OP_TYPE_IRCALL:
 			case RZ_ANALYSIS_OP_TYPE_UCCALL:
 				if (is_valid_xref(core, op.ptr, RZ_ANALYSIS_XREF_TYPE_CALL, cfg_debug)) {
-					set_new_xref(core, op.addr, op.ptr, RZ_ANALYSIS_XREF_TYPE_CALL, can_search_string);
+					set_new_xref(core, op.addr, op.ptr, RZ_ANALYSIS_XREF_TYPE_CALL, can_search_string, &xrefs);
 					count++;
 				}
 				break;
@@ -2317,6 +2322,8 @@ RZ_API int rz_core_analysis_search_xrefs(RZ_NONNULL RzCore *core, ut64 from, ut6
 		rz_analysis_op_fini(&op);
 	}
 	rz_cons_break_pop();
+	rz_analysis_xrefs_set_bulk(core->analysis, rz_vector_head(&xrefs), rz_vector_len(&xrefs));
+	rz_vector_fini(&xrefs);
 	free(buf);
 	free(block);
 	return count;
@@ -3607,15 +3614,14 @@ struct core_noretl {
 	RzSetU *todo;
 };
 
-static bool process_reference_noreturn_cb(void *u, const ut64 k, const void *v) {
-	RzCore *core = ((struct core_noretl *)u)->core;
-	RzList *noretl = ((struct core_noretl *)u)->noretl;
-	RzSetU *todo = ((struct core_noretl *)u)->todo;
-	RzAnalysisXRef *xref = (RzAnalysisXRef *)v;
+static void process_reference_noreturn(struct core_noretl *u, const RzAnalysisXRef *xref) {
+	RzCore *core = u->core;
+	RzList *noretl = u->noretl;
+	RzSetU *todo = u->todo;
 	if (xref->type == RZ_ANALYSIS_XREF_TYPE_CALL || xref->type == RZ_ANALYSIS_XREF_TYPE_CODE) {
 		// At first we check if there are any relocations that override the call address
 		// Note, that the relocation overrides only the part of the instruction
-		ut64 addr = k;
+		ut64 addr = xref->from;
 		ut8 buf[CALL_BUF_SIZE] = { 0 };
 		RzAnalysisOp op = { 0 };
 		if (core->analysis->iob.read_at(core->analysis->iob.io, addr, buf, CALL_BUF_SIZE)) {
@@ -3627,7 +3633,7 @@ static bool process_reference_noreturn_cb(void *u, const ut64 k, const void *v)
 					RzAnalysisBlock *block = find_block_at_xref_addr(core, addr);
 					if (!block) {
 						rz_analysis_op_fini(&op);
-						return true;
+						return;
 					}
 					relocation_noreturn_process(core, noretl, todo, block, rel, op.size, addr);
 				}
@@ -3637,13 +3643,6 @@ static bool process_reference_noreturn_cb(void *u, const ut64 k, const void *v)
 			RZ_LOG_INFO("analysis: Fail to load %d bytes of data at 0x%08" PFMT64x "\n", CALL_BUF_SIZE, addr);
 		}
 	}
-	return true;
-}
-
-static bool process_refs_cb(void *u, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach(ht, process_reference_noreturn_cb, u);
-	return true;
 }
 
 static bool reanalyze_fcns_cb(void *u, const ut64 k, const void *v) {
@@ -3667,7 +3666,14 @@ RZ_API void rz_core_analysis_propagate_noreturn_relocs(RzCore *core, ut64 addr)
 	// List of the potentially noreturn functions
 	RzSetU *todo = rz_set_u_new();
 	struct core_noretl u = { core, noretl, todo };
-	ht_up_foreach(core->analysis->ht_xrefs_to, process_refs_cb, &u);
+	RzIterator *it = rz_analysis_xrefs_iter(core->analysis);
+	if (it) {
+		RzAnalysisXRef *xref;
+		rz_iterator_foreach(it, xref) {
+			process_reference_noreturn(&u, xref);
+		}
+		rz_iterator_free(it);
+	}
 	rz_list_free(noretl);
 	core->analysis->bits = bits1;
 	core->rasm->bits = bits2;
@@ -4310,6 +4316,13 @@ RZ_API bool rz_core_analysis_sigdb_apply(RZ_NONNULL RzCore *core, RZ_NULLABLE in
 		return false;
 	}
 
+	if (!core->flirt_cache && !(core->flirt_cache = rz_sign_flirt_cache_new())) {
+		rz_list_free(sigdb);
+		return false;
+	}
+
+	RzPVector indexes;
+	rz_pvector_init(&indexes, NULL);
 	n_flags_old = rz_flag_count(core->flags, "flirt");
 	rz_list_foreach (sigdb, iter, sig) {
 		if (rz_cons_is_breaked()) {
@@ -4335,8 +4348,14 @@ RZ_API bool rz_core_analysis_sigdb_apply(RZ_NONNULL RzCore *core, RZ_NULLABLE in
 			rz_cons_printf("Applying %s/%s/%u/%s signature file\n",
 				sig->bin_name, sig->arch_name, sig->arch_bits, sig->base_name);
 		}
-		rz_sign_flirt_apply(core->analysis, sig->file_path, arch_id);
+		RzFlirtIndex *index = rz_sign_flirt_cache_get(core->flirt_cache, sig->file_path, arch_id);
+		if (index) {
+			rz_pvector_push(&indexes, index);
+		}
 	}
+	// all the signatures are matched in a single pass over the functions
+	rz_sign_flirt_apply_indexes(core->analysis, &indexes);
+	rz_pvector_fini(&indexes);
 	rz_list_free(sigdb);
 	n_flags_new = rz_flag_count(core->flags, "flirt");
 
@@ -72,6 +72,7 @@ RZ_API void rz_core_bin_options_init(RzCore *core, RZ_OUT RzBinOptions *opts, in
 	opts->obj_opts.elf_checks_sections = rz_config_get_b(core->config, "elf.checks.sections");
 	opts->obj_opts.elf_checks_segments = rz_config_get_b(core->config, "elf.checks.segments");
 	opts->obj_opts.big_endian = rz_config_get_b(core->config, "cfg.bigendian");
+	opts->obj_opts.lazy = rz_config_get_b(core->config, "bin.lazy");
 }
 
 RZ_API int rz_core_bin_set_by_fd(RzCore *core, ut64 bin_fd) {
@@ -311,7 +312,12 @@ RZ_API bool rz_core_bin_apply_all_info(RzCore *r, RzBinFile *binfile) {
 	}
 	rz_asm_use(r->rasm, arch);
 
-	rz_core_bin_apply_info(r, binfile, RZ_CORE_BIN_ACC_ALL);
+	ut32 mask = RZ_CORE_BIN_ACC_ALL;
+	if (binobj->opts.lazy) {
+		// flagging the strings would load them right away
+		mask &= ~RZ_CORE_BIN_ACC_STRINGS;
+	}
+	rz_core_bin_apply_info(r, binfile, mask);
 
 	rz_core_bin_set_cur(r, binfile);
 	return true;
@@ -1474,6 +1480,12 @@ static void select_flag_space(RzCore *core, RzBinSymbol *symbol) {
 	}
 }
 
+static void flag_bulk_item_fini(void *e, void *user) {
+	RzFlagBulkItem *item = e;
+	free(item->name);
+	free(item->realname);
+}
+
 RZ_API bool rz_core_bin_apply_symbols(RzCore *core, RzBinFile *binfile, bool va) {
 	rz_return_val_if_fail(core && binfile, false);
 	RzBinObject *o = binfile->o;
@@ -1487,6 +1499,12 @@ RZ_API bool rz_core_bin_apply_symbols(RzCore *core, RzBinFile *binfile, bool va)
 	rz_spaces_push(&core->analysis->meta_spaces, "bin");
 	rz_flag_space_push(core->flags, RZ_FLAGS_FS_SYMBOLS);
 
+	// the symbol flags are collected and set at once by rz_flag_set_bulk(),
+	// pending maps their names to their addresses until then
+	RzVector flags;
+	rz_vector_init(&flags, sizeof(RzFlagBulkItem), flag_bulk_item_fini, NULL);
+	HtSU *pending = ht_su_new(HT_STR_CONST);
+
 	RzBinObject *obj = rz_bin_cur_object(core->bin);
 	RzPVector *symbols = obj ? (RzPVector *)rz_bin_object_get_symbols(obj) : NULL;
 	void **iter;
@@ -1547,9 +1565,14 @@ RZ_API bool rz_core_bin_apply_symbols(RzCore *core, RzBinFile *binfile, bool va)
 				char *fnp = (core->bin->prefix) ? rz_str_newf("%s.%s", core->bin->prefix, fn) : rz_str_dup(fn ? fn : "");
 
 				RzFlagItem *fi = rz_flag_get(core->flags, fnp);
-				if (fi) {
+				bool found = !!fi;
+				ut64 found_addr = fi ? fi->offset : 0;
+				if (!found && pending) {
+					found_addr = ht_su_find(pending, fnp, &found);
+				}
+				if (found) {
 					RZ_FREE(fnp);
-					if (fi->offset == addr) {
+					if (found_addr == addr) {
 						// we have a duplicate flag which points
 						// at the same address and same name.
 						rz_core_sym_name_fini(&sn);
@@ -1562,14 +1585,23 @@ RZ_API bool rz_core_bin_apply_symbols(RzCore *core, RzBinFile *binfile, bool va)
 					}
 				}
 
-				fi = rz_flag_set(core->flags, fnp, addr, symbol->size);
-				if (fi) {
-					rz_flag_item_set_realname(fi, n);
-					fi->demangled = (bool)(size_t)sn.demname;
-				} else if (fn) {
-					RZ_LOG_WARN("core: cannot set flag with name '%s'\n", fnp);
+				RzFlagBulkItem *item = RZ_STR_ISNOTEMPTY(fnp) ? rz_vector_push(&flags, NULL) : NULL;
+				if (item) {
+					item->name = fnp;
+					item->realname = rz_str_dup(n);
+					item->demangled = (bool)(size_t)sn.demname;
+					item->offset = addr;
+					item->size = symbol->size;
+					item->space = rz_flag_space_cur(core->flags);
+					if (pending) {
+						ht_su_update(pending, fnp, addr);
+					}
+				} else {
+					if (fn) {
+						RZ_LOG_WARN("core: cannot set flag with name '%s'\n", fnp);
+					}
+					free(fnp);
 				}
-				free(fnp);
 			}
 			if (sn.demname) {
 				ut64 size = symbol->size ? symbol->size : 1;
@@ -1580,6 +1612,12 @@ RZ_API bool rz_core_bin_apply_symbols(RzCore *core, RzBinFile *binfile, bool va)
 		rz_core_sym_name_fini(&sn);
 	}
 
+	ht_su_free(pending);
+	if (!rz_flag_set_bulk(core->flags, &flags)) {
+		RZ_LOG_WARN("core: cannot set some of the symbol flags\n");
+	}
+	rz_vector_fini(&flags);
+
 	// handle thumb and arm for entry point since they are not present in symbols
 	if (is_arm) {
 		RzBinAddr *entry;
@@ -2861,6 +2899,7 @@ static bool strings_print(RzCore *core, RzCmdStateOutput *state, const RzPVector
 			break;
 		}
 		free(escaped_string);
+		rz_cons_stream_flush();
 	}
 	RZ_FREE(b64.string);
 	rz_cmd_state_output_array_end(state);
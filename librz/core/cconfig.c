@@ -159,6 +159,13 @@ static bool cb_analysis_depth(void *user, void *data) {
 	return true;
 }
 
+static bool cb_analysis_opcache(void *user, void *data) {
+	RzCore *core = (RzCore *)user;
+	RzConfigNode *node = (RzConfigNode *)data;
+	rz_analysis_op_cache_set_size(core->analysis, node->i_value);
+	return true;
+}
+
 static bool cb_analysis_graphdepth(void *user, void *data) {
 	RzCore *core = (RzCore *)user;
 	RzConfigNode *node = (RzConfigNode *)data;
@@ -2134,6 +2141,13 @@ static bool cb_ioff(void *user, void *data) {
 	return true;
 }
 
+static bool cb_io_rcache(void *user, void *data) {
+	RzCore *core = (RzCore *)user;
+	RzConfigNode *node = (RzConfigNode *)data;
+	rz_io_rcache_set_max_pages(core->io, node->i_value);
+	return true;
+}
+
 static bool cb_io_oxff(void *user, void *data) {
 	RzCore *core = (RzCore *)user;
 	RzConfigNode *node = (RzConfigNode *)data;
@@ -2314,6 +2328,12 @@ static bool cb_scrflush(void *user, void *data) {
 	return true;
 }
 
+static bool cb_scrstream(void *user, void *data) {
+	RzConfigNode *node = (RzConfigNode *)data;
+	rz_cons_singleton()->stream = node->i_value;
+	return true;
+}
+
 static bool cb_scrstrconv(void *user, void *data) {
 	RzCore *core = (RzCore *)user;
 	RzConfigNode *node = (RzConfigNode *)data;
@@ -2881,6 +2901,19 @@ static bool cb_analysis_bb_max_size(void *user, void *data) {
 	return true;
 }
 
+static bool cb_prj_format(void *user, void *data) {
+	RzConfigNode *node = (RzConfigNode *)data;
+	if (*node->value == '?') {
+		print_node_options(node);
+		return false;
+	}
+	if (strcmp(node->value, "text") && strcmp(node->value, "binary")) {
+		RZ_LOG_ERROR("core: prj.format: invalid format '%s'\n", node->value);
+		return false;
+	}
+	return true;
+}
+
 static bool cb_analysis_cpp_abi(void *user, void *data) {
 	RzCore *core = (RzCore *)user;
 	RzConfigNode *node = (RzConfigNode *)data;
@@ -3084,6 +3117,8 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETCB("analysis.cpu", RZ_SYS_ARCH, &cb_analysis_cpu, "Specify the analysis.cpu to use");
 	SETPREF("analysis.prelude", "", "Specify an hexpair to find preludes in code");
 	SETI("analysis.prelude.limit", 1024 * 1024 * 20, "Maximum size of the range to scan for preludes");
+	SETI("analysis.prelude.threads", 1, "Max threads used to scan for preludes (1 disables the parallel scan, 0 uses all available cores)");
+	SETICB("analysis.opcache", 4096, &cb_analysis_opcache, "Number of decoded ops kept in the analysis op cache, for the plugins supporting it (0 to disable)");
 	SETCB("analysis.recont", "false", &cb_analysis_recont, "End block after splitting a basic block instead of error"); // testing
 	SETCB("analysis.jmp.indir", "false", &cb_analysis_ijmp, "Follow the indirect jumps in function analysis"); // testing
 	SETI("analysis.ptrdepth", 3, "Maximum number of nested pointers to follow in analysis");
@@ -3351,6 +3386,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETCB("bin.dbginfo.debuginfod_urls", "http://debuginfod.elfutils.org/", NULL,
 		"Looks for debug symbols on the debuginfod servers, the value is a string of a space separated URLs");
 	SETBPREF("bin.relocs", "true", "Load relocs information at startup if available");
+	SETBPREF("bin.lazy", "false", "Load strings and fields of the binaries only when requested, the strings are not flagged at load time");
 	SETCB("bin.prefix", "", &cb_binprefix, "Prefix all symbols/sections/relocs with a specific string");
 	SETCB("bin.strings", "true", &cb_binstrings, "Load strings from rbin on startup");
 	SETCB("bin.debase64", "false", &cb_debase64, "Try to debase64 all strings");
@@ -3361,6 +3397,9 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	/* prj */
 	SETPREF("prj.file", "", "Path of the currently opened project");
 	SETBPREF("prj.compress", "false", "Compress the project file while saving");
+	n = NODECB("prj.format", "text", &cb_prj_format);
+	SETDESC(n, "Format of the saved project files (the format is detected when opening them)");
+	SETOPTIONS(n, "text", "binary", NULL);
 
 	/* cfg */
 	SETBPREF("cfg.plugins", "true", "Load plugins at startup");
@@ -3503,6 +3542,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETCB("dbg.swstep", "false", &cb_swstep, "Force use of software steps (code analysis+breakpoint)");
 	SETBPREF("dbg.trace.inrange", "false", "While tracing, avoid following calls outside specified range");
 	SETBPREF("dbg.trace.libs", "true", "Trace library code too");
+	SETBPREF("dbg.session.compress", "false", "Compress the memory pages saved by the checkpoints of a trace session");
 	SETBPREF("dbg.exitkills", "true", "Kill process on exit");
 	SETPREF("dbg.exe.path", "", "Path to binary being debugged");
 	SETCB("dbg.execs", "false", &cb_dbg_execs, "Stop execution if new thread is created");
@@ -3672,6 +3712,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETICB("scr.maxtab", 4096, &cb_completion_maxtab, "Change max number of auto completion suggestions");
 	SETICB("scr.pagesize", 1, &cb_scrpagesize, "Flush in pages when scr.linesleep is != 0");
 	SETCB("scr.flush", "false", &cb_scrflush, "Force flush to console in realtime (breaks scripting)");
+	SETCB("scr.stream", "false", &cb_scrstream, "Write out big outputs while they are produced when not printing to an interactive terminal");
 	SETBPREF("scr.slow", "true", "Do slow stuff on visual mode like RzFlag.get_at(true)");
 	SETCB("scr.prompt.popup", "false", &cb_scr_prompt_popup, "Show widget dropdown for autocomplete");
 #if __WINDOWS__
@@ -3764,6 +3805,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETI("search.distance", 0, "Search string distance");
 	SETBPREF("search.flags", "true", "All search results are flagged, otherwise only printed");
 	SETBPREF("search.overlap", "false", "Look for overlapped search hits");
+	SETI("search.max.threads", RZ_THREAD_N_CORES_ALL_AVAILABLE, "Max threads used to search large ranges in parallel (1 disables it, 0 uses all available cores)");
 	SETI("search.maxhits", 0, "Maximum number of hits (0: no limit)");
 	SETI("search.from", 0, "Search start address (inclusive)");
 	SETI("search.to", UT64_MAX, "Search end address (exclusive)");
@@ -3785,7 +3827,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 
 	/* rop */
 	SETI("rop.len", 5, "Maximum ROP gadget length");
-	SETBPREF("rop.cache", "false", "Cache rop gadget results(experimental)");
+	SETBPREF("rop.cache", "false", "Keep an index of the rop gadgets and their semantics in the cache directory");
 	SETBPREF("rop.subchains", "false", "Display every length gadget from rop.len=X to 2 in /Rl");
 	SETBPREF("rop.conditional", "false", "Include conditional jump, calls and returns in ropsearch");
 	SETBPREF("rop.comments", "false", "Display comments in rop search output");
@@ -3798,6 +3840,7 @@ RZ_API int rz_core_config_init(RzCore *core) {
 	SETCB("io.pcache", "false", &cb_iopcache, "io.cache for p-level");
 	SETCB("io.pcache.write", "false", &cb_iopcachewrite, "Enable write-cache");
 	SETCB("io.pcache.read", "false", &cb_iopcacheread, "Enable read-cache");
+	SETICB("io.rcache", 0, &cb_io_rcache, "Max number of 4K pages kept in the read cache of the io plugins (0 to disable)");
 	SETCB("io.ff", "true", &cb_ioff, "Fill invalid buffers with 0xff instead of returning error");
 	SETBPREF("io.exec", "true", "See !!rizin -h~-x");
 	SETICB("io.0xff", 0xff, &cb_io_oxff, "Use this value instead of 0xff to fill unallocated areas");
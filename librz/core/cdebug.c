@@ -733,6 +733,177 @@ RZ_API void rz_debug_traces_ascii(RzDebug *dbg, ut64 offset) {
 	rz_list_free(info_list);
 }
 
+/**
+ * \brief Traces the coverage of all the basic blocks of the analyzed functions
+ *
+ * A one-shot breakpoint is placed at the beginning of every block whenever
+ * the debuggee is resumed, until the block gets executed.
+ *
+ * \param core The RzCore instance
+ * \return the number of blocks added
+ */
+RZ_API ut64 rz_core_debug_coverage_add_functions(RZ_NONNULL RzCore *core) {
+	rz_return_val_if_fail(core && core->dbg, 0);
+	ut64 count = 0;
+	RzListIter *iter;
+	RzAnalysisFunction *fcn;
+	rz_list_foreach (core->analysis->fcns, iter, fcn) {
+		void **it;
+		rz_pvector_foreach (fcn->bbs, it) {
+			RzAnalysisBlock *bb = *it;
+			if (rz_debug_coverage_add(core->dbg, bb->addr, bb->size)) {
+				count++;
+			}
+		}
+	}
+	return count;
+}
+
+/**
+ * \brief Prints the basic blocks executed since the coverage started
+ * \param core The RzCore instance
+ * \param state Output state
+ */
+RZ_API void rz_core_debug_coverage_print(RZ_NONNULL RzCore *core, RZ_NONNULL RzCmdStateOutput *state) {
+	rz_return_if_fail(core && core->dbg && state);
+	RzPVector *covered = rz_debug_coverage_covered(core->dbg);
+	if (!covered) {
+		return;
+	}
+	rz_cmd_state_output_array_start(state);
+	void **it;
+	rz_pvector_foreach (covered, it) {
+		RzDebugCoverageBlock *b = *it;
+		switch (state->mode) {
+		case RZ_OUTPUT_MODE_QUIET:
+			rz_cons_printf("0x%" PFMT64x "\n", b->addr);
+			break;
+		case RZ_OUTPUT_MODE_JSON:
+			pj_o(state->d.pj);
+			pj_kn(state->d.pj, "addr", b->addr);
+			pj_kn(state->d.pj, "size", b->size);
+			pj_end(state->d.pj);
+			break;
+		case RZ_OUTPUT_MODE_STANDARD:
+		default:
+			rz_cons_printf("0x%08" PFMT64x " size=%u\n", b->addr, b->size);
+			break;
+		}
+	}
+	rz_cmd_state_output_array_end(state);
+	rz_pvector_free(covered);
+}
+
+typedef struct {
+	const char *path;
+	ut64 base;
+	ut64 end;
+} DrcovModule;
+
+static DrcovModule *drcov_module_find(RzVector /*<DrcovModule>*/ *modules, const char *path) {
+	DrcovModule *mod;
+	rz_vector_foreach (modules, mod) {
+		if (!strcmp(mod->path, path)) {
+			return mod;
+		}
+	}
+	return NULL;
+}
+
+static const DrcovModule *drcov_module_at(RzVector /*<DrcovModule>*/ *modules, ut64 addr, ut16 *id) {
+	DrcovModule *mod;
+	size_t i;
+	rz_vector_enumerate (modules, mod, i) {
+		if (i > UT16_MAX) {
+			break;
+		}
+		if (addr >= mod->base && addr < mod->end) {
+			*id = (ut16)i;
+			return mod;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Saves the basic block coverage in the drcov format of DynamoRIO
+ *
+ * The files can be loaded by the coverage tools supporting drcov, like
+ * lighthouse or bncov. The module table is built from the memory maps
+ * backed by files; blocks outside of them are not saved.
+ *
+ * \param core The RzCore instance
+ * \param file Path of the file to write
+ * \return success
+ */
+RZ_API bool rz_core_debug_coverage_drcov(RZ_NONNULL RzCore *core, RZ_NONNULL const char *file) {
+	rz_return_val_if_fail(core && core->dbg && file, false);
+	RzDebug *dbg = core->dbg;
+	rz_debug_map_sync(dbg);
+	RzVector modules;
+	rz_vector_init(&modules, sizeof(DrcovModule), NULL, NULL);
+	RzListIter *iter;
+	RzDebugMap *map;
+	rz_list_foreach (dbg->maps, iter, map) {
+		if (RZ_STR_ISEMPTY(map->file)) {
+			continue;
+		}
+		DrcovModule *mod = drcov_module_find(&modules, map->file);
+		if (mod) {
+			mod->base = RZ_MIN(mod->base, map->addr);
+			mod->end = RZ_MAX(mod->end, map->addr_end);
+		} else {
+			DrcovModule m = { map->file, map->addr, map->addr_end };
+			rz_vector_push(&modules, &m);
+		}
+	}
+
+	bool ret = false;
+	RzStrBuf sb;
+	rz_strbuf_init(&sb);
+	RzPVector *covered = rz_debug_coverage_covered(dbg);
+	ut8 *bbs = covered ? malloc(rz_pvector_len(covered) * 8 + 1) : NULL;
+	if (!bbs) {
+		goto beach;
+	}
+	ut64 n_bbs = 0;
+	void **it;
+	rz_pvector_foreach (covered, it) {
+		RzDebugCoverageBlock *b = *it;
+		ut16 id;
+		const DrcovModule *mod = drcov_module_at(&modules, b->addr, &id);
+		if (!mod || b->addr - mod->base > UT32_MAX) {
+			continue;
+		}
+		ut8 *entry = bbs + n_bbs++ * 8;
+		rz_write_le32(entry, (ut32)(b->addr - mod->base));
+		rz_write_le16(entry + 4, RZ_MIN(b->size, UT16_MAX));
+		rz_write_le16(entry + 6, id);
+	}
+
+	rz_strbuf_appendf(&sb, "DRCOV VERSION: 2\nDRCOV FLAVOR: drcov\n");
+	rz_strbuf_appendf(&sb, "Module Table: version 2, count %" PFMTSZu "\n", rz_vector_len(&modules));
+	rz_strbuf_append(&sb, "Columns: id, base, end, entry, checksum, timestamp, path\n");
+	DrcovModule *mod;
+	size_t id;
+	rz_vector_enumerate (&modules, mod, id) {
+		rz_strbuf_appendf(&sb, "%2" PFMTSZu ", 0x%016" PFMT64x ", 0x%016" PFMT64x ", 0x0000000000000000, 0x00000000, 0x00000000, %s\n",
+			id, mod->base, mod->end, mod->path);
+	}
+	rz_strbuf_appendf(&sb, "BB Table: %" PFMT64u " bbs\n", n_bbs);
+	ret = rz_file_dump(file, (const ut8 *)rz_strbuf_get(&sb), rz_strbuf_length(&sb), false) &&
+		rz_file_dump(file, bbs, n_bbs * 8, true);
+	if (!ret) {
+		RZ_LOG_ERROR("core: cannot write coverage to %s\n", file);
+	}
+beach:
+	free(bbs);
+	rz_pvector_free(covered);
+	rz_strbuf_fini(&sb);
+	rz_vector_fini(&modules);
+	return ret;
+}
+
 /**
  * \brief Close debug process (Kill debugee and all child processes)
  * \param core The RzCore instance
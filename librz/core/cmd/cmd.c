@@ -4706,10 +4706,6 @@ DEFINE_HANDLE_TS_FCN_AND_SYMBOL(grep_stmt) {
 	if (!arg_str) {
 		return RZ_CMD_STATUS_INVALID;
 	}
-	bool is_pipe = state->core->is_pipe;
-	state->core->is_pipe = true;
-	RzCmdStatus res = handle_ts_stmt(state, command);
-	state->core->is_pipe = is_pipe;
 	RZ_LOG_DEBUG("grep_stmt specifier: '%s'\n", arg_str);
 	RzStrBuf *sb = rz_strbuf_new(arg_str);
 	rz_strbuf_prepend(sb, "~");
@@ -4717,7 +4713,18 @@ DEFINE_HANDLE_TS_FCN_AND_SYMBOL(grep_stmt) {
 	rz_strbuf_free(sb);
 	char *specifier_str = rz_cmd_unescape_arg(specifier_str_es, true);
 	RZ_LOG_DEBUG("grep_stmt processed specifier: '%s'\n", specifier_str);
-	rz_cons_grep_process(specifier_str);
+	// when possible the grep is applied while the output is streamed
+	bool streaming = specifier_str && rz_cons_grep_stream_begin(specifier_str);
+	bool is_pipe = state->core->is_pipe;
+	state->core->is_pipe = true;
+	RzCmdStatus res = handle_ts_stmt(state, command);
+	state->core->is_pipe = is_pipe;
+	rz_cons_grep_stream_end(streaming);
+	if (streaming) {
+		free(specifier_str);
+	} else {
+		rz_cons_grep_process(specifier_str);
+	}
 	free(specifier_str_es);
 	free(arg_str);
 	return res;
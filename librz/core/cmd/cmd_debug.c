@@ -1507,6 +1507,49 @@ RZ_IPI RzCmdStatus rz_cmd_debug_traces_reset_handler(RzCore *core, int argc, con
 	return RZ_CMD_STATUS_OK;
 }
 
+// dtb
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_handler(RzCore *core, int argc, const char **argv) {
+	ut64 blocks, covered;
+	if (!rz_debug_coverage_stats(core->dbg, &blocks, &covered)) {
+		return RZ_CMD_STATUS_ERROR;
+	}
+	rz_cons_printf("blocks = %" PFMT64u "\n", blocks);
+	rz_cons_printf("covered = %" PFMT64u " (%.2f%%)\n", covered, blocks ? covered * 100.0 / blocks : 0.0);
+	return RZ_CMD_STATUS_OK;
+}
+
+// dtb+
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_add_handler(RzCore *core, int argc, const char **argv) {
+	if (rz_debug_is_dead(core->dbg)) {
+		RZ_LOG_ERROR("Cannot trace the coverage outside of debug mode, run ood?\n");
+		return RZ_CMD_STATUS_ERROR;
+	}
+	ut64 count = rz_core_debug_coverage_add_functions(core);
+	if (!count) {
+		RZ_LOG_ERROR("No basic blocks to trace, analyze some functions first.\n");
+		return RZ_CMD_STATUS_ERROR;
+	}
+	RZ_LOG_INFO("Tracing the coverage of %" PFMT64u " basic blocks\n", count);
+	return RZ_CMD_STATUS_OK;
+}
+
+// dtbl
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_list_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state) {
+	rz_core_debug_coverage_print(core, state);
+	return RZ_CMD_STATUS_OK;
+}
+
+// dtbd
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_drcov_handler(RzCore *core, int argc, const char **argv) {
+	return rz_core_debug_coverage_drcov(core, argv[1]) ? RZ_CMD_STATUS_OK : RZ_CMD_STATUS_ERROR;
+}
+
+// dtb-
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_reset_handler(RzCore *core, int argc, const char **argv) {
+	rz_debug_coverage_reset(core->dbg);
+	return RZ_CMD_STATUS_OK;
+}
+
 // dtc
 RZ_IPI RzCmdStatus rz_cmd_debug_trace_calls_handler(RzCore *core, int argc, const char **argv) {
 	ut64 from = argc > 1 ? rz_num_math(core->num, argv[1]) : 0;
@@ -1578,6 +1621,10 @@ RZ_IPI RzCmdStatus rz_cmd_debug_start_trace_session_handler(RzCore *core, int ar
 		return RZ_CMD_STATUS_ERROR;
 	}
 	core->dbg->session = rz_debug_session_new();
+	if (!core->dbg->session) {
+		return RZ_CMD_STATUS_ERROR;
+	}
+	core->dbg->session->compress_pages = rz_config_get_b(core->config, "dbg.session.compress");
 	rz_debug_add_checkpoint(core->dbg);
 	return RZ_CMD_STATUS_OK;
 }
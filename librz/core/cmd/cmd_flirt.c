@@ -31,10 +31,22 @@ RZ_IPI RzCmdStatus rz_flirt_scan_handler(RzCore *core, int argc, const char **ar
 	RzList *files = rz_file_globsearch(argv[1], depth);
 	ut8 arch_id = rz_core_flirt_arch_from_name(arch);
 
+	if (!core->flirt_cache && !(core->flirt_cache = rz_sign_flirt_cache_new())) {
+		rz_list_free(files);
+		return RZ_CMD_STATUS_ERROR;
+	}
+
+	RzPVector indexes;
+	rz_pvector_init(&indexes, NULL);
 	old = rz_flag_count(core->flags, "flirt");
 	rz_list_foreach (files, iter, file) {
-		rz_sign_flirt_apply(core->analysis, file, arch_id);
+		RzFlirtIndex *index = rz_sign_flirt_cache_get(core->flirt_cache, file, arch_id);
+		if (index) {
+			rz_pvector_push(&indexes, index);
+		}
 	}
+	rz_sign_flirt_apply_indexes(core->analysis, &indexes);
+	rz_pvector_fini(&indexes);
 	rz_list_free(files);
 	new = rz_flag_count(core->flags, "flirt");
 
@@ -13,6 +13,41 @@ static void rz_core_magic_reset(RzCore *core) {
 	kw_count = 0;
 }
 
+/**
+ * Returns the magic with the rules of \p file, or of dir.magic when it is
+ * NULL or empty. The rules are loaded only when they differ from the last
+ * ones loaded.
+ */
+static RzMagic *rz_core_magic_load(RzCore *core, const char *file) {
+	if (file) {
+		file = rz_str_trim_head_ro(file);
+		if (!*file) {
+			file = NULL;
+		}
+	}
+	const char *path = file ? file : rz_config_get(core->config, "dir.magic");
+	if (!path) {
+		path = "";
+	}
+	if (ck && ofile && !strcmp(path, ofile)) {
+		return ck;
+	}
+	rz_magic_free(ck);
+	free(ofile);
+	ofile = rz_str_dup(path);
+	ck = rz_magic_new(0);
+	if (!ck || !rz_magic_load(ck, path)) {
+		if (file) {
+			RZ_LOG_ERROR("core: failed rz_magic_load (\"%s\") %s\n", file, ck ? rz_magic_error(ck) : "");
+		} else {
+			RZ_LOG_ERROR("core: failed rz_magic_load (dir.magic) %s\n", ck ? rz_magic_error(ck) : "");
+		}
+		rz_magic_free(ck);
+		ck = NULL;
+	}
+	return ck;
+}
+
 static int rz_core_magic_at(RzCore *core, const char *file, ut64 addr, int depth, int v, PJ *pj, int *hits) {
 	const char *fmt;
 	char *q, *p;
@@ -23,18 +58,14 @@ static int rz_core_magic_at(RzCore *core, const char *file, ut64 addr, int depth
 	if (maxHits > 0 && *hits >= maxHits) {
 		return 0;
 	}
-#define NAH 32
 
 	if (--depth < 0) {
 		ret = 0;
 		goto seek_exit;
 	}
+	// always check a whole block, like rz_magic_index_scan() assumes
 	if (addr != core->offset) {
-		if (addr >= core->offset && (addr + NAH) < (core->offset + core->blocksize)) {
-			delta = addr - core->offset;
-		} else {
-			rz_core_seek(core, addr, true);
-		}
+		rz_core_seek(core, addr, true);
 	}
 	if (core->search->align) {
 		int mod = addr % core->search->align;
@@ -54,35 +85,9 @@ static int rz_core_magic_at(RzCore *core, const char *file, ut64 addr, int depth
 		if (!*file)
 			file = NULL;
 	}
-	if (file && ofile && file != ofile) {
-		if (strcmp(file, ofile)) {
-			rz_magic_free(ck);
-			ck = NULL;
-		}
-	}
-	if (!ck) {
-		// TODO: Move RzMagic into RzCore
-		rz_magic_free(ck);
-		// allocate once
-		ck = rz_magic_new(0);
-		if (file) {
-			free(ofile);
-			ofile = rz_str_dup(file);
-			if (!rz_magic_load(ck, file)) {
-				RZ_LOG_ERROR("core: failed rz_magic_load (\"%s\") %s\n", file, rz_magic_error(ck));
-				ck = NULL;
-				ret = -1;
-				goto seek_exit;
-			}
-		} else {
-			const char *magicpath = rz_config_get(core->config, "dir.magic");
-			if (!rz_magic_load(ck, magicpath)) {
-				ck = NULL;
-				RZ_LOG_ERROR("core: failed rz_magic_load (dir.magic) %s\n", rz_magic_error(ck));
-				ret = -1;
-				goto seek_exit;
-			}
-		}
+	if (!rz_core_magic_load(core, file)) {
+		ret = -1;
+		goto seek_exit;
 	}
 	// repeat:
 	// if (v) rz_cons_printf ("  %d # pm %s @ 0x%"PFMT64x"\n", depth, file? file: "", addr);
@@ -164,8 +169,6 @@ static int rz_core_magic_at(RzCore *core, const char *file, ut64 addr, int depth
 			}
 		}
 		free(p);
-		rz_magic_free(ck);
-		ck = NULL;
 		//		return adelta+1;
 	}
 	adelta++;
@@ -302,6 +302,143 @@ static int __prelude_cb_hit(RzSearchKeyword *kw, void *user, ut64 addr) {
 	return 1;
 }
 
+#define PRELUDE_CHUNK_SIZE        0x10000
+#define PRELUDE_CHUNKS_PER_THREAD 4
+
+typedef struct {
+	ut64 addr; ///< address of the first byte of the chunk
+	ut64 size; ///< amount of bytes where a hit can end
+	ut64 pre; ///< amount of bytes before addr in buf, the tail of the previous chunk
+	ut8 *buf;
+	RzVector /*<ut64>*/ hits; ///< matching addresses, sorted
+} PreludeChunk;
+
+typedef struct {
+	const RzSearch *search;
+	const RzSearchKeyword *kw;
+} PreludeScanContext;
+
+static void prelude_chunk_free(PreludeChunk *chunk) {
+	if (!chunk) {
+		return;
+	}
+	rz_vector_fini(&chunk->hits);
+	free(chunk->buf);
+	free(chunk);
+}
+
+static void prelude_chunk_scan(PreludeChunk *chunk, PreludeScanContext *ctx) {
+	const ut64 len = chunk->pre + chunk->size;
+	// hits ending within the tail of the previous chunk belong to it
+	ut64 i = chunk->pre + 1 > ctx->kw->keyword_length ? chunk->pre + 1 - ctx->kw->keyword_length : 0;
+	for (; i < len; i++) {
+		if (rz_search_keyword_match_at(ctx->search, ctx->kw, chunk->buf, len, i)) {
+			ut64 addr = chunk->addr - chunk->pre + i;
+			rz_vector_push(&chunk->hits, &addr);
+		}
+	}
+}
+
+/**
+ * Parallel variant of the prelude search loop.
+ *
+ * The interval is split into chunks of whole blocks, each one starting
+ * with the last bytes of the previous one (the length of the keyword minus
+ * one), so the hits across chunk boundaries are not lost. The chunks are
+ * read serially (RzIO is not thread-safe) a batch at a time, exactly like
+ * the serial loop reads the blocks, then they are scanned by a pool of
+ * threads. The hits are finally replayed in address order through
+ * rz_search_hit_new() on the calling thread, which analyzes the functions
+ * exactly like the serial search would do.
+ *
+ * Returns false when the parallel search cannot be used (nothing is done).
+ */
+static bool search_prelude_parallel(RzCore *core, ut64 from, ut64 to, RzSearchKeyword *kw, RzThreadNCores max_threads) {
+	const ut64 bsize = core->blocksize;
+	if (core->search->bckwrds || !bsize || !kw->keyword_length || to - from > UT64_MAX - bsize) {
+		return false;
+	}
+	RzPVector *batch = rz_pvector_new((RzPVectorFree)prelude_chunk_free);
+	if (!batch) {
+		return false;
+	}
+
+	// chunks are made of whole blocks to stop where the serial loop stops
+	const ut64 chunk_blocks = RZ_MAX(PRELUDE_CHUNK_SIZE / bsize, 1);
+	const size_t n_threads = rz_th_max_threads(max_threads);
+	const size_t batch_len = n_threads * PRELUDE_CHUNKS_PER_THREAD;
+	PreludeScanContext ctx = {
+		.search = core->search,
+		.kw = kw,
+	};
+	const bool overlap = core->search->overlap;
+	ut64 next = 0;
+	bool stop = false;
+	ut64 at = from;
+	while (at < to && !stop) {
+		rz_pvector_clear(batch);
+		while (at < to && !stop && rz_pvector_len(batch) < batch_len) {
+			PreludeChunk *chunk = RZ_NEW0(PreludeChunk);
+			if (!chunk) {
+				stop = true;
+				break;
+			}
+			rz_vector_init(&chunk->hits, sizeof(ut64), NULL, NULL);
+			chunk->addr = at;
+			chunk->pre = RZ_MIN(kw->keyword_length - 1, at - from);
+			for (ut64 n = 0; n < chunk_blocks && at + chunk->size < to; n++) {
+				if (rz_cons_is_breaked() || !rz_io_is_valid_offset(core->io, at + chunk->size, 0)) {
+					stop = true;
+					break;
+				}
+				chunk->size += bsize;
+			}
+			chunk->buf = chunk->size ? malloc(chunk->pre + chunk->size) : NULL;
+			if (!chunk->buf || !rz_pvector_push(batch, chunk)) {
+				prelude_chunk_free(chunk);
+				stop = true;
+				break;
+			}
+			(void)rz_io_read_at(core->io, at - chunk->pre, chunk->buf, chunk->pre + chunk->size);
+			at += chunk->size;
+		}
+		if (rz_pvector_empty(batch)) {
+			break;
+		}
+		if (!rz_th_iterate_pvector(batch, (RzThreadIterator)prelude_chunk_scan, RZ_MIN(n_threads, rz_pvector_len(batch)), &ctx)) {
+			RZ_LOG_ERROR("core: cannot search the preludes in parallel\n");
+			break;
+		}
+
+		// replay the hits like rz_search_mybinparse_update() would report them.
+		void **it;
+		rz_pvector_foreach (batch, it) {
+			PreludeChunk *chunk = *it;
+			ut64 *hit;
+			rz_vector_foreach (&chunk->hits, hit) {
+				if (rz_cons_is_breaked()) {
+					stop = true;
+					break;
+				}
+				if (!overlap && *hit < next) {
+					continue;
+				}
+				int t = rz_search_hit_new(core->search, kw, *hit);
+				if (!t || t > 1) {
+					stop = true;
+					break;
+				}
+				next = *hit + kw->keyword_length;
+			}
+			if (stop) {
+				break;
+			}
+		}
+	}
+	rz_pvector_free(batch);
+	return true;
+}
+
 RZ_API int rz_core_search_prelude(RzCore *core, ut64 from, ut64 to, const ut8 *buf, int blen, const ut8 *mask, int mlen) {
 	ut64 at;
 	ut8 *b = (ut8 *)malloc(core->blocksize);
@@ -314,11 +451,18 @@ RZ_API int rz_core_search_prelude(RzCore *core, ut64 from, ut64 to, const ut8 *b
 		free(b);
 		return 0;
 	}
+	RzSearchKeyword *kw = rz_search_keyword_new(buf, blen, mask, mlen, NULL);
 	rz_search_reset(core->search, RZ_SEARCH_KEYWORD);
-	rz_search_kw_add(core->search, rz_search_keyword_new(buf, blen, mask, mlen, NULL));
+	rz_search_kw_add(core->search, kw);
 	rz_search_begin(core->search);
 	rz_search_set_callback(core->search, &__prelude_cb_hit, core);
 	preludecnt = 0;
+	RzThreadNCores max_threads = rz_config_get_i(core->config, "analysis.prelude.threads");
+	if (kw && max_threads != 1 && search_prelude_parallel(core, from, to, kw, max_threads)) {
+		rz_search_kw_reset(core->search);
+		free(b);
+		return preludecnt;
+	}
 	for (at = from; at < to; at += core->blocksize) {
 		if (rz_cons_is_breaked()) {
 			break;
@@ -534,6 +678,7 @@ static int _cb_hit(RzSearchKeyword *kw, void *user, ut64 addr) {
 		rz_core_cmd(core, param->cmd_hit, 0);
 		rz_core_seek(core, here, true);
 	}
+	rz_cons_stream_flush();
 	return true;
 }
 
@@ -1234,6 +1379,354 @@ static void do_asm_search(RzCore *core, struct search_parameters *param, const c
 	rz_cons_break_pop();
 }
 
+#define SEARCH_CHUNK_SIZE          0x100000
+#define SEARCH_CHUNKS_PER_THREAD   4
+
+typedef struct {
+	ut64 addr; ///< address of the hit
+	ut64 block; ///< index of the block containing the last byte of the hit
+	RzSearchKeyword *kw;
+	ut32 kw_idx; ///< index of the keyword within RzSearch.kws
+} SearchChunkHit;
+
+typedef struct {
+	ut64 addr; ///< address of the first byte of the chunk
+	ut64 size; ///< amount of bytes where a hit can end
+	ut64 pre; ///< amount of bytes before addr in buf, the tail of the previous chunk
+	ut8 *buf;
+	RzVector /*<SearchChunkHit>*/ hits; ///< sorted like the serial loop reports them
+} SearchChunk;
+
+typedef struct {
+	const RzSearch *search;
+	ut64 from; ///< address of the first block of the search
+	ut64 bsize;
+} SearchChunkContext;
+
+typedef struct {
+	SearchChunk *chunk;
+	const SearchChunkContext *ctx;
+} SearchChunkScan;
+
+/**
+ * Sorts the hits by the block where the serial loop finds them, then
+ * by keyword and address, which is the order rz_search_update() uses.
+ */
+static int search_chunk_hit_cmp(const void *a, const void *b, void *user) {
+	const SearchChunkHit *ha = a, *hb = b;
+	if (ha->block != hb->block) {
+		return ha->block < hb->block ? -1 : 1;
+	}
+	if (ha->kw_idx != hb->kw_idx) {
+		return ha->kw_idx < hb->kw_idx ? -1 : 1;
+	}
+	if (ha->addr != hb->addr) {
+		return ha->addr < hb->addr ? -1 : 1;
+	}
+	return 0;
+}
+
+static bool search_chunk_cb_hit(RzSearchKeyword *kw, ut32 kw_idx, ut64 idx, void *user) {
+	SearchChunkScan *scan = user;
+	SearchChunk *chunk = scan->chunk;
+	// hits ending within the tail of the previous chunk belong to it
+	if (idx + kw->keyword_length <= chunk->pre) {
+		return true;
+	}
+	ut64 addr = chunk->addr - chunk->pre + idx;
+	SearchChunkHit hit = {
+		.addr = addr,
+		.block = (addr + kw->keyword_length - 1 - scan->ctx->from) / scan->ctx->bsize,
+		.kw = kw,
+		.kw_idx = kw_idx,
+	};
+	return rz_vector_push(&chunk->hits, &hit);
+}
+
+/**
+ * Searches the keywords within a single chunk, collecting every position
+ * where a keyword matches. The search is shared by all the threads.
+ */
+static void search_chunk_scan(SearchChunk *chunk, SearchChunkContext *ctx) {
+	SearchChunkScan scan = { chunk, ctx };
+	rz_search_keywords_find(ctx->search, chunk->buf, chunk->pre + chunk->size, search_chunk_cb_hit, &scan);
+	rz_vector_sort(&chunk->hits, search_chunk_hit_cmp, false, NULL);
+}
+
+static void search_chunk_free(SearchChunk *chunk) {
+	if (!chunk) {
+		return;
+	}
+	rz_vector_fini(&chunk->hits);
+	free(chunk->buf);
+	free(chunk);
+}
+
+/**
+ * Returns the amount of bytes from \p at which can be read like the serial
+ * search loop does, which stops at the first block not mapped.
+ */
+static ut64 search_valid_size(RzCore *core, ut64 at, ut64 size) {
+	for (ut64 off = 0; off < size; off += core->blocksize) {
+		if (!rz_io_is_valid_offset(core->io, at + off, 0)) {
+			return off;
+		}
+	}
+	return size;
+}
+
+/**
+ * Parallel variant of the keyword search loop of do_string_search().
+ *
+ * The interval is split into chunks of SEARCH_CHUNK_SIZE bytes, each one
+ * starting with the last bytes of the previous one (the length of the
+ * longest keyword minus one), so hits across chunk boundaries are not lost.
+ * A hit belongs to the chunk containing its last byte, like the serial loop
+ * finds it in the block containing its last byte. The chunks are read
+ * serially (RzIO is not thread-safe) a batch at a time, then every chunk
+ * of the batch is searched by a pool of threads sharing core->search, which
+ * is prepared once. The hits are finally reported through rz_search_hit_new()
+ * on the calling thread in the same order as the serial loop (block, keyword,
+ * address), which honors search.overlap, search.contiguous, search.align and
+ * search.maxhits like the serial loop. The last bytes read are left to the
+ * search, so a following interval is searched together with them as well.
+ *
+ * Returns false when the parallel search cannot be used (nothing is done).
+ */
+static bool search_keywords_parallel(RzCore *core, struct search_parameters *param, ut64 from, ut64 to, RzThreadNCores max_threads) {
+	RzSearch *search = core->search;
+	const ut64 bsize = core->blocksize;
+	if (search->mode != RZ_SEARCH_KEYWORD || search->bckwrds || search->inverse || !bsize) {
+		return false;
+	}
+	// chunks are made of whole blocks to stop where the serial loop stops
+	const ut64 chunk_size = RZ_MAX(SEARCH_CHUNK_SIZE / bsize, 1) * bsize;
+	if (to - from <= chunk_size) {
+		return false;
+	}
+	ut64 longest = 0;
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	rz_list_foreach (search->kws, iter, kw) {
+		longest = RZ_MAX(longest, kw->keyword_length);
+	}
+	RzPVector *batch = rz_pvector_new((RzPVectorFree)search_chunk_free);
+	// for each keyword, the address after its last hit
+	ut64 *next = RZ_NEWS0(ut64, RZ_MAX(rz_list_length(search->kws), 1));
+	if (!longest || !batch || !next) {
+		rz_pvector_free(batch);
+		free(next);
+		return false;
+	}
+	rz_search_keywords_prepare(search);
+
+	const size_t batch_len = (size_t)rz_th_max_threads(max_threads) * SEARCH_CHUNKS_PER_THREAD;
+	SearchChunkContext ctx = {
+		.search = search,
+		.from = from,
+		.bsize = bsize,
+	};
+	bool stop = false;
+	ut64 at = from;
+	while (at < to && !stop) {
+		print_search_progress(at, to, search->nhits, param);
+		if (rz_cons_is_breaked()) {
+			eprintf("\n\n");
+			break;
+		}
+		rz_pvector_clear(batch);
+		while (at < to && !stop && rz_pvector_len(batch) < batch_len) {
+			SearchChunk *chunk = RZ_NEW0(SearchChunk);
+			if (!chunk) {
+				stop = true;
+				break;
+			}
+			rz_vector_init(&chunk->hits, sizeof(SearchChunkHit), NULL, NULL);
+			chunk->addr = at;
+			chunk->pre = RZ_MIN(longest - 1, at - from);
+			chunk->size = search_valid_size(core, at, RZ_MIN(chunk_size, to - at));
+			if (chunk->size < RZ_MIN(chunk_size, to - at)) {
+				stop = true;
+			}
+			chunk->buf = chunk->size ? malloc(chunk->pre + chunk->size) : NULL;
+			if (!chunk->buf || !rz_pvector_push(batch, chunk)) {
+				search_chunk_free(chunk);
+				stop = true;
+				break;
+			}
+			(void)rz_io_read_at(core->io, at - chunk->pre, chunk->buf, chunk->pre + chunk->size);
+			at += chunk->size;
+		}
+		if (rz_pvector_empty(batch)) {
+			break;
+		}
+		// the next interval starts with the last bytes read, like in the serial loop
+		SearchChunk *last = rz_pvector_tail(batch);
+		rz_search_set_leftover(search, last->addr + last->size, last->buf, last->pre + last->size);
+		if (!rz_th_iterate_pvector(batch, (RzThreadIterator)search_chunk_scan, RZ_MIN((size_t)rz_th_max_threads(max_threads), rz_pvector_len(batch)), &ctx)) {
+			RZ_LOG_ERROR("core: cannot search the chunks in parallel\n");
+			break;
+		}
+
+		void **it;
+		rz_pvector_foreach (batch, it) {
+			SearchChunk *chunk = *it;
+			SearchChunkHit *hit;
+			rz_vector_foreach (&chunk->hits, hit) {
+				if (!search->overlap && hit->addr < next[hit->kw_idx]) {
+					continue;
+				}
+				int t = rz_search_hit_new(search, hit->kw, hit->addr);
+				if (!t || t > 1) {
+					stop = true;
+					break;
+				}
+				next[hit->kw_idx] = hit->addr + hit->kw->keyword_length;
+			}
+			if (stop) {
+				break;
+			}
+		}
+	}
+	print_search_progress(at, to, search->nhits, param);
+	rz_pvector_free(batch);
+	free(next);
+	return true;
+}
+
+typedef struct {
+	ut64 addr; ///< address of the first byte of the chunk
+	ut64 size; ///< amount of offsets to check
+	ut64 len; ///< amount of bytes in buf, includes the overlap with the next chunk
+	ut8 *buf;
+	RzVector /*<ut64>*/ cands; ///< candidate addresses, sorted
+} MagicChunk;
+
+typedef struct {
+	const RzMagicIndex *idx;
+	ut64 window;
+} MagicChunkContext;
+
+static bool magic_chunk_cb_cand(void *user, size_t offset) {
+	MagicChunk *chunk = user;
+	ut64 addr = chunk->addr + offset;
+	return rz_vector_push(&chunk->cands, &addr);
+}
+
+static void magic_chunk_scan(MagicChunk *chunk, MagicChunkContext *ctx) {
+	rz_magic_index_scan(ctx->idx, chunk->buf, chunk->len, chunk->size, ctx->window, magic_chunk_cb_cand, chunk);
+}
+
+static void magic_chunk_free(MagicChunk *chunk) {
+	if (!chunk) {
+		return;
+	}
+	rz_vector_fini(&chunk->cands);
+	free(chunk->buf);
+	free(chunk);
+}
+
+/**
+ * Runs the magic rules on [from, to) only where the rules can match.
+ *
+ * The range is split into chunks of SEARCH_CHUNK_SIZE bytes, each one
+ * overlapping the next one by a block, which is the buffer checked by
+ * rz_core_magic_at(). The chunks are read serially a batch at a time, then
+ * the candidate offsets of every chunk are found by a pool of threads with
+ * rz_magic_index_scan(). The candidates are finally checked in address order
+ * on the calling thread, since the magic, flags and output are not thread-safe.
+ *
+ * The unindexed loop moves to the next offset after a match and skips one
+ * after a miss (the step returned by rz_core_magic_at()), so only the
+ * candidates it would reach are checked, to report exactly the same matches.
+ *
+ * Returns false when the search must stop.
+ */
+static bool search_magic_indexed(RzCore *core, struct search_parameters *param, const RzMagicIndex *idx, const char *file, ut64 from, ut64 to, int *hits) {
+	const ut64 bsize = core->blocksize;
+	RzPVector *batch = rz_pvector_new((RzPVectorFree)magic_chunk_free);
+	if (!batch || !bsize) {
+		rz_pvector_free(batch);
+		return false;
+	}
+	RzThreadNCores max_threads = rz_config_get_i(core->config, "search.max.threads");
+	const size_t batch_len = (size_t)rz_th_max_threads(max_threads) * SEARCH_CHUNKS_PER_THREAD;
+	int maxhits = rz_config_get_i(core->config, "search.maxhits");
+	PJ *pj = param->outmode == RZ_MODE_JSON ? param->pj : NULL;
+	MagicChunkContext ctx = {
+		.idx = idx,
+		.window = bsize,
+	};
+	bool stop = false;
+	ut64 at = from;
+	ut64 next = from; // next offset checked by the unindexed loop
+	while (at < to && !stop) {
+		if (rz_cons_is_breaked()) {
+			break;
+		}
+		rz_pvector_clear(batch);
+		while (at < to && rz_pvector_len(batch) < batch_len) {
+			MagicChunk *chunk = RZ_NEW0(MagicChunk);
+			if (!chunk) {
+				stop = true;
+				break;
+			}
+			rz_vector_init(&chunk->cands, sizeof(ut64), NULL, NULL);
+			chunk->addr = at;
+			chunk->size = RZ_MIN(SEARCH_CHUNK_SIZE, to - at);
+			// the block of the last offsets goes past the chunk, like core->block
+			chunk->len = chunk->size + bsize - 1;
+			chunk->buf = malloc(chunk->len);
+			if (!chunk->buf || !rz_pvector_push(batch, chunk)) {
+				magic_chunk_free(chunk);
+				stop = true;
+				break;
+			}
+			(void)rz_io_read_at(core->io, at, chunk->buf, chunk->len);
+			at += chunk->size;
+		}
+		if (!rz_th_iterate_pvector(batch, (RzThreadIterator)magic_chunk_scan, RZ_MIN((size_t)rz_th_max_threads(max_threads), rz_pvector_len(batch)), &ctx)) {
+			RZ_LOG_ERROR("core: cannot scan the chunks in parallel\n");
+			stop = true;
+			break;
+		}
+
+		void **it;
+		rz_pvector_foreach (batch, it) {
+			MagicChunk *chunk = *it;
+			ut64 *addr;
+			rz_vector_foreach (&chunk->cands, addr) {
+				if (core->search->align) {
+					if (*addr % core->search->align) {
+						continue;
+					}
+				} else if (*addr < next) {
+					continue;
+				} else if ((*addr - next) & 1) {
+					// skipped by a miss, the offset after it is checked instead
+					next = *addr + 1;
+					continue;
+				}
+				if (rz_cons_is_breaked()) {
+					stop = true;
+					break;
+				}
+				int ret = rz_core_magic_at(core, file, *addr, 99, false, pj, hits);
+				if (ret == -1 || (maxhits && *hits >= maxhits)) {
+					stop = true;
+					break;
+				}
+				next = *addr + RZ_MAX(ret, 1);
+			}
+			if (stop) {
+				break;
+			}
+		}
+	}
+	rz_pvector_free(batch);
+	return !stop && !rz_cons_is_breaked();
+}
+
 static void do_string_search(RzCore *core, RzInterval search_itv, struct search_parameters *param) {
 	ut64 at;
 	ut8 *buf = NULL;
@@ -1265,6 +1758,7 @@ static void do_string_search(RzCore *core, RzInterval search_itv, struct search_
 		if (search->bckwrds) {
 			rz_search_string_prepare_backward(search);
 		}
+		RzThreadNCores max_threads = rz_config_get_i(core->config, "search.max.threads");
 		rz_cons_break_push(NULL, NULL);
 		// TODO search cross boundary
 		rz_list_foreach (param->boundaries, iter, map) {
@@ -1298,7 +1792,16 @@ static void do_string_search(RzCore *core, RzInterval search_itv, struct search_
 				   from1 = search->bckwrds ? to : from,
 				   to1 = search->bckwrds ? from : to;
 			ut64 len;
-			for (at = from1; at != to1; at = search->bckwrds ? at - len : at + len) {
+			if (max_threads != 1 && !param->regex_search && !param->aes_search && !param->privkey_search &&
+				search_keywords_parallel(core, param, from, to, max_threads)) {
+				if (core->search->maxhits > 0 && core->search->nhits >= core->search->maxhits) {
+					goto done;
+				}
+				at = to1;
+			} else {
+				at = from1;
+			}
+			for (; at != to1; at = search->bckwrds ? at - len : at + len) {
 				print_search_progress(at, to1, search->nhits, param);
 				if (rz_cons_is_breaked()) {
 					eprintf("\n\n");
@@ -2132,11 +2635,23 @@ reread:
 			rz_core_magic_reset(core);
 			int maxHits = rz_config_get_i(core->config, "search.maxhits");
 			int hits = 0;
+			// only the offsets where a rule can match are checked when the rules can be indexed
+			RzMagic *magic = rz_core_magic_load(core, file);
+			RzMagicIndex *idx = magic ? rz_magic_index_new(magic) : NULL;
 			rz_list_foreach (param.boundaries, iter, map) {
 				if (param.outmode != RZ_MODE_JSON) {
 					eprintf("-- %llx %llx\n", map->itv.addr, rz_itv_end(map->itv));
 				}
 				rz_cons_break_push(NULL, NULL);
+				if (idx) {
+					bool next = search_magic_indexed(core, &param, idx, file, map->itv.addr, rz_itv_end(map->itv), &hits);
+					rz_cons_clear_line(1);
+					rz_cons_break_pop();
+					if (!next) {
+						break;
+					}
+					continue;
+				}
 				for (addr = map->itv.addr; addr < rz_itv_end(map->itv); addr++) {
 					if (rz_cons_is_breaked()) {
 						break;
@@ -2154,6 +2669,7 @@ reread:
 				rz_cons_clear_line(1);
 				rz_cons_break_pop();
 			}
+			rz_magic_index_free(idx);
 			if (param.outmode == RZ_MODE_JSON) {
 				pj_end(param.pj);
 			}
@@ -53,6 +53,7 @@ static const RzCmdDescDetail cmd_debug_list_bp_details[2];
 static const RzCmdDescDetail cmd_debug_add_cond_bp_details[2];
 static const RzCmdDescDetail cmd_debug_add_watchpoint_details[3];
 static const RzCmdDescDetail cmd_debug_esil_add_details[2];
+static const RzCmdDescDetail cmd_debug_coverage_add_details[2];
 static const RzCmdDescDetail cmd_debug_signal_option_details[2];
 static const RzCmdDescDetail debug_reg_cond_details[4];
 static const RzCmdDescDetail dr_details[2];
@@ -423,6 +424,7 @@ static const RzCmdDescArg cmd_debug_step_until_esil_args[2];
 static const RzCmdDescArg cmd_debug_step_until_flag_args[2];
 static const RzCmdDescArg cmd_debug_trace_add_args[2];
 static const RzCmdDescArg cmd_debug_trace_add_addrs_args[2];
+static const RzCmdDescArg cmd_debug_coverage_drcov_args[2];
 static const RzCmdDescArg cmd_debug_trace_calls_args[4];
 static const RzCmdDescArg cmd_debug_trace_esil_args[2];
 static const RzCmdDescArg cmd_debug_save_trace_session_args[2];
@@ -8932,6 +8934,63 @@ static const RzCmdDescHelp cmd_debug_traces_reset_help = {
 	.args = cmd_debug_traces_reset_args,
 };
 
+static const RzCmdDescHelp dtb_help = {
+	.summary = "Basic block coverage with one-shot breakpoints",
+};
+static const RzCmdDescArg cmd_debug_coverage_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_coverage_help = {
+	.summary = "Show the basic block coverage summary",
+	.args = cmd_debug_coverage_args,
+};
+
+static const RzCmdDescDetailEntry cmd_debug_coverage_add_Examples_detail_entries[] = {
+	{ .text = "aaa; dtb+; dc; dtb", .arg_str = NULL, .comment = "Run the program and show how many blocks have been executed" },
+	{ 0 },
+};
+static const RzCmdDescDetail cmd_debug_coverage_add_details[] = {
+	{ .name = "Examples", .entries = cmd_debug_coverage_add_Examples_detail_entries },
+	{ 0 },
+};
+static const RzCmdDescArg cmd_debug_coverage_add_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_coverage_add_help = {
+	.summary = "Trace the coverage of all the basic blocks of the analyzed functions",
+	.details = cmd_debug_coverage_add_details,
+	.args = cmd_debug_coverage_add_args,
+};
+
+static const RzCmdDescArg cmd_debug_coverage_list_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_coverage_list_help = {
+	.summary = "List the executed basic blocks",
+	.args = cmd_debug_coverage_list_args,
+};
+
+static const RzCmdDescArg cmd_debug_coverage_drcov_args[] = {
+	{
+		.name = "file",
+		.type = RZ_CMD_ARG_TYPE_FILE,
+
+	},
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_coverage_drcov_help = {
+	.summary = "Save the basic block coverage to <file> in drcov format",
+	.args = cmd_debug_coverage_drcov_args,
+};
+
+static const RzCmdDescArg cmd_debug_coverage_reset_args[] = {
+	{ 0 },
+};
+static const RzCmdDescHelp cmd_debug_coverage_reset_help = {
+	.summary = "Stop tracing the basic block coverage and remove the traps",
+	.args = cmd_debug_coverage_reset_args,
+};
+
 static const RzCmdDescArg cmd_debug_trace_calls_args[] = {
 	{
 		.name = "from",
@@ -21408,6 +21467,20 @@ RZ_IPI void rzshell_cmddescs_init(RzCore *core) {
 	RzCmdDesc *cmd_debug_traces_reset_cd = rz_cmd_desc_argv_new(core->rcmd, dt_cd, "dt-", rz_cmd_debug_traces_reset_handler, &cmd_debug_traces_reset_help);
 	rz_warn_if_fail(cmd_debug_traces_reset_cd);
 
+	RzCmdDesc *dtb_cd = rz_cmd_desc_group_new(core->rcmd, dt_cd, "dtb", rz_cmd_debug_coverage_handler, &cmd_debug_coverage_help, &dtb_help);
+	rz_warn_if_fail(dtb_cd);
+	RzCmdDesc *cmd_debug_coverage_add_cd = rz_cmd_desc_argv_new(core->rcmd, dtb_cd, "dtb+", rz_cmd_debug_coverage_add_handler, &cmd_debug_coverage_add_help);
+	rz_warn_if_fail(cmd_debug_coverage_add_cd);
+
+	RzCmdDesc *cmd_debug_coverage_list_cd = rz_cmd_desc_argv_state_new(core->rcmd, dtb_cd, "dtbl", RZ_OUTPUT_MODE_STANDARD | RZ_OUTPUT_MODE_JSON | RZ_OUTPUT_MODE_QUIET, rz_cmd_debug_coverage_list_handler, &cmd_debug_coverage_list_help);
+	rz_warn_if_fail(cmd_debug_coverage_list_cd);
+
+	RzCmdDesc *cmd_debug_coverage_drcov_cd = rz_cmd_desc_argv_new(core->rcmd, dtb_cd, "dtbd", rz_cmd_debug_coverage_drcov_handler, &cmd_debug_coverage_drcov_help);
+	rz_warn_if_fail(cmd_debug_coverage_drcov_cd);
+
+	RzCmdDesc *cmd_debug_coverage_reset_cd = rz_cmd_desc_argv_new(core->rcmd, dtb_cd, "dtb-", rz_cmd_debug_coverage_reset_handler, &cmd_debug_coverage_reset_help);
+	rz_warn_if_fail(cmd_debug_coverage_reset_cd);
+
 	RzCmdDesc *cmd_debug_trace_calls_cd = rz_cmd_desc_argv_new(core->rcmd, dt_cd, "dtc", rz_cmd_debug_trace_calls_handler, &cmd_debug_trace_calls_help);
 	rz_warn_if_fail(cmd_debug_trace_calls_cd);
 
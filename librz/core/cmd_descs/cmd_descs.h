@@ -1149,6 +1149,16 @@ RZ_IPI RzCmdStatus rz_cmd_debug_trace_add_handler(RzCore *core, int argc, const
 RZ_IPI RzCmdStatus rz_cmd_debug_trace_add_addrs_handler(RzCore *core, int argc, const char **argv);
 // "dt-"
 RZ_IPI RzCmdStatus rz_cmd_debug_traces_reset_handler(RzCore *core, int argc, const char **argv);
+// "dtb"
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_handler(RzCore *core, int argc, const char **argv);
+// "dtb+"
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_add_handler(RzCore *core, int argc, const char **argv);
+// "dtbl"
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_list_handler(RzCore *core, int argc, const char **argv, RzCmdStateOutput *state);
+// "dtbd"
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_drcov_handler(RzCore *core, int argc, const char **argv);
+// "dtb-"
+RZ_IPI RzCmdStatus rz_cmd_debug_coverage_reset_handler(RzCore *core, int argc, const char **argv);
 // "dtc"
 RZ_IPI RzCmdStatus rz_cmd_debug_trace_calls_handler(RzCore *core, int argc, const char **argv);
 // "dte"
@@ -1732,6 +1732,7 @@ RZ_API void rz_core_fini(RzCore *c) {
 	rz_core_wait(c);
 	//  avoid double free
 	RZ_FREE_CUSTOM(c->hash, rz_hash_free);
+	RZ_FREE_CUSTOM(c->flirt_cache, rz_sign_flirt_cache_free);
 	RZ_FREE_CUSTOM(c->ropchain, rz_list_free);
 	RZ_FREE_CUSTOM(c->ev, rz_event_free);
 	RZ_FREE(c->cmdlog);
@@ -7,6 +7,7 @@
 #include <rz_types.h>
 #include <rz_core.h>
 #include <rz_il.h>
+#include <rz_rop.h>
 
 RZ_IPI void rz_core_kuery_print(RzCore *core, const char *k);
 RZ_IPI int rz_output_mode_to_char(RzOutputMode mode);
@@ -226,6 +227,41 @@ RZ_IPI void rz_heap_debug_block_win(RzCore *core, const char *addr, RzOutputMode
 RZ_IPI void rz_heap_list_w32(RzCore *core, RzOutputMode mode);
 #endif
 
+/* rop.c */
+RZ_IPI bool rz_core_rop_is_end_gadget(const RzAnalysisOp *aop, const ut8 crop);
+RZ_IPI bool rz_core_rop_is_invalid_instruction(const char *opst, const int end_gadget_cnt);
+
+/* rop_index.c */
+typedef struct {
+	ut32 offset; ///< Offset of the instruction from the start of the range
+	ut32 size;
+	char *mnemonic;
+} RzRopIndexInsn;
+
+typedef struct {
+	ut32 offset; ///< Offset of the first instruction from the start of the range
+	ut32 n_insns;
+	ut32 delay_size; ///< Delay slots of the end gadget
+} RzRopIndexGadget;
+
+/**
+ * \brief Gadgets found in a searched range, see rop_index.c
+ */
+typedef struct {
+	ut64 from; ///< Start address of the range
+	ut64 size; ///< Size of the range
+	ut32 n_ends; ///< Number of end gadgets in the range
+	RzVector /*<RzRopIndexInsn>*/ insns; ///< Instructions of the gadgets, sorted by offset
+	RzVector /*<RzRopIndexGadget>*/ gadgets; ///< Gadgets in the order the serial search finds them
+	ut32 n_semantics; ///< Number of gadget semantics stored on disk
+	char *path; ///< Path of the on-disk index, NULL if it is not cached
+} RzRopIndex;
+
+RZ_IPI RZ_OWN RzRopIndex *rz_core_rop_index_get(RZ_NONNULL RzCore *core, RZ_NONNULL const RzRopSearchContext *context, RZ_NONNULL const ut8 *buf);
+RZ_IPI RZ_BORROW const RzRopIndexInsn *rz_core_rop_index_insn_at(RZ_NONNULL const RzRopIndex *index, ut32 offset);
+RZ_IPI void rz_core_rop_index_sync(RZ_NONNULL RzCore *core, RZ_NONNULL RzRopIndex *index);
+RZ_IPI void rz_core_rop_index_free(RZ_NULLABLE RzRopIndex *index);
+
 RZ_IPI bool rz_core_cmd_lastcmd_repeat(RzCore *core, bool next);
 
 static inline RzCmdStatus bool2status(bool val) {
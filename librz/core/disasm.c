@@ -5534,6 +5534,7 @@ toro:
 			RZ_FREE(ds->prev_line_col);
 		}
 		RZ_FREE(ds->opstr);
+		rz_cons_stream_flush();
 		inc = ds->oplen;
 
 		if (ds->midflags == RZ_MIDFLAGS_REALIGN && skip_bytes_flag) {
@@ -646,7 +646,9 @@ static bool add_new_bin_string(RzCore *core, char *string, ut64 vaddr, ut32 size
 	RzBinString *bstr;
 	RzBin *bin = core->bin;
 	RzBinFile *bf = rz_bin_cur(bin);
-	if (!bf || !bf->o || !bf->o->strings) {
+	// the getter loads the strings when they are lazy
+	const RzPVector *strings = bf && bf->o ? rz_bin_object_get_strings(bf->o) : NULL;
+	if (!strings) {
 		free(string);
 		return false;
 	}
@@ -657,7 +659,6 @@ static bool add_new_bin_string(RzCore *core, char *string, ut64 vaddr, ut32 size
 		return true;
 	}
 
-	const RzPVector *strings = rz_bin_object_get_strings(bf->o);
 	ordinal = rz_pvector_len(strings);
 
 	ut64 paddr = rz_io_v2p(core->io, vaddr);
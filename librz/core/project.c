@@ -41,6 +41,33 @@ RZ_API RzProjectErr rz_project_save(RzCore *core, RzProject *prj, const char *fi
 }
 
 RZ_API RzProjectErr rz_project_save_file(RzCore *core, const char *file, bool compress) {
+	RzProject *prj = sdb_new0();
+	if (!prj) {
+		return RZ_PROJECT_ERR_UNKNOWN;
+	}
+	RzProjectErr err = rz_project_save(core, prj, file);
+	if (err == RZ_PROJECT_ERR_SUCCESS) {
+		const char *fmt = rz_config_get(core->config, "prj.format");
+		RzProjectFormat format = fmt && !strcmp(fmt, "binary") ? RZ_PROJECT_FORMAT_BINARY : RZ_PROJECT_FORMAT_TEXT;
+		err = rz_project_write_file(prj, file, format, compress);
+	}
+	sdb_free(prj);
+	if (err == RZ_PROJECT_ERR_SUCCESS) {
+		rz_config_set(core->config, "prj.file", file);
+	}
+	return err;
+}
+
+/**
+ * \brief Writes an already filled RzProject into \p file
+ *
+ * \param prj      The project to write
+ * \param file     The path of the project file
+ * \param format   The format of the project file
+ * \param compress Whether to compress the file once written
+ */
+RZ_API RzProjectErr rz_project_write_file(RZ_NONNULL RzProject *prj, RZ_NONNULL const char *file, RzProjectFormat format, bool compress) {
+	rz_return_val_if_fail(prj && file, RZ_PROJECT_ERR_UNKNOWN);
 	char *tmp_file = NULL;
 
 	if (compress) {
@@ -51,24 +78,13 @@ RZ_API RzProjectErr rz_project_save_file(RzCore *core, const char *file, bool co
 		close(mkstemp_fd);
 	}
 
-	RzProjectErr err;
+	RzProjectErr err = RZ_PROJECT_ERR_SUCCESS;
 	const char *save_file = compress ? tmp_file : file;
-	RzProject *prj = sdb_new0();
-	if (!prj) {
-		err = RZ_PROJECT_ERR_UNKNOWN;
-		goto tmp_file_err;
-	}
-	err = rz_project_save(core, prj, file);
-	if (err != RZ_PROJECT_ERR_SUCCESS) {
-		sdb_free(prj);
-		return err;
-	}
-	if (!sdb_text_save(prj, save_file, true)) {
+	bool saved = format == RZ_PROJECT_FORMAT_BINARY
+		? rz_project_bin_save(prj, save_file)
+		: sdb_text_save(prj, save_file, true);
+	if (!saved) {
 		err = RZ_PROJECT_ERR_FILE;
-	}
-	sdb_free(prj);
-
-	if (err != RZ_PROJECT_ERR_SUCCESS) {
 		goto tmp_file_err;
 	}
 
@@ -77,8 +93,6 @@ RZ_API RzProjectErr rz_project_save_file(RzCore *core, const char *file, bool co
 		goto tmp_file_err;
 	}
 
-	rz_config_set(core->config, "prj.file", file);
-
 tmp_file_err:
 	rz_file_rm(tmp_file);
 	free(tmp_file);
@@ -87,11 +101,7 @@ tmp_file_err:
 
 /// Load a file into an RzProject but don't actually migrate anything or load it into an RzCore
 RZ_API RzProject *rz_project_load_file_raw(const char *file) {
-	RzProject *prj = sdb_new0();
-	if (!prj) {
-		return NULL;
-	}
-
+	RzProject *prj = NULL;
 	char *tmp_file;
 	int mkstemp_fd = rz_file_mkstemp("ldprj", &tmp_file);
 	close(mkstemp_fd);
@@ -104,19 +114,22 @@ RZ_API RzProject *rz_project_load_file_raw(const char *file) {
 	const char *load_file = tmp_file;
 
 	if (!rz_file_exists(file)) {
-		prj = NULL;
 		goto return_goto;
 	}
 	if (rz_file_is_deflated(file)) {
 		if (!rz_file_inflate(file, tmp_file)) {
-			prj = NULL;
 			goto return_goto;
 		}
 	} else {
 		load_file = file;
 	}
 
-	if (!sdb_text_load(prj, load_file)) {
+	if (rz_project_bin_check(load_file)) {
+		prj = rz_project_bin_load(load_file);
+		goto return_goto;
+	}
+	prj = sdb_new0();
+	if (prj && !sdb_text_load(prj, load_file)) {
 		sdb_free(prj);
 		prj = NULL;
 	}
@@ -131,8 +144,11 @@ RZ_API void rz_project_free(RzProject *prj) {
 	sdb_free(prj);
 }
 
-RZ_API RzProjectErr rz_project_load(RzCore *core, RzProject *prj, bool load_bin_io, RZ_NULLABLE const char *file, RzSerializeResultInfo *res) {
-	rz_return_val_if_fail(core && prj, RZ_PROJECT_ERR_UNKNOWN);
+/**
+ * \brief Checks the type of \p prj and returns its version
+ */
+RZ_API RzProjectErr rz_project_version(RZ_NONNULL RzProject *prj, RZ_NONNULL RZ_OUT unsigned long *version) {
+	rz_return_val_if_fail(prj && version, RZ_PROJECT_ERR_UNKNOWN);
 	const char *type = sdb_const_get(prj, RZ_PROJECT_KEY_TYPE);
 	if (!type || strcmp(type, RZ_PROJECT_TYPE) != 0) {
 		return RZ_PROJECT_ERR_INVALID_TYPE;
@@ -141,13 +157,23 @@ RZ_API RzProjectErr rz_project_load(RzCore *core, RzProject *prj, bool load_bin_
 	if (!version_str) {
 		return RZ_PROJECT_ERR_INVALID_VERSION;
 	}
-	unsigned long version = strtoul(version_str, NULL, 0);
-	if (!version || version == ULONG_MAX) {
+	*version = strtoul(version_str, NULL, 0);
+	if (!*version || *version == ULONG_MAX) {
 		return RZ_PROJECT_ERR_INVALID_VERSION;
 	}
-	if (version > RZ_PROJECT_VERSION) {
+	if (*version > RZ_PROJECT_VERSION) {
 		return RZ_PROJECT_ERR_NEWER_VERSION;
 	}
+	return RZ_PROJECT_ERR_SUCCESS;
+}
+
+RZ_API RzProjectErr rz_project_load(RzCore *core, RzProject *prj, bool load_bin_io, RZ_NULLABLE const char *file, RzSerializeResultInfo *res) {
+	rz_return_val_if_fail(core && prj, RZ_PROJECT_ERR_UNKNOWN);
+	unsigned long version;
+	RzProjectErr err = rz_project_version(prj, &version);
+	if (err != RZ_PROJECT_ERR_SUCCESS) {
+		return err;
+	}
 	if (!rz_project_migrate(prj, version, res)) {
 		return RZ_PROJECT_ERR_MIGRATION_FAILED;
 	}
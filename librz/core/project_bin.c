@@ -0,0 +1,415 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file project_bin.c
+ * Binary project format.
+ *
+ * The binary format contains exactly the same RzProject sdb tree as the text
+ * format, but every namespace is stored as a section with a table of its
+ * entries sorted by key, so the file can be mapped in memory and single values
+ * looked up in place, without parsing or unescaping the sdb text.
+ *
+ * This is only a container for the key/value strings: the values keep the
+ * encodings of the serializers (e.g. the JSON of the functions), which the
+ * loaders still parse when a project is loaded, every object is built at
+ * load time and a save always writes the whole file again.
+ *
+ * Layout, all the integers are little endian:
+ *
+ *   header:   "RZPRJBIN", ut32 format version, ut32 number of sections,
+ *             ut64 offset of the section table, ut64 reserved
+ *   sections: the data of each namespace, written one after the other
+ *   table:    for each section: ut64 offset, ut64 size, ut32 number of entries,
+ *             ut32 index of the parent section, ut32 offset and ut32 length of the
+ *             name within the section
+ *
+ * A section starts with its entries (ut32 key offset, ut32 key length, ut32 value
+ * offset, ut32 value length, the offsets are relative to the section) followed
+ * by the NUL terminated strings. Section 0 is the root of the project and the
+ * parent of a section always comes before it.
+ */
+
+#include <rz_project.h>
+
+#define PRJ_BIN_MAGIC        "RZPRJBIN"
+#define PRJ_BIN_MAGIC_SIZE   8
+#define PRJ_BIN_VERSION      1
+#define PRJ_BIN_HEADER_SIZE  32
+#define PRJ_BIN_SECTION_SIZE 32
+#define PRJ_BIN_ENTRY_SIZE   16
+#define PRJ_BIN_NO_PARENT    UT32_MAX
+
+typedef struct {
+	ut64 offset;
+	ut64 size;
+	ut32 n_entries;
+	ut32 parent;
+	ut32 name_off;
+	ut32 name_len;
+} PrjBinSection;
+
+struct rz_project_bin_t {
+	RzMmap *map;
+	ut32 n_sections;
+	PrjBinSection *sections;
+};
+
+/**
+ * \brief Checks whether \p file starts with the magic of the binary project format
+ */
+RZ_API bool rz_project_bin_check(RZ_NONNULL const char *file) {
+	rz_return_val_if_fail(file, false);
+	ut8 magic[PRJ_BIN_MAGIC_SIZE];
+	FILE *f = rz_sys_fopen(file, "rb");
+	if (!f) {
+		return false;
+	}
+	bool ret = fread(magic, 1, sizeof(magic), f) == sizeof(magic) && !memcmp(magic, PRJ_BIN_MAGIC, sizeof(magic));
+	fclose(f);
+	return ret;
+}
+
+/* writer */
+
+typedef struct {
+	FILE *f;
+	ut64 offset;
+	RzVector /*<PrjBinSection>*/ sections;
+} PrjBinWriter;
+
+static bool write_all(PrjBinWriter *w, const void *buf, size_t len) {
+	if (len && fwrite(buf, 1, len, w->f) != len) {
+		return false;
+	}
+	w->offset += len;
+	return true;
+}
+
+static bool write_section(PrjBinWriter *w, Sdb *db, const char *name, ut32 parent) {
+	RzPVector *items = sdb_get_items(db, true);
+	if (!items) {
+		return false;
+	}
+	size_t n = rz_pvector_len(items);
+	ut64 strings = (ut64)n * PRJ_BIN_ENTRY_SIZE;
+	ut64 size = strings + strlen(name) + 1;
+	void **it;
+	rz_pvector_foreach (items, it) {
+		SdbKv *kv = *it;
+		size += (ut64)sdbkv_key_len(kv) + sdbkv_value_len(kv) + 2;
+	}
+	if (size > UT32_MAX) {
+		RZ_LOG_ERROR("project: namespace %s is too large for the binary format\n", name);
+		rz_pvector_free(items);
+		return false;
+	}
+	ut8 *buf = malloc(size);
+	if (!buf) {
+		rz_pvector_free(items);
+		return false;
+	}
+	PrjBinSection section = {
+		.offset = w->offset,
+		.size = size,
+		.n_entries = n,
+		.parent = parent,
+		.name_off = strings,
+		.name_len = strlen(name),
+	};
+	memcpy(buf + strings, name, section.name_len + 1);
+	ut32 str = strings + section.name_len + 1;
+	ut8 *entry = buf;
+	rz_pvector_foreach (items, it) {
+		SdbKv *kv = *it;
+		ut32 klen = sdbkv_key_len(kv);
+		ut32 vlen = sdbkv_value_len(kv);
+		rz_write_le32(entry, str);
+		rz_write_le32(entry + 4, klen);
+		memcpy(buf + str, sdbkv_key(kv), klen + 1);
+		str += klen + 1;
+		rz_write_le32(entry + 8, str);
+		rz_write_le32(entry + 12, vlen);
+		memcpy(buf + str, sdbkv_value(kv), vlen);
+		buf[str + vlen] = 0;
+		str += vlen + 1;
+		entry += PRJ_BIN_ENTRY_SIZE;
+	}
+	rz_pvector_free(items);
+	bool ret = write_all(w, buf, size) && rz_vector_push(&w->sections, &section);
+	free(buf);
+	return ret;
+}
+
+static bool write_tree(PrjBinWriter *w, Sdb *db, const char *name, ut32 parent) {
+	ut32 index = rz_vector_len(&w->sections);
+	if (!write_section(w, db, name, parent)) {
+		return false;
+	}
+	RzListIter *it;
+	SdbNs *ns;
+	rz_list_foreach (db->ns, it, ns) {
+		if (!write_tree(w, ns->sdb, ns->name, index)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Writes \p prj into \p file with the binary project format.
+ *
+ * Every namespace is written to the file as soon as it is visited, so only
+ * one namespace at a time is laid out in memory.
+ */
+RZ_API bool rz_project_bin_save(RZ_NONNULL RzProject *prj, RZ_NONNULL const char *file) {
+	rz_return_val_if_fail(prj && file, false);
+	PrjBinWriter w = { 0 };
+	w.f = rz_sys_fopen(file, "wb");
+	if (!w.f) {
+		return false;
+	}
+	rz_vector_init(&w.sections, sizeof(PrjBinSection), NULL, NULL);
+	bool ret = false;
+	ut8 header[PRJ_BIN_HEADER_SIZE] = { 0 };
+	// the header is written again at the end, once the section table is known
+	if (!write_all(&w, header, sizeof(header)) || !write_tree(&w, prj, "", PRJ_BIN_NO_PARENT)) {
+		goto beach;
+	}
+	ut64 table = w.offset;
+	PrjBinSection *section;
+	rz_vector_foreach (&w.sections, section) {
+		ut8 entry[PRJ_BIN_SECTION_SIZE];
+		rz_write_le64(entry, section->offset);
+		rz_write_le64(entry + 8, section->size);
+		rz_write_le32(entry + 16, section->n_entries);
+		rz_write_le32(entry + 20, section->parent);
+		rz_write_le32(entry + 24, section->name_off);
+		rz_write_le32(entry + 28, section->name_len);
+		if (!write_all(&w, entry, sizeof(entry))) {
+			goto beach;
+		}
+	}
+	memcpy(header, PRJ_BIN_MAGIC, PRJ_BIN_MAGIC_SIZE);
+	rz_write_le32(header + 8, PRJ_BIN_VERSION);
+	rz_write_le32(header + 12, rz_vector_len(&w.sections));
+	rz_write_le64(header + 16, table);
+	ret = !fseek(w.f, 0, SEEK_SET) && fwrite(header, 1, sizeof(header), w.f) == sizeof(header);
+beach:
+	rz_vector_fini(&w.sections);
+	if (fclose(w.f)) {
+		ret = false;
+	}
+	return ret;
+}
+
+/* reader */
+
+static bool section_valid(const RzProjectBin *pb, const PrjBinSection *section, ut32 index) {
+	ut64 len = pb->map->len;
+	if (section->offset > len || section->size > len - section->offset) {
+		return false;
+	}
+	if ((ut64)section->n_entries * PRJ_BIN_ENTRY_SIZE > section->size) {
+		return false;
+	}
+	if ((ut64)section->name_off + section->name_len >= section->size) {
+		return false;
+	}
+	if (index ? section->parent >= index : section->parent != PRJ_BIN_NO_PARENT) {
+		return false;
+	}
+	const ut8 *data = pb->map->buf + section->offset;
+	if (data[section->name_off + section->name_len]) {
+		return false;
+	}
+	const char *prev = NULL;
+	for (ut32 i = 0; i < section->n_entries; i++) {
+		const ut8 *entry = data + (ut64)i * PRJ_BIN_ENTRY_SIZE;
+		ut64 koff = rz_read_le32(entry), klen = rz_read_le32(entry + 4);
+		ut64 voff = rz_read_le32(entry + 8), vlen = rz_read_le32(entry + 12);
+		if (koff + klen >= section->size || voff + vlen >= section->size ||
+			data[koff + klen] || data[voff + vlen]) {
+			return false;
+		}
+		// rz_project_bin_get() relies on the keys being sorted and unique
+		const char *key = (const char *)data + koff;
+		if (strlen(key) != klen || strlen((const char *)data + voff) != vlen || (prev && strcmp(prev, key) >= 0)) {
+			return false;
+		}
+		prev = key;
+	}
+	return true;
+}
+
+/**
+ * \brief Maps a project file with the binary format in memory
+ *
+ * The whole file is validated once, the values can then be looked up in
+ * place with rz_project_bin_get() without loading the project.
+ */
+RZ_API RZ_OWN RzProjectBin *rz_project_bin_open(RZ_NONNULL const char *file) {
+	rz_return_val_if_fail(file, NULL);
+	RzProjectBin *pb = RZ_NEW0(RzProjectBin);
+	if (!pb) {
+		return NULL;
+	}
+	pb->map = rz_file_mmap(file, O_RDONLY, 0, 0);
+	if (!pb->map || !pb->map->buf || pb->map->len < PRJ_BIN_HEADER_SIZE) {
+		goto error;
+	}
+	const ut8 *buf = pb->map->buf;
+	if (memcmp(buf, PRJ_BIN_MAGIC, PRJ_BIN_MAGIC_SIZE) || rz_read_le32(buf + 8) != PRJ_BIN_VERSION) {
+		goto error;
+	}
+	pb->n_sections = rz_read_le32(buf + 12);
+	ut64 table = rz_read_le64(buf + 16);
+	if (!pb->n_sections || table > pb->map->len ||
+		(ut64)pb->n_sections * PRJ_BIN_SECTION_SIZE > pb->map->len - table) {
+		goto error;
+	}
+	pb->sections = RZ_NEWS(PrjBinSection, pb->n_sections);
+	if (!pb->sections) {
+		goto error;
+	}
+	for (ut32 i = 0; i < pb->n_sections; i++) {
+		const ut8 *entry = buf + table + (ut64)i * PRJ_BIN_SECTION_SIZE;
+		PrjBinSection *section = &pb->sections[i];
+		section->offset = rz_read_le64(entry);
+		section->size = rz_read_le64(entry + 8);
+		section->n_entries = rz_read_le32(entry + 16);
+		section->parent = rz_read_le32(entry + 20);
+		section->name_off = rz_read_le32(entry + 24);
+		section->name_len = rz_read_le32(entry + 28);
+		if (!section_valid(pb, section, i)) {
+			goto error;
+		}
+	}
+	return pb;
+error:
+	rz_project_bin_close(pb);
+	return NULL;
+}
+
+RZ_API void rz_project_bin_close(RZ_NULLABLE RzProjectBin *pb) {
+	if (!pb) {
+		return;
+	}
+	rz_file_mmap_free(pb->map);
+	free(pb->sections);
+	free(pb);
+}
+
+static inline const char *section_str(const RzProjectBin *pb, const PrjBinSection *section, ut32 off) {
+	return (const char *)pb->map->buf + section->offset + off;
+}
+
+static inline const ut8 *section_entry(const RzProjectBin *pb, const PrjBinSection *section, ut32 i) {
+	return pb->map->buf + section->offset + (ut64)i * PRJ_BIN_ENTRY_SIZE;
+}
+
+static const PrjBinSection *section_find(const RzProjectBin *pb, const char *path) {
+	ut32 cur = 0;
+	while (path && *path) {
+		const char *end = strchr(path, '/');
+		size_t len = end ? end - path : strlen(path);
+		ut32 child = 0;
+		for (child = cur + 1; child < pb->n_sections; child++) {
+			const PrjBinSection *section = &pb->sections[child];
+			if (section->parent == cur && section->name_len == len &&
+				!memcmp(section_str(pb, section, section->name_off), path, len)) {
+				break;
+			}
+		}
+		if (child >= pb->n_sections) {
+			return NULL;
+		}
+		cur = child;
+		path = end ? end + 1 : NULL;
+	}
+	return &pb->sections[cur];
+}
+
+/**
+ * \brief Looks up a value of a binary project in place
+ *
+ * \param pb   The mapped project
+ * \param ns   The '/' separated path of the namespace, like "core/analysis/functions", or "" for the root
+ * \param key  The key to look for
+ * \return The value, which lives as long as \p pb, or NULL if it does not exist
+ */
+RZ_API RZ_BORROW const char *rz_project_bin_get(RZ_NONNULL RzProjectBin *pb, RZ_NONNULL const char *ns, RZ_NONNULL const char *key) {
+	rz_return_val_if_fail(pb && ns && key, NULL);
+	const PrjBinSection *section = section_find(pb, ns);
+	if (!section) {
+		return NULL;
+	}
+	// the entries are sorted by key
+	ut32 l = 0, r = section->n_entries;
+	while (l < r) {
+		ut32 m = l + (r - l) / 2;
+		const ut8 *entry = section_entry(pb, section, m);
+		int cmp = strcmp(section_str(pb, section, rz_read_le32(entry)), key);
+		if (!cmp) {
+			return section_str(pb, section, rz_read_le32(entry + 8));
+		}
+		if (cmp < 0) {
+			l = m + 1;
+		} else {
+			r = m;
+		}
+	}
+	return NULL;
+}
+
+static bool load_section(const RzProjectBin *pb, const PrjBinSection *section, Sdb *db) {
+	for (ut32 j = 0; j < section->n_entries; j++) {
+		const ut8 *entry = section_entry(pb, section, j);
+		SdbKv kv = { { 0 } };
+		kv.base.key_len = rz_read_le32(entry + 4);
+		kv.base.value_len = rz_read_le32(entry + 12);
+		kv.base.key = rz_str_ndup(section_str(pb, section, rz_read_le32(entry)), kv.base.key_len);
+		kv.base.value = rz_str_ndup(section_str(pb, section, rz_read_le32(entry + 8)), kv.base.value_len);
+		// the keys are known to be unique, no need to look them up like sdb_set() does
+		if (!kv.base.key || !kv.base.value || !sdb_ht_insert_kvp(db->ht, &kv, false)) {
+			free(kv.base.key);
+			free(kv.base.value);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Loads a project file with the binary format into an RzProject
+ *
+ * The namespaces and their entries are inserted directly into the sdb
+ * tree of the project, which is all the loaders of the project need. The
+ * values are copied as they are, the loaders parse them afterwards.
+ */
+RZ_API RZ_OWN RzProject *rz_project_bin_load(RZ_NONNULL const char *file) {
+	rz_return_val_if_fail(file, NULL);
+	RzProjectBin *pb = rz_project_bin_open(file);
+	if (!pb) {
+		return NULL;
+	}
+	RzProject *prj = sdb_new0();
+	Sdb **dbs = RZ_NEWS0(Sdb *, pb->n_sections);
+	if (!prj || !dbs) {
+		goto error;
+	}
+	for (ut32 i = 0; i < pb->n_sections; i++) {
+		const PrjBinSection *section = &pb->sections[i];
+		dbs[i] = i ? sdb_ns(dbs[section->parent], section_str(pb, section, section->name_off), true) : prj;
+		if (!dbs[i] || !load_section(pb, section, dbs[i])) {
+			goto error;
+		}
+	}
+	free(dbs);
+	rz_project_bin_close(pb);
+	return prj;
+error:
+	free(dbs);
+	sdb_free(prj);
+	rz_project_bin_close(pb);
+	return NULL;
+}
@@ -711,3 +711,38 @@ RZ_API bool rz_project_migrate(RzProject *prj, unsigned long version, RzSerializ
 	}
 	return true;
 }
+
+/**
+ * \brief Migrates the project file \p src to the current version and writes it to \p dst
+ *
+ * This can also be used to convert a project between the text and the binary formats,
+ * \p src can be in either of them.
+ *
+ * \param src    The project file to migrate
+ * \param dst    Where to write the migrated project, it can be \p src itself
+ * \param format The format of \p dst
+ * \param res    Where to log the performed migrations
+ */
+RZ_API RzProjectErr rz_project_migrate_file(RZ_NONNULL const char *src, RZ_NONNULL const char *dst, RzProjectFormat format, RZ_NULLABLE RzSerializeResultInfo *res) {
+	rz_return_val_if_fail(src && dst, RZ_PROJECT_ERR_UNKNOWN);
+	RzProject *prj = rz_project_load_file_raw(src);
+	if (!prj) {
+		RZ_SERIALIZE_ERR(res, "failed to read database file");
+		return RZ_PROJECT_ERR_FILE;
+	}
+	unsigned long version;
+	RzProjectErr err = rz_project_version(prj, &version);
+	if (err != RZ_PROJECT_ERR_SUCCESS) {
+		goto beach;
+	}
+	if (!rz_project_migrate(prj, version, res)) {
+		err = RZ_PROJECT_ERR_MIGRATION_FAILED;
+		goto beach;
+	}
+	char projver[32];
+	sdb_set(prj, "version", rz_strf(projver, "%u", RZ_PROJECT_VERSION));
+	err = rz_project_write_file(prj, dst, format, rz_file_is_deflated(src));
+beach:
+	rz_project_free(prj);
+	return err;
+}
@@ -6,6 +6,7 @@
 #include <rz_util/rz_log.h>
 #include <rz_util/rz_regex.h>
 #include <rz_rop.h>
+#include "core_private.h"
 
 static bool is_cond_end_gadget(const RzAnalysisOp *aop) {
 	switch (aop->type) {
@@ -50,7 +51,7 @@ static bool is_ret_gadget(const RzCore *core, const RzCoreAsmHit *hit, const ut8
 	return status;
 }
 
-static bool is_end_gadget(const RzAnalysisOp *aop, const ut8 crop) {
+RZ_IPI bool rz_core_rop_is_end_gadget(const RzAnalysisOp *aop, const ut8 crop) {
 	if (aop->family == RZ_ANALYSIS_OP_FAMILY_SECURITY) {
 		return false;
 	}
@@ -1104,7 +1105,7 @@ static void init_grep_context(const RzRopSearchContext *context, char **grep_str
 	}
 }
 
-static bool process_instruction(const RzCore *core, RzAnalysisOp *aop, const int addr, const ut8 *buf, const int buf_len, ut32 *end_gadget_cnt) {
+static bool process_instruction(const RzCore *core, RzAnalysisOp *aop, const ut64 addr, const ut8 *buf, const int buf_len, ut32 *end_gadget_cnt) {
 	const int error = rz_analysis_op(core->analysis, aop, addr, buf, buf_len, RZ_ANALYSIS_OP_MASK_DISASM | RZ_ANALYSIS_OP_MASK_IL);
 	if (!aop) {
 		return false;
@@ -1112,13 +1113,13 @@ static bool process_instruction(const RzCore *core, RzAnalysisOp *aop, const int
 	if (error < 0 || (aop->type == RZ_ANALYSIS_OP_TYPE_NOP && aop->size == 0)) {
 		return false;
 	}
-	if (is_end_gadget(aop, 0)) {
+	if (rz_core_rop_is_end_gadget(aop, 0)) {
 		(*end_gadget_cnt)++;
 	}
 	return true;
 }
 
-static bool is_invalid_instruction(const char *opst, const int end_gadget_cnt) {
+RZ_IPI bool rz_core_rop_is_invalid_instruction(const char *opst, const int end_gadget_cnt) {
 	rz_return_val_if_fail(opst, false);
 	return !rz_str_ncasecmp(opst, "invalid", strlen("invalid")) ||
 		!rz_str_ncasecmp(opst, ".byte", strlen(".byte")) ||
@@ -1187,7 +1188,7 @@ static RzList /*<RzCoreAsmHit *>*/ *construct_rop_gadget(RzCore *core, ut8 *buf,
 			goto cleanup;
 		}
 
-		if (is_invalid_instruction(opst, end_gadget_cnt)) {
+		if (rz_core_rop_is_invalid_instruction(opst, end_gadget_cnt)) {
 			valid = false;
 			goto cleanup;
 		}
@@ -1364,7 +1365,7 @@ static RzList /*<RzRopEndListPair *>*/ *compute_end_gadget_list(const RzCore *co
 			continue;
 		}
 
-		if (is_end_gadget(&end_gadget, context->crop)) {
+		if (rz_core_rop_is_end_gadget(&end_gadget, context->crop)) {
 			RzRopEndListPair *epair = RZ_NEW0(RzRopEndListPair);
 			if (epair) {
 				epair->instr_offset = i + (end_gadget.delay ? context->increment : 0);
@@ -1432,38 +1433,46 @@ RZ_API RZ_NULLABLE RZ_OWN RzList /*<char *>*/ *rz_core_rop_handle_grep_args(RZ_N
 	return rx_list;
 }
 
-static bool process_disassembly(RzCore *core, ut8 *buf, const int idx, RzRopSearchContext *context,
-	RzList /*<char *>*/ *rx_list, RzRopEndListPair *end_gadget) {
-	RzAsmOp *asmop = rz_asm_op_new();
-	bool status = false;
-	const int ret = rz_asm_disassemble(core->rasm, asmop, buf + idx, context->to - context->from - idx);
-	if (!ret) {
-		goto fini;
-	}
-
-	rz_asm_set_pc(core->rasm, context->from + idx);
-	RzList *hitlist = construct_rop_gadget(core, buf, idx, context, rx_list, end_gadget);
-	if (!hitlist) {
-		goto fini;
-	}
-
+/**
+ * Reports the gadget in \p hitlist found at \p idx and consumes \p hitlist.
+ * Returns true when the maximum number of hits has been reached.
+ */
+static bool report_rop_gadget(RzCore *core, RzRopSearchContext *context, const int idx, RZ_OWN RzList /*<RzCoreAsmHit *>*/ *hitlist) {
 	if (core->search->align && (context->from + idx) % core->search->align != 0) {
 		rz_list_free(hitlist);
-		goto fini;
+		return false;
 	}
 
 	if (!rz_core_handle_rop_request_type(core, context, hitlist)) {
 		rz_list_free(hitlist);
-		goto fini;
+		return false;
 	}
 	rz_list_free(hitlist);
 
 	if (context->max_count > 0) {
 		context->max_count--;
 		if (context->max_count < 1) {
-			status = true;
+			return true;
 		}
 	}
+	return false;
+}
+
+static bool process_disassembly(RzCore *core, ut8 *buf, const int idx, RzRopSearchContext *context,
+	RzList /*<char *>*/ *rx_list, RzRopEndListPair *end_gadget) {
+	RzAsmOp *asmop = rz_asm_op_new();
+	bool status = false;
+	const int ret = rz_asm_disassemble(core->rasm, asmop, buf + idx, context->to - context->from - idx);
+	if (!ret) {
+		goto fini;
+	}
+
+	rz_asm_set_pc(core->rasm, context->from + idx);
+	RzList *hitlist = construct_rop_gadget(core, buf, idx, context, rx_list, end_gadget);
+	if (!hitlist) {
+		goto fini;
+	}
+	status = report_rop_gadget(core, context, idx, hitlist);
 
 fini:
 	rz_asm_op_free(asmop);
@@ -1491,6 +1500,88 @@ static bool update_end_gadget(int *i, const int ropdepth, RzRopEndListPair **end
 	return true;
 }
 
+/**
+ * Same as process_disassembly(), but the instructions of \p gadget come
+ * from \p index instead of being decoded again.
+ */
+static bool process_index_gadget(RzCore *core, const ut8 *buf, RzRopSearchContext *context, RzList /*<char *>*/ *rx_list,
+	const RzRopIndex *index, const RzRopIndexGadget *gadget) {
+	const char *start = NULL, *end = NULL;
+	int count = 0;
+	char *rx = NULL;
+	char *grep_str = NULL;
+	bool is_greparg = !(context->mask & (RZ_ROP_GADGET_PRINT_DETAIL | RZ_ROP_GADGET_ANALYZE)) && context->greparg;
+	if (is_greparg) {
+		init_grep_context(context, &grep_str, &start, &end, rx_list, &rx, &count);
+	}
+
+	RzList *hitlist = rz_core_asm_hit_list_new();
+	RzStrBuf *sb = rz_strbuf_new("");
+	bool valid = hitlist && sb;
+	ut32 offset = gadget->offset;
+	for (ut32 n = 0; valid && n < gadget->n_insns; n++) {
+		const RzRopIndexInsn *insn = rz_core_rop_index_insn_at(index, offset);
+		RzCoreAsmHit *hit = insn ? rz_core_asm_hit_new() : NULL;
+		if (!hit) {
+			valid = false;
+			break;
+		}
+		hit->addr = context->from + offset;
+		hit->len = insn->size;
+		rz_list_append(hitlist, hit);
+		char *asm_op_hex = rz_hex_bin2strdup(buf + offset, insn->size);
+		rz_strbuf_append(sb, asm_op_hex);
+		free(asm_op_hex);
+		offset += insn->size;
+
+		const char *opst = insn->mnemonic;
+		bool search_hit = false;
+		if (rx) {
+			int grep_find = rz_regex_contains(rx, opst, RZ_REGEX_ZERO_TERMINATED, RZ_REGEX_EXTENDED, RZ_REGEX_DEFAULT);
+			search_hit = end && context->greparg && grep_find;
+		} else if (is_greparg) {
+			search_hit = end && context->greparg && strstr(opst, grep_str);
+		}
+		if (search_hit) {
+			update_search_context(context, &start, &end, &grep_str, rx_list, &rx, &count);
+		}
+	}
+	free(grep_str);
+	if ((context->regexp && rx) || !valid || (is_greparg && end)) {
+		rz_list_free(hitlist);
+		rz_strbuf_free(sb);
+		return false;
+	}
+	const RzRopEndListPair end_gadget = { .delay_size = gadget->delay_size };
+	if (!handle_rop_list(sb, context, &end_gadget, hitlist)) {
+		rz_strbuf_free(sb);
+		return false;
+	}
+	rz_strbuf_free(sb);
+	rz_asm_set_pc(core->rasm, context->from + gadget->offset);
+	return report_rop_gadget(core, context, gadget->offset, hitlist);
+}
+
+static int handle_rop_index(RzCore *core, const ut8 *buf, RzRopSearchContext *context, RzList /*<char *>*/ *rx_list, RzRopIndex *index) {
+	// If we have no end gadgets, just skip all of this search nonsense.
+	if (!index->n_ends) {
+		return -1;
+	}
+	const RzRopIndexGadget *gadget;
+	rz_vector_foreach (&index->gadgets, gadget) {
+		if (!context->max_count || rz_cons_is_breaked()) {
+			break;
+		}
+		if (process_index_gadget(core, buf, context, rx_list, index, gadget)) {
+			break;
+		}
+	}
+	if (context->mask & RZ_ROP_GADGET_ANALYZE) {
+		rz_core_rop_index_sync(core, index);
+	}
+	return 0;
+}
+
 static int handle_rop_search_address(RzCore *core, RzRopSearchContext *context, RzList /*<char *>*/ *rx_list) {
 	const ut64 delta = context->to - context->from;
 	ut8 *buf = RZ_NEWS0(ut8, delta);
@@ -1502,6 +1593,14 @@ static int handle_rop_search_address(RzCore *core, RzRopSearchContext *context,
 		return -1;
 	}
 
+	RzRopIndex *index = rz_core_rop_index_get(core, context, buf);
+	if (index || rz_cons_is_breaked()) {
+		const int ret = index ? handle_rop_index(core, buf, context, rx_list, index) : -2;
+		rz_core_rop_index_free(index);
+		free(buf);
+		return ret;
+	}
+
 	context->end_list = compute_end_gadget_list(core, buf, context);
 	// If we have no end gadgets, just skip all of this search nonsense.
 	if (rz_list_empty(context->end_list)) {
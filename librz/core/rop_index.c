@@ -0,0 +1,897 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file rop_index.c
+ * Discovery and on-disk index of the ROP gadgets of a searched range.
+ *
+ * Which gadgets a range contains only depends on its bytes and on the
+ * decoding settings, so they are discovered once and then replayed by rop.c
+ * for every query (grep, output mode, analysis). The discovery splits the
+ * range in chunks which are decoded in parallel, and shares the decoded
+ * instructions between the overlapping windows walked back from the end
+ * gadgets. When `rop.cache` is enabled the index, together with the gadget
+ * semantics computed by `/Rg`, is stored in the cache directory, keyed by the
+ * sha256 of the range bytes and a hash of the settings.
+ *
+ * Layout of the index file, all the integers are little endian:
+ *
+ *   header:    "RZROPIDX", ut32 format version, ut64 size of the range,
+ *              ut32 number of end gadgets, ut32 number of instructions,
+ *              ut32 number of gadgets, ut32 number of gadget semantics
+ *   insns:     ut32 offset, ut32 size, ut32 mnemonic length, mnemonic
+ *   gadgets:   ut32 offset, ut32 number of instructions, ut32 delay size
+ *   semantics: ut64 address, ut64 stack change, ut64 pc value, ut32 size,
+ *              ut8 pc write, ut8 syscall, ut32 number of modified registers,
+ *              ut32 number of dependencies, followed by the registers
+ *   register:  ut32 name length, name, ut8 flags, ut64 initial value,
+ *              ut64 new value, ut64 bits
+ */
+
+#include <rz_core.h>
+#include <rz_th.h>
+#include "core_private.h"
+
+#define ROP_INDEX_MAGIC      "RZROPIDX"
+#define ROP_INDEX_MAGIC_SIZE 8
+#define ROP_INDEX_VERSION    1
+#define ROP_INDEX_CHUNK_SIZE 0x10000
+
+enum {
+	ROP_REG_MEM_READ = 1 << 0,
+	ROP_REG_PC_WRITE = 1 << 1,
+	ROP_REG_VAR_READ = 1 << 2,
+	ROP_REG_VAR_WRITE = 1 << 3,
+	ROP_REG_MEM_WRITE = 1 << 4,
+};
+
+typedef struct {
+	bool decoded;
+	bool valid; ///< Decoded and usable within a gadget
+	bool end; ///< Ends a gadget
+	bool emitted; ///< The mnemonic was moved into the instructions of the job
+	int size;
+	char *mnemonic;
+} RopDecoded;
+
+typedef struct {
+	RzThreadQueue *analyses; ///< Idle RzAnalysis clones, NULL when discovering serially
+	RzAnalysis *analysis; ///< Analysis used when discovering serially
+	const ut8 *buf;
+	ut64 from;
+	int delta;
+	int increment;
+	int ropdepth;
+	ut8 max_instr;
+	ut8 crop;
+	const RzRopEndListPair *ends;
+} RopDiscovery;
+
+typedef struct {
+	int lo; ///< First offset to decode, or first end gadget of the job
+	int hi; ///< End of the offsets to decode, or of the end gadgets of the job
+	RzVector /*<RzRopEndListPair>*/ ends;
+	RzVector /*<RzRopIndexGadget>*/ gadgets;
+	RzVector /*<RzRopIndexInsn>*/ insns;
+	RopDecoded *cache; ///< Decoded instructions of [cache_lo, cache_hi)
+	int cache_lo;
+	int cache_hi;
+	RopDecoded scratch; ///< Last instruction decoded outside of the cache
+} RopJob;
+
+static void rop_index_insn_fini(void *e, void *user) {
+	RzRopIndexInsn *insn = e;
+	free(insn->mnemonic);
+}
+
+static RopJob *rop_job_new(int lo, int hi) {
+	RopJob *job = RZ_NEW0(RopJob);
+	if (!job) {
+		return NULL;
+	}
+	job->lo = lo;
+	job->hi = hi;
+	rz_vector_init(&job->ends, sizeof(RzRopEndListPair), NULL, NULL);
+	rz_vector_init(&job->gadgets, sizeof(RzRopIndexGadget), NULL, NULL);
+	rz_vector_init(&job->insns, sizeof(RzRopIndexInsn), rop_index_insn_fini, NULL);
+	return job;
+}
+
+static void rop_job_free(RopJob *job) {
+	if (!job) {
+		return;
+	}
+	rz_vector_fini(&job->ends);
+	rz_vector_fini(&job->gadgets);
+	rz_vector_fini(&job->insns);
+	if (job->cache) {
+		for (int i = 0; i < job->cache_hi - job->cache_lo; i++) {
+			if (!job->cache[i].emitted) {
+				free(job->cache[i].mnemonic);
+			}
+		}
+		free(job->cache);
+	}
+	free(job->scratch.mnemonic);
+	free(job);
+}
+
+static RzAnalysis *discovery_analysis_acquire(RopDiscovery *d) {
+	return d->analyses ? rz_th_queue_wait_pop(d->analyses, false) : d->analysis;
+}
+
+static void discovery_analysis_release(RopDiscovery *d, RzAnalysis *analysis) {
+	if (d->analyses) {
+		rz_th_queue_push(d->analyses, analysis, false);
+	}
+}
+
+static void rop_job_find_ends(RopJob *job, RopDiscovery *d) {
+	RzAnalysis *analysis = discovery_analysis_acquire(d);
+	for (int i = job->lo; i < job->hi; i += d->increment) {
+		RzAnalysisOp op;
+		rz_analysis_op_init(&op);
+		if (rz_analysis_op(analysis, &op, d->from + i, d->buf + i, d->delta - i, RZ_ANALYSIS_OP_MASK_BASIC) > 0 &&
+			rz_core_rop_is_end_gadget(&op, d->crop)) {
+			RzRopEndListPair pair = {
+				.instr_offset = i + (op.delay ? d->increment : 0),
+				.delay_size = op.delay,
+			};
+			rz_vector_push(&job->ends, &pair);
+		}
+		rz_analysis_op_fini(&op);
+	}
+	discovery_analysis_release(d, analysis);
+}
+
+static void rop_insn_decode(RzAnalysis *analysis, const RopDiscovery *d, int idx, RopDecoded *insn) {
+	RzAnalysisOp op;
+	rz_analysis_op_init(&op);
+	const int ret = rz_analysis_op(analysis, &op, d->from + idx, d->buf + idx, d->delta - idx, RZ_ANALYSIS_OP_MASK_DISASM);
+	insn->decoded = true;
+	insn->valid = ret >= 0 && op.size >= 0 && !(op.type == RZ_ANALYSIS_OP_TYPE_NOP && op.size == 0);
+	insn->end = rz_core_rop_is_end_gadget(&op, 0);
+	insn->size = op.size;
+	insn->mnemonic = insn->valid ? rz_str_dup(op.mnemonic ? op.mnemonic : "") : NULL;
+	rz_analysis_op_fini(&op);
+}
+
+static const RopDecoded *rop_job_decode(RopJob *job, RzAnalysis *analysis, const RopDiscovery *d, int idx) {
+	if (idx >= job->cache_lo && idx < job->cache_hi) {
+		RopDecoded *insn = &job->cache[idx - job->cache_lo];
+		if (!insn->decoded) {
+			rop_insn_decode(analysis, d, idx, insn);
+		}
+		return insn;
+	}
+	// only chains which are going to be discarded step out of the cache
+	RZ_FREE(job->scratch.mnemonic);
+	rop_insn_decode(analysis, d, idx, &job->scratch);
+	return &job->scratch;
+}
+
+/**
+ * Walks the chain starting at \p idx like construct_rop_gadget() in rop.c
+ * and tells whether it ends exactly with the end gadget at \p end.
+ */
+static bool rop_job_chain(RopJob *job, RzAnalysis *analysis, const RopDiscovery *d, int idx, int end, ut32 *n_insns) {
+	ut32 end_gadget_cnt = 0;
+	ut32 n = 0;
+	for (ut8 nb_instr = 0; nb_instr < d->max_instr; nb_instr++) {
+		if (idx >= d->delta) {
+			return false;
+		}
+		const RopDecoded *insn = rop_job_decode(job, analysis, d, idx);
+		if (!insn->valid) {
+			return false;
+		}
+		if (insn->end) {
+			end_gadget_cnt++;
+		}
+		if (rz_core_rop_is_invalid_instruction(insn->mnemonic, end_gadget_cnt)) {
+			return false;
+		}
+		n++;
+		if (end <= idx) {
+			*n_insns = n;
+			return end == idx;
+		}
+		idx += insn->size;
+	}
+	return false;
+}
+
+static void rop_job_emit_insns(RopJob *job, int idx, ut32 n_insns) {
+	for (ut32 n = 0; n < n_insns; n++) {
+		RopDecoded *insn = &job->cache[idx - job->cache_lo];
+		if (!insn->emitted) {
+			RzRopIndexInsn entry = {
+				.offset = idx,
+				.size = insn->size,
+				.mnemonic = insn->mnemonic,
+			};
+			if (!rz_vector_push(&job->insns, &entry)) {
+				return;
+			}
+			insn->emitted = true;
+		}
+		idx += insn->size;
+	}
+}
+
+static void rop_job_find_gadgets(RopJob *job, RopDiscovery *d) {
+	const RzRopEndListPair *first = &d->ends[job->lo];
+	const RzRopEndListPair *last = &d->ends[job->hi - 1];
+	// the windows of the end gadgets of the job overlap, decode them once
+	job->cache_lo = job->lo ? RZ_MAX(first->instr_offset - d->ropdepth, 0) : 0;
+	job->cache_hi = RZ_MIN(last->instr_offset + 1, d->delta);
+	if (job->cache_hi <= job->cache_lo) {
+		return;
+	}
+	job->cache = RZ_NEWS0(RopDecoded, job->cache_hi - job->cache_lo);
+	if (!job->cache) {
+		return;
+	}
+	RzAnalysis *analysis = discovery_analysis_acquire(d);
+	for (int k = job->lo; k < job->hi; k++) {
+		const RzRopEndListPair *end = &d->ends[k];
+		int i = k ? RZ_MAX(end->instr_offset - d->ropdepth, 0) : 0;
+		for (; i <= end->instr_offset && i < d->delta; i += d->increment) {
+			ut32 n_insns = 0;
+			if (!rop_job_chain(job, analysis, d, i, end->instr_offset, &n_insns)) {
+				continue;
+			}
+			RzRopIndexGadget gadget = {
+				.offset = i,
+				.n_insns = n_insns,
+				.delay_size = end->delay_size,
+			};
+			if (!rz_vector_push(&job->gadgets, &gadget)) {
+				break;
+			}
+			rop_job_emit_insns(job, i, n_insns);
+		}
+	}
+	discovery_analysis_release(d, analysis);
+}
+
+static bool rop_jobs_run(RzPVector /*<RopJob *>*/ *jobs, RzThreadIterator fn, RopDiscovery *d, RzThreadNCores max_threads) {
+	if (d->analyses) {
+		return rz_th_iterate_pvector(jobs, fn, max_threads, d) && !rz_cons_is_breaked();
+	}
+	void **it;
+	rz_pvector_foreach (jobs, it) {
+		fn(*it, d);
+		if (rz_cons_is_breaked()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * The clones only know the plugin, cpu, bits and endianness, so the
+ * discovery runs in parallel only for decoders which do not look at
+ * anything else (like the io or the core bindings) and when the arch and
+ * bits do not change within the range through hints or sections.
+ */
+static bool rop_analysis_can_clone(RzCore *core, const RzRopSearchContext *context) {
+	static const char *const decoders[] = {
+		"x86", "arm", "mips", "riscv.cs", "sparc", "avr", "loongarch"
+	};
+	RzAnalysis *analysis = core->analysis;
+	if (!analysis->cur || analysis->arch_hints || analysis->bits_hints) {
+		return false;
+	}
+	bool known = false;
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(decoders) && !known; i++) {
+		known = RZ_STR_EQ(analysis->cur->name, decoders[i]);
+	}
+	if (!known) {
+		return false;
+	}
+	const ut64 bounds[] = { context->from, context->to - 1 };
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(bounds); i++) {
+		int bits = 0;
+		const char *arch = NULL;
+		rz_core_arch_bits_at(core, bounds[i], &bits, &arch);
+		if ((bits && bits != analysis->bits) ||
+			(arch && RZ_STR_NE(arch, analysis->cur->name) && RZ_STR_NE(arch, analysis->cur->arch))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static RzAnalysis *rop_analysis_clone(RzAnalysis *analysis) {
+	RzAnalysis *clone = rz_analysis_new();
+	if (!clone) {
+		return NULL;
+	}
+	if (!rz_analysis_use(clone, analysis->cur->name)) {
+		rz_analysis_free(clone);
+		return NULL;
+	}
+	rz_analysis_set_bits(clone, analysis->bits);
+	if (analysis->cpu) {
+		rz_analysis_set_cpu(clone, analysis->cpu);
+	}
+	rz_analysis_set_big_endian(clone, analysis->big_endian);
+	clone->gp = analysis->gp;
+	return clone;
+}
+
+static void rop_analyses_free(RzThreadQueue *analyses) {
+	if (!analyses) {
+		return;
+	}
+	RzAnalysis *analysis;
+	while ((analysis = rz_th_queue_pop(analyses, false))) {
+		rz_analysis_free(analysis);
+	}
+	rz_th_queue_free(analyses);
+}
+
+static RzThreadQueue *rop_analyses_new(RzAnalysis *analysis, RzThreadNCores n) {
+	RzThreadQueue *analyses = rz_th_queue_new(n, NULL);
+	if (!analyses) {
+		return NULL;
+	}
+	for (size_t i = 0; i < (size_t)n; i++) {
+		RzAnalysis *clone = rop_analysis_clone(analysis);
+		if (!clone || !rz_th_queue_push(analyses, clone, false)) {
+			rz_analysis_free(clone);
+			rop_analyses_free(analyses);
+			return NULL;
+		}
+	}
+	return analyses;
+}
+
+static RzRopIndex *rop_index_new(ut64 from, ut64 size) {
+	RzRopIndex *index = RZ_NEW0(RzRopIndex);
+	if (!index) {
+		return NULL;
+	}
+	index->from = from;
+	index->size = size;
+	rz_vector_init(&index->insns, sizeof(RzRopIndexInsn), rop_index_insn_fini, NULL);
+	rz_vector_init(&index->gadgets, sizeof(RzRopIndexGadget), NULL, NULL);
+	return index;
+}
+
+static int rop_index_insn_cmp(const void *a, const void *b, void *user) {
+	const RzRopIndexInsn *x = a, *y = b;
+	return x->offset < y->offset ? -1 : x->offset > y->offset;
+}
+
+/**
+ * Moves the gadgets and the instructions found by the jobs into \p index,
+ * keeping the gadgets in the order of the serial search.
+ */
+static bool rop_index_merge(RzRopIndex *index, RzPVector /*<RopJob *>*/ *jobs) {
+	RzVector insns;
+	rz_vector_init(&insns, sizeof(RzRopIndexInsn), rop_index_insn_fini, NULL);
+	bool ret = false;
+	void **it;
+	rz_pvector_foreach (jobs, it) {
+		RopJob *job = *it;
+		if (rz_vector_len(&job->gadgets) &&
+			!rz_vector_insert_range(&index->gadgets, rz_vector_len(&index->gadgets), job->gadgets.a, rz_vector_len(&job->gadgets))) {
+			goto beach;
+		}
+		if (rz_vector_len(&job->insns)) {
+			if (!rz_vector_insert_range(&insns, rz_vector_len(&insns), job->insns.a, rz_vector_len(&job->insns))) {
+				goto beach;
+			}
+			// the mnemonics are owned by insns now
+			job->insns.len = 0;
+		}
+	}
+	// windows of neighbouring jobs can overlap and emit the same instruction
+	rz_vector_sort(&insns, rop_index_insn_cmp, false, NULL);
+	if (rz_vector_len(&insns) && !rz_vector_reserve(&index->insns, rz_vector_len(&insns))) {
+		goto beach;
+	}
+	RzRopIndexInsn *insn;
+	rz_vector_foreach (&insns, insn) {
+		RzRopIndexInsn *prev = rz_vector_tail(&index->insns);
+		if (prev && prev->offset == insn->offset) {
+			free(insn->mnemonic);
+		} else {
+			rz_vector_push(&index->insns, insn);
+		}
+	}
+	insns.len = 0;
+	ret = true;
+beach:
+	rz_vector_fini(&insns);
+	return ret;
+}
+
+/**
+ * Finds the gadgets of the searched range, in parallel if possible.
+ * Without \p force NULL is returned when the discovery cannot run in
+ * parallel, so the caller can keep using the plain serial search.
+ */
+static RzRopIndex *rop_index_discover(RzCore *core, const RzRopSearchContext *context, const ut8 *buf, bool force) {
+	const ut64 size = context->to - context->from;
+	if (size > INT_MAX) {
+		return NULL;
+	}
+	const RzThreadNCores max_threads = rz_th_max_threads(rz_config_get_i(core->config, "search.max.threads"));
+	const bool parallel = max_threads > 1 && size >= 2 * ROP_INDEX_CHUNK_SIZE && rop_analysis_can_clone(core, context);
+	if (!parallel && !force) {
+		return NULL;
+	}
+	RopDiscovery d = {
+		.analysis = core->analysis,
+		.buf = buf,
+		.from = context->from,
+		.delta = (int)size,
+		.increment = context->increment,
+		// same depth as the serial search, see handle_rop_search_address()
+		.ropdepth = context->increment == 1 ? context->max_instr * 15 : context->max_instr * context->increment,
+		.max_instr = context->max_instr,
+		.crop = context->crop,
+	};
+	if (parallel) {
+		d.analyses = rop_analyses_new(core->analysis, max_threads);
+		if (!d.analyses && !force) {
+			return NULL;
+		}
+	}
+
+	RzRopIndex *index = NULL;
+	RzVector ends;
+	rz_vector_init(&ends, sizeof(RzRopEndListPair), NULL, NULL);
+	RzPVector *jobs = rz_pvector_new((RzPVectorFree)rop_job_free);
+	if (!jobs) {
+		goto beach;
+	}
+	for (int lo = 0; lo < d.delta; lo += ROP_INDEX_CHUNK_SIZE) {
+		RopJob *job = rop_job_new(lo, RZ_MIN(lo + ROP_INDEX_CHUNK_SIZE, d.delta));
+		if (!job || !rz_pvector_push(jobs, job)) {
+			rop_job_free(job);
+			goto beach;
+		}
+	}
+	if (!rop_jobs_run(jobs, (RzThreadIterator)rop_job_find_ends, &d, max_threads)) {
+		goto beach;
+	}
+	void **it;
+	rz_pvector_foreach (jobs, it) {
+		RopJob *job = *it;
+		if (rz_vector_len(&job->ends) &&
+			!rz_vector_insert_range(&ends, rz_vector_len(&ends), job->ends.a, rz_vector_len(&job->ends))) {
+			goto beach;
+		}
+	}
+	rz_pvector_clear(jobs);
+
+	index = rop_index_new(context->from, size);
+	if (!index) {
+		goto beach;
+	}
+	const int n_ends = rz_vector_len(&ends);
+	index->n_ends = n_ends;
+	if (!n_ends) {
+		goto beach;
+	}
+	d.ends = rz_vector_head(&ends);
+	int first = 0;
+	for (int k = 1; k <= n_ends; k++) {
+		if (k < n_ends && d.ends[k].instr_offset - d.ends[first].instr_offset < ROP_INDEX_CHUNK_SIZE) {
+			continue;
+		}
+		RopJob *job = rop_job_new(first, k);
+		if (!job || !rz_pvector_push(jobs, job)) {
+			rop_job_free(job);
+			RZ_FREE_CUSTOM(index, rz_core_rop_index_free);
+			goto beach;
+		}
+		first = k;
+	}
+	if (!rop_jobs_run(jobs, (RzThreadIterator)rop_job_find_gadgets, &d, max_threads) ||
+		!rop_index_merge(index, jobs)) {
+		RZ_FREE_CUSTOM(index, rz_core_rop_index_free);
+	}
+
+beach:
+	rz_pvector_free(jobs);
+	rz_vector_fini(&ends);
+	rop_analyses_free(d.analyses);
+	return index;
+}
+
+/* on-disk index */
+
+static char *rop_index_path(RzCore *core, const RzRopSearchContext *context, const ut8 *buf, ut64 size) {
+	RzAnalysis *analysis = core->analysis;
+	char *digest = rz_hash_cfg_calculate_small_block_string(core->hash, "sha256", buf, size, NULL, false);
+	char *settings = rz_str_newf("%d:%s:%s:%d:%d:0x%" PFMT64x ":%d:%d:%d", ROP_INDEX_VERSION,
+		analysis->cur ? analysis->cur->name : "", rz_str_get(analysis->cpu), analysis->bits, analysis->big_endian,
+		context->from, context->max_instr, context->crop, context->increment);
+	char *cache = rz_path_home_cache();
+	char *path = NULL;
+	if (digest && settings && cache) {
+		path = rz_str_newf("%s" RZ_SYS_DIR "rop" RZ_SYS_DIR "%s-%08x.idx", cache, digest,
+			rz_hash_xxhash((const ut8 *)settings, strlen(settings)));
+	}
+	free(cache);
+	free(settings);
+	free(digest);
+	return path;
+}
+
+static bool read_string(RzBuffer *b, char **out) {
+	ut32 len;
+	if (!rz_buf_read_le32(b, &len) || len > rz_buf_size(b) - rz_buf_tell(b)) {
+		return false;
+	}
+	char *str = malloc((size_t)len + 1);
+	if (!str) {
+		return false;
+	}
+	if (rz_buf_read(b, (ut8 *)str, len) != len) {
+		free(str);
+		return false;
+	}
+	str[len] = '\0';
+	*out = str;
+	return true;
+}
+
+static RzRopRegInfo *rop_reg_info_read(RzBuffer *b) {
+	RzRopRegInfo *reg_info = RZ_NEW0(RzRopRegInfo);
+	if (!reg_info) {
+		return NULL;
+	}
+	ut8 flags;
+	if (!read_string(b, &reg_info->name) || !rz_buf_read8(b, &flags) ||
+		!rz_buf_read_le64(b, &reg_info->init_val) || !rz_buf_read_le64(b, &reg_info->new_val) ||
+		!rz_buf_read_le64(b, &reg_info->bits)) {
+		rz_core_rop_reg_info_free(reg_info);
+		return NULL;
+	}
+	reg_info->is_mem_read = flags & ROP_REG_MEM_READ;
+	reg_info->is_pc_write = flags & ROP_REG_PC_WRITE;
+	reg_info->is_var_read = flags & ROP_REG_VAR_READ;
+	reg_info->is_var_write = flags & ROP_REG_VAR_WRITE;
+	reg_info->is_mem_write = flags & ROP_REG_MEM_WRITE;
+	return reg_info;
+}
+
+static RzRopGadgetInfo *rop_gadget_info_read(RzBuffer *b) {
+	ut64 address, stack_change, curr_pc_val;
+	ut32 size, n_modified, n_dependencies;
+	ut8 is_pc_write, is_syscall;
+	if (!rz_buf_read_le64(b, &address) || !rz_buf_read_le64(b, &stack_change) ||
+		!rz_buf_read_le64(b, &curr_pc_val) || !rz_buf_read_le32(b, &size) ||
+		!rz_buf_read8(b, &is_pc_write) || !rz_buf_read8(b, &is_syscall) ||
+		!rz_buf_read_le32(b, &n_modified) || !rz_buf_read_le32(b, &n_dependencies)) {
+		return NULL;
+	}
+	RzRopGadgetInfo *gadget_info = rz_core_rop_gadget_info_new(address);
+	if (!gadget_info) {
+		return NULL;
+	}
+	gadget_info->stack_change = stack_change;
+	gadget_info->curr_pc_val = curr_pc_val;
+	gadget_info->size = size;
+	gadget_info->is_pc_write = is_pc_write;
+	gadget_info->is_syscall = is_syscall;
+	for (ut32 i = 0; i < n_modified; i++) {
+		RzRopRegInfo *reg_info = rop_reg_info_read(b);
+		if (!reg_info || !rz_pvector_push(gadget_info->modified_registers, reg_info)) {
+			rz_core_rop_reg_info_free(reg_info);
+			goto fail;
+		}
+	}
+	for (ut32 i = 0; i < n_dependencies; i++) {
+		RzRopRegInfo *reg_info = rop_reg_info_read(b);
+		if (!reg_info || !rz_list_append(gadget_info->dependencies, reg_info)) {
+			rz_core_rop_reg_info_free(reg_info);
+			goto fail;
+		}
+	}
+	return gadget_info;
+fail:
+	rz_core_rop_gadget_info_free(gadget_info);
+	return NULL;
+}
+
+static bool rop_index_read(RzCore *core, RzRopIndex *index, RzBuffer *b) {
+	ut8 magic[ROP_INDEX_MAGIC_SIZE];
+	ut32 version, n_ends, n_insns, n_gadgets, n_semantics;
+	ut64 size;
+	if (rz_buf_read(b, magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, ROP_INDEX_MAGIC, sizeof(magic)) ||
+		!rz_buf_read_le32(b, &version) || version != ROP_INDEX_VERSION ||
+		!rz_buf_read_le64(b, &size) || size != index->size ||
+		!rz_buf_read_le32(b, &n_ends) || !rz_buf_read_le32(b, &n_insns) ||
+		!rz_buf_read_le32(b, &n_gadgets) || !rz_buf_read_le32(b, &n_semantics)) {
+		return false;
+	}
+	// every record takes at least 12 bytes, do not trust the counts blindly
+	const ut64 left = rz_buf_size(b) - rz_buf_tell(b);
+	if ((ut64)n_insns * 12 > left || (ut64)n_gadgets * 12 > left ||
+		(n_insns && !rz_vector_reserve(&index->insns, n_insns)) ||
+		(n_gadgets && !rz_vector_reserve(&index->gadgets, n_gadgets))) {
+		return false;
+	}
+	index->n_ends = n_ends;
+	for (ut32 i = 0; i < n_insns; i++) {
+		RzRopIndexInsn insn = { 0 };
+		if (!rz_buf_read_le32(b, &insn.offset) || !rz_buf_read_le32(b, &insn.size) ||
+			(ut64)insn.offset + insn.size > size || !read_string(b, &insn.mnemonic)) {
+			return false;
+		}
+		const RzRopIndexInsn *prev = rz_vector_tail(&index->insns);
+		if ((prev && prev->offset >= insn.offset) || !rz_vector_push(&index->insns, &insn)) {
+			free(insn.mnemonic);
+			return false;
+		}
+	}
+	for (ut32 i = 0; i < n_gadgets; i++) {
+		RzRopIndexGadget gadget;
+		if (!rz_buf_read_le32(b, &gadget.offset) || !rz_buf_read_le32(b, &gadget.n_insns) ||
+			!rz_buf_read_le32(b, &gadget.delay_size) || gadget.offset >= size) {
+			return false;
+		}
+		rz_vector_push(&index->gadgets, &gadget);
+	}
+	// the semantics reach the session only once the whole index is valid
+	RzPVector *semantics = rz_pvector_new((RzPVectorFree)rz_core_rop_gadget_info_free);
+	if (!semantics) {
+		return false;
+	}
+	for (ut32 i = 0; i < n_semantics; i++) {
+		RzRopGadgetInfo *gadget_info = rop_gadget_info_read(b);
+		if (!gadget_info) {
+			rz_pvector_free(semantics);
+			return false;
+		}
+		if (!rz_pvector_push(semantics, gadget_info)) {
+			rz_core_rop_gadget_info_free(gadget_info);
+			rz_pvector_free(semantics);
+			return false;
+		}
+	}
+	if (n_semantics && !core->analysis->ht_rop_semantics) {
+		core->analysis->ht_rop_semantics = ht_up_new(NULL, (HtUPFreeValue)rz_core_rop_gadget_info_free);
+		if (!core->analysis->ht_rop_semantics) {
+			rz_pvector_free(semantics);
+			return false;
+		}
+	}
+	void **it;
+	rz_pvector_foreach (semantics, it) {
+		RzRopGadgetInfo *gadget_info = *it;
+		// semantics computed in this session win over the stored ones
+		if (!ht_up_insert(core->analysis->ht_rop_semantics, gadget_info->address, gadget_info)) {
+			rz_core_rop_gadget_info_free(gadget_info);
+		}
+	}
+	// the hashtable owns the semantics now
+	semantics->v.free = NULL;
+	rz_pvector_free(semantics);
+	index->n_semantics = n_semantics;
+	return true;
+}
+
+static RzRopIndex *rop_index_load(RzCore *core, const char *path, ut64 from, ut64 size) {
+	if (!rz_file_exists(path)) {
+		return NULL;
+	}
+	RzBuffer *b = rz_buf_new_slurp(path);
+	if (!b) {
+		return NULL;
+	}
+	RzRopIndex *index = rop_index_new(from, size);
+	if (index && !rop_index_read(core, index, b)) {
+		RZ_LOG_WARN("core: ignoring invalid rop index %s\n", path);
+		RZ_FREE_CUSTOM(index, rz_core_rop_index_free);
+	}
+	rz_buf_free(b);
+	return index;
+}
+
+static bool write_u8(FILE *f, ut8 v) {
+	return fwrite(&v, 1, 1, f) == 1;
+}
+
+static bool write_le32(FILE *f, ut32 v) {
+	ut8 tmp[4];
+	rz_write_le32(tmp, v);
+	return fwrite(tmp, 1, sizeof(tmp), f) == sizeof(tmp);
+}
+
+static bool write_le64(FILE *f, ut64 v) {
+	ut8 tmp[8];
+	rz_write_le64(tmp, v);
+	return fwrite(tmp, 1, sizeof(tmp), f) == sizeof(tmp);
+}
+
+static bool write_string(FILE *f, const char *str) {
+	const size_t len = strlen(str);
+	return write_le32(f, len) && fwrite(str, 1, len, f) == len;
+}
+
+static bool rop_reg_info_write(FILE *f, const RzRopRegInfo *reg_info) {
+	const ut8 flags = (reg_info->is_mem_read ? ROP_REG_MEM_READ : 0) |
+		(reg_info->is_pc_write ? ROP_REG_PC_WRITE : 0) |
+		(reg_info->is_var_read ? ROP_REG_VAR_READ : 0) |
+		(reg_info->is_var_write ? ROP_REG_VAR_WRITE : 0) |
+		(reg_info->is_mem_write ? ROP_REG_MEM_WRITE : 0);
+	return write_string(f, rz_str_get(reg_info->name)) && write_u8(f, flags) &&
+		write_le64(f, reg_info->init_val) && write_le64(f, reg_info->new_val) &&
+		write_le64(f, reg_info->bits);
+}
+
+static bool rop_gadget_info_write(FILE *f, const RzRopGadgetInfo *gadget_info) {
+	if (!write_le64(f, gadget_info->address) || !write_le64(f, gadget_info->stack_change) ||
+		!write_le64(f, gadget_info->curr_pc_val) || !write_le32(f, gadget_info->size) ||
+		!write_u8(f, gadget_info->is_pc_write) || !write_u8(f, gadget_info->is_syscall) ||
+		!write_le32(f, rz_pvector_len(gadget_info->modified_registers)) ||
+		!write_le32(f, rz_list_length(gadget_info->dependencies))) {
+		return false;
+	}
+	void **it;
+	rz_pvector_foreach (gadget_info->modified_registers, it) {
+		if (!rop_reg_info_write(f, *it)) {
+			return false;
+		}
+	}
+	RzListIter *iter;
+	RzRopRegInfo *reg_info;
+	rz_list_foreach (gadget_info->dependencies, iter, reg_info) {
+		if (!rop_reg_info_write(f, reg_info)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Collects the semantics known for the gadgets of \p index into \p out.
+ */
+static void rop_index_semantics(RzCore *core, const RzRopIndex *index, RzPVector /*<RzRopGadgetInfo *>*/ *out) {
+	HtUP *semantics = core->analysis->ht_rop_semantics;
+	if (!semantics) {
+		return;
+	}
+	const RzRopIndexGadget *gadget;
+	rz_vector_foreach (&index->gadgets, gadget) {
+		RzRopGadgetInfo *gadget_info = ht_up_find(semantics, index->from + gadget->offset, NULL);
+		if (gadget_info) {
+			rz_pvector_push(out, gadget_info);
+		}
+	}
+}
+
+static bool rop_index_write(FILE *f, const RzRopIndex *index, const RzPVector /*<RzRopGadgetInfo *>*/ *semantics) {
+	if (fwrite(ROP_INDEX_MAGIC, 1, ROP_INDEX_MAGIC_SIZE, f) != ROP_INDEX_MAGIC_SIZE ||
+		!write_le32(f, ROP_INDEX_VERSION) || !write_le64(f, index->size) ||
+		!write_le32(f, index->n_ends) || !write_le32(f, rz_vector_len(&index->insns)) ||
+		!write_le32(f, rz_vector_len(&index->gadgets)) || !write_le32(f, rz_pvector_len(semantics))) {
+		return false;
+	}
+	const RzRopIndexInsn *insn;
+	rz_vector_foreach (&index->insns, insn) {
+		if (!write_le32(f, insn->offset) || !write_le32(f, insn->size) || !write_string(f, insn->mnemonic)) {
+			return false;
+		}
+	}
+	const RzRopIndexGadget *gadget;
+	rz_vector_foreach (&index->gadgets, gadget) {
+		if (!write_le32(f, gadget->offset) || !write_le32(f, gadget->n_insns) || !write_le32(f, gadget->delay_size)) {
+			return false;
+		}
+	}
+	void **it;
+	rz_pvector_foreach (semantics, it) {
+		if (!rop_gadget_info_write(f, *it)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool rop_index_save(RzCore *core, RzRopIndex *index) {
+	RzPVector semantics;
+	rz_pvector_init(&semantics, NULL);
+	rop_index_semantics(core, index, &semantics);
+
+	bool ret = false;
+	char *dir = rz_file_dirname(index->path);
+	FILE *f = dir && rz_sys_mkdirp(dir) ? rz_sys_fopen(index->path, "wb") : NULL;
+	if (f) {
+		ret = rop_index_write(f, index, &semantics);
+		fclose(f);
+		if (!ret) {
+			rz_file_rm(index->path);
+		}
+	}
+	if (!ret) {
+		RZ_LOG_WARN("core: cannot write the rop index %s\n", index->path);
+	}
+	index->n_semantics = rz_pvector_len(&semantics);
+	rz_pvector_fini(&semantics);
+	free(dir);
+	return ret;
+}
+
+/**
+ * \brief Returns the gadgets of the range [context->from, context->to)
+ * \param core RzCore
+ * \param context Search context, the range and the decoding settings are used
+ * \param buf Bytes of the range
+ *
+ * With `rop.cache` the index is loaded from the cache directory, or
+ * discovered and stored there. Otherwise it is discovered in parallel, and
+ * NULL is returned when that is not possible so the caller can fall back to
+ * the serial search.
+ */
+RZ_IPI RZ_OWN RzRopIndex *rz_core_rop_index_get(RZ_NONNULL RzCore *core, RZ_NONNULL const RzRopSearchContext *context, RZ_NONNULL const ut8 *buf) {
+	rz_return_val_if_fail(core && context && buf, NULL);
+	const ut64 size = context->to - context->from;
+	char *path = context->cache ? rop_index_path(core, context, buf, size) : NULL;
+	RzRopIndex *index = path ? rop_index_load(core, path, context->from, size) : NULL;
+	if (index) {
+		index->path = path;
+		return index;
+	}
+	index = rop_index_discover(core, context, buf, path != NULL);
+	if (!index || !path) {
+		free(path);
+		return index;
+	}
+	index->path = path;
+	rop_index_save(core, index);
+	return index;
+}
+
+/**
+ * \brief Returns the instruction of \p index starting at \p offset, if any
+ */
+RZ_IPI RZ_BORROW const RzRopIndexInsn *rz_core_rop_index_insn_at(RZ_NONNULL const RzRopIndex *index, ut32 offset) {
+	rz_return_val_if_fail(index, NULL);
+	const RzRopIndexInsn *insns = rz_vector_head(&index->insns);
+	size_t lo = 0, hi = rz_vector_len(&index->insns);
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		if (insns[mid].offset < offset) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo < rz_vector_len(&index->insns) && insns[lo].offset == offset ? &insns[lo] : NULL;
+}
+
+/**
+ * \brief Stores \p index again if semantics were computed for more of its gadgets
+ */
+RZ_IPI void rz_core_rop_index_sync(RZ_NONNULL RzCore *core, RZ_NONNULL RzRopIndex *index) {
+	rz_return_if_fail(core && index);
+	if (!index->path) {
+		return;
+	}
+	RzPVector semantics;
+	rz_pvector_init(&semantics, NULL);
+	rop_index_semantics(core, index, &semantics);
+	const bool changed = rz_pvector_len(&semantics) > index->n_semantics;
+	rz_pvector_fini(&semantics);
+	if (changed) {
+		rop_index_save(core, index);
+	}
+}
+
+RZ_IPI void rz_core_rop_index_free(RZ_NULLABLE RzRopIndex *index) {
+	if (!index) {
+		return;
+	}
+	rz_vector_fini(&index->insns);
+	rz_vector_fini(&index->gadgets);
+	free(index->path);
+	free(index);
+}
@@ -0,0 +1,416 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file coverage.c
+ * Basic block coverage collected with one-shot software breakpoints.
+ *
+ * A trap is placed at the beginning of every traced block before the
+ * inferior is resumed. The first time a block is executed its trap is hit:
+ * the block is marked in the hits bitmap, its original bytes are put back
+ * and the inferior is resumed right away, thus every block costs a single
+ * stop and the code runs at native speed afterwards.
+ *
+ * Traps are planted and removed in bulk: the memory around close blocks is
+ * read with one call and written back with one call per page, instead of
+ * one read and one write per block like rz_bp does.
+ */
+
+#include <rz_debug.h>
+
+#define COVERAGE_SPAN_MAX  0x10000
+#define COVERAGE_PAGE_MASK (~(ut64)0xfff)
+
+static inline bool bit_get(const ut8 *bits, size_t i) {
+	return bits[i >> 3] & (1 << (i & 7));
+}
+
+static inline void bit_set(ut8 *bits, size_t i) {
+	bits[i >> 3] |= 1 << (i & 7);
+}
+
+static inline void bit_unset(ut8 *bits, size_t i) {
+	bits[i >> 3] &= ~(1 << (i & 7));
+}
+
+static int block_cmp(const void *a, const void *b, void *user) {
+	const RzDebugCoverageBlock *x = a;
+	const RzDebugCoverageBlock *y = b;
+	return x->addr < y->addr ? -1 : (x->addr > y->addr);
+}
+
+static RzDebugCoverage *coverage_new(void) {
+	RzDebugCoverage *cov = RZ_NEW0(RzDebugCoverage);
+	if (!cov) {
+		return NULL;
+	}
+	rz_vector_init(&cov->blocks, sizeof(RzDebugCoverageBlock), NULL, NULL);
+	rz_vector_init(&cov->pending, sizeof(RzDebugCoverageBlock), NULL, NULL);
+	cov->pid = -1;
+	return cov;
+}
+
+RZ_API void rz_debug_coverage_free(RZ_NULLABLE RzDebugCoverage *cov) {
+	if (!cov) {
+		return;
+	}
+	rz_vector_fini(&cov->blocks);
+	rz_vector_fini(&cov->pending);
+	free(cov->hits);
+	free(cov->armed);
+	free(cov);
+}
+
+/**
+ * Merges the pending blocks into the sorted ones, keeping the state of the
+ * latter. When two traps would overlap only the first block is kept,
+ * preferring the blocks which were already there.
+ */
+static bool coverage_sort(RzDebugCoverage *cov) {
+	size_t n_new = rz_vector_len(&cov->pending);
+	if (!n_new) {
+		return true;
+	}
+	rz_vector_sort(&cov->pending, block_cmp, false, NULL);
+	size_t n_old = rz_vector_len(&cov->blocks);
+	size_t bitmap_size = (n_old + n_new + 7) / 8;
+	RzVector merged;
+	rz_vector_init(&merged, sizeof(RzDebugCoverageBlock), NULL, NULL);
+	ut8 *hits = calloc(1, bitmap_size);
+	ut8 *armed = calloc(1, bitmap_size);
+	if (!hits || !armed || !rz_vector_reserve(&merged, n_old + n_new)) {
+		rz_vector_fini(&merged);
+		free(hits);
+		free(armed);
+		return false;
+	}
+	size_t i = 0, j = 0;
+	bool last_old = false;
+	while (i < n_old || j < n_new) {
+		RzDebugCoverageBlock *b;
+		bool old = j >= n_new;
+		if (!old && i < n_old) {
+			RzDebugCoverageBlock *x = rz_vector_index_ptr(&cov->blocks, i);
+			RzDebugCoverageBlock *y = rz_vector_index_ptr(&cov->pending, j);
+			old = x->addr <= y->addr;
+		}
+		size_t src = old ? i++ : j++;
+		b = rz_vector_index_ptr(old ? &cov->blocks : &cov->pending, src);
+		size_t dst = rz_vector_len(&merged);
+		RzDebugCoverageBlock *last = dst ? rz_vector_tail(&merged) : NULL;
+		if (last && b->addr < last->addr + last->trap_size) {
+			if (!old || last_old) {
+				continue;
+			}
+			// an old block wins over a new one, which has no state yet
+			dst--;
+			rz_vector_pop(&merged, NULL);
+		}
+		rz_vector_push(&merged, b);
+		last_old = old;
+		if (old && bit_get(cov->hits, src)) {
+			bit_set(hits, dst);
+		}
+		if (old && bit_get(cov->armed, src)) {
+			bit_set(armed, dst);
+		}
+	}
+	rz_vector_fini(&cov->blocks);
+	rz_vector_clear(&cov->pending);
+	cov->blocks = merged;
+	free(cov->hits);
+	free(cov->armed);
+	cov->hits = hits;
+	cov->armed = armed;
+	return true;
+}
+
+/**
+ * Returns the index of the first block starting at or after \p addr.
+ */
+static size_t coverage_lower_bound(RzDebugCoverage *cov, ut64 addr) {
+	size_t lo = 0, hi = rz_vector_len(&cov->blocks);
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		RzDebugCoverageBlock *b = rz_vector_index_ptr(&cov->blocks, mid);
+		if (b->addr < addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static bool coverage_find(RzDebugCoverage *cov, ut64 addr, size_t *idx) {
+	size_t i = coverage_lower_bound(cov, addr);
+	if (i >= rz_vector_len(&cov->blocks)) {
+		return false;
+	}
+	RzDebugCoverageBlock *b = rz_vector_index_ptr(&cov->blocks, i);
+	if (b->addr != addr) {
+		return false;
+	}
+	*idx = i;
+	return true;
+}
+
+/**
+ * \brief Stops collecting coverage, removing all the traps from memory
+ */
+RZ_API void rz_debug_coverage_reset(RZ_NONNULL RzDebug *dbg) {
+	rz_return_if_fail(dbg);
+	if (!dbg->coverage) {
+		return;
+	}
+	if (!rz_debug_is_dead(dbg)) {
+		rz_debug_coverage_restore(dbg, false);
+	}
+	rz_debug_coverage_free(dbg->coverage);
+	dbg->coverage = NULL;
+}
+
+/**
+ * \brief Adds a basic block to trace
+ *
+ * The original bytes at \p addr are saved right away, thus this must be
+ * called while the inferior is stopped and the traps are not in memory.
+ *
+ * \param addr  The address of the block
+ * \param size  The size of the block, only used for reporting
+ * \return true if the block can be traced
+ */
+RZ_API bool rz_debug_coverage_add(RZ_NONNULL RzDebug *dbg, ut64 addr, ut32 size) {
+	rz_return_val_if_fail(dbg, false);
+	if (!dbg->iob.read_at) {
+		return false;
+	}
+	if (!dbg->coverage && !(dbg->coverage = coverage_new())) {
+		return false;
+	}
+	RzDebugCoverageBlock block = {
+		.addr = addr,
+		.size = size,
+	};
+	int trap_size = rz_bp_size_at(dbg->bp, addr);
+	if (trap_size <= 0 || trap_size > RZ_DEBUG_COVERAGE_TRAP_MAX) {
+		return false;
+	}
+	if (rz_bp_get_bytes(dbg->bp, addr, block.trap, trap_size) != trap_size) {
+		return false;
+	}
+	if (!dbg->iob.read_at(dbg->iob.io, addr, block.orig, trap_size)) {
+		return false;
+	}
+	block.trap_size = trap_size;
+	return rz_vector_push(&dbg->coverage->pending, &block);
+}
+
+static bool coverage_wants(RzDebugCoverage *cov, size_t i, bool set) {
+	return set ? !bit_get(cov->hits, i) : bit_get(cov->armed, i);
+}
+
+static bool coverage_write(RzDebug *dbg, ut64 addr, const ut8 *buf, ut64 len) {
+	return dbg->iob.write_at(dbg->iob.io, addr, buf, (int)len);
+}
+
+/**
+ * \brief Places or removes the traps of the blocks not executed yet
+ *
+ * Blocks close to each other are handled together with a single read of
+ * the memory around them and a single write per page. A block is skipped
+ * when the memory holds neither its original bytes nor its trap (e.g. it
+ * is not mapped in the current process or the code has changed).
+ *
+ * \param set  true to place the traps, false to remove them
+ */
+RZ_API bool rz_debug_coverage_restore(RZ_NONNULL RzDebug *dbg, bool set) {
+	rz_return_val_if_fail(dbg, false);
+	RzDebugCoverage *cov = dbg->coverage;
+	if (!cov || (set && cov->pid == dbg->pid)) {
+		return true;
+	}
+	if (!set && !cov->n_armed) {
+		cov->pid = -1;
+		return true;
+	}
+	if (!dbg->iob.read_at || !dbg->iob.write_at || !coverage_sort(cov)) {
+		return false;
+	}
+	ut8 *buf = malloc(COVERAGE_SPAN_MAX);
+	if (!buf) {
+		return false;
+	}
+	bool ret = true;
+	size_t n = rz_vector_len(&cov->blocks);
+	size_t i = 0;
+	while (i < n) {
+		if (!coverage_wants(cov, i, set)) {
+			i++;
+			continue;
+		}
+		RzDebugCoverageBlock *first = rz_vector_index_ptr(&cov->blocks, i);
+		ut64 span_beg = first->addr;
+		ut64 span_end = span_beg;
+		size_t end = i;
+		for (; end < n; end++) {
+			RzDebugCoverageBlock *b = rz_vector_index_ptr(&cov->blocks, end);
+			if (b->addr + b->trap_size - span_beg > COVERAGE_SPAN_MAX) {
+				break;
+			}
+			if (coverage_wants(cov, end, set)) {
+				span_end = b->addr + b->trap_size;
+			}
+		}
+		if (!dbg->iob.read_at(dbg->iob.io, span_beg, buf, (int)(span_end - span_beg))) {
+			i = end;
+			continue;
+		}
+		// patch the blocks and write back the modified bytes one page at a time
+		ut64 run_beg = UT64_MAX, run_end = 0;
+		for (; i < end; i++) {
+			if (!coverage_wants(cov, i, set)) {
+				continue;
+			}
+			RzDebugCoverageBlock *b = rz_vector_index_ptr(&cov->blocks, i);
+			ut8 *mem = buf + (b->addr - span_beg);
+			const ut8 *from = set ? b->orig : b->trap;
+			const ut8 *to = set ? b->trap : b->orig;
+			bool trapped = set;
+			if (!memcmp(mem, from, b->trap_size)) {
+				memcpy(mem, to, b->trap_size);
+				if (run_beg != UT64_MAX && (b->addr & COVERAGE_PAGE_MASK) > ((run_end - 1) & COVERAGE_PAGE_MASK)) {
+					ret &= coverage_write(dbg, run_beg, buf + (run_beg - span_beg), run_end - run_beg);
+					run_beg = UT64_MAX;
+				}
+				if (run_beg == UT64_MAX) {
+					run_beg = b->addr;
+				}
+				run_end = b->addr + b->trap_size;
+			} else if (memcmp(mem, to, b->trap_size)) {
+				// neither the original bytes nor the trap, leave it alone
+				trapped = false;
+			}
+			if (trapped && !bit_get(cov->armed, i)) {
+				bit_set(cov->armed, i);
+				cov->n_armed++;
+			} else if (!trapped && bit_get(cov->armed, i)) {
+				bit_unset(cov->armed, i);
+				cov->n_armed--;
+			}
+		}
+		if (run_beg != UT64_MAX) {
+			ret &= coverage_write(dbg, run_beg, buf + (run_beg - span_beg), run_end - run_beg);
+		}
+	}
+	free(buf);
+	cov->pid = set ? dbg->pid : -1;
+	return ret;
+}
+
+/**
+ * \brief Marks the block at \p addr as executed and removes its trap
+ *
+ * \return true if \p addr is the beginning of a block not executed before
+ */
+RZ_API bool rz_debug_coverage_hit(RZ_NONNULL RzDebug *dbg, ut64 addr) {
+	rz_return_val_if_fail(dbg, false);
+	RzDebugCoverage *cov = dbg->coverage;
+	size_t i;
+	if (!cov || !coverage_sort(cov) || !coverage_find(cov, addr, &i) || bit_get(cov->hits, i)) {
+		return false;
+	}
+	bit_set(cov->hits, i);
+	cov->n_hits++;
+	if (bit_get(cov->armed, i)) {
+		RzDebugCoverageBlock *b = rz_vector_index_ptr(&cov->blocks, i);
+		bit_unset(cov->armed, i);
+		cov->n_armed--;
+		coverage_write(dbg, b->addr, b->orig, b->trap_size);
+	}
+	return true;
+}
+
+/**
+ * \brief Finds the coverage trap which stopped the inferior at \p pc
+ *
+ * Like for regular breakpoints, the pc may point either to the trap or
+ * right after it depending on the architecture. When it is not known yet
+ * and both cases are possible, the latter one is preferred.
+ *
+ * \param pc    The program counter after the trap
+ * \param addr  Set to the address of the block whose trap was hit
+ */
+RZ_API bool rz_debug_coverage_trap_at(RZ_NONNULL RzDebug *dbg, ut64 pc, RZ_NONNULL ut64 *addr) {
+	rz_return_val_if_fail(dbg && addr, false);
+	RzDebugCoverage *cov = dbg->coverage;
+	if (!cov || !cov->n_armed || !coverage_sort(cov)) {
+		return false;
+	}
+	size_t i = coverage_lower_bound(cov, pc);
+	size_t n = rz_vector_len(&cov->blocks);
+	RzDebugCoverageBlock *at = NULL, *ending = NULL;
+	if (i < n && bit_get(cov->armed, i)) {
+		at = rz_vector_index_ptr(&cov->blocks, i);
+		at = at->addr == pc ? at : NULL;
+	}
+	if (i > 0 && bit_get(cov->armed, i - 1)) {
+		ending = rz_vector_index_ptr(&cov->blocks, i - 1);
+		ending = ending->addr + ending->trap_size == pc ? ending : NULL;
+	}
+	if (dbg->pc_at_bp_set) {
+		RzDebugCoverageBlock *b = dbg->pc_at_bp ? at : ending;
+		if (!b) {
+			return false;
+		}
+		*addr = b->addr;
+		return true;
+	}
+	if (!at && !ending) {
+		return false;
+	}
+	*addr = ending ? ending->addr : at->addr;
+	return true;
+}
+
+/**
+ * \brief Counts the traced blocks and the executed ones
+ */
+RZ_API bool rz_debug_coverage_stats(RZ_NONNULL RzDebug *dbg, RZ_NULLABLE ut64 *blocks, RZ_NULLABLE ut64 *covered) {
+	rz_return_val_if_fail(dbg, false);
+	RzDebugCoverage *cov = dbg->coverage;
+	if (cov && !coverage_sort(cov)) {
+		return false;
+	}
+	if (blocks) {
+		*blocks = cov ? rz_vector_len(&cov->blocks) : 0;
+	}
+	if (covered) {
+		*covered = cov ? cov->n_hits : 0;
+	}
+	return true;
+}
+
+/**
+ * \brief Returns the executed blocks, sorted by address
+ *
+ * The blocks are owned by the debugger and are valid until another block
+ * is added or the coverage is reset.
+ */
+RZ_API RZ_OWN RzPVector /*<RzDebugCoverageBlock *>*/ *rz_debug_coverage_covered(RZ_NONNULL RzDebug *dbg) {
+	rz_return_val_if_fail(dbg, NULL);
+	RzDebugCoverage *cov = dbg->coverage;
+	RzPVector *ret = rz_pvector_new(NULL);
+	if (!ret || !cov) {
+		return ret;
+	}
+	if (!coverage_sort(cov) || !rz_pvector_reserve(ret, cov->n_hits)) {
+		rz_pvector_free(ret);
+		return NULL;
+	}
+	for (size_t i = 0; i < rz_vector_len(&cov->blocks); i++) {
+		if (bit_get(cov->hits, i)) {
+			rz_pvector_push(ret, rz_vector_index_ptr(&cov->blocks, i));
+		}
+	}
+	return ret;
+}
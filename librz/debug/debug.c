@@ -195,6 +195,27 @@ static int rz_debug_bp_hit(RzDebug *dbg, RzRegItem *pc_ri, ut64 pc, RzBreakpoint
 	return true;
 }
 
+/*
+ * Handles a stop caused by a coverage trap: the block is marked as executed,
+ * its original bytes are restored and the pc is moved back to the block, so
+ * that the inferior can be resumed right away.
+ */
+static bool rz_debug_coverage_trap_hit(RzDebug *dbg, RzRegItem *pc_ri, ut64 pc) {
+	ut64 addr;
+	if (!rz_debug_coverage_trap_at(dbg, pc, &addr) || !rz_debug_coverage_hit(dbg, addr)) {
+		return false;
+	}
+	if (addr != pc) {
+		if (!rz_reg_set_value(dbg->reg, pc_ri, addr) || !rz_debug_reg_sync(dbg, RZ_REG_TYPE_GPR, true)) {
+			eprintf("failed to set PC!\n");
+			return false;
+		}
+	}
+	/* the trap is gone, there is nothing to step over */
+	dbg->reason.bp_addr = 0;
+	return true;
+}
+
 /* enable all software breakpoints */
 static int rz_debug_bps_enable(RzDebug *dbg) {
 	/* restore all sw breakpoints. we are about to step/continue so these need
@@ -438,6 +459,7 @@ RZ_API RzDebug *rz_debug_free(RzDebug *dbg) {
 		rz_list_free(dbg->call_frames);
 		free(dbg->btalgo);
 		rz_debug_trace_free(dbg->trace);
+		rz_debug_coverage_free(dbg->coverage);
 		rz_debug_session_free(dbg->session);
 		rz_analysis_op_free(dbg->cur_op);
 		dbg->trace = NULL;
@@ -667,6 +689,7 @@ RZ_API const char *rz_debug_reason_to_string(int type) {
 	case RZ_DEBUG_REASON_FPU: return "fpu";
 	case RZ_DEBUG_REASON_STEP: return "step";
 	case RZ_DEBUG_REASON_USERSUSP: return "suspended-by-user";
+	case RZ_DEBUG_REASON_COVERAGE: return "coverage";
 	}
 	return "unhandled";
 }
@@ -757,6 +780,13 @@ RZ_API RzDebugReasonType rz_debug_wait(RzDebug *dbg, RzBreakpointItem **bp) {
 				return RZ_DEBUG_REASON_ERROR;
 			}
 
+			/* breakpoints set by the user take precedence over coverage traps */
+			if (b) {
+				rz_debug_coverage_hit(dbg, b->addr);
+			} else if (reason == RZ_DEBUG_REASON_BREAKPOINT && rz_debug_coverage_trap_hit(dbg, pc_ri, pc)) {
+				reason = RZ_DEBUG_REASON_COVERAGE;
+			}
+
 			if (bp) {
 				*bp = b;
 			}
@@ -1125,8 +1155,9 @@ RZ_API bool rz_debug_goto_cnum(RzDebug *dbg, ut32 cnum) {
 		eprintf("Error: out of cnum range\n");
 		return false;
 	}
-	dbg->session->cnum = cnum;
+	// the memory is restored starting from the current state
 	rz_debug_session_restore_reg_mem(dbg, cnum);
+	dbg->session->cnum = cnum;
 
 	return true;
 }
@@ -1203,6 +1234,8 @@ repeat:
 		if (!rz_debug_recoil(dbg, RZ_DBG_RECOIL_CONTINUE)) {
 			return 0;
 		}
+		/* plant the coverage traps, they are removed before returning */
+		rz_debug_coverage_restore(dbg, true);
 		/* tell the inferior to go! */
 		ret = dbg->cur->cont(dbg, dbg->pid, dbg->tid, sig);
 		// XXX(jjd): why? //dbg->reason.signum = 0;
@@ -1211,6 +1244,10 @@ repeat:
 		return 0;
 	}
 
+	if (reason == RZ_DEBUG_REASON_COVERAGE) {
+		goto repeat;
+	}
+
 	if (dbg->corebind.core) {
 		RzCore *core = (RzCore *)dbg->corebind.core;
 		RzNum *num = core->num;
@@ -1334,6 +1371,7 @@ repeat:
 	if (reason != RZ_DEBUG_REASON_BREAKPOINT) {
 		rz_bp_restore(dbg->bp, false);
 	}
+	rz_debug_coverage_restore(dbg, false);
 
 	// Add a checkpoint at stops
 	if (dbg->session && !dbg->trace_continue) {
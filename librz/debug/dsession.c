@@ -7,23 +7,206 @@
 #define CMP_CNUM_REG(x, y)   ((x) >= ((RzDebugChangeReg *)y)->cnum ? 1 : -1)
 #define CMP_CNUM_MEM(x, y)   ((x) >= ((RzDebugChangeMem *)y)->cnum ? 1 : -1)
 #define CMP_CNUM_CHKPT(x, y) ((x) >= ((RzDebugCheckpoint *)y)->cnum ? 1 : -1)
+#define CMP_CNUM(x, y)       ((x) > *(ut32 *)(y) ? 1 : ((x) < *(ut32 *)(y) ? -1 : 0))
+#define CMP_PAGE_ADDR(x, y)  ((x) > ((RzDebugCheckpointPage *)(y))->addr ? 1 : ((x) < ((RzDebugCheckpointPage *)(y))->addr ? -1 : 0))
 
-RZ_API void rz_debug_session_free(RzDebugSession *session) {
-	if (session) {
-		rz_vector_free(session->checkpoints);
-		ht_up_free(session->registers);
-		ht_up_free(session->memory);
-		RZ_FREE(session);
+#define PAGE_ALIGN(x)        ((x) & ~(ut64)(RZ_DEBUG_SESSION_PAGE_SIZE - 1))
+#define PAGE_WBITS           (-15) // raw deflate, without header
+#define CHECKPOINT_READ_SIZE (64 * RZ_DEBUG_SESSION_PAGE_SIZE)
+
+/**
+ * Memory changes recorded on a page, used to find the pages which differ
+ * between two states of the session without walking every changed byte.
+ */
+typedef struct {
+	RzVector /*<ut64>*/ addrs; ///< addresses with at least one change
+	RzVector /*<ut32>*/ cnums; ///< cnums of the changes, sorted and unique
+} PageChanges;
+
+static void page_changes_free(PageChanges *pc) {
+	if (!pc) {
+		return;
+	}
+	rz_vector_fini(&pc->addrs);
+	rz_vector_fini(&pc->cnums);
+	free(pc);
+}
+
+static bool page_changes_add(HtUP *memory_pages, ut64 addr, ut32 cnum, bool new_addr) {
+	PageChanges *pc = ht_up_find(memory_pages, PAGE_ALIGN(addr), NULL);
+	if (!pc) {
+		pc = RZ_NEW0(PageChanges);
+		if (!pc) {
+			return false;
+		}
+		rz_vector_init(&pc->addrs, sizeof(ut64), NULL, NULL);
+		rz_vector_init(&pc->cnums, sizeof(ut32), NULL, NULL);
+		ht_up_insert(memory_pages, PAGE_ALIGN(addr), pc);
+	}
+	if (new_addr && !rz_vector_push(&pc->addrs, &addr)) {
+		return false;
+	}
+	size_t index;
+	rz_vector_lower_bound(&pc->cnums, cnum, index, CMP_CNUM);
+	if (index < pc->cnums.len && *(ut32 *)rz_vector_index_ptr(&pc->cnums, index) == cnum) {
+		return true;
+	}
+	return rz_vector_insert(&pc->cnums, index, &cnum);
+}
+
+/* Checks if the page has been changed in (from, to] */
+static bool page_changes_between(PageChanges *pc, ut32 from, ut32 to) {
+	if (from >= to) {
+		return false;
 	}
+	size_t index;
+	rz_vector_upper_bound(&pc->cnums, from, index, CMP_CNUM);
+	return index < pc->cnums.len && *(ut32 *)rz_vector_index_ptr(&pc->cnums, index) <= to;
+}
+
+static void page_free(RzDebugPage *page) {
+	if (page) {
+		free(page->data);
+		free(page);
+	}
+}
+
+static bool page_chain_free_cb(void *user, const ut64 key, const void *value) {
+	RzDebugPage *page = (RzDebugPage *)value;
+	while (page) {
+		RzDebugPage *next = page->next;
+		page_free(page);
+		page = next;
+	}
+	return true;
+}
+
+/* Copies the uncompressed content of the page into buf */
+static bool page_read(const RzDebugPage *page, ut8 *buf) {
+	if (!page->compressed) {
+		memcpy(buf, page->data, page->len);
+		return true;
+	}
+	int len = 0;
+	ut8 *data = rz_inflatew(page->data, page->size, NULL, &len, PAGE_WBITS);
+	if (!data || len != page->len) {
+		free(data);
+		return false;
+	}
+	memcpy(buf, data, len);
+	free(data);
+	return true;
+}
+
+static bool page_equals(const RzDebugPage *page, const ut8 *buf, ut32 len) {
+	if (page->len != len) {
+		return false;
+	}
+	if (!page->compressed) {
+		return !memcmp(page->data, buf, len);
+	}
+	ut8 tmp[RZ_DEBUG_SESSION_PAGE_SIZE];
+	return page_read(page, tmp) && !memcmp(tmp, buf, len);
+}
+
+static void page_link(RzDebugSession *session, RzDebugPage *page) {
+	page->next = ht_up_find(session->pages, page->hash, NULL);
+	ht_up_update(session->pages, page->hash, page);
+}
+
+/* Returns a reference to the page of the store with the given content, adding it if needed */
+static RzDebugPage *page_get(RzDebugSession *session, const ut8 *buf, ut32 len) {
+	ut32 hash = rz_hash_xxhash(buf, len);
+	RzDebugPage *page = ht_up_find(session->pages, hash, NULL);
+	for (; page; page = page->next) {
+		if (page_equals(page, buf, len)) {
+			page->refs++;
+			return page;
+		}
+	}
+
+	page = RZ_NEW0(RzDebugPage);
+	if (!page) {
+		return NULL;
+	}
+	page->hash = hash;
+	page->refs = 1;
+	page->len = len;
+	if (session->compress_pages) {
+		int size = 0;
+		ut8 *data = rz_deflatew(buf, len, NULL, &size, PAGE_WBITS);
+		if (data && size > 0 && size < len) {
+			page->data = data;
+			page->size = size;
+			page->compressed = true;
+		} else {
+			free(data);
+		}
+	}
+	if (!page->data) {
+		page->data = rz_mem_dup(buf, len);
+		page->size = len;
+		if (!page->data) {
+			free(page);
+			return NULL;
+		}
+	}
+	page_link(session, page);
+	return page;
+}
+
+static void page_unref(RzDebugSession *session, RzDebugPage *page) {
+	if (--page->refs) {
+		return;
+	}
+	RzDebugPage *head = ht_up_find(session->pages, page->hash, NULL);
+	if (head == page) {
+		if (page->next) {
+			ht_up_update(session->pages, page->hash, page->next);
+		} else {
+			ht_up_delete(session->pages, page->hash);
+		}
+	} else {
+		for (; head; head = head->next) {
+			if (head->next == page) {
+				head->next = page->next;
+				break;
+			}
+		}
+	}
+	page_free(page);
 }
 
 static void rz_debug_checkpoint_fini(void *element, void *user) {
 	RzDebugCheckpoint *checkpoint = element;
+	RzDebugSession *session = user;
 	size_t i;
 	for (i = 0; i < RZ_REG_TYPE_LAST; i++) {
 		rz_reg_arena_free(checkpoint->arena[i]);
 	}
 	rz_list_free(checkpoint->snaps);
+	if (checkpoint->pages) {
+		RzDebugCheckpointPage *cp;
+		rz_vector_foreach (checkpoint->pages, cp) {
+			page_unref(session, cp->page);
+		}
+		rz_vector_free(checkpoint->pages);
+	}
+}
+
+RZ_API void rz_debug_session_free(RzDebugSession *session) {
+	if (session) {
+		// checkpoints release their pages, so they go first
+		rz_vector_free(session->checkpoints);
+		ht_up_free(session->registers);
+		ht_up_free(session->memory);
+		ht_up_free(session->memory_pages);
+		if (session->pages) {
+			ht_up_foreach(session->pages, page_chain_free_cb, NULL);
+			ht_up_free(session->pages);
+		}
+		RZ_FREE(session);
+	}
 }
 
 RZ_API RzDebugSession *rz_debug_session_new(void) {
@@ -32,7 +215,7 @@ RZ_API RzDebugSession *rz_debug_session_new(void) {
 		return NULL;
 	}
 
-	session->checkpoints = rz_vector_new(sizeof(RzDebugCheckpoint), rz_debug_checkpoint_fini, NULL);
+	session->checkpoints = rz_vector_new(sizeof(RzDebugCheckpoint), rz_debug_checkpoint_fini, session);
 	if (!session->checkpoints) {
 		rz_debug_session_free(session);
 		return NULL;
@@ -47,10 +230,145 @@ RZ_API RzDebugSession *rz_debug_session_new(void) {
 		rz_debug_session_free(session);
 		return NULL;
 	}
+	session->memory_pages = ht_up_new(NULL, (HtUPFreeValue)page_changes_free);
+	if (!session->memory_pages) {
+		rz_debug_session_free(session);
+		return NULL;
+	}
+	session->pages = ht_up_new(NULL, NULL);
+	if (!session->pages) {
+		rz_debug_session_free(session);
+		return NULL;
+	}
 
 	return session;
 }
 
+/**
+ * \brief Saves memory content into a checkpoint
+ *
+ * The content is split in pages which are shared with the other checkpoints
+ * of the session having the same content; content already saved in the
+ * checkpoint at the same addresses is replaced.
+ *
+ * \param session The session owning the checkpoint
+ * \param checkpoint The checkpoint
+ * \param addr The address of the content
+ * \param buf The content
+ * \param size The size of the content
+ * \return true on success, false otherwise
+ */
+RZ_API bool rz_debug_checkpoint_add_memory(RZ_NONNULL RzDebugSession *session, RZ_NONNULL RzDebugCheckpoint *checkpoint, ut64 addr, RZ_NONNULL const ut8 *buf, ut64 size) {
+	rz_return_val_if_fail(session && checkpoint && buf, false);
+	if (!checkpoint->pages) {
+		checkpoint->pages = rz_vector_new(sizeof(RzDebugCheckpointPage), NULL, NULL);
+		if (!checkpoint->pages) {
+			return false;
+		}
+	}
+	while (size) {
+		ut64 len = RZ_MIN(size, PAGE_ALIGN(addr) + RZ_DEBUG_SESSION_PAGE_SIZE - addr);
+		RzDebugPage *page = page_get(session, buf, len);
+		if (!page) {
+			return false;
+		}
+		size_t index;
+		rz_vector_lower_bound(checkpoint->pages, addr, index, CMP_PAGE_ADDR);
+		RzDebugCheckpointPage *cp = index < checkpoint->pages->len ? rz_vector_index_ptr(checkpoint->pages, index) : NULL;
+		if (cp && cp->addr == addr) {
+			page_unref(session, cp->page);
+			cp->page = page;
+		} else {
+			RzDebugCheckpointPage entry = { addr, page };
+			if (!rz_vector_insert(checkpoint->pages, index, &entry)) {
+				page_unref(session, page);
+				return false;
+			}
+		}
+		if (addr + len < addr) {
+			break;
+		}
+		addr += len;
+		buf += len;
+		size -= len;
+	}
+	return true;
+}
+
+/**
+ * \brief Reads the memory content saved in a checkpoint
+ *
+ * \param checkpoint The checkpoint
+ * \param addr The address to read from
+ * \param buf The buffer to fill, bytes not saved in the checkpoint are set to 0
+ * \param size The number of bytes to read
+ * \return true if all the bytes have been saved in the checkpoint, false otherwise
+ */
+RZ_API bool rz_debug_checkpoint_read(RZ_NONNULL const RzDebugCheckpoint *checkpoint, ut64 addr, RZ_NONNULL ut8 *buf, ut64 size) {
+	rz_return_val_if_fail(checkpoint && buf, false);
+	ut8 tmp[RZ_DEBUG_SESSION_PAGE_SIZE];
+	bool complete = true;
+	memset(buf, 0, size);
+	if (!checkpoint->pages) {
+		return !size;
+	}
+	ut64 end = addr + size;
+	size_t index;
+	// first page starting at or before addr
+	rz_vector_upper_bound(checkpoint->pages, addr, index, CMP_PAGE_ADDR);
+	index = index ? index - 1 : 0;
+	ut64 cur = addr;
+	for (; index < checkpoint->pages->len && cur < end; index++) {
+		const RzDebugCheckpointPage *cp = rz_vector_index_ptr(checkpoint->pages, index);
+		ut64 page_end = cp->addr + cp->page->len;
+		if (page_end <= cur) {
+			continue;
+		}
+		if (cp->addr >= end) {
+			break;
+		}
+		if (cp->addr > cur) {
+			complete = false;
+		}
+		if (!page_read(cp->page, tmp)) {
+			return false;
+		}
+		ut64 from = RZ_MAX(cp->addr, addr);
+		ut64 to = RZ_MIN(page_end, end);
+		memcpy(buf + (from - addr), tmp + (from - cp->addr), to - from);
+		cur = to;
+	}
+	return complete && cur >= end;
+}
+
+static bool checkpoint_save_map(RzDebug *dbg, RzDebugCheckpoint *checkpoint, RzDebugMap *map, ut8 *buf) {
+	if (map->size < 1 || map->size > UT32_MAX) {
+		return false;
+	}
+	RzDebugSnap *snap = RZ_NEW0(RzDebugSnap);
+	if (!snap) {
+		return false;
+	}
+	snap->name = rz_str_dup(map->name);
+	snap->addr = map->addr;
+	snap->addr_end = map->addr_end;
+	snap->size = map->size;
+	snap->perm = map->perm;
+	snap->user = map->user;
+	snap->shared = map->shared;
+	rz_list_append(checkpoint->snaps, snap);
+
+	ut64 off, len;
+	for (off = 0; off < map->size; off += len) {
+		len = RZ_MIN(map->size - off, CHECKPOINT_READ_SIZE);
+		dbg->iob.read_at(dbg->iob.io, map->addr + off, buf, len);
+		if (!rz_debug_checkpoint_add_memory(dbg->session, checkpoint, map->addr + off, buf, len)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 RZ_API bool rz_debug_add_checkpoint(RzDebug *dbg) {
 	rz_return_val_if_fail(dbg->session, false);
 	size_t i;
@@ -65,22 +383,24 @@ RZ_API bool rz_debug_add_checkpoint(RzDebug *dbg) {
 		checkpoint.arena[i] = b;
 	}
 
-	// Save current memory maps
+	// Save current memory maps, pages equal to the ones of the previous
+	// checkpoints are shared with them
 	checkpoint.snaps = rz_list_newf((RzListFree)rz_debug_snap_free);
-	if (!checkpoint.snaps) {
+	ut8 *buf = malloc(CHECKPOINT_READ_SIZE);
+	if (!checkpoint.snaps || !buf) {
+		free(buf);
+		rz_debug_checkpoint_fini(&checkpoint, dbg->session);
 		return false;
 	}
 	RzListIter *iter;
 	RzDebugMap *map;
 	rz_debug_map_sync(dbg);
 	rz_list_foreach (dbg->maps, iter, map) {
-		if ((map->perm & RZ_PERM_RW) == RZ_PERM_RW) {
-			RzDebugSnap *snap = rz_debug_snap_map(dbg, map);
-			if (snap) {
-				rz_list_append(checkpoint.snaps, snap);
-			}
+		if ((map->perm & RZ_PERM_RW) == RZ_PERM_RW && !checkpoint_save_map(dbg, &checkpoint, map, buf)) {
+			RZ_LOG_ERROR("debug: cannot save map at 0x%08" PFMT64x " into the checkpoint\n", map->addr);
 		}
 	}
+	free(buf);
 
 	checkpoint.cnum = dbg->session->cnum;
 	rz_vector_push(dbg->session->checkpoints, &checkpoint);
@@ -128,54 +448,198 @@ RZ_API void _restore_registers(RzDebug *dbg, ut32 cnum) {
 	}
 }
 
-static void _set_initial_memory(RzDebug *dbg) {
-	RzListIter *iter;
-	RzDebugSnap *snap;
-	rz_list_foreach (dbg->session->cur_chkpt->snaps, iter, snap) {
-		dbg->iob.write_at(dbg->iob.io, snap->addr, snap->data, snap->size);
+static RzDebugCheckpoint *_get_checkpoint_before(RzDebugSession *session, ut32 cnum) {
+	RzDebugCheckpoint *checkpoint = NULL;
+	size_t index;
+	rz_vector_upper_bound(session->checkpoints, cnum, index, CMP_CNUM_CHKPT);
+	if (index > 0 && index <= session->checkpoints->len) {
+		checkpoint = rz_vector_index_ptr(session->checkpoints, index - 1);
 	}
+	return checkpoint;
 }
 
-static bool _restore_memory_cb(void *user, const ut64 key, const void *value) {
-	size_t index;
-	RzDebug *dbg = user;
-	RzVector *vmem = (RzVector *)value;
+/*
+ * Writes the content of the page at page_addr as it was at cnum.
+ * With `verify` only the bytes saved in the checkpoint are restored and
+ * they are written only when the memory differs from them.
+ */
+static void _restore_page(RzDebug *dbg, ut64 page_addr, ut32 cnum, bool verify) {
+	RzDebugSession *session = dbg->session;
+	RzDebugCheckpoint *chkpt = session->cur_chkpt;
+	ut8 buf[RZ_DEBUG_SESSION_PAGE_SIZE];
+	ut64 beg = 0, end = 0;
+
+	size_t index = 0;
+	if (chkpt->pages) {
+		rz_vector_lower_bound(chkpt->pages, page_addr, index, CMP_PAGE_ADDR);
+	}
+	if (chkpt->pages && index < chkpt->pages->len) {
+		RzDebugCheckpointPage *cp = rz_vector_index_ptr(chkpt->pages, index);
+		if (PAGE_ALIGN(cp->addr) == page_addr && page_read(cp->page, buf)) {
+			beg = cp->addr;
+			end = cp->addr + cp->page->len;
+		}
+	}
 
-	rz_vector_upper_bound(vmem, dbg->session->cnum, index, CMP_CNUM_MEM);
-	if (index > 0 && index <= vmem->len) {
-		RzDebugChangeMem *mem = rz_vector_index_ptr(vmem, index - 1);
-		if (mem->cnum > dbg->session->cur_chkpt->cnum) {
-			dbg->iob.write_at(dbg->iob.io, key, &mem->data, 1);
+	PageChanges *pc = ht_up_find(session->memory_pages, page_addr, NULL);
+	if (pc) {
+		ut64 *addr;
+		rz_vector_foreach (&pc->addrs, addr) {
+			RzVector *vmem = ht_up_find(session->memory, *addr, NULL);
+			if (!vmem) {
+				continue;
+			}
+			rz_vector_upper_bound(vmem, cnum, index, CMP_CNUM_MEM);
+			if (!index) {
+				continue;
+			}
+			RzDebugChangeMem *mem = rz_vector_index_ptr(vmem, index - 1);
+			if (mem->cnum <= chkpt->cnum) {
+				continue;
+			}
+			if (*addr >= beg && *addr < end) {
+				buf[*addr - beg] = mem->data;
+			} else if (!verify) {
+				dbg->iob.write_at(dbg->iob.io, *addr, &mem->data, 1);
+			}
 		}
 	}
+	if (end <= beg) {
+		return;
+	}
+	if (verify) {
+		ut8 cur[RZ_DEBUG_SESSION_PAGE_SIZE];
+		if (dbg->iob.read_at(dbg->iob.io, beg, cur, end - beg) && !memcmp(cur, buf, end - beg)) {
+			return;
+		}
+	}
+	dbg->iob.write_at(dbg->iob.io, beg, buf, end - beg);
+}
+
+typedef struct {
+	RzDebug *dbg;
+	HtUP *todo; ///< pages to write
+	ut32 from;
+	ut32 to;
+} RestoreCtx;
+
+static bool _restore_changed_cb(void *user, const ut64 key, const void *value) {
+	RestoreCtx *ctx = user;
+	if (page_changes_between((PageChanges *)value, ctx->from, ctx->to)) {
+		ht_up_insert(ctx->todo, key, NULL);
+	}
 	return true;
 }
 
-static void _restore_memory(RzDebug *dbg, ut32 cnum) {
-	_set_initial_memory(dbg);
-	ht_up_foreach(dbg->session->memory, _restore_memory_cb, dbg);
+static bool _restore_page_cb(void *user, const ut64 key, const void *value) {
+	RestoreCtx *ctx = user;
+	_restore_page(ctx->dbg, key, ctx->to, false);
+	return true;
 }
 
-static RzDebugCheckpoint *_get_checkpoint_before(RzDebugSession *session, ut32 cnum) {
-	RzDebugCheckpoint *checkpoint = NULL;
-	size_t index;
-	rz_vector_upper_bound(session->checkpoints, cnum, index, CMP_CNUM_CHKPT);
-	if (index > 0 && index <= session->checkpoints->len) {
-		checkpoint = rz_vector_index_ptr(session->checkpoints, index - 1);
+/* Adds to todo the pages whose content is not shared by the two checkpoints */
+static void _checkpoints_diff(HtUP *todo, RzDebugCheckpoint *a, RzDebugCheckpoint *b) {
+	size_t i = 0, j = 0;
+	size_t a_len = a->pages ? a->pages->len : 0;
+	size_t b_len = b->pages ? b->pages->len : 0;
+	while (j < b_len) {
+		RzDebugCheckpointPage *bp = rz_vector_index_ptr(b->pages, j);
+		RzDebugCheckpointPage *ap = i < a_len ? rz_vector_index_ptr(a->pages, i) : NULL;
+		if (ap && ap->addr < bp->addr) {
+			i++;
+			continue;
+		}
+		if (!ap || ap->addr > bp->addr || ap->page != bp->page) {
+			ht_up_insert(todo, PAGE_ALIGN(bp->addr), NULL);
+		}
+		if (ap && ap->addr == bp->addr) {
+			i++;
+		}
+		j++;
 	}
-	return checkpoint;
 }
 
-RZ_API void rz_debug_session_restore_reg_mem(RzDebug *dbg, ut32 cnum) {
+/*
+ * Brings the memory from the state at cnum `from` to the one at `to`.
+ *
+ * The pages with changes recorded between the two states and the ones
+ * differing between the checkpoints of the two states are written. The
+ * other pages of the checkpoint may still have been written behind the
+ * session (e.g. `wx` while stopped), so they are compared with the memory
+ * and written only when they differ. When `full` is set the current state
+ * is unknown, so every page saved in the checkpoint is written.
+ */
+static void _restore_memory(RzDebug *dbg, ut32 from, ut32 to, bool full) {
+	RzDebugSession *session = dbg->session;
+	RzDebugCheckpoint *to_chkpt = session->cur_chkpt;
+	RzDebugCheckpoint *from_chkpt = full ? NULL : _get_checkpoint_before(session, from);
+	RestoreCtx ctx = { 0 };
+	ctx.dbg = dbg;
+	ctx.todo = ht_up_new(NULL, NULL);
+	if (!ctx.todo) {
+		return;
+	}
+	if (!from_chkpt) {
+		RzDebugCheckpointPage *cp;
+		if (to_chkpt->pages) {
+			rz_vector_foreach (to_chkpt->pages, cp) {
+				ht_up_insert(ctx.todo, PAGE_ALIGN(cp->addr), NULL);
+			}
+		}
+		ctx.from = to_chkpt->cnum;
+		ctx.to = to;
+	} else if (from_chkpt == to_chkpt) {
+		ctx.from = RZ_MIN(from, to);
+		ctx.to = RZ_MAX(from, to);
+	} else {
+		_checkpoints_diff(ctx.todo, from_chkpt, to_chkpt);
+		ctx.from = RZ_MIN(from_chkpt->cnum, to_chkpt->cnum);
+		ctx.to = RZ_MAX(from, to);
+	}
+	ht_up_foreach(session->memory_pages, _restore_changed_cb, &ctx);
+
+	// the changes are applied up to the target
+	ctx.to = to;
+	ht_up_foreach(ctx.todo, _restore_page_cb, &ctx);
+	if (from_chkpt && to_chkpt->pages) {
+		RzDebugCheckpointPage *cp;
+		rz_vector_foreach (to_chkpt->pages, cp) {
+			bool found;
+			ht_up_find(ctx.todo, PAGE_ALIGN(cp->addr), &found);
+			if (!found) {
+				_restore_page(dbg, PAGE_ALIGN(cp->addr), to, true);
+			}
+		}
+	}
+	ht_up_free(ctx.todo);
+}
+
+static void session_restore(RzDebug *dbg, ut32 cnum, bool full) {
+	RzDebugSession *session = dbg->session;
+	RzDebugCheckpoint *chkpt = _get_checkpoint_before(session, cnum);
+	if (!chkpt) {
+		RZ_LOG_ERROR("debug: no checkpoint before cnum %u\n", cnum);
+		return;
+	}
 	// Set checkpoint for initial registers and memory
-	dbg->session->cur_chkpt = _get_checkpoint_before(dbg->session, cnum);
+	session->cur_chkpt = chkpt;
 
 	// Restore registers
 	_restore_registers(dbg, cnum);
 	rz_debug_reg_sync(dbg, RZ_REG_TYPE_ANY, true);
 
 	// Restore memory
-	_restore_memory(dbg, cnum);
+	_restore_memory(dbg, session->cnum, cnum, full);
+}
+
+/**
+ * \brief Restores registers and memory as they were at cnum
+ *
+ * The memory of the debuggee is expected to be at the state of
+ * session->cnum, so that only the pages which differ from it are written.
+ */
+RZ_API void rz_debug_session_restore_reg_mem(RzDebug *dbg, ut32 cnum) {
+	session_restore(dbg, cnum, false);
 }
 
 RZ_API void rz_debug_session_list_memory(RzDebug *dbg) {
@@ -227,6 +691,7 @@ RZ_API bool rz_debug_session_add_reg_change(RzDebugSession *session, int arena,
 }
 
 RZ_API bool rz_debug_session_add_mem_change(RzDebugSession *session, ut64 addr, ut8 data) {
+	bool new_addr = false;
 	RzVector *vmem = ht_up_find(session->memory, addr, NULL);
 	if (!vmem) {
 		vmem = rz_vector_new(sizeof(RzDebugChangeMem), NULL, NULL);
@@ -235,10 +700,11 @@ RZ_API bool rz_debug_session_add_mem_change(RzDebugSession *session, ut64 addr,
 			return false;
 		}
 		ht_up_insert(session->memory, addr, vmem);
+		new_addr = true;
 	}
 	RzDebugChangeMem mem = { session->cnum, data };
 	rz_vector_push(vmem, &mem);
-	return true;
+	return page_changes_add(session->memory_pages, addr, session->cnum, new_addr);
 }
 
 /* Save and Load Session */
@@ -344,7 +810,14 @@ static void serialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *che
 			pj_kn(j, "addr", snap->addr);
 			pj_kn(j, "addr_end", snap->addr_end);
 			pj_kn(j, "size", snap->size);
-			char *edata = sdb_encode((const void *)snap->data, snap->size);
+			ut8 *data = malloc(snap->size);
+			if (!data) {
+				pj_free(j);
+				return;
+			}
+			rz_debug_checkpoint_read(chkpt, snap->addr, data, snap->size);
+			char *edata = sdb_encode(data, snap->size);
+			free(data);
 			if (!edata) {
 				pj_free(j);
 				return;
@@ -405,57 +878,6 @@ RZ_API void rz_debug_session_serialize(RzDebugSession *session, Sdb *db) {
 	serialize_checkpoints(sdb_ns(db, "checkpoints", true), session->checkpoints);
 }
 
-static bool session_sdb_save(Sdb *db, const char *path) {
-	char *filename;
-	if (!rz_file_is_directory(path)) {
-		eprintf("Error: %s is not a directory\n", path);
-		return false;
-	}
-
-	filename = rz_str_newf("%s%ssession.sdb", path, RZ_SYS_DIR);
-	sdb_file(db, filename);
-	if (!sdb_sync(db)) {
-		eprintf("Failed to sync session to %s\n", filename);
-		free(filename);
-		sdb_close(db);
-		return false;
-	}
-	free(filename);
-	sdb_close(db);
-
-	RzListIter *it;
-	SdbNs *ns;
-	rz_list_foreach (db->ns, it, ns) {
-		char *filename = rz_str_newf("%s%s%s.sdb", path, RZ_SYS_DIR, ns->name);
-		sdb_file(ns->sdb, filename);
-		if (!sdb_sync(ns->sdb)) {
-			eprintf("Failed to sync %s to %s\n", ns->name, filename);
-			free(filename);
-			sdb_close(ns->sdb);
-			return false;
-		}
-		free(filename);
-		sdb_close(ns->sdb);
-	}
-
-	return true;
-}
-
-RZ_API bool rz_debug_session_save(RzDebugSession *session, const char *path) {
-	Sdb *db = sdb_new0();
-	if (!db) {
-		return false;
-	}
-	rz_debug_session_serialize(session, db);
-
-	if (!session_sdb_save(db, path)) {
-		sdb_free(db);
-		return false;
-	}
-	sdb_free(db);
-	return true;
-}
-
 #define CHECK_TYPE(v, t) \
 	if (!v || v->type != t) \
 	continue
@@ -472,7 +894,8 @@ static bool deserialize_memory_cb(void *user, const SdbKv *kv) {
 		return true;
 	}
 
-	HtUP *memory = user;
+	RzDebugSession *session = user;
+	HtUP *memory = session->memory;
 	// Insert a new vector into `memory` HtUP at `addr`
 	ut64 addr = sdb_atoi(sdbkv_key(kv));
 	RzVector *vmem = rz_vector_new(sizeof(RzDebugChangeMem), NULL, NULL);
@@ -499,6 +922,7 @@ static bool deserialize_memory_cb(void *user, const SdbKv *kv) {
 
 		RzDebugChangeMem mem = { cnum, data };
 		rz_vector_push(vmem, &mem);
+		page_changes_add(session->memory_pages, addr, cnum, vmem->len == 1);
 	}
 
 	free(json_str);
@@ -506,8 +930,8 @@ static bool deserialize_memory_cb(void *user, const SdbKv *kv) {
 	return true;
 }
 
-static void deserialize_memory(Sdb *db, HtUP *memory) {
-	sdb_foreach(db, deserialize_memory_cb, memory);
+static void deserialize_memory(Sdb *db, RzDebugSession *session) {
+	sdb_foreach(db, deserialize_memory_cb, session);
 }
 
 static bool deserialize_registers_cb(void *user, const SdbKv *kv) {
@@ -571,7 +995,7 @@ static bool deserialize_checkpoints_cb(void *user, const SdbKv *kv) {
 		return true;
 	}
 
-	RzVector *checkpoints = user;
+	RzDebugSession *session = user;
 	RzDebugCheckpoint checkpoint = { 0 };
 	checkpoint.cnum = (int)sdb_atoi(sdbkv_key(kv));
 
@@ -643,7 +1067,12 @@ static bool deserialize_checkpoints_cb(void *user, const SdbKv *kv) {
 		snap->addr = addrj->num.u_value;
 		snap->addr_end = addr_endj->num.u_value;
 		snap->size = sizej->num.u_value;
-		snap->data = sdb_decode(dataj->str_value, NULL);
+		int data_len = 0;
+		ut8 *data = sdb_decode(dataj->str_value, &data_len);
+		if (data) {
+			rz_debug_checkpoint_add_memory(session, &checkpoint, snap->addr, data, RZ_MIN(snap->size, data_len));
+			free(data);
+		}
 		snap->perm = permj->num.s_value;
 		snap->user = userj->num.s_value;
 		snap->shared = sharedj->num.u_value;
@@ -653,12 +1082,12 @@ static bool deserialize_checkpoints_cb(void *user, const SdbKv *kv) {
 end:
 	free(json_str);
 	rz_json_free(chkpt_json);
-	rz_vector_push(checkpoints, &checkpoint);
+	rz_vector_push(session->checkpoints, &checkpoint);
 	return true;
 }
 
-static void deserialize_checkpoints(Sdb *db, RzVector /*<RzDebugCheckpoint>*/ *checkpoints) {
-	sdb_foreach(db, deserialize_checkpoints_cb, checkpoints);
+static void deserialize_checkpoints(Sdb *db, RzDebugSession *session) {
+	sdb_foreach(db, deserialize_checkpoints_cb, session);
 }
 
 static bool session_sdb_load_ns(Sdb *db, const char *nspath, const char *filename) {
@@ -701,6 +1130,12 @@ error:
 	return NULL;
 }
 
+static int checkpoint_cmp(const void *a, const void *b, void *user) {
+	const RzDebugCheckpoint *x = a;
+	const RzDebugCheckpoint *y = b;
+	return x->cnum < y->cnum ? -1 : (x->cnum > y->cnum);
+}
+
 RZ_API void rz_debug_session_deserialize(RzDebugSession *session, Sdb *db) {
 	Sdb *subdb;
 
@@ -716,19 +1151,438 @@ RZ_API void rz_debug_session_deserialize(RzDebugSession *session, Sdb *db) {
 		func; \
 	} while (0)
 
-	DESERIALIZE("memory", deserialize_memory(subdb, session->memory));
+	DESERIALIZE("memory", deserialize_memory(subdb, session));
 	DESERIALIZE("registers", deserialize_registers(subdb, session->registers));
-	DESERIALIZE("checkpoints", deserialize_checkpoints(subdb, session->checkpoints));
+	DESERIALIZE("checkpoints", deserialize_checkpoints(subdb, session));
+	// sdb does not keep the order of the keys
+	rz_vector_sort(session->checkpoints, checkpoint_cmp, false, NULL);
+}
+
+/*
+ * Binary Format (little endian):
+ *
+ *   "RZDS" <version:ut32> <maxcnum:ut32>
+ *   <count:ut32> registers: <key:ut64> <count:ut32> [<cnum:ut32> <data:ut64>]
+ *   <count:ut32> memory: <addr:ut64> <count:ut32> [<cnum:ut32> <data:ut8>]
+ *   <count:ut32> pages: <hash:ut32> <len:ut32> <size:ut32> <compressed:ut8> <data>
+ *   <count:ut32> checkpoints:
+ *     <cnum:ut32>
+ *     <count:ut32> arenas: <size:ut32> <bytes> (UT32_MAX for a missing arena)
+ *     <count:ut32> snaps: <name_len:ut32> <name> <addr:ut64> <addr_end:ut64>
+ *                         <size:ut32> <perm:ut32> <user:ut32> <shared:ut8>
+ *     <count:ut32> pages: <addr:ut64> <index of the page:ut32>
+ *
+ * Pages shared by several checkpoints are written only once.
+ */
+#define SESSION_MAGIC   "RZDS"
+#define SESSION_VERSION 1
+#define SESSION_FILE    "session.rzds"
+
+typedef struct {
+	RzBuffer *b;
+	bool ok;
+} SessionWriter;
+
+static bool write_registers_cb(void *user, const ut64 key, const void *value) {
+	SessionWriter *w = user;
+	const RzVector *vreg = value;
+	RzDebugChangeReg *reg;
+	w->ok &= rz_buf_write_le64(w->b, key) && rz_buf_write_le32(w->b, vreg->len);
+	rz_vector_foreach (vreg, reg) {
+		w->ok &= rz_buf_write_le32(w->b, reg->cnum) && rz_buf_write_le64(w->b, reg->data);
+	}
+	return w->ok;
+}
+
+static bool write_memory_cb(void *user, const ut64 key, const void *value) {
+	SessionWriter *w = user;
+	const RzVector *vmem = value;
+	RzDebugChangeMem *mem;
+	w->ok &= rz_buf_write_le64(w->b, key) && rz_buf_write_le32(w->b, vmem->len);
+	rz_vector_foreach (vmem, mem) {
+		w->ok &= rz_buf_write_le32(w->b, mem->cnum) && rz_buf_write8(w->b, mem->data);
+	}
+	return w->ok;
+}
+
+static bool write_string(RzBuffer *b, const char *str) {
+	ut32 len = str ? strlen(str) : 0;
+	return rz_buf_write_le32(b, len) && rz_buf_write(b, (const ut8 *)str, len) == len;
+}
+
+static bool write_checkpoint(RzBuffer *b, RzDebugCheckpoint *chkpt, HtUP *index) {
+	size_t i;
+	bool ok = rz_buf_write_le32(b, chkpt->cnum) && rz_buf_write_le32(b, RZ_REG_TYPE_LAST);
+	for (i = 0; i < RZ_REG_TYPE_LAST; i++) {
+		RzRegArena *arena = chkpt->arena[i];
+		if (!arena || !arena->bytes) {
+			ok &= rz_buf_write_le32(b, UT32_MAX);
+			continue;
+		}
+		ok &= rz_buf_write_le32(b, arena->size) && rz_buf_write(b, arena->bytes, arena->size) == arena->size;
+	}
+
+	RzListIter *iter;
+	RzDebugSnap *snap;
+	ok &= rz_buf_write_le32(b, rz_list_length(chkpt->snaps));
+	rz_list_foreach (chkpt->snaps, iter, snap) {
+		ok &= write_string(b, snap->name) &&
+			rz_buf_write_le64(b, snap->addr) &&
+			rz_buf_write_le64(b, snap->addr_end) &&
+			rz_buf_write_le32(b, snap->size) &&
+			rz_buf_write_le32(b, snap->perm) &&
+			rz_buf_write_le32(b, snap->user) &&
+			rz_buf_write8(b, snap->shared);
+	}
+
+	RzDebugCheckpointPage *cp;
+	ok &= rz_buf_write_le32(b, chkpt->pages ? chkpt->pages->len : 0);
+	if (chkpt->pages) {
+		rz_vector_foreach (chkpt->pages, cp) {
+			ut64 idx = (ut64)(size_t)ht_up_find(index, (ut64)(size_t)cp->page, NULL);
+			ok &= rz_buf_write_le64(b, cp->addr) && rz_buf_write_le32(b, idx - 1);
+		}
+	}
+	return ok;
+}
+
+/**
+ * \brief Writes the session in a compact binary format
+ *
+ * \param session The session to write
+ * \param b The buffer to write into, at its current position
+ * \return true on success, false otherwise
+ */
+RZ_API bool rz_debug_session_write(RZ_NONNULL RzDebugSession *session, RZ_NONNULL RzBuffer *b) {
+	rz_return_val_if_fail(session && b, false);
+	SessionWriter w = { b, true };
+	w.ok = rz_buf_write(b, (const ut8 *)SESSION_MAGIC, 4) == 4 &&
+		rz_buf_write_le32(b, SESSION_VERSION) &&
+		rz_buf_write_le32(b, session->maxcnum);
+
+	w.ok &= rz_buf_write_le32(b, session->registers->count);
+	ht_up_foreach(session->registers, write_registers_cb, &w);
+	w.ok &= rz_buf_write_le32(b, session->memory->count);
+	ht_up_foreach(session->memory, write_memory_cb, &w);
+	if (!w.ok) {
+		return false;
+	}
+
+	// page -> index + 1
+	HtUP *index = ht_up_new(NULL, NULL);
+	RzPVector pages;
+	rz_pvector_init(&pages, NULL);
+	if (!index) {
+		return false;
+	}
+	RzDebugCheckpoint *chkpt;
+	RzDebugCheckpointPage *cp;
+	rz_vector_foreach (session->checkpoints, chkpt) {
+		if (!chkpt->pages) {
+			continue;
+		}
+		rz_vector_foreach (chkpt->pages, cp) {
+			if (ht_up_find(index, (ut64)(size_t)cp->page, NULL)) {
+				continue;
+			}
+			rz_pvector_push(&pages, cp->page);
+			ht_up_insert(index, (ut64)(size_t)cp->page, (void *)(size_t)rz_pvector_len(&pages));
+		}
+	}
+
+	void **it;
+	w.ok &= rz_buf_write_le32(b, rz_pvector_len(&pages));
+	rz_pvector_foreach (&pages, it) {
+		RzDebugPage *page = *it;
+		w.ok &= rz_buf_write_le32(b, page->hash) &&
+			rz_buf_write_le32(b, page->len) &&
+			rz_buf_write_le32(b, page->size) &&
+			rz_buf_write8(b, page->compressed) &&
+			rz_buf_write(b, page->data, page->size) == page->size;
+	}
+
+	w.ok &= rz_buf_write_le32(b, session->checkpoints->len);
+	rz_vector_foreach (session->checkpoints, chkpt) {
+		w.ok &= write_checkpoint(b, chkpt, index);
+	}
+
+	rz_pvector_fini(&pages);
+	ht_up_free(index);
+	return w.ok;
+}
+
+static char *read_string(RzBuffer *b) {
+	ut32 len;
+	if (!rz_buf_read_le32(b, &len) || len > rz_buf_size(b) - rz_buf_tell(b)) {
+		return NULL;
+	}
+	char *str = malloc(len + 1);
+	if (!str) {
+		return NULL;
+	}
+	if (rz_buf_read(b, (ut8 *)str, len) != len) {
+		free(str);
+		return NULL;
+	}
+	str[len] = '\0';
+	return str;
+}
+
+static bool read_changes(RzDebugSession *session, RzBuffer *b, bool memory) {
+	ut32 count, n, i, cnum;
+	ut64 key, reg_data;
+	ut8 mem_data;
+	if (!rz_buf_read_le32(b, &count)) {
+		return false;
+	}
+	while (count--) {
+		if (!rz_buf_read_le64(b, &key) || !rz_buf_read_le32(b, &n)) {
+			return false;
+		}
+		RzVector *vec = rz_vector_new(memory ? sizeof(RzDebugChangeMem) : sizeof(RzDebugChangeReg), NULL, NULL);
+		if (!vec || !ht_up_insert(memory ? session->memory : session->registers, key, vec)) {
+			rz_vector_free(vec);
+			return false;
+		}
+		for (i = 0; i < n; i++) {
+			if (!rz_buf_read_le32(b, &cnum)) {
+				return false;
+			}
+			if (memory) {
+				if (!rz_buf_read8(b, &mem_data)) {
+					return false;
+				}
+				RzDebugChangeMem mem = { cnum, mem_data };
+				if (!rz_vector_push(vec, &mem) || !page_changes_add(session->memory_pages, key, cnum, !i)) {
+					return false;
+				}
+			} else {
+				if (!rz_buf_read_le64(b, &reg_data)) {
+					return false;
+				}
+				RzDebugChangeReg reg = { cnum, reg_data };
+				if (!rz_vector_push(vec, &reg)) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static RzDebugPage *read_page(RzBuffer *b) {
+	ut32 hash, len, size;
+	ut8 compressed;
+	if (!rz_buf_read_le32(b, &hash) || !rz_buf_read_le32(b, &len) ||
+		!rz_buf_read_le32(b, &size) || !rz_buf_read8(b, &compressed)) {
+		return NULL;
+	}
+	if (!len || len > RZ_DEBUG_SESSION_PAGE_SIZE || !size || size > rz_buf_size(b) - rz_buf_tell(b) ||
+		(!compressed && size != len)) {
+		return NULL;
+	}
+	RzDebugPage *page = RZ_NEW0(RzDebugPage);
+	if (!page) {
+		return NULL;
+	}
+	page->hash = hash;
+	page->len = len;
+	page->size = size;
+	page->compressed = compressed;
+	page->data = malloc(size);
+	if (!page->data || rz_buf_read(b, page->data, size) != size) {
+		page_free(page);
+		return NULL;
+	}
+	return page;
 }
 
+static bool read_checkpoint(RzBuffer *b, RzDebugCheckpoint *chkpt, RzDebugPage **pages, ut32 n_pages) {
+	ut32 cnum, count, size, i;
+	if (!rz_buf_read_le32(b, &cnum) || !rz_buf_read_le32(b, &count) || count > RZ_REG_TYPE_LAST) {
+		return false;
+	}
+	chkpt->cnum = cnum;
+	for (i = 0; i < count; i++) {
+		if (!rz_buf_read_le32(b, &size)) {
+			return false;
+		}
+		if (size == UT32_MAX) {
+			continue;
+		}
+		if (size > rz_buf_size(b) - rz_buf_tell(b)) {
+			return false;
+		}
+		chkpt->arena[i] = rz_reg_arena_new(size);
+		if (!chkpt->arena[i] || rz_buf_read(b, chkpt->arena[i]->bytes, size) != size) {
+			return false;
+		}
+	}
+
+	chkpt->snaps = rz_list_newf((RzListFree)rz_debug_snap_free);
+	if (!chkpt->snaps || !rz_buf_read_le32(b, &count)) {
+		return false;
+	}
+	while (count--) {
+		RzDebugSnap *snap = RZ_NEW0(RzDebugSnap);
+		if (!snap || !rz_list_append(chkpt->snaps, snap)) {
+			free(snap);
+			return false;
+		}
+		ut32 perm, user;
+		ut8 shared;
+		snap->name = read_string(b);
+		if (!snap->name || !rz_buf_read_le64(b, &snap->addr) || !rz_buf_read_le64(b, &snap->addr_end) ||
+			!rz_buf_read_le32(b, &snap->size) || !rz_buf_read_le32(b, &perm) ||
+			!rz_buf_read_le32(b, &user) || !rz_buf_read8(b, &shared)) {
+			return false;
+		}
+		snap->perm = perm;
+		snap->user = user;
+		snap->shared = shared;
+	}
+
+	if (!rz_buf_read_le32(b, &count)) {
+		return false;
+	}
+	chkpt->pages = rz_vector_new(sizeof(RzDebugCheckpointPage), NULL, NULL);
+	if (!chkpt->pages || !rz_vector_reserve(chkpt->pages, count)) {
+		return false;
+	}
+	while (count--) {
+		RzDebugCheckpointPage cp;
+		ut32 idx;
+		if (!rz_buf_read_le64(b, &cp.addr) || !rz_buf_read_le32(b, &idx) || idx >= n_pages) {
+			return false;
+		}
+		RzDebugCheckpointPage *last = rz_vector_tail(chkpt->pages);
+		if (last && last->addr >= cp.addr) {
+			return false;
+		}
+		cp.page = pages[idx];
+		cp.page->refs++;
+		rz_vector_push(chkpt->pages, &cp);
+	}
+	return true;
+}
+
+/**
+ * \brief Reads a session written by rz_debug_session_write() into an empty session
+ *
+ * \param session The session to fill
+ * \param b The buffer to read from, at its current position
+ * \return true on success, false otherwise
+ */
+RZ_API bool rz_debug_session_read(RZ_NONNULL RzDebugSession *session, RZ_NONNULL RzBuffer *b) {
+	rz_return_val_if_fail(session && b, false);
+	ut8 magic[4];
+	ut32 version, maxcnum, n_pages, count, i;
+	if (rz_buf_read(b, magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, SESSION_MAGIC, sizeof(magic))) {
+		RZ_LOG_ERROR("debug: invalid session file\n");
+		return false;
+	}
+	if (!rz_buf_read_le32(b, &version) || version != SESSION_VERSION) {
+		RZ_LOG_ERROR("debug: unsupported session version\n");
+		return false;
+	}
+	if (!rz_buf_read_le32(b, &maxcnum) || !read_changes(session, b, false) || !read_changes(session, b, true) ||
+		!rz_buf_read_le32(b, &n_pages) || n_pages > rz_buf_size(b) - rz_buf_tell(b)) {
+		return false;
+	}
+	session->maxcnum = maxcnum;
+
+	bool ok = true;
+	RzDebugPage **pages = RZ_NEWS0(RzDebugPage *, n_pages);
+	if (!pages && n_pages) {
+		return false;
+	}
+	for (i = 0; i < n_pages && ok; i++) {
+		pages[i] = read_page(b);
+		ok = pages[i];
+	}
+	ok = ok && rz_buf_read_le32(b, &count);
+	while (ok && count--) {
+		RzDebugCheckpoint chkpt = { 0 };
+		ok = read_checkpoint(b, &chkpt, pages, n_pages);
+		RzDebugCheckpoint *last = rz_vector_tail(session->checkpoints);
+		if (ok && last && last->cnum >= chkpt.cnum) {
+			ok = false;
+		}
+		if (!ok || !rz_vector_push(session->checkpoints, &chkpt)) {
+			// pages are not in the store yet, do not let fini release them
+			if (chkpt.pages) {
+				RzDebugCheckpointPage *cp;
+				rz_vector_foreach (chkpt.pages, cp) {
+					cp->page->refs--;
+				}
+				rz_vector_clear(chkpt.pages);
+			}
+			rz_debug_checkpoint_fini(&chkpt, session);
+			ok = false;
+		}
+	}
+	// move the referenced pages into the store
+	for (i = 0; i < n_pages; i++) {
+		if (pages[i] && pages[i]->refs) {
+			page_link(session, pages[i]);
+		} else {
+			page_free(pages[i]);
+		}
+	}
+	free(pages);
+	return ok;
+}
+
+/**
+ * \brief Saves the session into the directory at path
+ */
+RZ_API bool rz_debug_session_save(RzDebugSession *session, const char *path) {
+	if (!rz_file_is_directory(path)) {
+		eprintf("Error: %s is not a directory\n", path);
+		return false;
+	}
+	RzBuffer *b = rz_buf_new_empty(0);
+	if (!b) {
+		return false;
+	}
+	char *filename = rz_str_newf("%s%s" SESSION_FILE, path, RZ_SYS_DIR);
+	bool ret = filename && rz_debug_session_write(session, b) && rz_buf_dump(b, filename);
+	if (!ret) {
+		eprintf("Failed to save session to %s\n", filename);
+	}
+	free(filename);
+	rz_buf_free(b);
+	return ret;
+}
+
+/**
+ * \brief Loads the session saved into the directory at path
+ *
+ * Sessions saved in the old sdb format are loaded too.
+ */
 RZ_API bool rz_debug_session_load(RzDebug *dbg, const char *path) {
-	Sdb *db = session_sdb_load(path);
-	if (!db) {
+	char *filename = rz_str_newf("%s%s" SESSION_FILE, path, RZ_SYS_DIR);
+	if (!filename) {
 		return false;
 	}
-	rz_debug_session_deserialize(dbg->session, db);
+	if (rz_file_exists(filename)) {
+		RzBuffer *b = rz_buf_new_slurp(filename);
+		bool ret = b && rz_debug_session_read(dbg->session, b);
+		rz_buf_free(b);
+		free(filename);
+		if (!ret) {
+			return false;
+		}
+	} else {
+		free(filename);
+		Sdb *db = session_sdb_load(path);
+		if (!db) {
+			return false;
+		}
+		rz_debug_session_deserialize(dbg->session, db);
+		sdb_free(db);
+	}
 	// Restore debugger to the beginning of the session
-	rz_debug_session_restore_reg_mem(dbg, 0);
-	sdb_free(db);
+	session_restore(dbg, 0, true);
 	return true;
 }
@@ -201,6 +201,7 @@ static void linux_remove_fork_bps(RzDebug *dbg) {
 	RzBreakpointItem *b;
 	int prev_pid = dbg->pid;
 	int prev_tid = dbg->tid;
+	bool coverage_armed = dbg->coverage && dbg->coverage->pid == prev_pid;
 
 	// Set dbg tid to the new child temporarily
 	dbg->pid = dbg->forked_pid;
@@ -217,6 +218,7 @@ static void linux_remove_fork_bps(RzDebug *dbg) {
 	// Unset software breakpoints in the child process
 	rz_debug_bp_update(dbg);
 	rz_bp_restore(dbg->bp, false);
+	rz_debug_coverage_restore(dbg, false);
 
 	// Return to the parent
 	dbg->pid = prev_pid;
@@ -225,6 +227,9 @@ static void linux_remove_fork_bps(RzDebug *dbg) {
 
 	// Restore sw breakpoints in the parent
 	rz_bp_restore(dbg->bp, true);
+	if (coverage_armed) {
+		rz_debug_coverage_restore(dbg, true);
+	}
 }
 
 #ifdef PT_GETEVENTMSG
@@ -191,6 +191,22 @@ RZ_API bool rz_demangler_plugin_del(RZ_NONNULL RzDemangler *dem, RZ_NONNULL RzDe
 	return rz_list_delete_data(dem->plugins, plugin);
 }
 
+/**
+ * \brief Returns true when \p plugin is one of the demanglers built into rizin
+ *
+ * The static plugins can demangle from several threads at once, while the
+ * plugins added with rz_demangler_plugin_add() are not expected to.
+ */
+RZ_API bool rz_demangler_plugin_is_static(RZ_NONNULL const RzDemanglerPlugin *plugin) {
+	rz_return_val_if_fail(plugin, false);
+	for (ut32 i = 0; i < RZ_ARRAY_SIZE(demangler_static_plugins); ++i) {
+		if (demangler_static_plugins[i] == plugin) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * \brief Returns a demangler plugin pointer based on the language that is found
  *
@@ -0,0 +1,282 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file anchor_diff.c
+ * Streaming byte diff for big inputs.
+ *
+ * The generic diff in diff.c indexes every single element of B and behaves
+ * quadratically on big buffers, thus it cannot be used for whole firmware
+ * images. This diff works like rsync instead:
+ * - A is split in blocks and the rolling hash of each block is stored in a
+ *   sorted array; the block size grows with the size of A so that the index
+ *   never exceeds ANCHOR_MAX_ENTRIES entries.
+ * - A and B are walked together; equal bytes are skipped by comparing big
+ *   chunks at once. On the first mismatch the rolling hash is computed over
+ *   B until a window equal to a block of A (following the current position
+ *   in A) is found; that window is the next anchor, while the bytes in the
+ *   middle are reported as deleted, inserted or replaced.
+ *
+ * Every operation is passed to a callback as soon as it is found, so the
+ * memory used does not depend on the amount of differences.
+ */
+
+#include <rz_diff.h>
+#include <rz_util.h>
+
+#define ANCHOR_DEFAULT_BLOCK_SIZE 64
+#define ANCHOR_MIN_BLOCK_SIZE     16
+#define ANCHOR_MAX_ENTRIES        (1 << 20)
+#define ANCHOR_FILTER_BITS        24
+#define ANCHOR_MAX_CANDIDATES     16
+#define ANCHOR_HASH_PRIME         0x01000193u
+
+typedef struct {
+	ut32 hash;
+	ut64 offset;
+} Anchor;
+
+typedef struct {
+	const ut8 *a;
+	ut64 a_size;
+	const ut8 *b;
+	ut64 b_size;
+	ut32 block_size;
+	ut32 prime_pow; ///< ANCHOR_HASH_PRIME ^ (block_size - 1)
+	Anchor *anchors;
+	ut64 n_anchors;
+	ut8 *filter; ///< bloom-like bitmap of the hashes in anchors
+	RzDiffBytesOpCallback cb;
+	void *user;
+} AnchorDiff;
+
+static inline ut32 filter_index(ut32 hash) {
+	return (hash * 0x9E3779B1u) >> (32 - ANCHOR_FILTER_BITS);
+}
+
+static inline bool filter_has(const AnchorDiff *ad, ut32 hash) {
+	ut32 idx = filter_index(hash);
+	return ad->filter[idx >> 3] & (1 << (idx & 7));
+}
+
+static ut32 window_hash(const ut8 *buf, ut32 size) {
+	ut32 h = 0;
+	for (ut32 i = 0; i < size; i++) {
+		h = h * ANCHOR_HASH_PRIME + buf[i];
+	}
+	return h;
+}
+
+static inline ut32 window_roll(const AnchorDiff *ad, ut32 h, ut8 out, ut8 in) {
+	return (h - out * ad->prime_pow) * ANCHOR_HASH_PRIME + in;
+}
+
+static int anchor_cmp(const void *x, const void *y) {
+	const Anchor *a = x;
+	const Anchor *b = y;
+	if (a->hash != b->hash) {
+		return a->hash < b->hash ? -1 : 1;
+	}
+	return a->offset < b->offset ? -1 : (a->offset > b->offset);
+}
+
+/**
+ * Returns the amount of equal bytes at the beginning of a and b.
+ * memcmp() is vectorized by the libc, so whole chunks are compared with it
+ * and only the chunk containing the mismatch is scanned byte by byte.
+ */
+static ut64 common_prefix(const ut8 *a, const ut8 *b, ut64 size) {
+	ut64 i = 0;
+	while (i + 4096 <= size && !memcmp(a + i, b + i, 4096)) {
+		i += 4096;
+	}
+	while (i + 64 <= size && !memcmp(a + i, b + i, 64)) {
+		i += 64;
+	}
+	while (i < size && a[i] == b[i]) {
+		i++;
+	}
+	return i;
+}
+
+static bool index_build(AnchorDiff *ad) {
+	ad->n_anchors = ad->a_size / ad->block_size;
+	ad->filter = calloc(1, (1 << ANCHOR_FILTER_BITS) / 8);
+	if (!ad->filter) {
+		return false;
+	}
+	if (!ad->n_anchors) {
+		return true;
+	}
+	ad->anchors = RZ_NEWS(Anchor, ad->n_anchors);
+	if (!ad->anchors) {
+		return false;
+	}
+	for (ut64 i = 0; i < ad->n_anchors; i++) {
+		Anchor *anchor = &ad->anchors[i];
+		anchor->offset = i * ad->block_size;
+		anchor->hash = window_hash(ad->a + anchor->offset, ad->block_size);
+		ut32 idx = filter_index(anchor->hash);
+		ad->filter[idx >> 3] |= 1 << (idx & 7);
+	}
+	qsort(ad->anchors, ad->n_anchors, sizeof(Anchor), anchor_cmp);
+	return true;
+}
+
+/**
+ * Finds in the index the first block of A with the given hash which starts
+ * at or after a_min and has the same content of b_window.
+ */
+static bool index_find(const AnchorDiff *ad, ut32 hash, ut64 a_min, const ut8 *b_window, ut64 *a_off) {
+	// lower bound of (hash, a_min)
+	ut64 lo = 0, hi = ad->n_anchors;
+	while (lo < hi) {
+		ut64 mid = lo + (hi - lo) / 2;
+		const Anchor *anchor = &ad->anchors[mid];
+		if (anchor->hash < hash || (anchor->hash == hash && anchor->offset < a_min)) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	for (ut32 n = 0; lo < ad->n_anchors && n < ANCHOR_MAX_CANDIDATES; lo++, n++) {
+		const Anchor *anchor = &ad->anchors[lo];
+		if (anchor->hash != hash) {
+			break;
+		}
+		if (!memcmp(ad->a + anchor->offset, b_window, ad->block_size)) {
+			*a_off = anchor->offset;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Scans B from b_beg looking for a window which equals a block of A located
+ * at or after a_beg.
+ */
+static bool anchor_next(const AnchorDiff *ad, ut64 a_beg, ut64 b_beg, ut64 *a_off, ut64 *b_off) {
+	ut32 bs = ad->block_size;
+	if (!ad->n_anchors || b_beg + bs > ad->b_size || a_beg + bs > ad->a_size) {
+		return false;
+	}
+	const ut8 *b = ad->b;
+	ut32 h = window_hash(b + b_beg, bs);
+	for (ut64 j = b_beg;; j++) {
+		if (filter_has(ad, h) && index_find(ad, h, a_beg, b + j, a_off)) {
+			*b_off = j;
+			return true;
+		}
+		if (j + bs >= ad->b_size) {
+			break;
+		}
+		h = window_roll(ad, h, b[j], b[j + bs]);
+	}
+	return false;
+}
+
+static bool emit(AnchorDiff *ad, RzDiffOpType type, ut64 a_beg, ut64 a_end, ut64 b_beg, ut64 b_end) {
+	RzDiffBytesOp op = {
+		.type = type,
+		.a_beg = a_beg,
+		.a_end = a_end,
+		.b_beg = b_beg,
+		.b_end = b_end,
+	};
+	return ad->cb(&op, ad->user);
+}
+
+static bool emit_gap(AnchorDiff *ad, ut64 a_beg, ut64 a_end, ut64 b_beg, ut64 b_end) {
+	if (a_beg < a_end && b_beg < b_end) {
+		return emit(ad, RZ_DIFF_OP_REPLACE, a_beg, a_end, b_beg, b_end);
+	} else if (a_beg < a_end) {
+		return emit(ad, RZ_DIFF_OP_DELETE, a_beg, a_end, b_beg, b_beg);
+	} else if (b_beg < b_end) {
+		return emit(ad, RZ_DIFF_OP_INSERT, a_beg, a_beg, b_beg, b_end);
+	}
+	return true;
+}
+
+static bool anchor_diff_run(AnchorDiff *ad) {
+	const ut8 *a = ad->a;
+	const ut8 *b = ad->b;
+	ut64 pa = 0, pb = 0;
+	while (pa < ad->a_size && pb < ad->b_size) {
+		ut64 n = common_prefix(a + pa, b + pb, RZ_MIN(ad->a_size - pa, ad->b_size - pb));
+		if (n) {
+			if (!emit(ad, RZ_DIFF_OP_EQUAL, pa, pa + n, pb, pb + n)) {
+				return false;
+			}
+			pa += n;
+			pb += n;
+			continue;
+		}
+
+		ut64 na, nb;
+		if (!anchor_next(ad, pa, pb, &na, &nb)) {
+			break;
+		}
+		// the bytes right before the anchor may match too
+		while (na > pa && nb > pb && a[na - 1] == b[nb - 1]) {
+			na--;
+			nb--;
+		}
+		if (!emit_gap(ad, pa, na, pb, nb)) {
+			return false;
+		}
+		pa = na;
+		pb = nb;
+	}
+	return emit_gap(ad, pa, ad->a_size, pb, ad->b_size);
+}
+
+/**
+ * \brief Diffs two big buffers of bytes and streams the operations
+ *
+ * Unlike rz_diff_bytes_new() the memory used is bounded (about 18 MiB at
+ * most, regardless of the size of the inputs) and the running time is
+ * linear in the size of the inputs, at the cost of less minimal results:
+ * a moved block is reported as deleted and inserted and changes shorter
+ * than a block may be merged with the surrounding ones.
+ *
+ * The operations are passed to \p cb in order; consecutive operations
+ * are contiguous and together cover both the buffers.
+ *
+ * \param a           The first buffer
+ * \param a_size      The size of the first buffer
+ * \param b           The second buffer
+ * \param b_size      The size of the second buffer
+ * \param block_size  The minimum size of the anchors (0 to use the default one)
+ * \param cb          The callback to call for each operation; return false to stop
+ * \param user        The user pointer passed to the callback
+ *
+ * \return false on failure or when the callback has stopped the diff, otherwise true
+ */
+RZ_API bool rz_diff_bytes_stream(RZ_NONNULL const ut8 *a, ut64 a_size, RZ_NONNULL const ut8 *b, ut64 b_size, ut32 block_size, RZ_NONNULL RzDiffBytesOpCallback cb, RZ_NULLABLE void *user) {
+	rz_return_val_if_fail(a && b && cb, false);
+
+	AnchorDiff ad = {
+		.a = a,
+		.a_size = a_size,
+		.b = b,
+		.b_size = b_size,
+		.cb = cb,
+		.user = user,
+	};
+	ut64 bs = block_size ? RZ_MAX(block_size, ANCHOR_MIN_BLOCK_SIZE) : ANCHOR_DEFAULT_BLOCK_SIZE;
+	// bound the index size by using bigger blocks for bigger inputs
+	bs = RZ_MAX(bs, (a_size + ANCHOR_MAX_ENTRIES - 1) / ANCHOR_MAX_ENTRIES);
+	if (bs > UT32_MAX) {
+		return false;
+	}
+	ad.block_size = (ut32)bs;
+	ad.prime_pow = 1;
+	for (ut32 i = 1; i < ad.block_size; i++) {
+		ad.prime_pow *= ANCHOR_HASH_PRIME;
+	}
+
+	bool result = index_build(&ad) && anchor_diff_run(&ad);
+	free(ad.anchors);
+	free(ad.filter);
+	return result;
+}
@@ -13,6 +13,8 @@ RZ_LIB_VERSION(rz_flag);
 #define IS_FI_IN_SPACE(fi, sp)  (!(sp) || (fi)->space == (sp))
 #define STRDUP_OR_NULL(s)       (!RZ_STR_ISEMPTY(s) ? strdup(s) : NULL)
 
+#define FLAG_ITEMS_BLOCK 1024
+
 static const char *str_callback(RzNum *user, ut64 off, int *ok) {
 	RzFlag *f = (RzFlag *)user;
 	if (ok) {
@@ -76,6 +78,63 @@ static void free_item_name(RzFlagItem *item) {
 	}
 }
 
+static void flag_item_fini(RzFlagItem *item) {
+	free(item->color);
+	free(item->comment);
+	free(item->alias);
+	/* release only one of the two pointers if they are the same */
+	free_item_name(item);
+	free(item->realname);
+}
+
+/* Flag items are allocated in blocks of FLAG_ITEMS_BLOCK items, which
+ * avoids the overhead of one heap allocation per flag. Unset items are
+ * kept in f->free_items and reused by the next flags. */
+static RzFlagItem *flag_item_new(RzFlag *f) {
+	if (!rz_pvector_empty(f->free_items)) {
+		return rz_pvector_pop(f->free_items);
+	}
+	RzFlagItem *block = rz_pvector_tail(f->item_blocks);
+	if (!block || f->item_blocks_used == FLAG_ITEMS_BLOCK) {
+		block = RZ_NEWS0(RzFlagItem, FLAG_ITEMS_BLOCK);
+		if (!block || !rz_pvector_push(f->item_blocks, block)) {
+			free(block);
+			return NULL;
+		}
+		f->item_blocks_used = 0;
+	}
+	return &block[f->item_blocks_used++];
+}
+
+static void flag_item_release(RzFlag *f, RzFlagItem *item) {
+	flag_item_fini(item);
+	memset(item, 0, sizeof(RzFlagItem));
+	rz_pvector_push(f->free_items, item);
+}
+
+static bool flag_item_fini_cb(void *user, const char *k, const void *v) {
+	flag_item_fini((RzFlagItem *)v);
+	return true;
+}
+
+static void flag_items_free(RzFlag *f) {
+	if (f->ht_name) {
+		ht_sp_foreach(f->ht_name, flag_item_fini_cb, NULL);
+	}
+	rz_pvector_free(f->item_blocks);
+	rz_pvector_free(f->free_items);
+	f->item_blocks = NULL;
+	f->free_items = NULL;
+	f->item_blocks_used = 0;
+}
+
+static bool flag_items_init(RzFlag *f) {
+	f->ht_name = ht_sp_new(HT_STR_CONST, NULL, NULL);
+	f->item_blocks = rz_pvector_new(free);
+	f->free_items = rz_pvector_new(NULL);
+	return f->ht_name && f->item_blocks && f->free_items;
+}
+
 /* return the list of flag at the nearest position.
    dir == -1 -> result <= off
    dir == 0 ->  result == off
@@ -224,8 +283,11 @@ RZ_API RzFlag *rz_flag_new(void) {
 	}
 	f->zones = NULL;
 	f->tags = sdb_new0();
-	f->ht_name = ht_sp_new(HT_STR_DUP, NULL, (HtSPFreeValue)rz_flag_item_free);
 	f->by_off = rz_skiplist_new(flag_skiplist_free, flag_skiplist_cmp);
+	if (!flag_items_init(f)) {
+		rz_flag_free(f);
+		return NULL;
+	}
 	rz_list_free(f->zones);
 	new_spaces(f);
 	return f;
@@ -249,22 +311,22 @@ RZ_API RzFlagItem *rz_flag_item_clone(RzFlagItem *item) {
 	return n;
 }
 
+/**
+ * \brief Frees an item which does not belong to any RzFlag, e.g. one
+ * returned by rz_flag_item_clone(). Use rz_flag_unset() for the others.
+ */
 RZ_API void rz_flag_item_free(RzFlagItem *item) {
 	if (!item) {
 		return;
 	}
-	free(item->color);
-	free(item->comment);
-	free(item->alias);
-	/* release only one of the two pointers if they are the same */
-	free_item_name(item);
-	free(item->realname);
+	flag_item_fini(item);
 	free(item);
 }
 
 RZ_API RzFlag *rz_flag_free(RzFlag *f) {
 	rz_return_val_if_fail(f, NULL);
 	rz_skiplist_free(f->by_off);
+	flag_items_free(f);
 	ht_sp_free(f->ht_name);
 	sdb_free(f->tags);
 	rz_spaces_fini(&f->spaces);
@@ -644,9 +706,9 @@ RZ_API RzFlagItem *rz_flag_set(RzFlag *f, const char *name, ut64 off, ut32 size)
 	}
 
 	if (!item) {
-		item = RZ_NEW0(RzFlagItem);
+		item = flag_item_new(f);
 		if (!item) {
-			goto err;
+			return NULL;
 		}
 		is_new = true;
 	}
@@ -657,9 +719,202 @@ RZ_API RzFlagItem *rz_flag_set(RzFlag *f, const char *name, ut64 off, ut32 size)
 	update_flag_item_offset(f, item, off, is_new, true);
 	update_flag_item_name(f, item, name, true);
 	return item;
-err:
-	rz_flag_item_free(item);
-	return NULL;
+}
+
+typedef struct {
+	ut64 offset;
+	size_t idx; ///< position in the input, to keep the order of flags at the same offset
+	RzFlagItem *item;
+} FlagBulkEntry;
+
+static int flag_bulk_entry_cmp(const void *a, const void *b, void *user) {
+	const FlagBulkEntry *x = a, *y = b;
+	if (x->offset != y->offset) {
+		return x->offset < y->offset ? -1 : 1;
+	}
+	return x->idx < y->idx ? -1 : (x->idx > y->idx);
+}
+
+static bool flag_is_indexed(RzFlag *f, RzFlagItem *item) {
+	const RzList *list = rz_flag_get_list(f, item->offset);
+	return list && rz_list_contains(list, item);
+}
+
+static RzFlagsAtOffset *flags_at_offset_new(ut64 off) {
+	RzFlagsAtOffset *res = RZ_NEW(RzFlagsAtOffset);
+	if (!res) {
+		return NULL;
+	}
+	res->flags = rz_list_new();
+	if (!res->flags) {
+		free(res);
+		return NULL;
+	}
+	res->off = off;
+	return res;
+}
+
+/* Adds the new items, sorted by offset, to the offset index with a single
+ * merge instead of one skiplist lookup and insertion per item. */
+static bool flag_bulk_index(RzFlag *f, RzVector /*<FlagBulkEntry>*/ *entries) {
+	FlagBulkEntry *e;
+	rz_vector_foreach (entries, e) {
+		// items can be moved by a later one with the same name
+		e->offset = e->item->offset;
+	}
+	if (rz_vector_len(entries) > 1) {
+		rz_vector_sort(entries, flag_bulk_entry_cmp, false, NULL);
+	}
+	bool res = true;
+	RzPVector offsets;
+	rz_pvector_init(&offsets, NULL);
+	RzFlagsAtOffset *at = NULL;
+	rz_vector_foreach (entries, e) {
+		if (!at || at->off != e->item->offset) {
+			at = flags_at_offset_new(e->item->offset);
+			if (!at || !rz_pvector_push(&offsets, at)) {
+				if (at) {
+					flag_skiplist_free(at);
+					at = NULL;
+				}
+				res &= update_flag_item_offset(f, e->item, e->item->offset, true, true);
+				continue;
+			}
+		}
+		rz_list_append(at->flags, e->item);
+	}
+
+	size_t count = rz_pvector_len(&offsets);
+	void **data = count ? RZ_NEWS(void *, count) : NULL;
+	size_t inserted = 0;
+	if (data) {
+		memcpy(data, rz_pvector_data(&offsets), count * sizeof(void *));
+		inserted = rz_skiplist_insert_sorted(f->by_off, data, count);
+	}
+	for (size_t i = 0; inserted < count && i < count; i++) {
+		RzFlagsAtOffset *mine = rz_pvector_at(&offsets, i);
+		if (data && data[i] == mine) {
+			continue;
+		}
+		// either there were already flags at this offset or the
+		// merge failed, in which case they are inserted one by one
+		RzFlagsAtOffset *dst = data && data[i] ? data[i] : flags_at_offset(f, mine->off);
+		if (dst) {
+			rz_list_join(dst->flags, mine->flags);
+		} else {
+			res = false;
+		}
+		flag_skiplist_free(mine);
+	}
+	free(data);
+	rz_pvector_fini(&offsets);
+	return res;
+}
+
+static bool flag_name_copy_cb(void *user, const char *k, const void *v) {
+	return ht_sp_insert((HtSP *)user, k, (void *)v);
+}
+
+/* Sizes the name table for \p n more names at once, instead of growing
+ * and rehashing it several times while they are inserted. */
+static void flag_names_reserve(RzFlag *f, size_t n) {
+	ut32 count = ht_sp_size(f->ht_name);
+	if (n <= count || count + n > UT32_MAX) {
+		return;
+	}
+	HtSP *ht = ht_sp_new_opt_size(&f->ht_name->opt, count + n);
+	if (!ht) {
+		return;
+	}
+	ht_sp_foreach(f->ht_name, flag_name_copy_cb, ht);
+	if (ht_sp_size(ht) != count) {
+		ht_sp_free(ht);
+		return;
+	}
+	ht_sp_free(f->ht_name);
+	f->ht_name = ht;
+}
+
+/**
+ * \brief Creates or modifies many flags at once
+ *
+ * Every item is applied as rz_flag_set() would, followed by
+ * rz_flag_item_set_realname() when it has a real name, but the offset index
+ * is built in a single pass over the items sorted by offset, which is much
+ * faster than setting the flags one by one when loading e.g. all the
+ * symbols of a binary. The strings in \p items are copied.
+ *
+ * \param f RzFlag to add the flags to
+ * \param items Flags to create; an item with the same name of a previous
+ *        one modifies the flag created by the latter
+ * \return false if any of the flags could not be set, true otherwise
+ */
+RZ_API bool rz_flag_set_bulk(RZ_NONNULL RzFlag *f, RZ_NONNULL RzVector /*<RzFlagBulkItem>*/ *items) {
+	rz_return_val_if_fail(f && items, false);
+	RzVector entries;
+	rz_vector_init(&entries, sizeof(FlagBulkEntry), NULL, NULL);
+	if (!rz_vector_reserve(&entries, rz_vector_len(items))) {
+		return false;
+	}
+
+	flag_names_reserve(f, rz_vector_len(items));
+
+	bool res = true;
+	RzFlagBulkItem *bi;
+	rz_vector_foreach (items, bi) {
+		if (RZ_STR_ISEMPTY(bi->name)) {
+			res = false;
+			continue;
+		}
+		RzSpace *space = bi->space ? bi->space : rz_flag_space_cur(f);
+		char *name = filter_item_name(bi->name);
+		if (!name) {
+			res = false;
+			continue;
+		}
+		RzFlagItem *item = ht_sp_find(f->ht_name, name, NULL);
+		if (item) {
+			free(name);
+			if (item->offset != bi->offset) {
+				item->space = space;
+				if (flag_is_indexed(f, item)) {
+					update_flag_item_offset(f, item, bi->offset, false, true);
+				} else {
+					// created by a previous item, it is indexed later
+					item->offset = bi->offset;
+				}
+			}
+			item->size = bi->size;
+		} else {
+			item = flag_item_new(f);
+			if (!item) {
+				free(name);
+				res = false;
+				continue;
+			}
+			if (!ht_sp_insert(f->ht_name, name, item)) {
+				free(name);
+				flag_item_release(f, item);
+				res = false;
+				continue;
+			}
+			item->name = name;
+			item->realname = name;
+			item->offset = bi->offset;
+			item->size = bi->size;
+			item->space = space;
+			FlagBulkEntry e = { .offset = bi->offset, .idx = rz_vector_len(&entries), .item = item };
+			rz_vector_push(&entries, &e);
+		}
+		if (bi->realname) {
+			rz_flag_item_set_realname(item, bi->realname);
+		}
+		item->demangled = bi->demangled;
+	}
+
+	res &= flag_bulk_index(f, &entries);
+	rz_vector_fini(&entries);
+	return res;
 }
 
 /* add/replace/remove the alias of a flag item */
@@ -707,6 +962,7 @@ RZ_API bool rz_flag_unset(RzFlag *f, RzFlagItem *item) {
 	rz_return_val_if_fail(f && item, false);
 	remove_offsetmap(f, item);
 	ht_sp_delete(f->ht_name, item->name);
+	flag_item_release(f, item);
 	return true;
 }
 
@@ -785,8 +1041,9 @@ RZ_API bool rz_flag_unset_name(RzFlag *f, const char *name) {
 /* unset all flag items in the RzFlag f */
 RZ_API void rz_flag_unset_all(RzFlag *f) {
 	rz_return_if_fail(f);
+	flag_items_free(f);
 	ht_sp_free(f->ht_name);
-	f->ht_name = ht_sp_new(HT_STR_DUP, NULL, (HtSPFreeValue)rz_flag_item_free);
+	flag_items_init(f);
 	rz_skiplist_purge(f->by_off);
 	rz_spaces_fini(&f->spaces);
 	new_spaces(f);
@@ -22,8 +22,14 @@ typedef struct hash_cfg_config_t {
 	ut8 *hmac_key;
 	RzHashSize digest_size;
 	const RzHashPlugin *plugin;
+	bool failed; ///< set by rz_hash_cfg_update_mt when the update fails
 } HashCfgConfig;
 
+typedef struct {
+	const ut8 *data;
+	ut64 size;
+} HashCfgUpdate;
+
 #if HAVE_LIB_SSL
 #include <openssl/opensslv.h>
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
@@ -450,6 +456,48 @@ RZ_API bool rz_hash_cfg_update(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const ut8 *d
 	return true;
 }
 
+static void hash_cfg_config_update(HashCfgConfig *mdc, const HashCfgUpdate *update) {
+	mdc->failed = !mdc->plugin->update(mdc->context, update->data, update->size);
+}
+
+/**
+ * \brief Inserts data into each the message digest contextes in parallel
+ *
+ * Same as rz_hash_cfg_update() but each configured algorithm consumes the
+ * data on its own thread, thus the data is read only once by all of them.
+ * This is worth it only for big chunks of data and several algorithms;
+ * otherwise the method behaves exactly like rz_hash_cfg_update().
+ * */
+RZ_API bool rz_hash_cfg_update_mt(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const ut8 *data, ut64 size, RzThreadNCores max_threads) {
+	rz_return_val_if_fail(md && hash_cfg_can_update(md), false);
+	// one thread per algorithm at most
+	ut32 n_threads = RZ_MIN((ut32)rz_th_max_threads(max_threads), rz_list_length(md->configurations));
+	if (n_threads < 2) {
+		return rz_hash_cfg_update(md, data, size);
+	}
+
+	HashCfgUpdate update = {
+		.data = data,
+		.size = size,
+	};
+	if (!rz_th_iterate_list(md->configurations, (RzThreadIterator)hash_cfg_config_update, (RzThreadNCores)n_threads, &update)) {
+		RZ_LOG_ERROR("msg digest: failed to run the parallel update.\n");
+		return false;
+	}
+
+	RzListIter *iter = NULL;
+	HashCfgConfig *mdc = NULL;
+	rz_list_foreach (md->configurations, iter, mdc) {
+		if (mdc->failed) {
+			RZ_LOG_ERROR("msg digest: failed to call update for %s.\n", mdc->plugin->name);
+			return false;
+		}
+	}
+
+	md->status = RZ_MSG_DIGEST_STATUS_UPDATE;
+	return true;
+}
+
 /**
  * \brief Generates the final value of the message digest contextes
  *
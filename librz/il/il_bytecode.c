@@ -0,0 +1,1109 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file
+ * RzIL Bytecode
+ *
+ * The tree evaluator in il_vm_eval.c allocates a RzBitVector or RzILBool for
+ * every intermediate value and looks up every variable by name. Here an
+ * effect is instead compiled once into a flat list of instructions working
+ * on an array of unboxed ut64 registers:
+ * - every pure op writes its result into a fresh register
+ * - let-bound vars are the register of their value, local vars get their
+ *   own register
+ * - global vars are resolved once per step by rz_il_bytecode_bind() and
+ *   read/written in place
+ * - ite, branch and repeat become conditional jumps
+ *
+ * Only effects whose values all fit into 64 bits and which don't use floats
+ * can be compiled. For them, the execution is equivalent to the one of the
+ * tree evaluator, including the order and contents of the generated events.
+ */
+
+#include <rz_il/rz_il_vm.h>
+
+extern RZ_IPI RzILOpPureHandler rz_il_op_handler_pure_table_default[RZ_IL_OP_PURE_MAX];
+extern RZ_IPI RzILOpEffectHandler rz_il_op_handler_effect_table_default[RZ_IL_OP_EFFECT_MAX];
+
+typedef enum {
+	BC_CONST, ///< d = imm
+	BC_MOV, ///< d = a
+	BC_GVAR, ///< d = global[imm]
+	BC_LVAR, ///< d = local[imm]
+	BC_NEG,
+	BC_NOT,
+	BC_ADD,
+	BC_SUB,
+	BC_MUL,
+	BC_DIV,
+	BC_SDIV,
+	BC_MOD,
+	BC_SMOD,
+	BC_AND,
+	BC_OR,
+	BC_XOR,
+	BC_INV, ///< boolean not
+	BC_SHL, ///< d = a << b, filled with c
+	BC_SHR, ///< d = a >> b, filled with c
+	BC_EQ,
+	BC_ULE,
+	BC_SLE,
+	BC_MSB,
+	BC_LSB,
+	BC_IS_ZERO,
+	BC_CAST, ///< d = the imm low bits of a, extended to w bits with c
+	BC_APPEND, ///< d = a:b, b being imm bits long
+	BC_LOAD, ///< d = mem[imm][a]
+	BC_LOADW,
+	BC_STORE, ///< mem[imm][a] = b
+	BC_STOREW,
+	BC_SETG, ///< global[imm] = b
+	BC_SETL, ///< local[imm] = b
+	BC_JMP, ///< pc = a
+	BC_GOTO, ///< goto gotos[imm]
+	BC_LABEL, ///< labels[imm] = pc
+	BC_EMPTY,
+	BC_BR, ///< jump to imm
+	BC_BRF, ///< jump to imm if a is false
+} BcCode;
+
+typedef struct {
+	BcCode code;
+	ut32 w; ///< bits of the result, or of the operands for comparisons and stores
+	ut32 w2; ///< bits of the key for memory accesses
+	ut32 d;
+	ut32 a;
+	ut32 b;
+	ut32 c;
+	ut64 imm;
+} BcInsn;
+
+typedef struct {
+	char *name;
+	RzILSortPure sort;
+	RzILVal *val; ///< bound by rz_il_bytecode_bind()
+} BcGlobal;
+
+typedef struct {
+	char *name;
+	RzILSortPure sort;
+	ut32 reg;
+	bool defined; ///< set during the current step
+} BcLocal;
+
+/**
+ * Instructions computing the condition of a repeat. The tree evaluator
+ * leaves the loop when the condition can't be evaluated, so a failure in
+ * [start, end) jumps to exit instead of aborting.
+ */
+typedef struct {
+	ut32 start;
+	ut32 end;
+	ut32 exit;
+} BcRegion;
+
+struct rz_il_bytecode_t {
+	RzVector /*<BcInsn>*/ code;
+	RzVector /*<BcGlobal>*/ globals;
+	RzVector /*<BcLocal>*/ locals;
+	RzVector /*<BcRegion>*/ regions;
+	RzPVector /*<char *>*/ labels;
+	RzPVector /*<RzILOpEffect *>*/ gotos; ///< passed to the hooks
+	ut64 *regs;
+	ut32 n_regs;
+};
+
+typedef struct {
+	const char *name;
+	ut32 reg;
+	RzILSortPure sort;
+} BcBinding;
+
+typedef struct {
+	RzILVM *vm;
+	RzILBytecode *bc;
+	RzVector /*<BcBinding>*/ scope; ///< let-bound vars, innermost last
+} BcCompiler;
+
+static inline ut64 width_mask(ut32 w) {
+	return w >= 64 ? UT64_MAX : (1ULL << w) - 1;
+}
+
+static inline bool sort_is_small(RzILSortPure sort) {
+	return sort.type == RZ_IL_TYPE_PURE_BOOL ||
+		(sort.type == RZ_IL_TYPE_PURE_BITVECTOR && sort.props.bv.length && sort.props.bv.length <= 64);
+}
+
+static inline ut32 sort_width(RzILSortPure sort) {
+	return sort.type == RZ_IL_TYPE_PURE_BOOL ? 1 : sort.props.bv.length;
+}
+
+static inline bool sort_is_bv(RzILSortPure sort) {
+	return sort.type == RZ_IL_TYPE_PURE_BITVECTOR;
+}
+
+static inline bool sort_is_bool(RzILSortPure sort) {
+	return sort.type == RZ_IL_TYPE_PURE_BOOL;
+}
+
+static BcInsn *emit(BcCompiler *c, BcCode code, ut32 w) {
+	BcInsn *insn = rz_vector_push(&c->bc->code, NULL);
+	if (!insn) {
+		return NULL;
+	}
+	memset(insn, 0, sizeof(*insn));
+	insn->code = code;
+	insn->w = w;
+	return insn;
+}
+
+static inline ut32 code_pos(BcCompiler *c) {
+	return rz_vector_len(&c->bc->code);
+}
+
+static inline void patch_target(BcCompiler *c, ut32 pos, ut32 target) {
+	BcInsn *insn = rz_vector_index_ptr(&c->bc->code, pos);
+	insn->imm = target;
+}
+
+static inline ut32 reg_new(BcCompiler *c) {
+	return c->bc->n_regs++;
+}
+
+static bool global_index(BcCompiler *c, const char *name, ut32 *index, RzILSortPure *sort) {
+	BcGlobal *g;
+	ut32 i = 0;
+	rz_vector_foreach (&c->bc->globals, g) {
+		if (!strcmp(g->name, name)) {
+			*index = i;
+			*sort = g->sort;
+			return true;
+		}
+		i++;
+	}
+	RzILVal *val = rz_il_vm_get_var_value(c->vm, RZ_IL_VAR_KIND_GLOBAL, name);
+	if (!val || !rz_il_vm_get_var(c->vm, RZ_IL_VAR_KIND_GLOBAL, name)) {
+		return false;
+	}
+	RzILSortPure s = rz_il_value_get_sort(val);
+	if (!sort_is_small(s)) {
+		return false;
+	}
+	g = rz_vector_push(&c->bc->globals, NULL);
+	if (!g) {
+		return false;
+	}
+	g->name = rz_str_dup(name);
+	g->sort = s;
+	g->val = NULL;
+	if (!g->name) {
+		rz_vector_pop(&c->bc->globals, NULL);
+		return false;
+	}
+	*index = i;
+	*sort = s;
+	return true;
+}
+
+static BcLocal *local_find(BcCompiler *c, const char *name, ut32 *index) {
+	BcLocal *l;
+	ut32 i = 0;
+	rz_vector_foreach (&c->bc->locals, l) {
+		if (!strcmp(l->name, name)) {
+			*index = i;
+			return l;
+		}
+		i++;
+	}
+	return NULL;
+}
+
+static bool compile_pure(BcCompiler *c, RzILOpPure *op, ut32 *reg, RzILSortPure *sort);
+
+static bool compile_bv(BcCompiler *c, RzILOpPure *op, ut32 *reg, ut32 *w) {
+	RzILSortPure sort;
+	if (!compile_pure(c, op, reg, &sort) || !sort_is_bv(sort)) {
+		return false;
+	}
+	*w = sort.props.bv.length;
+	return true;
+}
+
+static bool compile_bool(BcCompiler *c, RzILOpPure *op, ut32 *reg) {
+	RzILSortPure sort;
+	return compile_pure(c, op, reg, &sort) && sort_is_bool(sort);
+}
+
+static bool compile_var(BcCompiler *c, RzILOpArgsVar *args, ut32 *reg, RzILSortPure *sort) {
+	ut32 index;
+	BcInsn *insn;
+	switch (args->kind) {
+	case RZ_IL_VAR_KIND_LOCAL_PURE:
+		for (ut32 i = rz_vector_len(&c->scope); i; i--) {
+			BcBinding *b = rz_vector_index_ptr(&c->scope, i - 1);
+			if (!strcmp(b->name, args->v)) {
+				*reg = b->reg;
+				*sort = b->sort;
+				return true;
+			}
+		}
+		return false;
+	case RZ_IL_VAR_KIND_GLOBAL:
+		if (!global_index(c, args->v, &index, sort) || !(insn = emit(c, BC_GVAR, sort_width(*sort)))) {
+			return false;
+		}
+		break;
+	case RZ_IL_VAR_KIND_LOCAL: {
+		// only locals set earlier in the same effect are known
+		BcLocal *l = local_find(c, args->v, &index);
+		if (!l || !(insn = emit(c, BC_LVAR, sort_width(l->sort)))) {
+			return false;
+		}
+		*sort = l->sort;
+		break;
+	}
+	default:
+		return false;
+	}
+	insn->imm = index;
+	insn->d = *reg = reg_new(c);
+	return true;
+}
+
+static bool compile_ite(BcCompiler *c, RzILOpArgsIte *args, ut32 *reg, RzILSortPure *sort) {
+	ut32 cond, x, y;
+	RzILSortPure sx, sy;
+	if (!compile_bool(c, args->condition, &cond)) {
+		return false;
+	}
+	ut32 d = reg_new(c);
+	ut32 brf = code_pos(c);
+	BcInsn *insn = emit(c, BC_BRF, 1);
+	if (!insn) {
+		return false;
+	}
+	insn->a = cond;
+	if (!compile_pure(c, args->x, &x, &sx) || !(insn = emit(c, BC_MOV, sort_width(sx)))) {
+		return false;
+	}
+	insn->d = d;
+	insn->a = x;
+	ut32 br = code_pos(c);
+	if (!emit(c, BC_BR, 0)) {
+		return false;
+	}
+	patch_target(c, brf, code_pos(c));
+	if (!compile_pure(c, args->y, &y, &sy) || !rz_il_sort_pure_eq(sx, sy) || !(insn = emit(c, BC_MOV, sort_width(sy)))) {
+		return false;
+	}
+	insn->d = d;
+	insn->a = y;
+	patch_target(c, br, code_pos(c));
+	*reg = d;
+	*sort = sx;
+	return true;
+}
+
+static bool compile_let(BcCompiler *c, RzILOpArgsLet *args, ut32 *reg, RzILSortPure *sort) {
+	BcBinding b = { .name = args->name };
+	if (!compile_pure(c, args->exp, &b.reg, &b.sort) || !rz_vector_push(&c->scope, &b)) {
+		return false;
+	}
+	bool ret = compile_pure(c, args->body, reg, sort);
+	rz_vector_pop(&c->scope, NULL);
+	return ret;
+}
+
+static bool compile_bool_op(BcCompiler *c, BcCode code, RzILOpPure *x, RzILOpPure *y, ut32 *reg, RzILSortPure *sort) {
+	ut32 rx, ry = 0;
+	if (!compile_bool(c, x, &rx) || (y && !compile_bool(c, y, &ry))) {
+		return false;
+	}
+	BcInsn *insn = emit(c, code, 1);
+	if (!insn) {
+		return false;
+	}
+	insn->a = rx;
+	insn->b = ry;
+	insn->d = *reg = reg_new(c);
+	*sort = rz_il_sort_pure_bool();
+	return true;
+}
+
+/**
+ * bitv -> bitv, bitv -> bitv -> bitv and bitv -> bitv -> bool ops,
+ * the operands must have the same size
+ */
+static bool compile_bv_op(BcCompiler *c, BcCode code, RzILOpPure *x, RzILOpPure *y, bool to_bool, ut32 *reg, RzILSortPure *sort) {
+	ut32 rx, ry = 0, wx, wy;
+	if (!compile_bv(c, x, &rx, &wx) || (y && (!compile_bv(c, y, &ry, &wy) || wx != wy))) {
+		return false;
+	}
+	BcInsn *insn = emit(c, code, wx);
+	if (!insn) {
+		return false;
+	}
+	insn->a = rx;
+	insn->b = ry;
+	insn->d = *reg = reg_new(c);
+	*sort = to_bool ? rz_il_sort_pure_bool() : rz_il_sort_pure_bv(wx);
+	return true;
+}
+
+static bool compile_shift(BcCompiler *c, BcCode code, struct rz_il_op_args_shift_t *args, ut32 *reg, RzILSortPure *sort) {
+	ut32 rx, ry, rf, wx, wy;
+	if (!compile_bv(c, args->x, &rx, &wx) || !compile_bv(c, args->y, &ry, &wy) || !compile_bool(c, args->fill_bit, &rf)) {
+		return false;
+	}
+	BcInsn *insn = emit(c, code, wx);
+	if (!insn) {
+		return false;
+	}
+	insn->a = rx;
+	insn->b = ry;
+	insn->c = rf;
+	insn->d = *reg = reg_new(c);
+	*sort = rz_il_sort_pure_bv(wx);
+	return true;
+}
+
+static bool compile_cast(BcCompiler *c, RzILOpArgsCast *args, ut32 *reg, RzILSortPure *sort) {
+	ut32 rf, rv, wv;
+	if (!args->length || args->length > 64 || !compile_bool(c, args->fill, &rf) || !compile_bv(c, args->val, &rv, &wv)) {
+		return false;
+	}
+	BcInsn *insn = emit(c, BC_CAST, args->length);
+	if (!insn) {
+		return false;
+	}
+	insn->a = rv;
+	insn->c = rf;
+	insn->imm = RZ_MIN(wv, args->length);
+	insn->d = *reg = reg_new(c);
+	*sort = rz_il_sort_pure_bv(args->length);
+	return true;
+}
+
+static bool compile_append(BcCompiler *c, RzILOpArgsAppend *args, ut32 *reg, RzILSortPure *sort) {
+	ut32 rh, rl, wh, wl;
+	if (!compile_bv(c, args->high, &rh, &wh) || !compile_bv(c, args->low, &rl, &wl) || wh + wl > 64) {
+		return false;
+	}
+	BcInsn *insn = emit(c, BC_APPEND, wh + wl);
+	if (!insn) {
+		return false;
+	}
+	insn->a = rh;
+	insn->b = rl;
+	insn->imm = wl;
+	insn->d = *reg = reg_new(c);
+	*sort = rz_il_sort_pure_bv(wh + wl);
+	return true;
+}
+
+static bool compile_load(BcCompiler *c, BcCode code, RzILMemIndex index, RzILOpPure *key, ut32 n_bits, ut32 *reg, RzILSortPure *sort) {
+	RzILMem *mem = rz_il_vm_get_mem(c->vm, index);
+	ut32 rk, wk;
+	if (!mem || !compile_bv(c, key, &rk, &wk) || wk != rz_il_mem_key_len(mem)) {
+		return false;
+	}
+	ut32 w = code == BC_LOAD ? rz_il_mem_value_len(mem) : n_bits;
+	if (!w || w > 64) {
+		return false;
+	}
+	BcInsn *insn = emit(c, code, w);
+	if (!insn) {
+		return false;
+	}
+	insn->w2 = wk;
+	insn->a = rk;
+	insn->imm = index;
+	insn->d = *reg = reg_new(c);
+	*sort = rz_il_sort_pure_bv(w);
+	return true;
+}
+
+static bool compile_pure(BcCompiler *c, RzILOpPure *op, ut32 *reg, RzILSortPure *sort) {
+	if (op->code >= RZ_IL_OP_PURE_MAX ||
+		c->vm->op_handler_pure_table[op->code] != rz_il_op_handler_pure_table_default[op->code]) {
+		// custom handlers can only be run by the tree evaluator
+		return false;
+	}
+	BcInsn *insn;
+	switch (op->code) {
+	case RZ_IL_OP_VAR:
+		return compile_var(c, &op->op.var, reg, sort);
+	case RZ_IL_OP_ITE:
+		return compile_ite(c, &op->op.ite, reg, sort);
+	case RZ_IL_OP_LET:
+		return compile_let(c, &op->op.let, reg, sort);
+	case RZ_IL_OP_B0:
+	case RZ_IL_OP_B1:
+		if (!(insn = emit(c, BC_CONST, 1))) {
+			return false;
+		}
+		insn->imm = op->code == RZ_IL_OP_B1;
+		insn->d = *reg = reg_new(c);
+		*sort = rz_il_sort_pure_bool();
+		return true;
+	case RZ_IL_OP_INV:
+		return compile_bool_op(c, BC_INV, op->op.boolinv.x, NULL, reg, sort);
+	case RZ_IL_OP_AND:
+		return compile_bool_op(c, BC_AND, op->op.booland.x, op->op.booland.y, reg, sort);
+	case RZ_IL_OP_OR:
+		return compile_bool_op(c, BC_OR, op->op.boolor.x, op->op.boolor.y, reg, sort);
+	case RZ_IL_OP_XOR:
+		return compile_bool_op(c, BC_XOR, op->op.boolxor.x, op->op.boolxor.y, reg, sort);
+	case RZ_IL_OP_BITV: {
+		RzBitVector *bv = op->op.bitv.value;
+		if (!bv || !bv->len || bv->len > 64 || !(insn = emit(c, BC_CONST, bv->len))) {
+			return false;
+		}
+		insn->imm = rz_bv_to_ut64(bv);
+		insn->d = *reg = reg_new(c);
+		*sort = rz_il_sort_pure_bv(bv->len);
+		return true;
+	}
+	case RZ_IL_OP_MSB:
+		return compile_bv_op(c, BC_MSB, op->op.msb.bv, NULL, true, reg, sort);
+	case RZ_IL_OP_LSB:
+		return compile_bv_op(c, BC_LSB, op->op.lsb.bv, NULL, true, reg, sort);
+	case RZ_IL_OP_IS_ZERO:
+		return compile_bv_op(c, BC_IS_ZERO, op->op.is_zero.bv, NULL, true, reg, sort);
+	case RZ_IL_OP_NEG:
+		return compile_bv_op(c, BC_NEG, op->op.neg.bv, NULL, false, reg, sort);
+	case RZ_IL_OP_LOGNOT:
+		return compile_bv_op(c, BC_NOT, op->op.lognot.bv, NULL, false, reg, sort);
+	case RZ_IL_OP_ADD:
+		return compile_bv_op(c, BC_ADD, op->op.add.x, op->op.add.y, false, reg, sort);
+	case RZ_IL_OP_SUB:
+		return compile_bv_op(c, BC_SUB, op->op.sub.x, op->op.sub.y, false, reg, sort);
+	case RZ_IL_OP_MUL:
+		return compile_bv_op(c, BC_MUL, op->op.mul.x, op->op.mul.y, false, reg, sort);
+	case RZ_IL_OP_DIV:
+		return compile_bv_op(c, BC_DIV, op->op.div.x, op->op.div.y, false, reg, sort);
+	case RZ_IL_OP_SDIV:
+		return compile_bv_op(c, BC_SDIV, op->op.sdiv.x, op->op.sdiv.y, false, reg, sort);
+	case RZ_IL_OP_MOD:
+		return compile_bv_op(c, BC_MOD, op->op.mod.x, op->op.mod.y, false, reg, sort);
+	case RZ_IL_OP_SMOD:
+		return compile_bv_op(c, BC_SMOD, op->op.smod.x, op->op.smod.y, false, reg, sort);
+	case RZ_IL_OP_LOGAND:
+		return compile_bv_op(c, BC_AND, op->op.logand.x, op->op.logand.y, false, reg, sort);
+	case RZ_IL_OP_LOGOR:
+		return compile_bv_op(c, BC_OR, op->op.logor.x, op->op.logor.y, false, reg, sort);
+	case RZ_IL_OP_LOGXOR:
+		return compile_bv_op(c, BC_XOR, op->op.logxor.x, op->op.logxor.y, false, reg, sort);
+	case RZ_IL_OP_SHIFTL:
+		return compile_shift(c, BC_SHL, &op->op.shiftl, reg, sort);
+	case RZ_IL_OP_SHIFTR:
+		return compile_shift(c, BC_SHR, &op->op.shiftr, reg, sort);
+	case RZ_IL_OP_EQ:
+		return compile_bv_op(c, BC_EQ, op->op.eq.x, op->op.eq.y, true, reg, sort);
+	case RZ_IL_OP_ULE:
+		return compile_bv_op(c, BC_ULE, op->op.ule.x, op->op.ule.y, true, reg, sort);
+	case RZ_IL_OP_SLE:
+		return compile_bv_op(c, BC_SLE, op->op.sle.x, op->op.sle.y, true, reg, sort);
+	case RZ_IL_OP_CAST:
+		return compile_cast(c, &op->op.cast, reg, sort);
+	case RZ_IL_OP_APPEND:
+		return compile_append(c, &op->op.append, reg, sort);
+	case RZ_IL_OP_LOAD:
+		return compile_load(c, BC_LOAD, op->op.load.mem, op->op.load.key, 0, reg, sort);
+	case RZ_IL_OP_LOADW:
+		return compile_load(c, BC_LOADW, op->op.loadw.mem, op->op.loadw.key, op->op.loadw.n_bits, reg, sort);
+	default:
+		// floats
+		return false;
+	}
+}
+
+static bool compile_set(BcCompiler *c, RzILOpArgsSet *args) {
+	ut32 rx, index;
+	RzILSortPure sx, sort;
+	if (!compile_pure(c, args->x, &rx, &sx)) {
+		return false;
+	}
+	BcInsn *insn;
+	if (args->is_local) {
+		BcLocal *l = local_find(c, args->v, &index);
+		if (l && !rz_il_sort_pure_eq(l->sort, sx)) {
+			return false;
+		}
+		if (!l) {
+			index = rz_vector_len(&c->bc->locals);
+			l = rz_vector_push(&c->bc->locals, NULL);
+			if (!l) {
+				return false;
+			}
+			l->name = rz_str_dup(args->v);
+			l->sort = sx;
+			l->reg = reg_new(c);
+			l->defined = false;
+			if (!l->name) {
+				rz_vector_pop(&c->bc->locals, NULL);
+				return false;
+			}
+		}
+		insn = emit(c, BC_SETL, sort_width(sx));
+	} else {
+		if (!global_index(c, args->v, &index, &sort) || !rz_il_sort_pure_eq(sort, sx)) {
+			return false;
+		}
+		insn = emit(c, BC_SETG, sort_width(sx));
+	}
+	if (!insn) {
+		return false;
+	}
+	insn->b = rx;
+	insn->imm = index;
+	return true;
+}
+
+static bool compile_effect(BcCompiler *c, RzILOpEffect *op) {
+	if (op->code >= RZ_IL_OP_EFFECT_MAX ||
+		c->vm->op_handler_effect_table[op->code] != rz_il_op_handler_effect_table_default[op->code]) {
+		return false;
+	}
+	RzILBytecode *bc = c->bc;
+	BcInsn *insn;
+	ut32 ra, rb, wa, wb, pos, brf;
+	switch (op->code) {
+	case RZ_IL_OP_EMPTY:
+		return emit(c, BC_EMPTY, 0);
+	case RZ_IL_OP_NOP:
+		return true;
+	case RZ_IL_OP_SET:
+		return compile_set(c, &op->op.set);
+	case RZ_IL_OP_JMP:
+		if (!compile_bv(c, op->op.jmp.dst, &ra, &wa) || !(insn = emit(c, BC_JMP, wa))) {
+			return false;
+		}
+		insn->a = ra;
+		return true;
+	case RZ_IL_OP_GOTO: {
+		char *lbl = rz_str_dup(op->op.goto_.lbl);
+		RzILOpEffect *hook_op = lbl ? rz_il_op_new_goto(lbl) : NULL;
+		if (!hook_op || !rz_pvector_push(&bc->labels, lbl)) {
+			free(lbl);
+			rz_il_op_effect_free(hook_op);
+			return false;
+		}
+		if (!rz_pvector_push(&bc->gotos, hook_op)) {
+			rz_il_op_effect_free(hook_op);
+			return false;
+		}
+		if (!(insn = emit(c, BC_GOTO, 0))) {
+			return false;
+		}
+		insn->imm = rz_pvector_len(&bc->gotos) - 1;
+		insn->a = rz_pvector_len(&bc->labels) - 1;
+		return true;
+	}
+	case RZ_IL_OP_SEQ:
+		return compile_effect(c, op->op.seq.x) && compile_effect(c, op->op.seq.y);
+	case RZ_IL_OP_BLK:
+		if (op->op.blk.label) {
+			char *lbl = rz_str_dup(op->op.blk.label);
+			if (!lbl || !rz_pvector_push(&bc->labels, lbl)) {
+				free(lbl);
+				return false;
+			}
+			if (!(insn = emit(c, BC_LABEL, 0))) {
+				return false;
+			}
+			insn->imm = rz_pvector_len(&bc->labels) - 1;
+		}
+		return compile_effect(c, op->op.blk.data_eff) && compile_effect(c, op->op.blk.ctrl_eff);
+	case RZ_IL_OP_REPEAT: {
+		BcRegion region = { .start = code_pos(c) };
+		if (!compile_bool(c, op->op.repeat.condition, &ra)) {
+			return false;
+		}
+		region.end = code_pos(c);
+		brf = code_pos(c);
+		if (!(insn = emit(c, BC_BRF, 1))) {
+			return false;
+		}
+		insn->a = ra;
+		if (!compile_effect(c, op->op.repeat.data_eff) || !(insn = emit(c, BC_BR, 0))) {
+			return false;
+		}
+		insn->imm = region.start;
+		region.exit = code_pos(c);
+		patch_target(c, brf, region.exit);
+		return region.start == region.end || rz_vector_push(&bc->regions, &region);
+	}
+	case RZ_IL_OP_BRANCH:
+		if (!compile_bool(c, op->op.branch.condition, &ra)) {
+			return false;
+		}
+		brf = code_pos(c);
+		if (!(insn = emit(c, BC_BRF, 1))) {
+			return false;
+		}
+		insn->a = ra;
+		if (!compile_effect(c, op->op.branch.true_eff)) {
+			return false;
+		}
+		pos = code_pos(c);
+		if (!emit(c, BC_BR, 0)) {
+			return false;
+		}
+		patch_target(c, brf, code_pos(c));
+		if (!compile_effect(c, op->op.branch.false_eff)) {
+			return false;
+		}
+		patch_target(c, pos, code_pos(c));
+		return true;
+	case RZ_IL_OP_STORE:
+	case RZ_IL_OP_STOREW: {
+		bool word = op->code == RZ_IL_OP_STOREW;
+		RzILMemIndex index = word ? op->op.storew.mem : op->op.store.mem;
+		RzILMem *mem = rz_il_vm_get_mem(c->vm, index);
+		if (!mem ||
+			!compile_bv(c, word ? op->op.storew.key : op->op.store.key, &ra, &wa) ||
+			!compile_bv(c, word ? op->op.storew.value : op->op.store.value, &rb, &wb) ||
+			wa != rz_il_mem_key_len(mem) || (!word && wb != rz_il_mem_value_len(mem))) {
+			return false;
+		}
+		if (!(insn = emit(c, word ? BC_STOREW : BC_STORE, wb))) {
+			return false;
+		}
+		insn->w2 = wa;
+		insn->a = ra;
+		insn->b = rb;
+		insn->imm = index;
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+static void global_fini(void *e, void *user) {
+	BcGlobal *g = e;
+	free(g->name);
+}
+
+static void local_fini(void *e, void *user) {
+	BcLocal *l = e;
+	free(l->name);
+}
+
+/**
+ * \brief Compiles \p op into bytecode which can be run by rz_il_vm_step_bytecode()
+ *
+ * The global vars, memories and handlers of \p vm are used to check the
+ * types, thus the bytecode must only be used with this vm.
+ *
+ * \return the bytecode or NULL if \p op contains values larger than 64 bits,
+ *         floats or anything else which can only be evaluated by the tree
+ *         evaluator (rz_il_vm_step() must be used in this case)
+ */
+RZ_API RZ_OWN RzILBytecode *rz_il_bytecode_compile(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILOpEffect *op) {
+	rz_return_val_if_fail(vm && op, NULL);
+	RzILBytecode *bc = RZ_NEW0(RzILBytecode);
+	if (!bc) {
+		return NULL;
+	}
+	rz_vector_init(&bc->code, sizeof(BcInsn), NULL, NULL);
+	rz_vector_init(&bc->globals, sizeof(BcGlobal), global_fini, NULL);
+	rz_vector_init(&bc->locals, sizeof(BcLocal), local_fini, NULL);
+	rz_vector_init(&bc->regions, sizeof(BcRegion), NULL, NULL);
+	rz_pvector_init(&bc->labels, free);
+	rz_pvector_init(&bc->gotos, (RzPVectorFree)rz_il_op_effect_free);
+
+	BcCompiler c = { .vm = vm, .bc = bc };
+	rz_vector_init(&c.scope, sizeof(BcBinding), NULL, NULL);
+	bool ok = compile_effect(&c, op);
+	rz_vector_fini(&c.scope);
+	if (!ok || !(bc->regs = RZ_NEWS0(ut64, RZ_MAX(bc->n_regs, 1)))) {
+		rz_il_bytecode_free(bc);
+		return NULL;
+	}
+	return bc;
+}
+
+RZ_API void rz_il_bytecode_free(RZ_NULLABLE RzILBytecode *bc) {
+	if (!bc) {
+		return;
+	}
+	rz_vector_fini(&bc->code);
+	rz_vector_fini(&bc->globals);
+	rz_vector_fini(&bc->locals);
+	rz_vector_fini(&bc->regions);
+	rz_pvector_fini(&bc->labels);
+	rz_pvector_fini(&bc->gotos);
+	free(bc->regs);
+	free(bc);
+}
+
+/**
+ * \brief Resolves the global vars used by \p bc
+ *
+ * Must be called before every rz_il_vm_step_bytecode(), since the values of
+ * the global vars may have been replaced in the meantime.
+ *
+ * \return false if a global var does not exist anymore or its sort changed,
+ *         in which case the op must be evaluated with rz_il_vm_step()
+ */
+RZ_API bool rz_il_bytecode_bind(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILBytecode *bc) {
+	rz_return_val_if_fail(vm && bc, false);
+	BcGlobal *g;
+	rz_vector_foreach (&bc->globals, g) {
+		RzILVal *val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_GLOBAL, g->name);
+		if (!val || !rz_il_sort_pure_eq(rz_il_value_get_sort(val), g->sort)) {
+			return false;
+		}
+		g->val = val;
+	}
+	return true;
+}
+
+static inline ut64 val_get(const RzILVal *val) {
+	return val->type == RZ_IL_TYPE_PURE_BOOL ? val->data.b->b : val->data.bv->bits.small_u;
+}
+
+static inline void val_set(RzILVal *val, ut64 v) {
+	if (val->type == RZ_IL_TYPE_PURE_BOOL) {
+		val->data.b->b = v;
+	} else {
+		val->data.bv->bits.small_u = v;
+	}
+}
+
+static inline void bv_small(RzBitVector *bv, ut32 w, ut64 v) {
+	bv->bits.small_u = v;
+	bv->_elem_len = 0;
+	bv->len = w;
+}
+
+/**
+ * Boxes \p v into \p val, using \p bv or \p b as storage.
+ */
+static inline void val_small(RzILVal *val, RzBitVector *bv, RzILBool *b, RzILSortPure sort, ut64 v) {
+	val->type = sort.type;
+	if (sort.type == RZ_IL_TYPE_PURE_BOOL) {
+		b->b = v;
+		val->data.b = b;
+	} else {
+		bv_small(bv, sort.props.bv.length, v);
+		val->data.bv = bv;
+	}
+}
+
+static inline ut64 udiv(ut64 x, ut64 y, ut64 m) {
+	return y ? x / y : m;
+}
+
+static inline ut64 umod(ut64 x, ut64 y) {
+	return y ? x % y : x;
+}
+
+static inline bool msb(ut64 x, ut32 w) {
+	return (x >> (w - 1)) & 1;
+}
+
+// same as rz_bv_sdiv()
+static ut64 sdiv(ut64 x, ut64 y, ut32 w) {
+	ut64 m = width_mask(w);
+	bool mx = msb(x, w);
+	bool my = msb(y, w);
+	if (!mx && !my) {
+		return udiv(x, y, m);
+	} else if (mx && !my) {
+		return -udiv(-x & m, y, m) & m;
+	} else if (!mx && my) {
+		return -udiv(x, -y & m, m) & m;
+	}
+	return udiv(-x & m, -y & m, m);
+}
+
+// same as rz_bv_smod()
+static ut64 smod(ut64 x, ut64 y, ut32 w) {
+	ut64 m = width_mask(w);
+	bool mx = msb(x, w);
+	bool my = msb(y, w);
+	if (!mx && !my) {
+		return umod(x, y);
+	} else if (mx && !my) {
+		return -umod(-x & m, y) & m;
+	} else if (!mx && my) {
+		return -umod(x, -y & m) & m;
+	}
+	return -umod(-x & m, -y & m) & m;
+}
+
+static void perform_jump(RzILVM *vm, RZ_OWN RzBitVector *dst) {
+	rz_il_vm_event_add(vm, rz_il_event_pc_write_new(vm->pc, dst));
+	rz_bv_free(vm->pc);
+	vm->pc = dst;
+}
+
+/**
+ * Makes the locals visible to a hook and takes back their values after it.
+ */
+static bool call_hook(RzILVM *vm, RzILBytecode *bc, RzILEffectLabel *label, RzILOpEffect *op) {
+	ut64 *r = bc->regs;
+	BcLocal *l;
+	rz_vector_foreach (&bc->locals, l) {
+		if (!l->defined) {
+			continue;
+		}
+		RzBitVector bv;
+		RzILBool b;
+		RzILVal val;
+		val_small(&val, &bv, &b, l->sort, r[l->reg]);
+		rz_il_vm_set_local_var(vm, l->name, rz_il_value_dup(&val));
+	}
+	RzILVmHook hook = (RzILVmHook)label->hook;
+	hook(vm, op);
+	rz_vector_foreach (&bc->locals, l) {
+		RzILVal *val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_LOCAL, l->name);
+		if (val && rz_il_sort_pure_eq(rz_il_value_get_sort(val), l->sort)) {
+			r[l->reg] = val_get(val);
+			l->defined = true;
+		}
+	}
+	// the hook may have replaced the values of the globals
+	return rz_il_bytecode_bind(vm, bc);
+}
+
+static bool read_local(RzILVM *vm, RzILBytecode *bc, BcLocal *l, ut64 *out) {
+	if (l->defined) {
+		*out = bc->regs[l->reg];
+		return true;
+	}
+	// set before this step, like the tree evaluator would see it
+	RzILVal *val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_LOCAL, l->name);
+	if (!val || !rz_il_sort_pure_eq(rz_il_value_get_sort(val), l->sort)) {
+		RZ_LOG_ERROR("RzIL: reading value of variable \"%s\" of kind %s failed.\n",
+			l->name, rz_il_var_kind_name(RZ_IL_VAR_KIND_LOCAL));
+		return false;
+	}
+	*out = val_get(val);
+	return true;
+}
+
+/**
+ * Runs the bytecode, rz_il_bytecode_bind() must have been called before.
+ */
+RZ_IPI bool rz_il_bytecode_run(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILBytecode *bc) {
+	const BcInsn *code = bc->code.a;
+	const ut32 n_code = rz_vector_len(&bc->code);
+	BcGlobal *globals = bc->globals.a;
+	BcLocal *locals = bc->locals.a;
+	ut64 *r = bc->regs;
+	for (ut32 i = 0; i < rz_vector_len(&bc->locals); i++) {
+		locals[i].defined = false;
+	}
+
+	ut32 pc = 0;
+	while (pc < n_code) {
+		const BcInsn *in = &code[pc++];
+		const ut64 m = width_mask(in->w);
+		bool ok = true;
+		switch (in->code) {
+		case BC_CONST:
+			r[in->d] = in->imm;
+			break;
+		case BC_MOV:
+			r[in->d] = r[in->a];
+			break;
+		case BC_GVAR: {
+			BcGlobal *g = &globals[in->imm];
+			rz_il_vm_event_add(vm, rz_il_event_var_read_new(g->name, g->val));
+			r[in->d] = val_get(g->val);
+			break;
+		}
+		case BC_LVAR:
+			ok = read_local(vm, bc, &locals[in->imm], &r[in->d]);
+			break;
+		case BC_NEG:
+			r[in->d] = -r[in->a] & m;
+			break;
+		case BC_NOT:
+			r[in->d] = ~r[in->a] & m;
+			break;
+		case BC_ADD:
+			r[in->d] = (r[in->a] + r[in->b]) & m;
+			break;
+		case BC_SUB:
+			r[in->d] = (r[in->a] - r[in->b]) & m;
+			break;
+		case BC_MUL:
+			r[in->d] = (r[in->a] * r[in->b]) & m;
+			break;
+		case BC_DIV:
+			if (!r[in->b]) {
+				rz_il_vm_event_add(vm, rz_il_event_exception_new("division by zero"));
+			}
+			r[in->d] = udiv(r[in->a], r[in->b], m);
+			break;
+		case BC_SDIV:
+			r[in->d] = sdiv(r[in->a], r[in->b], in->w);
+			break;
+		case BC_MOD:
+			r[in->d] = umod(r[in->a], r[in->b]);
+			break;
+		case BC_SMOD:
+			r[in->d] = smod(r[in->a], r[in->b], in->w);
+			break;
+		case BC_AND:
+			r[in->d] = r[in->a] & r[in->b];
+			break;
+		case BC_OR:
+			r[in->d] = r[in->a] | r[in->b];
+			break;
+		case BC_XOR:
+			r[in->d] = r[in->a] ^ r[in->b];
+			break;
+		case BC_INV:
+			r[in->d] = !r[in->a];
+			break;
+		case BC_SHL:
+		case BC_SHR: {
+			// same as rz_bv_lshift_fill() and rz_bv_rshift_fill() with the amount truncated to 32 bits
+			ut32 s = (ut32)r[in->b];
+			ut64 x = r[in->a];
+			bool fill = r[in->c];
+			if (!s) {
+				r[in->d] = x;
+			} else if (s >= in->w) {
+				r[in->d] = fill ? m : 0;
+			} else if (in->code == BC_SHL) {
+				r[in->d] = ((x << s) | (fill ? width_mask(s) : 0)) & m;
+			} else {
+				r[in->d] = (x >> s) | (fill ? m & ~(m >> s) : 0);
+			}
+			break;
+		}
+		case BC_EQ:
+			r[in->d] = r[in->a] == r[in->b];
+			break;
+		case BC_ULE:
+			r[in->d] = r[in->a] <= r[in->b];
+			break;
+		case BC_SLE: {
+			bool mx = msb(r[in->a], in->w);
+			bool my = msb(r[in->b], in->w);
+			r[in->d] = mx == my ? r[in->a] <= r[in->b] : mx;
+			break;
+		}
+		case BC_MSB:
+			r[in->d] = msb(r[in->a], in->w);
+			break;
+		case BC_LSB:
+			r[in->d] = r[in->a] & 1;
+			break;
+		case BC_IS_ZERO:
+			r[in->d] = !r[in->a];
+			break;
+		case BC_CAST: {
+			ut64 low = width_mask(in->imm);
+			r[in->d] = (r[in->a] & low) | (r[in->c] ? m & ~low : 0);
+			break;
+		}
+		case BC_APPEND:
+			r[in->d] = (r[in->a] << in->imm) | r[in->b];
+			break;
+		case BC_LOAD:
+		case BC_LOADW: {
+			RzBitVector key;
+			bv_small(&key, in->w2, r[in->a]);
+			RzBitVector *val = in->code == BC_LOAD
+				? rz_il_vm_mem_load(vm, in->imm, &key)
+				: rz_il_vm_mem_loadw(vm, in->imm, &key, in->w);
+			if (!val || rz_bv_len(val) != in->w) {
+				ok = false;
+			} else {
+				r[in->d] = rz_bv_to_ut64(val);
+			}
+			rz_bv_free(val);
+			break;
+		}
+		case BC_STORE:
+		case BC_STOREW: {
+			RzBitVector key, val;
+			bv_small(&key, in->w2, r[in->a]);
+			bv_small(&val, in->w, r[in->b]);
+			if (in->code == BC_STORE) {
+				rz_il_vm_mem_store(vm, in->imm, &key, &val);
+			} else {
+				rz_il_vm_mem_storew(vm, in->imm, &key, &val);
+			}
+			break;
+		}
+		case BC_SETG: {
+			BcGlobal *g = &globals[in->imm];
+			RzBitVector bv;
+			RzILBool b;
+			RzILVal val;
+			val_small(&val, &bv, &b, g->sort, r[in->b]);
+			rz_il_vm_event_add(vm, rz_il_event_var_write_new(g->name, g->val, &val));
+			val_set(g->val, r[in->b]);
+			break;
+		}
+		case BC_SETL: {
+			BcLocal *l = &locals[in->imm];
+			r[l->reg] = r[in->b];
+			l->defined = true;
+			break;
+		}
+		case BC_JMP:
+			perform_jump(vm, rz_bv_new_from_ut64(in->w, r[in->a]));
+			break;
+		case BC_GOTO: {
+			const char *name = rz_pvector_at(&bc->labels, in->a);
+			RzILEffectLabel *label = rz_il_vm_find_label_by_name(vm, name);
+			if (!label) {
+				ok = false;
+			} else if (label->type == EFFECT_LABEL_SYSCALL || label->type == EFFECT_LABEL_HOOK) {
+				ok = call_hook(vm, bc, label, rz_pvector_at(&bc->gotos, in->imm));
+				globals = bc->globals.a;
+			} else {
+				perform_jump(vm, rz_bv_dup(label->addr));
+			}
+			break;
+		}
+		case BC_LABEL:
+			rz_il_vm_create_label(vm, rz_pvector_at(&bc->labels, in->imm), vm->pc);
+			break;
+		case BC_EMPTY: {
+			char *s = rz_bv_as_hex_string(vm->pc, true);
+			RZ_LOG_INFO("Encountered an empty instruction at %s\n", s);
+			free(s);
+			break;
+		}
+		case BC_BR:
+			pc = in->imm;
+			break;
+		case BC_BRF:
+			if (!r[in->a]) {
+				pc = in->imm;
+			}
+			break;
+		default:
+			rz_warn_if_reached();
+			return false;
+		}
+		if (ok) {
+			continue;
+		}
+		BcRegion *region;
+		bool handled = false;
+		rz_vector_foreach (&bc->regions, region) {
+			if (pc - 1 >= region->start && pc - 1 < region->end) {
+				pc = region->exit;
+				handled = true;
+				break;
+			}
+		}
+		if (!handled) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -8,6 +8,9 @@
 
 #include <rz_il/rz_il_vm.h>
 
+// il_bytecode.c
+RZ_IPI bool rz_il_bytecode_run(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILBytecode *bc);
+
 // Handler for core theory opcodes
 void *rz_il_handler_ite(RzILVM *vm, RzILOpPure *op, RzILTypePure *type);
 void *rz_il_handler_var(RzILVM *vm, RzILOpPure *op, RzILTypePure *type);
@@ -299,9 +302,7 @@ RZ_API void rz_il_vm_clear_events(RzILVM *vm) {
  * \param op_list, a list of op roots.
  * \param fallthrough_addr initial address to set PC to. Thus also the address to "step to" if no explicit jump occurs.
  */
-RZ_API bool rz_il_vm_step(RzILVM *vm, RzILOpEffect *op, ut64 fallthrough_addr) {
-	rz_return_val_if_fail(vm && op, false);
-
+static void step_begin(RzILVM *vm, ut64 fallthrough_addr) {
 	rz_il_vm_clear_events(vm);
 
 	// Set the successor pc **before** evaluating. Any jmp/goto may then overwrite it again.
@@ -309,7 +310,12 @@ RZ_API bool rz_il_vm_step(RzILVM *vm, RzILOpEffect *op, ut64 fallthrough_addr) {
 	rz_il_vm_event_add(vm, rz_il_event_pc_write_new(vm->pc, next_pc));
 	rz_bv_free(vm->pc);
 	vm->pc = next_pc;
+}
+
+RZ_API bool rz_il_vm_step(RzILVM *vm, RzILOpEffect *op, ut64 fallthrough_addr) {
+	rz_return_val_if_fail(vm && op, false);
 
+	step_begin(vm, fallthrough_addr);
 	bool succ = rz_il_evaluate_effect(vm, op);
 
 	// remove any local defined variable (local pure vars are unbound automatically)
@@ -317,6 +323,21 @@ RZ_API bool rz_il_vm_step(RzILVM *vm, RzILOpEffect *op, ut64 fallthrough_addr) {
 	return succ;
 }
 
+/**
+ * \brief Same as rz_il_vm_step(), but executes an op compiled with rz_il_bytecode_compile()
+ *
+ * rz_il_bytecode_bind() must have succeeded right before.
+ */
+RZ_API bool rz_il_vm_step_bytecode(RzILVM *vm, RzILBytecode *bc, ut64 fallthrough_addr) {
+	rz_return_val_if_fail(vm && bc, false);
+
+	step_begin(vm, fallthrough_addr);
+	bool succ = rz_il_bytecode_run(vm, bc);
+
+	rz_il_var_set_reset(&vm->local_vars);
+	return succ;
+}
+
 static void *eval_pure(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILOpPure *op, RZ_NONNULL RzILTypePure *type) {
 	rz_return_val_if_fail(vm && op && type, NULL);
 	RzILOpPureHandler handler = vm->op_handler_pure_table[op->code];
@@ -461,6 +461,27 @@ typedef struct {
 	RzSetU *visited;
 } RzAnalysisDebugInfo;
 
+#define RZ_ANALYSIS_OP_CACHE_BYTES 32
+
+typedef struct rz_analysis_op_cache_entry_t RzAnalysisOpCacheEntry;
+
+/**
+ * \brief Cache of the ops decoded by rz_analysis_op()
+ */
+typedef struct rz_analysis_op_cache_t {
+	RzAnalysisOpCacheEntry *entries; ///< direct mapped by address, allocated on first use
+	size_t size; ///< number of entries, a power of 2 (0 disables the cache)
+	ut64 gen; ///< bumped every time the cached ops may have become stale
+	ut64 range_gen; ///< bumped every time the cached ops of a range may have become stale
+	ut64 hits;
+	ut64 misses;
+} RzAnalysisOpCache;
+
+/**
+ * \brief Store of the xrefs, sorted by (from, to) and by (to, from)
+ */
+typedef struct rz_analysis_xrefs_t RzAnalysisXRefs;
+
 typedef struct rz_analysis_t {
 	void *core;
 	ut8 ptr_alignment_I;
@@ -500,8 +521,7 @@ typedef struct rz_analysis_t {
 	HtSP /*<RzAnalysisPlugin *>*/ *plugins;
 	Sdb *sdb_noret;
 	Sdb *sdb_fmts;
-	HtUP *ht_xrefs_from;
-	HtUP *ht_xrefs_to;
+	RzAnalysisXRefs *xrefs;
 	bool recursive_noreturn; // analysis.rnr
 	// moved from RzAnalysisFcn
 	Sdb *sdb; // root
@@ -540,6 +560,7 @@ typedef struct rz_analysis_t {
 	RzAnalysisDebugInfo *debug_info; ///< store all debug info parsed from DWARF, etc..
 	ut64 cmpval; ///< last compare value for jump table.
 	ut64 lea_jmptbl_ip; ///< jump table x86 lea ip
+	RzAnalysisOpCache opcache; ///< analysis.opcache
 } RzAnalysis;
 
 typedef enum rz_analysis_addr_hint_type_t {
@@ -1177,6 +1198,7 @@ typedef struct rz_analysis_esil_t {
 	ut8 lastsz; // in bits //used for signature-flag
 	/* native ops and custom ops */
 	HtSP *ops;
+	HtSP /*<char *, EsilProgram *>*/ *parse_cache; ///< expressions already split into words by rz_analysis_esil_parse()
 	RzStrBuf current_opstr;
 	RzIDStorage *sources;
 	HtUP *interrupts;
@@ -1283,6 +1305,7 @@ struct rz_analysis_il_vm_t {
 	RZ_NONNULL RzILVM *vm; ///< low-level vm to execute IL code
 	RZ_NONNULL RzBuffer *io_buf; ///< buffer to use for memory 0 (io)
 	RZ_NONNULL RzILRegBinding *reg_binding; ///< specifies which (global) variables are bound to registers
+	RZ_NULLABLE HtUP /*<ut64, RzAnalysisILBytecodeEntry *>*/ *bytecode; ///< ops compiled to bytecode by address, see rz_il_bytecode_compile()
 } /* RzAnalysisILVM */;
 
 typedef enum {
@@ -1370,6 +1393,7 @@ typedef struct rz_analysis_plugin_t {
 	int bits;
 	int esil; // can do esil or not
 	int fileformat_type;
+	bool cacheable; ///< op() only depends on the bytes, the address and the RzAnalysis settings, so its ops can be cached
 	bool (*init)(void **user);
 	bool (*fini)(void *user);
 	// int (*reset_counter) (RzAnalysis *analysis, ut64 start_addr);
@@ -1617,6 +1641,12 @@ RZ_API RzStackAddr rz_analysis_op_apply_sp_effect(RzAnalysisOp *op, RzStackAddr
 RZ_API RZ_NULLABLE RZ_OWN char *rz_analysis_op_describe_sp_effect(RzAnalysisOp *op);
 RZ_API RzAnalysisOp *rz_analysis_op_new(void);
 RZ_API void rz_analysis_op_free(void *op);
+
+/* op_cache.c */
+RZ_API void rz_analysis_op_cache_invalidate(RZ_NONNULL RzAnalysis *analysis);
+RZ_API void rz_analysis_op_cache_invalidate_range(RZ_NONNULL RzAnalysis *analysis, ut64 addr, ut64 size);
+RZ_API void rz_analysis_op_cache_set_size(RZ_NONNULL RzAnalysis *analysis, size_t size);
+RZ_API void rz_analysis_op_cache_fini(RZ_NONNULL RzAnalysis *analysis);
 RZ_API void rz_analysis_op_init(RzAnalysisOp *op);
 RZ_API bool rz_analysis_op_fini(RzAnalysisOp *op);
 RZ_API int rz_analysis_op_reg_delta(RzAnalysis *analysis, ut64 addr, const char *name);
@@ -1797,6 +1827,11 @@ RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_list(RzAnalysis *
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_from(const RzAnalysisFunction *fcn);
 RZ_API RZ_OWN RzList /*<RzAnalysisXRef *>*/ *rz_analysis_function_get_xrefs_to(const RzAnalysisFunction *fcn);
 RZ_API bool rz_analysis_xrefs_set(RzAnalysis *analysis, ut64 from, ut64 to, RzAnalysisXRefType type);
+RZ_API size_t rz_analysis_xrefs_set_bulk(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const RzAnalysisXRef *xrefs, size_t n);
+RZ_API RZ_OWN RzIterator /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_to_iter(RZ_NONNULL RzAnalysis *analysis, ut64 addr);
+RZ_API RZ_OWN RzIterator /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_get_from_iter(RZ_NONNULL RzAnalysis *analysis, ut64 addr);
+RZ_API RZ_OWN RzIterator /*<RzAnalysisXRef *>*/ *rz_analysis_xrefs_iter(RZ_NONNULL RzAnalysis *analysis);
+RZ_API ut64 rz_analysis_xrefs_memory_usage(RZ_NONNULL RzAnalysis *analysis);
 RZ_API bool rz_analysis_xrefs_deln(RzAnalysis *analysis, ut64 from, ut64 to, RzAnalysisXRefType type);
 RZ_API bool rz_analysis_xref_del(RzAnalysis *analysis, ut64 from, ut64 to);
 
@@ -283,8 +283,17 @@ typedef struct rz_bin_file_load_options_t {
 	bool elf_load_sections; ///< ELF specific, load or not ELF sections
 	bool elf_checks_sections; ///< ELF specific, checks or not ELF sections
 	bool elf_checks_segments; ///< ELF specific, checks or not ELF sections
+	bool lazy; ///< defer loading the strings and the fields until they are requested
 } RzBinObjectLoadOptions;
 
+/**
+ * \brief Items of a RzBinObject which can be loaded on demand (see RzBinObjectLoadOptions.lazy)
+ */
+typedef enum {
+	RZ_BIN_OBJECT_LAZY_STRINGS = 1 << 0,
+	RZ_BIN_OBJECT_LAZY_FIELDS = 1 << 1,
+} RzBinObjectLazyItem;
+
 typedef struct rz_bin_string_database_t RzBinStrDb;
 
 typedef struct rz_bin_object_t {
@@ -323,6 +332,9 @@ typedef struct rz_bin_object_t {
 	RzBinLanguage lang;
 	RZ_DEPRECATE RZ_BORROW Sdb *kv; ///< deprecated, put info in C structures instead of this (holds a copy of another pointer.)
 	void *bin_obj; // internal pointer used by formats
+	RZ_BORROW RzBinFile *bf; ///< file owning the object, used to load the lazy items
+	ut32 lazy_pending; ///< RzBinObjectLazyItem bits of the items not loaded yet
+	RzThreadLock *lazy_lock; ///< guards the loading of the lazy items, NULL when nothing is lazy
 } RzBinObject;
 
 // XXX: RbinFile may hold more than one RzBinObject
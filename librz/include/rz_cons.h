@@ -498,6 +498,11 @@ typedef struct rz_cons_context_t {
 	int row;
 	int col;
 	int rowcol_calc_start;
+
+	// Streaming of big outputs, see rz_cons_stream_flush()
+	bool streamed; ///< part of the output has already been written out
+	bool stream_grep; ///< the grep has been parsed before running the command
+	int stream_hold; ///< streaming is suspended while > 0
 } RzConsContext;
 
 #define HUD_BUF_SIZE 512
@@ -572,6 +577,7 @@ typedef struct rz_cons_t {
 	RZ_DEPRECATE bool newline;
 	RzVirtTermMode vtmode;
 	bool flush;
+	bool stream; // write out big outputs while they are produced
 	bool use_utf8; // use utf8 features
 	bool use_utf8_curvy; // use utf8 curved corners
 	bool dotted_lines;
@@ -966,6 +972,7 @@ RZ_API int rz_cons_memcat(const char *str, int len);
 RZ_API void rz_cons_newline(void);
 RZ_API void rz_cons_filter(void);
 RZ_API void rz_cons_flush(void);
+RZ_API void rz_cons_stream_flush(void);
 RZ_API void rz_cons_set_flush(bool flush);
 RZ_API void rz_cons_last(void);
 RZ_API int rz_cons_less_str(const char *str, const char *exitkeys);
@@ -1024,6 +1031,8 @@ RZ_API void rz_cons_grep_help(void);
 RZ_API void rz_cons_grep_parsecmd(char *cmd, const char *quotestr);
 RZ_API char *rz_cons_grep_strip(char *cmd, const char *quotestr);
 RZ_API void rz_cons_grep_process(RZ_OWN char *grep);
+RZ_API bool rz_cons_grep_stream_begin(RZ_NONNULL const char *grep);
+RZ_API void rz_cons_grep_stream_end(bool parsed);
 RZ_API int rz_cons_grep_line(char *buf, int len); // must be static
 RZ_API void rz_cons_grepbuf(void);
 
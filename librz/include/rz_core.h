@@ -338,6 +338,7 @@ struct rz_core_t {
 	RzList /*<char *>*/ *ropchain;
 	RzCoreSeekHistory seek_history;
 	RzHash *hash;
+	RzFlirtCache *flirt_cache; ///< FLIRT indexes of the applied signature files
 
 	bool marks_init;
 	ut64 marks[UT8_MAX + 1];
@@ -580,6 +581,9 @@ RZ_API void rz_core_debug_set_register_flags(RzCore *core);
 RZ_API void rz_core_debug_clear_register_flags(RzCore *core);
 
 RZ_API bool rz_core_debug_process_close(RzCore *core);
+RZ_API ut64 rz_core_debug_coverage_add_functions(RZ_NONNULL RzCore *core);
+RZ_API void rz_core_debug_coverage_print(RZ_NONNULL RzCore *core, RZ_NONNULL RzCmdStateOutput *state);
+RZ_API bool rz_core_debug_coverage_drcov(RZ_NONNULL RzCore *core, RZ_NONNULL const char *file);
 RZ_API bool rz_core_debug_step_until_frame(RzCore *core);
 RZ_API bool rz_core_debug_step_back(RzCore *core, int steps);
 RZ_API bool rz_core_debug_step_over(RzCore *core, int steps);
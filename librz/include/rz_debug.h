@@ -115,6 +115,7 @@ typedef enum {
 	RZ_DEBUG_REASON_INT,
 	RZ_DEBUG_REASON_FPU,
 	RZ_DEBUG_REASON_USERSUSP,
+	RZ_DEBUG_REASON_COVERAGE, ///< a coverage trap has been hit and removed, the inferior can go on
 } RzDebugReasonType;
 
 /* TODO: move to rz_analysis */
@@ -182,10 +183,34 @@ typedef struct {
 	ut8 data;
 } RzDebugChangeMem;
 
+#define RZ_DEBUG_SESSION_PAGE_SIZE 0x1000
+
+/**
+ * \brief Memory page saved by the checkpoints of a session
+ *
+ * Pages are deduplicated by content, so a page which does not change
+ * between two checkpoints is stored only once and shared by both.
+ */
+typedef struct rz_debug_page_t {
+	ut32 hash; ///< hash of the uncompressed content
+	ut32 refs; ///< number of checkpoints referencing the page
+	ut32 len; ///< size of the uncompressed content
+	ut32 size; ///< size of data
+	bool compressed; ///< data is deflated
+	ut8 *data;
+	struct rz_debug_page_t *next; ///< next page with the same hash
+} RzDebugPage;
+
+typedef struct {
+	ut64 addr;
+	RzDebugPage *page;
+} RzDebugCheckpointPage;
+
 typedef struct rz_debug_checkpoint_t {
 	int cnum;
 	RzRegArena *arena[RZ_REG_TYPE_LAST];
-	RzList /*<RzDebugSnap *>*/ *snaps;
+	RzList /*<RzDebugSnap *>*/ *snaps; ///< saved maps, their content is in pages
+	RzVector /*<RzDebugCheckpointPage>*/ *pages; ///< sorted by address
 } RzDebugCheckpoint;
 
 typedef struct rz_debug_session_t {
@@ -194,7 +219,10 @@ typedef struct rz_debug_session_t {
 	RzDebugCheckpoint *cur_chkpt;
 	RzVector /*<RzDebugCheckpoint>*/ *checkpoints;
 	HtUP *memory; /* RzVector<RzDebugChangeMem> */
+	HtUP *memory_pages; /* memory changes indexed by page */
 	HtUP *registers; /* RzVector<RzDebugChangeReg> */
+	HtUP *pages; /* RzDebugPage by hash */
+	bool compress_pages; ///< deflate the pages saved by new checkpoints
 	int reasontype /*RzDebugReasonType*/;
 	RzBreakpointItem *bp;
 } RzDebugSession;
@@ -237,6 +265,32 @@ typedef struct rz_debug_tracepoint_t {
 	ut64 stamp;
 } RzDebugTracepoint;
 
+#define RZ_DEBUG_COVERAGE_TRAP_MAX 8
+
+/**
+ * \brief Basic block traced by the coverage tracer
+ */
+typedef struct rz_debug_coverage_block_t {
+	ut64 addr;
+	ut32 size;
+	ut8 trap_size;
+	ut8 trap[RZ_DEBUG_COVERAGE_TRAP_MAX]; ///< software breakpoint placed at addr
+	ut8 orig[RZ_DEBUG_COVERAGE_TRAP_MAX]; ///< original bytes at addr
+} RzDebugCoverageBlock;
+
+/**
+ * \brief Basic block coverage collected with one-shot software breakpoints
+ */
+typedef struct rz_debug_coverage_t {
+	RzVector /*<RzDebugCoverageBlock>*/ blocks; ///< sorted by address, traps never overlap
+	RzVector /*<RzDebugCoverageBlock>*/ pending; ///< blocks added since blocks was last sorted
+	ut8 *hits; ///< one bit per block, set once the block has been executed
+	ut8 *armed; ///< one bit per block, set while the trap of the block is in memory
+	ut64 n_hits;
+	ut64 n_armed;
+	int pid; ///< process holding the traps or -1
+} RzDebugCoverage;
+
 typedef struct rz_debug_t {
 	char *arch;
 	RZ_DEPRECATE int bits; ///< bad indicator for the bitness of the debuggee
@@ -278,6 +332,7 @@ typedef struct rz_debug_t {
 
 	/* tracing vars */
 	RzDebugTrace *trace;
+	RzDebugCoverage *coverage; ///< basic block coverage, NULL when not collected
 	HtUP *tracenodes;
 	RTree *tree;
 	RzList /*<RzDebugFrame *>*/ *call_frames;
@@ -569,6 +624,16 @@ RZ_API RzDebugTracepoint *rz_debug_trace_add(RzDebug *dbg, ut64 addr, int size);
 RZ_API RzDebugTrace *rz_debug_trace_new(void);
 RZ_API void rz_debug_trace_free(RzDebugTrace *dbg);
 RZ_API int rz_debug_trace_tag(RzDebug *dbg, int tag);
+
+/* coverage */
+RZ_API void rz_debug_coverage_free(RZ_NULLABLE RzDebugCoverage *cov);
+RZ_API void rz_debug_coverage_reset(RZ_NONNULL RzDebug *dbg);
+RZ_API bool rz_debug_coverage_add(RZ_NONNULL RzDebug *dbg, ut64 addr, ut32 size);
+RZ_API bool rz_debug_coverage_restore(RZ_NONNULL RzDebug *dbg, bool set);
+RZ_API bool rz_debug_coverage_hit(RZ_NONNULL RzDebug *dbg, ut64 addr);
+RZ_API bool rz_debug_coverage_trap_at(RZ_NONNULL RzDebug *dbg, ut64 pc, RZ_NONNULL ut64 *addr);
+RZ_API bool rz_debug_coverage_stats(RZ_NONNULL RzDebug *dbg, RZ_NULLABLE ut64 *blocks, RZ_NULLABLE ut64 *covered);
+RZ_API RZ_OWN RzPVector /*<RzDebugCoverageBlock *>*/ *rz_debug_coverage_covered(RZ_NONNULL RzDebug *dbg);
 RZ_API int rz_debug_child_fork(RzDebug *dbg);
 RZ_API int rz_debug_child_clone(RzDebug *dbg);
 
@@ -598,6 +663,10 @@ RZ_API void rz_debug_session_serialize(RzDebugSession *session, Sdb *db);
 RZ_API void rz_debug_session_deserialize(RzDebugSession *session, Sdb *db);
 RZ_API bool rz_debug_session_save(RzDebugSession *session, const char *file);
 RZ_API bool rz_debug_session_load(RzDebug *dbg, const char *file);
+RZ_API bool rz_debug_session_write(RZ_NONNULL RzDebugSession *session, RZ_NONNULL RzBuffer *b);
+RZ_API bool rz_debug_session_read(RZ_NONNULL RzDebugSession *session, RZ_NONNULL RzBuffer *b);
+RZ_API bool rz_debug_checkpoint_add_memory(RZ_NONNULL RzDebugSession *session, RZ_NONNULL RzDebugCheckpoint *checkpoint, ut64 addr, RZ_NONNULL const ut8 *buf, ut64 size);
+RZ_API bool rz_debug_checkpoint_read(RZ_NONNULL const RzDebugCheckpoint *checkpoint, ut64 addr, RZ_NONNULL ut8 *buf, ut64 size);
 RZ_API bool rz_debug_trace_ins_before(RzDebug *dbg);
 RZ_API bool rz_debug_trace_ins_after(RZ_NONNULL RzDebug *dbg);
 
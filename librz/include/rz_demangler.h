@@ -25,7 +25,7 @@ typedef struct rz_demangler_plugin_t {
 	const char *language; ///< demangler language
 	const char *author; ///< demangler author
 	const char *license; ///< demangler license
-	RzDemanglerPluginCb demangle; ///< demangler method to resolve the mangled symbol
+	RzDemanglerPluginCb demangle; ///< demangler method to resolve the mangled symbol (reentrant for the static plugins, see rz_demangler_plugin_is_static())
 } RzDemanglerPlugin;
 
 typedef struct rz_demangler_t {
@@ -51,6 +51,7 @@ RZ_API RzDemanglerFlag rz_demangler_get_flags(RZ_NONNULL RzDemangler *demangler)
 RZ_API void rz_demangler_plugin_iterate(RZ_NONNULL RzDemangler *demangler, RZ_NONNULL RzDemanglerIter iter, RZ_NULLABLE void *data);
 RZ_API bool rz_demangler_plugin_add(RZ_NONNULL RzDemangler *demangler, RZ_NONNULL RzDemanglerPlugin *plugin);
 RZ_API bool rz_demangler_plugin_del(RZ_NONNULL RzDemangler *demangler, RZ_NONNULL RzDemanglerPlugin *plugin);
+RZ_API bool rz_demangler_plugin_is_static(RZ_NONNULL const RzDemanglerPlugin *plugin);
 RZ_API RZ_BORROW const RzDemanglerPlugin *rz_demangler_plugin_get(RZ_NONNULL RzDemangler *demangler, RZ_NONNULL const char *language);
 RZ_API bool rz_demangler_resolve(RZ_NONNULL RzDemangler *demangler, RZ_NULLABLE const char *symbol, RZ_NONNULL const char *language, RZ_NONNULL RZ_OWN char **output);
 
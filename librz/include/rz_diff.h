@@ -69,6 +69,20 @@ typedef bool (*RzDiffIgnoreLine)(RZ_BORROW const char *line);
 
 typedef struct rz_diff_t RzDiff;
 
+/**
+ * Operation produced by rz_diff_bytes_stream(); same as RzDiffOp
+ * but with 64 bit offsets, so that it can describe big inputs.
+ */
+typedef struct rz_diff_bytes_op_t {
+	RzDiffOpType type;
+	ut64 a_beg;
+	ut64 a_end;
+	ut64 b_beg;
+	ut64 b_end;
+} RzDiffBytesOp;
+
+typedef bool (*RzDiffBytesOpCallback)(RZ_BORROW const RzDiffBytesOp *op, RZ_NULLABLE void *user);
+
 #ifdef RZ_API
 
 /* To calculate the hash of a complex structure made of
@@ -77,6 +91,7 @@ RZ_API ut32 rz_diff_hash_data(RZ_NULLABLE const ut8 *buffer, ut32 size);
 
 RZ_API RZ_OWN RzDiff *rz_diff_bytes_new(RZ_BORROW const ut8 *a, ut32 a_size, RZ_BORROW const ut8 *b, ut32 b_size, RZ_NULLABLE RzDiffIgnoreByte ignore);
 RZ_API RZ_OWN RzDiff *rz_diff_lines_new(RZ_BORROW const char *a, RZ_BORROW const char *b, RZ_NULLABLE RzDiffIgnoreLine ignore);
+RZ_API bool rz_diff_bytes_stream(RZ_NONNULL const ut8 *a, ut64 a_size, RZ_NONNULL const ut8 *b, ut64 b_size, ut32 block_size, RZ_NONNULL RzDiffBytesOpCallback cb, RZ_NULLABLE void *user);
 RZ_API RZ_OWN RzDiff *rz_diff_generic_new(RZ_BORROW const void *a, ut32 a_size, RZ_BORROW const void *b, ut32 b_size, RZ_NONNULL RzDiffMethods *methods);
 RZ_API void rz_diff_free(RZ_NULLABLE RzDiff *diff);
 RZ_API RZ_BORROW const void *rz_diff_get_a(RZ_NONNULL RzDiff *diff);
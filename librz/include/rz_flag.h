@@ -50,10 +50,25 @@ typedef struct rz_flag_t {
 	Sdb *tags;
 	RzNum *num;
 	RzSkipList *by_off; /* flags sorted by offset, value=RzFlagsAtOffset */
-	HtSP *ht_name; /* hashmap key=item name, value=RzFlagItem * */
+	HtSP *ht_name; /* hashmap key=item name (borrowed from the item), value=RzFlagItem * */
 	RzList /*<RzFlagZoneItem *>*/ *zones;
+	RzPVector /*<RzFlagItem *>*/ *item_blocks; /* arena the flag items are allocated from */
+	ut32 item_blocks_used; /* number of items taken from the last block */
+	RzPVector /*<RzFlagItem *>*/ *free_items; /* unset items to reuse */
 } RzFlag;
 
+/**
+ * \brief Flag to create through rz_flag_set_bulk()
+ */
+typedef struct rz_flag_bulk_item_t {
+	char *name; ///< name of the flag, filtered as in rz_flag_set()
+	char *realname; ///< real name of the flag, or NULL to use the name
+	bool demangled; ///< whether the real name comes from demangling
+	ut64 offset; ///< offset flagged by the item
+	ut64 size; ///< size of the flag item
+	RzSpace *space; ///< flag space of the item, or NULL for the current one
+} RzFlagBulkItem;
+
 /* compile time dependency */
 
 typedef bool (*RzFlagExistAt)(RzFlag *f, const char *flag_prefix, ut16 fp_size, ut64 off);
@@ -114,6 +129,7 @@ RZ_API void rz_flag_unset_all(RzFlag *f);
 RZ_API void rz_flag_unset_all_in_space(RzFlag *f, const char *space_name);
 RZ_API RzFlagItem *rz_flag_set(RzFlag *fo, const char *name, ut64 addr, ut32 size);
 RZ_API RzFlagItem *rz_flag_set_next(RzFlag *fo, const char *name, ut64 addr, ut32 size);
+RZ_API bool rz_flag_set_bulk(RZ_NONNULL RzFlag *f, RZ_NONNULL RzVector /*<RzFlagBulkItem>*/ *items);
 RZ_API void rz_flag_item_set_alias(RzFlagItem *item, const char *alias);
 RZ_API void rz_flag_item_free(RzFlagItem *item);
 RZ_API void rz_flag_item_set_comment(RzFlagItem *item, const char *comment);
@@ -221,6 +221,19 @@ RZ_API void rz_sign_flirt_info_fini(RZ_NULLABLE RzFlirtInfo *info);
 
 RZ_API bool rz_sign_flirt_apply(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const char *flirt_file, ut8 expected_arch);
 
+typedef struct rz_flirt_index_t RzFlirtIndex;
+typedef struct rz_flirt_cache_t RzFlirtCache;
+
+RZ_API RZ_OWN RzFlirtIndex *rz_sign_flirt_index_new(RZ_NONNULL RZ_OWN RzFlirtNode *root);
+RZ_API RZ_OWN RzFlirtIndex *rz_sign_flirt_index_load(RZ_NONNULL const char *flirt_file, ut8 expected_arch);
+RZ_API void rz_sign_flirt_index_free(RZ_NULLABLE RzFlirtIndex *index);
+RZ_API RZ_BORROW const RzFlirtModule *rz_sign_flirt_index_match(RZ_NONNULL const RzFlirtIndex *index, RZ_NONNULL const ut8 *b, ut32 b_size);
+RZ_API bool rz_sign_flirt_apply_indexes(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const RzPVector /*<RzFlirtIndex *>*/ *indexes);
+
+RZ_API RZ_OWN RzFlirtCache *rz_sign_flirt_cache_new(void);
+RZ_API void rz_sign_flirt_cache_free(RZ_NULLABLE RzFlirtCache *cache);
+RZ_API RZ_BORROW RzFlirtIndex *rz_sign_flirt_cache_get(RZ_NONNULL RzFlirtCache *cache, RZ_NONNULL const char *flirt_file, ut8 expected_arch);
+
 typedef struct rz_flirt_compressed_options_t {
 	ut8 version; ///< FLIRT version (supported only from v5 to v10)
 	ut8 arch; ///< FLIRT arch type (RZ_FLIRT_SIG_ARCH_*)
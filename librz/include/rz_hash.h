@@ -9,6 +9,7 @@
 #include <rz_util/ht_sp.h>
 #include <rz_util/rz_mem.h>
 #include <rz_util/rz_str.h>
+#include <rz_th.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -81,6 +82,7 @@ RZ_API bool rz_hash_cfg_configure(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const cha
 RZ_API bool rz_hash_cfg_hmac(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const ut8 *key, ut64 key_size);
 RZ_API bool rz_hash_cfg_init(RZ_NONNULL RzHashCfg *md);
 RZ_API bool rz_hash_cfg_update(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const ut8 *data, ut64 size);
+RZ_API bool rz_hash_cfg_update_mt(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const ut8 *data, ut64 size, RzThreadNCores max_threads);
 RZ_API bool rz_hash_cfg_final(RZ_NONNULL RzHashCfg *md);
 RZ_API bool rz_hash_cfg_iterate(RZ_NONNULL RzHashCfg *md, size_t iterate);
 RZ_API RZ_BORROW const ut8 *rz_hash_cfg_get_result(RZ_NONNULL RzHashCfg *md, RZ_NONNULL const char *name, RZ_NONNULL RzHashSize *size);
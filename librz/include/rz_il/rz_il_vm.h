@@ -101,6 +101,14 @@ RZ_API bool rz_il_evaluate_effect(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILOpEffect
 
 RZ_API bool rz_il_vm_step(RzILVM *vm, RzILOpEffect *op, ut64 fallthrough_addr);
 
+// Bytecode
+typedef struct rz_il_bytecode_t RzILBytecode;
+
+RZ_API RZ_OWN RzILBytecode *rz_il_bytecode_compile(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILOpEffect *op);
+RZ_API void rz_il_bytecode_free(RZ_NULLABLE RzILBytecode *bc);
+RZ_API bool rz_il_bytecode_bind(RZ_NONNULL RzILVM *vm, RZ_NONNULL RzILBytecode *bc);
+RZ_API bool rz_il_vm_step_bytecode(RzILVM *vm, RzILBytecode *bc, ut64 fallthrough_addr);
+
 #ifdef __cplusplus
 }
 #endif
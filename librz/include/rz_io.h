@@ -56,6 +56,20 @@ extern "C" {
 
 RZ_LIB_VERSION_HEADER(rz_io);
 
+#define RZ_IO_RCACHE_PAGE_SIZE 0x1000
+
+/**
+ * \brief Page granular read cache (see io_rcache.c)
+ */
+typedef struct rz_io_rcache_t {
+	ut64 max_pages; ///< maximum amount of cached pages, 0 when the cache is disabled
+	ut64 n_pages; ///< current amount of cached pages
+	ut64 hits; ///< amount of page lookups served by the cache
+	ut64 misses; ///< amount of page lookups which required a plugin read
+	struct rz_io_rcache_page_t *lru_head; ///< most recently used page
+	struct rz_io_rcache_page_t *lru_tail; ///< least recently used page
+} RzIORCache;
+
 typedef struct rz_io_t {
 	struct rz_io_desc_t *desc; // XXX deprecate... we should use only the fd integer, not hold a weak pointer
 	ut64 off;
@@ -75,6 +89,7 @@ typedef struct rz_io_t {
 	RzIDStorage *files;
 	RzPVector /*<RzIOCache *>*/ cache;
 	RzSkyline cache_skyline;
+	RzIORCache rcache;
 	ut8 *write_mask;
 	int write_mask_len;
 	HtSP /*<RzIOPlugin *>*/ *plugins;
@@ -83,6 +98,7 @@ typedef struct rz_io_t {
 #if USE_PTRACE_WRAP
 	struct ptrace_wrap_instance_t *ptrace_wrap;
 #endif
+	ut64 ptrace_epoch; ///< bumped by rz_io_ptrace() whenever the tracee may run or its memory may change
 #if __WINDOWS__
 	struct w32dbg_wrap_instance_t *priv_w32dbg_wrap; ///< Do not access this directly, use rz_io_get_w32dbg_wrap() instead!
 #endif
@@ -99,6 +115,7 @@ typedef struct rz_io_desc_t {
 	char *name;
 	char *referer;
 	HtUP /*<ut64, RzIODescCache *>*/ *cache;
+	HtUP /*<ut64, struct rz_io_rcache_page_t *>*/ *rcache;
 	void *data;
 	struct rz_io_plugin_t *plugin;
 	RzIO *io;
@@ -416,6 +433,14 @@ RZ_API void rz_io_desc_cache_fini(RzIODesc *desc);
 RZ_API void rz_io_desc_cache_fini_all(RzIO *io);
 RZ_API RzList /*<RzIOCache *>*/ *rz_io_desc_cache_list(RzIODesc *desc);
 
+/* io/io_rcache.c */
+RZ_API int rz_io_rcache_read(RZ_NONNULL RzIODesc *desc, ut64 addr, RZ_NONNULL RZ_OUT ut8 *buf, size_t len);
+RZ_API void rz_io_rcache_invalidate(RZ_NONNULL RzIODesc *desc, ut64 addr, ut64 len);
+RZ_API void rz_io_rcache_desc_fini(RZ_NONNULL RzIODesc *desc);
+RZ_API void rz_io_rcache_flush(RZ_NONNULL RzIO *io);
+RZ_API void rz_io_rcache_set_max_pages(RZ_NONNULL RzIO *io, ut64 max_pages);
+RZ_API void rz_io_rcache_reset_stats(RZ_NONNULL RzIO *io);
+
 /* io/fd.c */
 RZ_API int rz_io_fd_open(RzIO *io, const char *uri, int flags, int mode);
 RZ_API bool rz_io_fd_close(RzIO *io, int fd);
@@ -277,6 +277,9 @@ struct rz_magic_set {
 typedef struct rz_magic_set RzMagic;
 #endif
 
+typedef struct rz_magic_index_t RzMagicIndex;
+typedef bool (*RzMagicIndexCallback)(void *user, size_t offset);
+
 #ifdef RZ_API
 RZ_API RzMagic *rz_magic_new(int flags);
 RZ_API void rz_magic_free(RzMagic *);
@@ -293,6 +296,10 @@ RZ_API bool rz_magic_load_buffer(RzMagic *, const char *);
 RZ_API bool rz_magic_compile(RzMagic *, const char *);
 RZ_API bool rz_magic_check(RzMagic *, const char *);
 RZ_API int rz_magic_errno(RzMagic *);
+
+RZ_API RZ_OWN RzMagicIndex *rz_magic_index_new(RZ_NONNULL RzMagic *ms);
+RZ_API void rz_magic_index_free(RZ_NULLABLE RzMagicIndex *idx);
+RZ_API bool rz_magic_index_scan(RZ_NONNULL const RzMagicIndex *idx, RZ_NONNULL const ut8 *buf, size_t len, size_t size, size_t window, RZ_NONNULL RzMagicIndexCallback cb, RZ_NULLABLE void *user);
 #endif
 
 #endif
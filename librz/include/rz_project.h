@@ -28,10 +28,19 @@ typedef enum rz_project_err {
 	RZ_PROJECT_ERR_UNKNOWN
 } RzProjectErr;
 
+typedef enum rz_project_format {
+	RZ_PROJECT_FORMAT_TEXT, ///< sdb text, optionally compressed
+	RZ_PROJECT_FORMAT_BINARY, ///< same sdb tree, with a sorted table of entries per namespace, see project_bin.c
+} RzProjectFormat;
+
+typedef struct rz_project_bin_t RzProjectBin;
+
 RZ_API RZ_NONNULL const char *rz_project_err_message(RzProjectErr err);
 RZ_API RzProjectErr rz_project_save(RzCore *core, RzProject *prj, const char *file);
 RZ_API RzProjectErr rz_project_save_file(RzCore *core, const char *file, bool compress);
+RZ_API RzProjectErr rz_project_write_file(RZ_NONNULL RzProject *prj, RZ_NONNULL const char *file, RzProjectFormat format, bool compress);
 RZ_API RzProject *rz_project_load_file_raw(const char *file);
+RZ_API RzProjectErr rz_project_version(RZ_NONNULL RzProject *prj, RZ_NONNULL RZ_OUT unsigned long *version);
 RZ_API void rz_project_free(RzProject *prj);
 
 /**
@@ -64,6 +73,15 @@ RZ_API bool rz_project_migrate_v15_v16(RzProject *prj, RzSerializeResultInfo *re
 RZ_API bool rz_project_migrate_v16_v17(RzProject *prj, RzSerializeResultInfo *res);
 RZ_API bool rz_project_migrate_v17_v18(RzProject *prj, RzSerializeResultInfo *res);
 RZ_API bool rz_project_migrate(RzProject *prj, unsigned long version, RzSerializeResultInfo *res);
+RZ_API RzProjectErr rz_project_migrate_file(RZ_NONNULL const char *src, RZ_NONNULL const char *dst, RzProjectFormat format, RZ_NULLABLE RzSerializeResultInfo *res);
+
+/* project_bin.c */
+RZ_API bool rz_project_bin_check(RZ_NONNULL const char *file);
+RZ_API bool rz_project_bin_save(RZ_NONNULL RzProject *prj, RZ_NONNULL const char *file);
+RZ_API RZ_OWN RzProjectBin *rz_project_bin_open(RZ_NONNULL const char *file);
+RZ_API void rz_project_bin_close(RZ_NULLABLE RzProjectBin *pb);
+RZ_API RZ_BORROW const char *rz_project_bin_get(RZ_NONNULL RzProjectBin *pb, RZ_NONNULL const char *ns, RZ_NONNULL const char *key);
+RZ_API RZ_OWN RzProject *rz_project_bin_load(RZ_NONNULL const char *file);
 
 #ifdef __cplusplus
 }
@@ -157,6 +157,7 @@ typedef struct rz_reg_t {
 	int size;
 	bool is_thumb;
 	bool big_endian;
+	ut64 profile_gen; ///< incremented every time the profile, thus every RzRegItem, is replaced
 } RzReg;
 
 typedef struct rz_reg_flags_t {
@@ -49,7 +49,10 @@ typedef struct rz_search_hit_t {
 	ut64 addr;
 } RzSearchHit;
 
+typedef struct rz_search_automaton_t RzSearchAutomaton;
+
 typedef int (*RzSearchCallback)(RzSearchKeyword *kw, void *user, ut64 where);
+typedef bool (*RzSearchMatchCallback)(RzSearchKeyword *kw, ut32 kw_idx, ut64 idx, void *user);
 
 typedef struct rz_search_t {
 	int n_kws; // hit${n_kws}_${count}
@@ -72,6 +75,7 @@ typedef struct rz_search_t {
 	RzList /*<RzSearchKeyword *>*/ *kws; // TODO: Use rz_search_kw_new ()
 	RzIOBind iob;
 	char bckwrds;
+	RzSearchAutomaton *automaton; // multi keyword matcher, built lazily from kws
 } RzSearch;
 
 #ifdef RZ_API
@@ -110,6 +114,10 @@ RZ_API int rz_search_strings_update(RzSearch *s, ut64 from, const ut8 *buf, int
 RZ_API int rz_search_regexp_update(RzSearch *s, ut64 from, const ut8 *buf, int len);
 // Returns 2 if search.maxhits is reached, 0 on error, otherwise 1
 RZ_API int rz_search_hit_new(RzSearch *s, RzSearchKeyword *kw, ut64 addr);
+RZ_API bool rz_search_keyword_match_at(RZ_NONNULL const RzSearch *s, RZ_NONNULL const RzSearchKeyword *kw, RZ_NONNULL const ut8 *buf, ut64 len, ut64 idx);
+RZ_API void rz_search_keywords_prepare(RZ_NONNULL RzSearch *s);
+RZ_API bool rz_search_keywords_find(RZ_NONNULL const RzSearch *s, RZ_NONNULL const ut8 *buf, ut64 len, RZ_NONNULL RzSearchMatchCallback cb, RZ_NULLABLE void *user);
+RZ_API bool rz_search_set_leftover(RZ_NONNULL RzSearch *s, ut64 end, RZ_NONNULL const ut8 *buf, ut64 len);
 RZ_API void rz_search_set_distance(RzSearch *s, int dist);
 RZ_API int rz_search_set_string_limits(RzSearch *s, ut32 min, ut32 max); // dup again?
 // RZ_API int rz_search_set_callback(RzSearch *s, int (*callback)(struct rz_search_kw_t *, void *, ut64), void *user);
@@ -674,7 +674,41 @@ static ptrace_wrap_instance *io_ptrace_wrap_instance(RzIO *io) {
 }
 #endif
 
+/**
+ * Returns false for the requests which only inspect a stopped tracee, so
+ * that the memory read while it is stopped can be cached (see io_ptrace.c).
+ */
+static bool ptrace_may_change_memory(rz_ptrace_request_t request) {
+#if __linux__
+	switch (request) {
+	case PTRACE_PEEKTEXT:
+	case PTRACE_PEEKDATA:
+	case PTRACE_PEEKUSER:
+	case PTRACE_GETSIGINFO:
+	case PTRACE_GETEVENTMSG:
+	case PTRACE_GETREGSET:
+	case PTRACE_SETOPTIONS:
+#if defined(PT_GETREGS) || defined(PTRACE_GETREGS)
+	case PTRACE_GETREGS:
+#endif
+#if defined(PT_GETFPREGS) || defined(PTRACE_GETFPREGS)
+	case PTRACE_GETFPREGS:
+#endif
+#if defined(PT_GETFPXREGS) || defined(PTRACE_GETFPXREGS)
+	case PTRACE_GETFPXREGS:
+#endif
+		return false;
+	default:
+		break;
+	}
+#endif
+	return true;
+}
+
 RZ_API long rz_io_ptrace(RzIO *io, rz_ptrace_request_t request, pid_t pid, void *addr, rz_ptrace_data_t data) {
+	if (ptrace_may_change_memory(request)) {
+		io->ptrace_epoch++;
+	}
 #if USE_PTRACE_WRAP
 	ptrace_wrap_instance *wrap = io_ptrace_wrap_instance(io);
 	if (!wrap) {
@@ -688,6 +722,7 @@ RZ_API long rz_io_ptrace(RzIO *io, rz_ptrace_request_t request, pid_t pid, void
 }
 
 RZ_API pid_t rz_io_ptrace_fork(RzIO *io, void (*child_callback)(void *), void *child_callback_user) {
+	io->ptrace_epoch++;
 #if USE_PTRACE_WRAP
 	ptrace_wrap_instance *wrap = io_ptrace_wrap_instance(io);
 	if (!wrap) {
@@ -705,6 +740,7 @@ RZ_API pid_t rz_io_ptrace_fork(RzIO *io, void (*child_callback)(void *), void *c
 }
 
 RZ_API void *rz_io_ptrace_func(RzIO *io, void *(*func)(void *), void *user) {
+	io->ptrace_epoch++;
 #if USE_PTRACE_WRAP
 	ptrace_wrap_instance *wrap = io_ptrace_wrap_instance(io);
 	if (wrap) {
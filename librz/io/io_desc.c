@@ -38,6 +38,7 @@ RZ_API void rz_io_desc_free(RzIODesc *desc) {
 		free(desc->referer);
 		free(desc->name);
 		rz_io_desc_cache_fini(desc);
+		rz_io_rcache_desc_fini(desc);
 		if (desc->io && desc->io->files) {
 			rz_id_storage_delete(desc->io->files, desc->fd);
 		}
@@ -205,7 +206,9 @@ RZ_API int rz_io_desc_read(RzIODesc *desc, ut8 *buf, size_t len) {
 			return rz_io_cache_read(desc->io, seek, buf, len);
 		}
 	}
-	int ret = rz_io_plugin_read(desc, buf, len);
+	int ret = seek != UT64_MAX
+		? rz_io_rcache_read(desc, seek, buf, len)
+		: rz_io_plugin_read(desc, buf, len);
 	if (ret > 0 && desc->io->cachemode) {
 		rz_io_cache_write(desc->io, seek, buf, len);
 	} else if ((ret > 0) && desc->io && (desc->io->p_cache & 1)) {
@@ -250,6 +253,7 @@ RZ_API ut8 *rz_io_desc_get_buf(RzIODesc *desc, RZ_OUT RZ_NONNULL ut64 *size) {
 RZ_API bool rz_io_desc_resize(RzIODesc *desc, ut64 newsize) {
 	if (desc && desc->plugin && desc->plugin->resize) {
 		bool ret = desc->plugin->resize(desc->io, desc, newsize);
+		rz_io_rcache_desc_fini(desc);
 		if (desc->io && desc->io->p_cache) {
 			rz_io_desc_cache_cleanup(desc);
 		}
@@ -0,0 +1,260 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file io_rcache.c
+ * Page granular read cache placed between RzIODesc and the io plugins.
+ *
+ * Pages are keyed by (desc, page aligned offset within the desc), thus
+ * the cached data does not depend on how the desc is mapped and does not
+ * need to be invalidated when maps change. Every write which goes through
+ * rz_io_plugin_write() invalidates the touched pages and resizing or
+ * closing a desc drops all its pages. The least recently used pages are
+ * evicted when the amount of cached pages exceeds RzIORCache.max_pages.
+ */
+
+#include <rz_io.h>
+
+struct rz_io_rcache_page_t {
+	RzIODesc *desc;
+	ut64 addr; ///< page aligned offset within the desc
+	size_t size; ///< amount of valid bytes within data
+	struct rz_io_rcache_page_t *prev; ///< more recently used page
+	struct rz_io_rcache_page_t *next; ///< less recently used page
+	ut8 data[RZ_IO_RCACHE_PAGE_SIZE];
+};
+
+typedef struct rz_io_rcache_page_t RzIORCachePage;
+
+static void lru_unlink(RzIORCache *rc, RzIORCachePage *page) {
+	if (page->prev) {
+		page->prev->next = page->next;
+	} else {
+		rc->lru_head = page->next;
+	}
+	if (page->next) {
+		page->next->prev = page->prev;
+	} else {
+		rc->lru_tail = page->prev;
+	}
+	page->prev = NULL;
+	page->next = NULL;
+}
+
+static void lru_push_front(RzIORCache *rc, RzIORCachePage *page) {
+	page->prev = NULL;
+	page->next = rc->lru_head;
+	if (rc->lru_head) {
+		rc->lru_head->prev = page;
+	}
+	rc->lru_head = page;
+	if (!rc->lru_tail) {
+		rc->lru_tail = page;
+	}
+}
+
+static void page_drop(RzIORCache *rc, RzIORCachePage *page) {
+	lru_unlink(rc, page);
+	ht_up_delete(page->desc->rcache, page->addr);
+	rc->n_pages--;
+	free(page);
+}
+
+static void rcache_shrink(RzIORCache *rc, ut64 max_pages) {
+	while (rc->n_pages > max_pages && rc->lru_tail) {
+		page_drop(rc, rc->lru_tail);
+	}
+}
+
+static bool rcache_usable(RzIODesc *desc) {
+	RzIO *io = desc->io;
+	if (!io || !io->rcache.max_pages || !desc->plugin) {
+		return false;
+	}
+	// the content of debuggers and char devices can change without writes
+	return !desc->plugin->isdbg && !rz_io_desc_is_chardevice(desc);
+}
+
+static RzIORCachePage *page_fill(RzIODesc *desc, ut64 page_addr) {
+	RzIORCache *rc = &desc->io->rcache;
+	if (!desc->rcache) {
+		desc->rcache = ht_up_new(NULL, NULL);
+		if (!desc->rcache) {
+			return NULL;
+		}
+	}
+	RzIORCachePage *page = RZ_NEW0(RzIORCachePage);
+	if (!page) {
+		return NULL;
+	}
+	if (rz_io_desc_seek(desc, page_addr, RZ_IO_SEEK_SET) != page_addr) {
+		free(page);
+		return NULL;
+	}
+	int ret = rz_io_plugin_read(desc, page->data, sizeof(page->data));
+	if (ret <= 0) {
+		free(page);
+		return NULL;
+	}
+	page->desc = desc;
+	page->addr = page_addr;
+	page->size = ret;
+	if (!ht_up_insert(desc->rcache, page_addr, page)) {
+		free(page);
+		return NULL;
+	}
+	lru_push_front(rc, page);
+	rc->n_pages++;
+	rcache_shrink(rc, rc->max_pages);
+	return page;
+}
+
+static RzIORCachePage *page_get(RzIODesc *desc, ut64 page_addr) {
+	RzIORCache *rc = &desc->io->rcache;
+	RzIORCachePage *page = desc->rcache ? ht_up_find(desc->rcache, page_addr, NULL) : NULL;
+	if (page) {
+		rc->hits++;
+		if (rc->lru_head != page) {
+			lru_unlink(rc, page);
+			lru_push_front(rc, page);
+		}
+		return page;
+	}
+	rc->misses++;
+	return page_fill(desc, page_addr);
+}
+
+/**
+ * \brief Reads from the desc through the read cache.
+ *
+ * Behaves like rz_io_plugin_read() called after seeking at \p addr: the
+ * returned value is the amount of read bytes and the desc is left seeked
+ * right after the last read byte. When the cache is disabled or cannot be
+ * used for this desc, the plugin is called directly.
+ *
+ * \param desc  The RzIODesc to read from
+ * \param addr  The offset within the desc
+ * \param buf   The buffer to fill
+ * \param len   The amount of bytes to read
+ *
+ * \return The amount of read bytes, or a negative value on error
+ */
+RZ_API int rz_io_rcache_read(RZ_NONNULL RzIODesc *desc, ut64 addr, RZ_NONNULL RZ_OUT ut8 *buf, size_t len) {
+	rz_return_val_if_fail(desc && buf, -1);
+	if (!rcache_usable(desc) || len > INT_MAX) {
+		return rz_io_plugin_read(desc, buf, len);
+	}
+
+	size_t done = 0;
+	while (done < len) {
+		ut64 cur = addr + done;
+		if (cur < addr) {
+			break;
+		}
+		ut64 page_addr = cur & ~((ut64)RZ_IO_RCACHE_PAGE_SIZE - 1);
+		RzIORCachePage *page = page_get(desc, page_addr);
+		if (!page) {
+			// let the plugin decide what to do with the remaining bytes
+			if (rz_io_desc_seek(desc, cur, RZ_IO_SEEK_SET) != cur) {
+				break;
+			}
+			int ret = rz_io_plugin_read(desc, buf + done, len - done);
+			if (ret < 0 && !done) {
+				return ret;
+			}
+			return done + RZ_MAX(ret, 0);
+		}
+		size_t off = cur - page_addr;
+		if (off >= page->size) {
+			break;
+		}
+		size_t n = RZ_MIN(len - done, page->size - off);
+		memcpy(buf + done, page->data + off, n);
+		done += n;
+		if (page->size < RZ_IO_RCACHE_PAGE_SIZE) {
+			// short page, no more data after it
+			break;
+		}
+	}
+	rz_io_desc_seek(desc, addr + done, RZ_IO_SEEK_SET);
+	return (int)done;
+}
+
+/**
+ * \brief Drops the cached pages of the desc overlapping [addr, addr + len)
+ */
+RZ_API void rz_io_rcache_invalidate(RZ_NONNULL RzIODesc *desc, ut64 addr, ut64 len) {
+	rz_return_if_fail(desc);
+	if (!desc->rcache || !desc->io || !len) {
+		return;
+	}
+	RzIORCache *rc = &desc->io->rcache;
+	ut64 end = addr + len - 1;
+	if (end < addr) {
+		end = UT64_MAX;
+	}
+	ut64 page_addr = addr & ~((ut64)RZ_IO_RCACHE_PAGE_SIZE - 1);
+	ut64 last = end & ~((ut64)RZ_IO_RCACHE_PAGE_SIZE - 1);
+	ut64 n_pages = ((last - page_addr) / RZ_IO_RCACHE_PAGE_SIZE) + 1;
+	if (!n_pages || n_pages > rc->n_pages) {
+		// faster to drop everything than testing each page
+		rz_io_rcache_desc_fini(desc);
+		return;
+	}
+	for (ut64 i = 0; i < n_pages; i++, page_addr += RZ_IO_RCACHE_PAGE_SIZE) {
+		RzIORCachePage *page = ht_up_find(desc->rcache, page_addr, NULL);
+		if (page) {
+			page_drop(rc, page);
+		}
+	}
+}
+
+/**
+ * \brief Drops all the cached pages of the desc
+ */
+RZ_API void rz_io_rcache_desc_fini(RZ_NONNULL RzIODesc *desc) {
+	rz_return_if_fail(desc);
+	if (!desc->rcache) {
+		return;
+	}
+	if (desc->io) {
+		RzIORCache *rc = &desc->io->rcache;
+		RzIORCachePage *page = rc->lru_head;
+		while (page) {
+			RzIORCachePage *next = page->next;
+			if (page->desc == desc) {
+				lru_unlink(rc, page);
+				rc->n_pages--;
+				free(page);
+			}
+			page = next;
+		}
+	}
+	ht_up_free(desc->rcache);
+	desc->rcache = NULL;
+}
+
+/**
+ * \brief Drops all the cached pages of every desc
+ */
+RZ_API void rz_io_rcache_flush(RZ_NONNULL RzIO *io) {
+	rz_return_if_fail(io);
+	rcache_shrink(&io->rcache, 0);
+}
+
+/**
+ * \brief Sets the maximum amount of cached pages (0 disables the cache)
+ */
+RZ_API void rz_io_rcache_set_max_pages(RZ_NONNULL RzIO *io, ut64 max_pages) {
+	rz_return_if_fail(io);
+	io->rcache.max_pages = max_pages;
+	rcache_shrink(&io->rcache, max_pages);
+}
+
+/**
+ * \brief Resets the hit and miss counters of the read cache
+ */
+RZ_API void rz_io_rcache_reset_stats(RZ_NONNULL RzIO *io) {
+	rz_return_if_fail(io);
+	io->rcache.hits = 0;
+	io->rcache.misses = 0;
+}
@@ -17,16 +17,42 @@
 #include <sys/wait.h>
 #include <errno.h>
 
+#if __linux__ && !(defined(__ANDROID_API__) && __ANDROID_API__ < 23)
+#include <sys/uio.h>
+#define USE_PROCESS_VM 1
+#else
+#define USE_PROCESS_VM 0
+#endif
+
+#define PTRACE_PAGE_SIZE 0x1000
+// reads bigger than this bypass the page cache
+#define PTRACE_CACHE_MAX_READ  (16 * PTRACE_PAGE_SIZE)
+#define PTRACE_CACHE_MAX_PAGES 256
+
+typedef struct {
+	ut64 addr;
+	ut8 data[PTRACE_PAGE_SIZE];
+} PtraceCachePage;
+
 typedef struct {
 	int pid;
 	int tid;
 	int fd;
 	int opid;
+	bool use_vm; ///< process_vm_readv()/process_vm_writev() are usable
+	bool use_mem; ///< /proc/pid/mem is usable
+	/**
+	 * Pages read while the tracee is stopped, valid until RzIO.ptrace_epoch
+	 * changes, i.e. until the tracee runs or its memory is written.
+	 */
+	HtUP /*<ut64, PtraceCachePage *>*/ *cache;
+	ut64 cache_epoch;
 } RzIOPtrace;
 #define RzIOPTRACE_OPID(x) (((RzIOPtrace *)(x)->data)->opid)
 #define RzIOPTRACE_PID(x)  (((RzIOPtrace *)(x)->data)->pid)
 #define RzIOPTRACE_FD(x)   (((RzIOPtrace *)(x)->data)->fd)
 static void open_pidmem(RzIOPtrace *iop);
+static void close_pidmem(RzIOPtrace *iop);
 
 #undef RZ_IO_NFDS
 #define RZ_IO_NFDS 2
@@ -43,12 +69,12 @@ extern int errno;
 #endif
 #endif
 
-#if 0
-procpidmem is buggy.. running this sometimes results in ffff
-
-	while : ; do rizin -qc 'oo;x' -d ls ; done
-#endif
+#if __linux__
+// /proc/pid/mem is used when process_vm_readv() is not available
+#define USE_PROC_PID_MEM 1
+#else
 #define USE_PROC_PID_MEM 0
+#endif
 
 static int __waitpid(int pid) {
 	int st = 0;
@@ -83,50 +109,20 @@ static int debug_os_read_at(RzIO *io, int pid, ut32 *buf, int sz, ut64 addr) {
 	return sz;
 }
 
-static int __read(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len) {
-#if USE_PROC_PID_MEM
-	int ret, fd;
-#endif
-	ut64 addr = io->off;
-	if (!desc || !desc->data) {
-		return -1;
-	}
-	memset(buf, '\xff', len); // TODO: only memset the non-readed bytes
-	/* reopen procpidmem if necessary */
-#if USE_PROC_PID_MEM
-	fd = RzIOPTRACE_FD(desc);
-	if (RzIOPTRACE_PID(desc) != RzIOPTRACE_OPID(desc)) {
-		if (fd != -1) {
-			close(fd);
-		}
-		open_pidmem((RzIOPtrace *)desc->data);
-		fd = RzIOPTRACE_FD(desc);
-		RzIOPTRACE_OPID(desc) = RzIOPTRACE_PID(desc);
-	}
-	// /proc/pid/mem fails on latest linux
-	if (fd != -1) {
-		ret = lseek(fd, addr, SEEK_SET);
-		if (ret >= 0) {
-			// Workaround for the buggy Debian Wheeze's /proc/pid/mem
-			if (read(fd, buf, len) != -1) {
-				return ret;
-			}
-		}
-	}
-#endif
+static int ptrace_read_at(RzIO *io, int pid, ut8 *buf, size_t len, ut64 addr) {
 	/* A requirement to be multiple of sizeof(void *)
 	 * in case of posix_memalign() use under the hood */
 	ut8 alignment = RZ_MAX(sizeof(ut32), sizeof(void *));
 	ut32 *aligned_buf = (ut32 *)rz_malloc_aligned(len, alignment);
-	if (aligned_buf) {
-		int res = debug_os_read_at(io, RzIOPTRACE_PID(desc), (ut32 *)aligned_buf, len, addr);
-		if (res > 0) {
-			memcpy(buf, aligned_buf, len);
-		}
-		rz_free_aligned(aligned_buf);
-		return res;
+	if (!aligned_buf) {
+		return -1;
 	}
-	return -1;
+	int res = debug_os_read_at(io, pid, aligned_buf, len, addr);
+	if (res > 0) {
+		memcpy(buf, aligned_buf, len);
+	}
+	rz_free_aligned(aligned_buf);
+	return res;
 }
 
 static int ptrace_write_at(RzIO *io, int pid, const ut8 *pbuf, int sz, ut64 addr) {
@@ -154,11 +150,191 @@ static int ptrace_write_at(RzIO *io, int pid, const ut8 *pbuf, int sz, ut64 addr
 	return sz;
 }
 
+/**
+ * Drops the cached pages and reopens /proc/pid/mem, whose mapping belongs
+ * to the old address space after an exec, if the tracee has run or another
+ * pid has been selected since the last access.
+ */
+static void ptrace_sync(RzIO *io, RzIOPtrace *iop) {
+	if (iop->pid == iop->opid && iop->cache_epoch == io->ptrace_epoch) {
+		return;
+	}
+	if (iop->use_mem) {
+		close_pidmem(iop);
+		open_pidmem(iop);
+	}
+	iop->opid = iop->pid;
+	iop->cache_epoch = io->ptrace_epoch;
+	ht_up_free(iop->cache);
+	iop->cache = NULL;
+}
+
+/**
+ * Reads with as few syscalls as possible the bytes of [addr, addr + len),
+ * from the start of the range up to the first unreadable byte.
+ * Returns the amount of bytes read.
+ */
+static size_t bulk_read(RzIOPtrace *iop, ut8 *buf, size_t len, ut64 addr) {
+	size_t done = 0;
+#if USE_PROCESS_VM
+	if (iop->use_vm) {
+		struct iovec local = { buf, len };
+		struct iovec remote = { (void *)(size_t)addr, len };
+		ssize_t r = process_vm_readv(iop->pid, &local, 1, &remote, 1, 0);
+		if (r > 0) {
+			done = r;
+		} else if (r < 0 && (errno == ENOSYS || errno == EPERM)) {
+			iop->use_vm = false;
+		}
+	}
+#endif
+	// unlike process_vm_readv(), /proc/pid/mem also reads the pages which
+	// are not readable by the tracee, just like ptrace
+	while (iop->fd != -1 && done < len) {
+		ssize_t r = pread(iop->fd, buf + done, len - done, (off_t)(addr + done));
+		if (r <= 0) {
+			break;
+		}
+		done += r;
+	}
+	return done;
+}
+
+/**
+ * Reads [addr, addr + len) with the fastest available method. The bytes of
+ * the unreadable pages are left untouched.
+ */
+static void ptrace_read_range(RzIO *io, RzIOPtrace *iop, ut8 *buf, size_t len, ut64 addr) {
+	size_t done = 0;
+	while (done < len) {
+		done += bulk_read(iop, buf + done, len - done, addr + done);
+		if (done >= len) {
+			break;
+		}
+		ut64 at = addr + done;
+		if (!iop->use_vm && iop->fd == -1) {
+			ptrace_read_at(io, iop->pid, buf + done, len - done, at);
+			break;
+		}
+		// the rest of the page could not be read in bulk (e.g. it is not
+		// readable by the tracee or pread() failed), so try it with ptrace
+		size_t n = RZ_MIN(len - done, PTRACE_PAGE_SIZE - (at & (PTRACE_PAGE_SIZE - 1)));
+		ptrace_read_at(io, iop->pid, buf + done, n, at);
+		done += n;
+	}
+}
+
+static const PtraceCachePage *cache_page(RzIOPtrace *iop, ut64 page_addr) {
+	if (!iop->cache) {
+		iop->cache = ht_up_new(NULL, free);
+		if (!iop->cache) {
+			return NULL;
+		}
+	}
+	PtraceCachePage *page = ht_up_find(iop->cache, page_addr, NULL);
+	if (page) {
+		return page;
+	}
+	if (iop->cache->count >= PTRACE_CACHE_MAX_PAGES) {
+		ht_up_free(iop->cache);
+		iop->cache = ht_up_new(NULL, free);
+		if (!iop->cache) {
+			return NULL;
+		}
+	}
+	page = RZ_NEW(PtraceCachePage);
+	if (!page) {
+		return NULL;
+	}
+	// only fully readable pages are cached
+	if (bulk_read(iop, page->data, PTRACE_PAGE_SIZE, page_addr) != PTRACE_PAGE_SIZE) {
+		free(page);
+		return NULL;
+	}
+	page->addr = page_addr;
+	if (!ht_up_insert(iop->cache, page_addr, page)) {
+		free(page);
+		return NULL;
+	}
+	return page;
+}
+
+static int __read(RzIO *io, RzIODesc *desc, ut8 *buf, size_t len) {
+	ut64 addr = io->off;
+	if (!desc || !desc->data) {
+		return -1;
+	}
+	if (!len || addr == UT64_MAX) {
+		return -1;
+	}
+	RzIOPtrace *iop = desc->data;
+	memset(buf, '\xff', len);
+	ptrace_sync(io, iop);
+	if (len > PTRACE_CACHE_MAX_READ || (!iop->use_vm && iop->fd == -1)) {
+		ptrace_read_range(io, iop, buf, len, addr);
+		return len;
+	}
+	size_t done = 0;
+	while (done < len) {
+		ut64 at = addr + done;
+		ut64 page_addr = at & ~(ut64)(PTRACE_PAGE_SIZE - 1);
+		size_t delta = at - page_addr;
+		size_t n = RZ_MIN(len - done, PTRACE_PAGE_SIZE - delta);
+		const PtraceCachePage *page = cache_page(iop, page_addr);
+		if (page) {
+			memcpy(buf + done, page->data + delta, n);
+		} else {
+			ptrace_read_range(io, iop, buf + done, n, at);
+		}
+		done += n;
+	}
+	return len;
+}
+
+/**
+ * Writes [addr, addr + len) with process_vm_writev() or /proc/pid/mem up
+ * to the first byte which cannot be written this way (for example code,
+ * which is not writable by the tracee). Returns the amount of bytes written.
+ */
+static size_t bulk_write(RzIOPtrace *iop, const ut8 *buf, size_t len, ut64 addr) {
+	size_t done = 0;
+#if USE_PROCESS_VM
+	if (iop->use_vm) {
+		struct iovec local = { (void *)buf, len };
+		struct iovec remote = { (void *)(size_t)addr, len };
+		ssize_t r = process_vm_writev(iop->pid, &local, 1, &remote, 1, 0);
+		if (r > 0) {
+			done = r;
+		} else if (r < 0 && (errno == ENOSYS || errno == EPERM)) {
+			iop->use_vm = false;
+		}
+	}
+#endif
+	while (iop->fd != -1 && done < len) {
+		ssize_t r = pwrite(iop->fd, buf + done, len - done, (off_t)(addr + done));
+		if (r <= 0) {
+			break;
+		}
+		done += r;
+	}
+	return done;
+}
+
 static int __write(RzIO *io, RzIODesc *fd, const ut8 *buf, size_t len) {
 	if (!fd || !fd->data) {
 		return -1;
 	}
-	return ptrace_write_at(io, RzIOPTRACE_PID(fd), buf, len, io->off);
+	RzIOPtrace *iop = fd->data;
+	ut64 addr = io->off;
+	ptrace_sync(io, iop);
+	ht_up_free(iop->cache);
+	iop->cache = NULL;
+	size_t done = bulk_write(iop, buf, len, addr);
+	if (done >= len) {
+		return len;
+	}
+	int r = ptrace_write_at(io, iop->pid, buf + done, len - done, addr + done);
+	return r < 0 ? (done ? done : -1) : done + r;
 }
 
 static void open_pidmem(RzIOPtrace *iop) {
@@ -169,11 +345,6 @@ static void open_pidmem(RzIOPtrace *iop) {
 	if (iop->fd == -1) {
 		iop->fd = open(pidmem, O_RDONLY);
 	}
-#if 0
-	if (iop->fd == -1)
-		eprintf ("Warning: Cannot open /proc/%d/mem. "
-			"Fallback to ptrace io.\n", iop->pid);
-#endif
 #else
 	iop->fd = -1;
 #endif
@@ -254,7 +425,10 @@ static RzIODesc *__open(RzIO *io, const char *file, int rw, int mode) {
 		return NULL;
 	}
 
-	riop->pid = riop->tid = pid;
+	riop->pid = riop->tid = riop->opid = pid;
+	riop->use_vm = USE_PROCESS_VM;
+	riop->use_mem = USE_PROC_PID_MEM;
+	riop->cache_epoch = io->ptrace_epoch;
 	open_pidmem(riop);
 	desc = rz_io_desc_new(io, &rz_io_plugin_ptrace, file, rw | RZ_PERM_X, mode, riop);
 	desc->name = rz_sys_pid_to_path(pid);
@@ -288,6 +462,7 @@ static int __close(RzIODesc *desc) {
 	}
 	RzIOPtrace *riop = desc->data;
 	desc->data = NULL;
+	ht_up_free(riop->cache);
 	long ret = rz_io_ptrace(desc->io, PTRACE_DETACH, pid, 0, 0);
 	if (errno == ESRCH) {
 		// process does not exist, may have been killed earlier -- continue as normal
@@ -307,12 +482,19 @@ static char *__system(RzIO *io, RzIODesc *fd, const char *cmd) {
 	if (!strcmp(cmd, "help")) {
 		eprintf("Usage: R!cmd args\n"
 			" R!ptrace   - use ptrace io\n"
-			" R!mem      - use /proc/pid/mem io if possible\n"
+			" R!mem      - use process_vm_readv or /proc/pid/mem io if possible\n"
 			" R!pid      - show targeted pid\n"
 			" R!pid <#>  - select new pid\n");
 	} else if (!strcmp(cmd, "ptrace")) {
+		iop->use_vm = false;
+		iop->use_mem = false;
 		close_pidmem(iop);
+		ht_up_free(iop->cache);
+		iop->cache = NULL;
 	} else if (!strcmp(cmd, "mem")) {
+		iop->use_vm = USE_PROCESS_VM;
+		iop->use_mem = USE_PROC_PID_MEM;
+		close_pidmem(iop);
 		open_pidmem(iop);
 	} else if (!strncmp(cmd, "pid", 3)) {
 		if (iop) {
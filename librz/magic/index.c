@@ -0,0 +1,616 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file index.c
+ * Prefilter of the offsets where the magic rules can match.
+ *
+ * Every top-level binary test is reduced to a test on a pair of adjacent
+ * bytes: the two bytes at some fixed distance from the start of the buffer
+ * must be one of the accepted pairs. The tests at the same distance are
+ * merged in a single table of 64K bits, so a buffer can be matched by the
+ * magic rules only if at least one table accepts its pair. The tests that
+ * cannot be reduced (indirect offsets, regex and search tests, relations
+ * on words...) make the index unusable, thus rz_magic_index_new() refuses
+ * to build it.
+ *
+ * Scanning the tests one by one would read every byte once per test, so
+ * the tests near the start of the buffer are scanned at once: every pair
+ * of the data is looked up in the union of their tables, which rejects
+ * most of the pairs, and only the accepted ones are mapped back to the
+ * offsets of the tests accepting them.
+ */
+
+#include <rz_userconf.h>
+#include <rz_magic.h>
+#include <rz_util.h>
+
+/* amount of offsets scanned at once by rz_magic_index_scan() */
+#define INDEX_SCAN_BLOCK 4096
+/* tests scanned at once are the first 64 within this distance */
+#define INDEX_SCATTER_OFFSET 1024
+
+#define PAIR(b0, b1)        ((ut32)(b0) | ((ut32)(b1) << 8))
+#define PAIR_HAS(t, p)      (((t)->accept[(p) >> 6] >> ((p) & 63)) & 1)
+#define PAIR_SET(t, b0, b1) ((t)->accept[PAIR(b0, b1) >> 6] |= 1ULL << (PAIR(b0, b1) & 63))
+
+typedef struct {
+	ut32 offset; ///< distance of the first byte from the start of the buffer
+	ut32 min_len; ///< minimum size of the buffer for the test to match
+	ut32 count; ///< amount of pairs accepted
+	ut64 accept[0x10000 / 64]; ///< bitmap of the accepted pairs, indexed by PAIR()
+} MagicIndexTest;
+
+struct rz_magic_index_t {
+	RzVector /*<MagicIndexTest>*/ tests; ///< sorted by offset and min_len
+	ut64 scatter; ///< bit i is set when the test i is scanned at once with the others
+	ut64 any[0x10000 / 64]; ///< union of the pairs accepted by the tests in scatter
+	ut64 *masks; ///< for each pair, the tests in scatter accepting it
+};
+
+#if !USE_LIB_MAGIC
+
+#include "file.h"
+#include "tar.h"
+#include <ctype.h>
+
+static int index_test_cmp(const void *a, const void *b) {
+	const MagicIndexTest *x = a, *y = b;
+	if (x->offset != y->offset) {
+		return x->offset < y->offset ? -1 : 1;
+	}
+	return x->min_len < y->min_len ? -1 : (x->min_len > y->min_len);
+}
+
+static void test_count(MagicIndexTest *t) {
+	t->count = 0;
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(t->accept); i++) {
+		for (ut64 bits = t->accept[i]; bits; bits &= bits - 1) {
+			t->count++;
+		}
+	}
+}
+
+/**
+ * Sets in \p t all the pairs made of a value accepted by \p first and a
+ * value accepted by \p second.
+ */
+static void test_set(MagicIndexTest *t, const ut8 first[256], const ut8 second[256]) {
+	memset(t->accept, 0, sizeof(t->accept));
+	for (int b0 = 0; b0 < 256; b0++) {
+		if (!first[b0]) {
+			continue;
+		}
+		for (int b1 = 0; b1 < 256; b1++) {
+			if (second[b1]) {
+				PAIR_SET(t, b0, b1);
+			}
+		}
+	}
+	test_count(t);
+}
+
+static bool index_add(RzMagicIndex *idx, const MagicIndexTest *t) {
+	size_t i;
+	rz_vector_lower_bound(&idx->tests, t, i, index_test_cmp);
+	MagicIndexTest *dst = NULL;
+	if (i < rz_vector_len(&idx->tests)) {
+		dst = rz_vector_index_ptr(&idx->tests, i);
+		if (index_test_cmp(dst, t)) {
+			dst = NULL;
+		}
+	}
+	if (!dst) {
+		return rz_vector_insert(&idx->tests, i, (void *)t);
+	}
+	for (size_t j = 0; j < RZ_ARRAY_SIZE(dst->accept); j++) {
+		dst->accept[j] |= t->accept[j];
+	}
+	test_count(dst);
+	return true;
+}
+
+/**
+ * Evaluates a byte test on the value \p b exactly like magiccheck() does.
+ */
+static bool byte_test(RzMagic *ms, struct rz_magic *m, ut8 b) {
+	ut8 x = b;
+	if (m->num_mask) {
+		ut8 mask = (ut8)m->num_mask;
+		switch (m->mask_op & FILE_OPS_MASK) {
+		case FILE_OPAND: x &= mask; break;
+		case FILE_OPOR: x |= mask; break;
+		case FILE_OPXOR: x ^= mask; break;
+		case FILE_OPADD: x += mask; break;
+		case FILE_OPMINUS: x -= mask; break;
+		case FILE_OPMULTIPLY: x *= mask; break;
+		case FILE_OPDIVIDE: x /= mask; break;
+		case FILE_OPMODULO: x %= mask; break;
+		}
+	}
+	if (m->mask_op & FILE_OPINVERSE) {
+		x = ~x;
+	}
+	ut64 v = file_signextend(ms, m, x);
+	ut64 l = m->value.q;
+	switch (m->reln) {
+	case 'x': return true;
+	case '!': return v != l;
+	case '=': return v == l;
+	case '>': return v > l;
+	case '<': return v < l;
+	case '&': return (v & l) == l;
+	case '^': return (v & l) != l;
+	default: return true;
+	}
+}
+
+/**
+ * Computes the values accepted for the byte \p i (0 is the least
+ * significant) of a numeric equality. Only the masks working byte by byte
+ * are supported.
+ */
+static bool numeric_byte(const struct rz_magic *m, int i, ut8 accept[256], ut32 *count) {
+	ut8 mask = (ut8)(m->num_mask >> (i * 8));
+	ut8 want = (ut8)(m->value.q >> (i * 8));
+	*count = 0;
+	for (int v = 0; v < 256; v++) {
+		ut8 x = v;
+		if (m->num_mask) {
+			switch (m->mask_op & FILE_OPS_MASK) {
+			case FILE_OPAND: x &= mask; break;
+			case FILE_OPOR: x |= mask; break;
+			case FILE_OPXOR: x ^= mask; break;
+			default: return false;
+			}
+		}
+		if (m->mask_op & FILE_OPINVERSE) {
+			x = ~x;
+		}
+		accept[v] = x == want;
+		*count += accept[v];
+	}
+	return true;
+}
+
+/**
+ * Returns the width of the numeric test \p m and whether its bytes are
+ * stored in big endian order, or 0 when the type is not supported.
+ */
+static int numeric_width(const struct rz_magic *m, bool *big_endian) {
+	*big_endian = false;
+	switch (m->type) {
+	case FILE_SHORT:
+		*big_endian = RZ_SYS_ENDIAN;
+		return 2;
+	case FILE_BESHORT:
+		*big_endian = true;
+		return 2;
+	case FILE_LESHORT:
+		return 2;
+	case FILE_LONG:
+	case FILE_DATE:
+	case FILE_LDATE:
+		*big_endian = RZ_SYS_ENDIAN;
+		return 4;
+	case FILE_BELONG:
+	case FILE_BEDATE:
+	case FILE_BELDATE:
+		*big_endian = true;
+		return 4;
+	case FILE_LELONG:
+	case FILE_LEDATE:
+	case FILE_LELDATE:
+		return 4;
+	case FILE_QUAD:
+	case FILE_QDATE:
+	case FILE_QLDATE:
+		*big_endian = RZ_SYS_ENDIAN;
+		return 8;
+	case FILE_BEQUAD:
+	case FILE_BEQDATE:
+	case FILE_BEQLDATE:
+		*big_endian = true;
+		return 8;
+	case FILE_LEQUAD:
+	case FILE_LEQDATE:
+	case FILE_LEQLDATE:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Reduces a numeric equality to the most selective pair of adjacent bytes
+ * it tests, preferring the pairs not made of zeroes, the value read past
+ * the end of the buffer.
+ */
+static bool test_numeric(struct rz_magic *m, MagicIndexTest *t) {
+	bool big_endian;
+	int width = numeric_width(m, &big_endian);
+	if (!width || m->reln != '=') {
+		return false;
+	}
+	// accepted values of the bytes, in memory order
+	ut8 accept[8][256];
+	ut32 count[8];
+	for (int i = 0; i < width; i++) {
+		int pos = big_endian ? width - 1 - i : i;
+		if (!numeric_byte(m, i, accept[pos], &count[pos])) {
+			return false;
+		}
+	}
+	int best = 0;
+	ut64 best_count = UT64_MAX;
+	bool best_zero = true;
+	for (int pos = 0; pos + 1 < width; pos++) {
+		ut64 c = (ut64)count[pos] * count[pos + 1];
+		bool zero = accept[pos][0] && accept[pos + 1][0];
+		if (c < best_count || (c == best_count && best_zero && !zero)) {
+			best = pos;
+			best_count = c;
+			best_zero = zero;
+		}
+	}
+	t->offset = m->offset + best;
+	test_set(t, accept[best], accept[best + 1]);
+	return true;
+}
+
+static void string_char(const struct rz_magic *m, ut8 c, ut8 accept[256]) {
+	memset(accept, 0, 256);
+	accept[c] = 1;
+	if ((m->str_flags & STRING_IGNORE_LOWERCASE) && islower(c)) {
+		accept[toupper(c)] = 1;
+	} else if ((m->str_flags & STRING_IGNORE_UPPERCASE) && isupper(c)) {
+		accept[tolower(c)] = 1;
+	}
+}
+
+/**
+ * Reduces a string equality to a pair of its characters: the first pair
+ * not made of zeroes or, when blanks may be skipped, the first one.
+ */
+static bool test_string(struct rz_magic *m, MagicIndexTest *t) {
+	if (m->reln != '=' || !m->vallen) {
+		return false;
+	}
+	const ut32 compact = STRING_COMPACT_BLANK | STRING_COMPACT_OPTIONAL_BLANK;
+	const char *s = m->value.s;
+	size_t len = RZ_MIN((size_t)m->vallen, sizeof(m->value.s));
+	if ((m->str_flags & compact) && isspace((ut8)s[0])) {
+		return false;
+	}
+	size_t k = 0;
+	if (!(m->str_flags & compact)) {
+		while (k + 2 < len && !s[k] && !s[k + 1]) {
+			k++;
+		}
+	}
+	ut8 first[256], second[256];
+	string_char(m, (ut8)s[k], first);
+	if (k + 1 >= len || ((m->str_flags & compact) && isspace((ut8)s[k + 1]))) {
+		memset(second, 1, sizeof(second));
+	} else {
+		string_char(m, (ut8)s[k + 1], second);
+	}
+	t->offset = m->offset + k;
+	test_set(t, first, second);
+	return true;
+}
+
+/**
+ * Reduces the test \p m to a test on a pair of bytes in \p t, which accepts
+ * at least all the buffers accepted by \p m.
+ */
+static bool test_reduce(RzMagic *ms, struct rz_magic *m, MagicIndexTest *t) {
+	t->offset = 0;
+	t->min_len = 0;
+	if (m->flag & (INDIR | OFFADD)) {
+		return false;
+	}
+	switch (m->type) {
+	case FILE_BYTE: {
+		ut8 first[256], second[256];
+		for (int v = 0; v < 256; v++) {
+			first[v] = byte_test(ms, m, (ut8)v);
+		}
+		memset(second, 1, sizeof(second));
+		t->offset = m->offset;
+		test_set(t, first, second);
+		return true;
+	}
+	case FILE_STRING:
+		return test_string(m, t);
+	default:
+		return test_numeric(m, t);
+	}
+}
+
+/**
+ * Indexes the top-level test magic[top] and its continuations.
+ *
+ * A test without description prints something only when one of its first
+ * level continuations matches too, thus these are used to refine it: when
+ * they test the same bytes the accepted pairs are intersected, otherwise
+ * the continuations are indexed in place of the top-level test if they
+ * accept less pairs.
+ */
+static bool index_rule(RzMagicIndex *idx, RzMagic *ms, struct rz_magic *magic, ut32 nmagic, ut32 top) {
+	MagicIndexTest *t = RZ_NEW(MagicIndexTest);
+	if (!t) {
+		return false;
+	}
+	bool ret = false;
+	RzVector conts;
+	rz_vector_init(&conts, sizeof(MagicIndexTest), NULL, NULL);
+	if (!test_reduce(ms, &magic[top], t)) {
+		goto end;
+	}
+	bool refine = !*magic[top].desc, same = true;
+	ut64 count = 0;
+	for (ut32 i = top + 1; refine && i < nmagic && magic[i].cont_level; i++) {
+		if (magic[i].cont_level != 1) {
+			continue;
+		}
+		MagicIndexTest *c = rz_vector_push(&conts, NULL);
+		if (!c || magic[i].type == FILE_DEFAULT || !test_reduce(ms, &magic[i], c)) {
+			refine = false;
+			break;
+		}
+		same &= c->offset == t->offset;
+		count += c->count;
+	}
+	if (refine && same) {
+		ut64 any[RZ_ARRAY_SIZE(t->accept)] = { 0 };
+		MagicIndexTest *c;
+		rz_vector_foreach (&conts, c) {
+			for (size_t j = 0; j < RZ_ARRAY_SIZE(any); j++) {
+				any[j] |= c->accept[j];
+			}
+		}
+		for (size_t j = 0; j < RZ_ARRAY_SIZE(any); j++) {
+			t->accept[j] &= any[j];
+		}
+		test_count(t);
+		// nothing can be printed when no pair is left
+		ret = !t->count || index_add(idx, t);
+	} else if (refine && count < t->count) {
+		MagicIndexTest *c;
+		ret = true;
+		rz_vector_foreach (&conts, c) {
+			if (!index_add(idx, c)) {
+				ret = false;
+				break;
+			}
+		}
+	} else {
+		ret = index_add(idx, t);
+	}
+end:
+	rz_vector_fini(&conts);
+	free(t);
+	return ret;
+}
+
+/**
+ * file_is_tar() needs a whole record and parses its checksum field as
+ * octal: the first character must be a space or an octal digit for the
+ * checksum to match.
+ */
+static bool index_tar(RzMagicIndex *idx) {
+	MagicIndexTest *t = RZ_NEW(MagicIndexTest);
+	if (!t) {
+		return false;
+	}
+	ut8 first[256], second[256];
+	for (int v = 0; v < 256; v++) {
+		first[v] = isspace(v) || (v >= '0' && v <= '7');
+	}
+	memset(second, 1, sizeof(second));
+	t->offset = offsetof(struct header, chksum);
+	t->min_len = RECORDSIZE;
+	test_set(t, first, second);
+	bool ret = index_add(idx, t);
+	free(t);
+	return ret;
+}
+
+static bool index_rules(RzMagicIndex *idx, RzMagic *ms) {
+	for (struct mlist *ml = ms->mlist->next; ml != ms->mlist; ml = ml->next) {
+		for (ut32 i = 0; i < ml->nmagic; i++) {
+			struct rz_magic *m = &ml->magic[i];
+			// only the top-level binary tests are evaluated by rz_magic_buffer()
+			if (m->cont_level || !(m->flag & BINTEST)) {
+				continue;
+			}
+			if (!index_rule(idx, ms, ml->magic, ml->nmagic, i)) {
+				RZ_LOG_DEBUG("magic: cannot index the rule at line %u\n", m->lineno);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Builds the tables of the tests scanned at once.
+ */
+static bool index_scatter(RzMagicIndex *idx) {
+	idx->masks = RZ_NEWS0(ut64, 0x10000);
+	if (!idx->masks) {
+		return false;
+	}
+	size_t i = 0;
+	MagicIndexTest *t;
+	rz_vector_foreach (&idx->tests, t) {
+		if (i >= 64 || t->offset >= INDEX_SCATTER_OFFSET) {
+			break;
+		}
+		if (!t->min_len) {
+			idx->scatter |= 1ULL << i;
+			for (size_t j = 0; j < RZ_ARRAY_SIZE(t->accept); j++) {
+				idx->any[j] |= t->accept[j];
+				for (ut64 bits = t->accept[j]; bits; bits &= bits - 1) {
+					idx->masks[j * 64 + (63 - rz_bits_leading_zeros(bits & -bits))] |= 1ULL << i;
+				}
+			}
+		}
+		i++;
+	}
+	return true;
+}
+
+/**
+ * \brief Builds the index of the offsets where the rules of \p ms can match
+ *
+ * \param ms  The magic with the rules already loaded
+ * \return The index or NULL when one of the rules cannot be indexed
+ */
+RZ_API RZ_OWN RzMagicIndex *rz_magic_index_new(RZ_NONNULL RzMagic *ms) {
+	rz_return_val_if_fail(ms, NULL);
+	// without a match the MIME type is still printed
+	if (!ms->mlist || (ms->flags & RZ_MAGIC_MIME)) {
+		return NULL;
+	}
+	RzMagicIndex *idx = RZ_NEW0(RzMagicIndex);
+	if (!idx) {
+		return NULL;
+	}
+	rz_vector_init(&idx->tests, sizeof(MagicIndexTest), NULL, NULL);
+	if ((!(ms->flags & RZ_MAGIC_NO_CHECK_TAR) && !index_tar(idx)) ||
+		(!(ms->flags & RZ_MAGIC_NO_CHECK_SOFT) && !index_rules(idx, ms)) ||
+		!index_scatter(idx)) {
+		rz_magic_index_free(idx);
+		return NULL;
+	}
+	return idx;
+}
+
+#else
+
+RZ_API RZ_OWN RzMagicIndex *rz_magic_index_new(RZ_NONNULL RzMagic *ms) {
+	// the rules of libmagic are not accessible
+	return NULL;
+}
+
+#endif
+
+RZ_API void rz_magic_index_free(RZ_NULLABLE RzMagicIndex *idx) {
+	if (!idx) {
+		return;
+	}
+	rz_vector_fini(&idx->tests);
+	free(idx->masks);
+	free(idx);
+}
+
+/**
+ * Marks the offsets in [at, at + n) accepted by the test \p t. With
+ * \p tail only the offsets where the pair is not entirely within the data
+ * are checked.
+ */
+static void scan_test(const MagicIndexTest *t, const ut8 *buf, size_t len, size_t window, size_t at, size_t n, bool tail, ut8 *cand) {
+	if (window < t->min_len || len < t->min_len || at > len - t->min_len) {
+		return;
+	}
+	// offsets where the buffer is big enough for the test
+	n = RZ_MIN(n, len - t->min_len - at + 1);
+	const size_t off = t->offset;
+	if (off >= window && !PAIR_HAS(t, PAIR(0, 0))) {
+		// the test always reads past the end of the buffer
+		return;
+	}
+	// offsets where both the bytes are within the buffer
+	size_t inside = 0;
+	if (off + 1 < window && at + off + 1 < len) {
+		inside = RZ_MIN(n, len - at - off - 1);
+	}
+	const ut8 *p = buf + at + off;
+	for (size_t i = 0; i < inside && !tail; i++) {
+		ut32 pair = PAIR(p[i], p[i + 1]);
+		cand[i] |= PAIR_HAS(t, pair);
+	}
+	// past the end of the buffer the bytes are read as 0
+	for (size_t i = inside; i < n; i++) {
+		size_t size = RZ_MIN(window, len - at - i);
+		ut8 b0 = off < size ? p[i] : 0;
+		ut8 b1 = off + 1 < size ? p[i + 1] : 0;
+		ut32 pair = PAIR(b0, b1);
+		cand[i] |= PAIR_HAS(t, pair);
+	}
+}
+
+/**
+ * Marks the offsets in [at, at + n) accepted by the tests in \p scatter,
+ * whose pairs are entirely within the data and the buffer.
+ */
+static void scan_scatter(const RzMagicIndex *idx, ut64 scatter, size_t max_off, const ut8 *buf, size_t len, size_t at, size_t n, ut8 *cand) {
+	if (len < 2) {
+		return;
+	}
+	const MagicIndexTest *tests = rz_vector_index_ptr((RzVector *)&idx->tests, 0);
+	size_t end = RZ_MIN(at + n + max_off, len - 1);
+	for (size_t j = at; j < end; j++) {
+		ut32 pair = PAIR(buf[j], buf[j + 1]);
+		if (!((idx->any[pair >> 6] >> (pair & 63)) & 1)) {
+			continue;
+		}
+		for (ut64 mask = idx->masks[pair] & scatter; mask; mask &= mask - 1) {
+			size_t off = tests[63 - rz_bits_leading_zeros(mask & -mask)].offset;
+			if (j >= at + off && j - off < at + n) {
+				cand[j - off - at] = 1;
+			}
+		}
+	}
+}
+
+/**
+ * \brief Finds the offsets where the magic rules can match
+ *
+ * The buffer checked at the offset i is `buf + i` of `RZ_MIN(window, len - i)`
+ * bytes, the same buffer passed to rz_magic_buffer(). Offsets not reported
+ * are guaranteed to give no result, the reported ones must be checked with
+ * rz_magic_buffer().
+ *
+ * \param idx     The index
+ * \param buf     The data
+ * \param len     The size of \p buf
+ * \param size    The amount of offsets to check, starting from 0
+ * \param window  The size of the buffer checked at each offset
+ * \param cb      The callback called with each candidate offset, return false to stop
+ * \param user    The user pointer passed to \p cb
+ * \return false when stopped by \p cb, otherwise true
+ */
+RZ_API bool rz_magic_index_scan(RZ_NONNULL const RzMagicIndex *idx, RZ_NONNULL const ut8 *buf, size_t len, size_t size, size_t window, RZ_NONNULL RzMagicIndexCallback cb, RZ_NULLABLE void *user) {
+	rz_return_val_if_fail(idx && buf && cb, false);
+	// the tests scanned at once must read their pair within the buffer
+	ut64 scatter = 0;
+	size_t max_off = 0;
+	for (size_t i = 0; i < rz_vector_len(&idx->tests); i++) {
+		const MagicIndexTest *t = rz_vector_index_ptr((RzVector *)&idx->tests, i);
+		if (i < 64 && (idx->scatter & (1ULL << i)) && t->offset + 1 < window) {
+			scatter |= 1ULL << i;
+			max_off = RZ_MAX(max_off, t->offset);
+		}
+	}
+	ut8 cand[INDEX_SCAN_BLOCK];
+	size = RZ_MIN(size, len);
+	for (size_t at = 0; at < size; at += INDEX_SCAN_BLOCK) {
+		size_t n = RZ_MIN(size - at, INDEX_SCAN_BLOCK);
+		memset(cand, 0, n);
+		scan_scatter(idx, scatter, max_off, buf, len, at, n, cand);
+		for (size_t i = 0; i < rz_vector_len(&idx->tests); i++) {
+			const MagicIndexTest *t = rz_vector_index_ptr((RzVector *)&idx->tests, i);
+			bool tail = i < 64 && (scatter & (1ULL << i));
+			scan_test(t, buf, len, window, at, n, tail, cand);
+		}
+		for (size_t i = 0; i < n; i++) {
+			// buffers smaller than 2 bytes are always described as empty or short
+			if ((cand[i] || RZ_MIN(window, len - at - i) < 2) && !cb(user, at + i)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -34,6 +34,7 @@ typedef enum {
 
 typedef enum {
 	DIFF_TYPE_UNKNOWN = 0,
+	DIFF_TYPE_BLOCKS,
 	DIFF_TYPE_BYTES,
 	DIFF_TYPE_CLASSES,
 	DIFF_TYPE_COMMAND,
@@ -226,6 +227,7 @@ static void rz_diff_show_help(bool usage_only) {
 		"-1",       "[cmd]",        "Input for file1 when option -t 'commands' is given.",
 		"-t",       "[type]",       "Compute the difference between two files based on its type:",
 		"",         "",             "   bytes      | compare raw bytes in the files (only for small files)",
+		"",         "",             "   blocks     | compare raw bytes in the files (for big files, less precise)",
 		"",         "",             "   lines      | compare text files",
 		"",         "",             "   functions  | compare functions found in the files",
 		"",         "",             "              | optional -0 <fcn name|offset> to compare only one function",
@@ -362,6 +364,8 @@ static void rz_diff_parse_arguments(int argc, const char **argv, DiffContext *ct
 
 		if (!strcmp(type, "bytes")) {
 			rz_diff_ctx_set_type(ctx, DIFF_TYPE_BYTES);
+		} else if (!strcmp(type, "blocks")) {
+			rz_diff_ctx_set_type(ctx, DIFF_TYPE_BLOCKS);
 		} else if (!strcmp(type, "lines")) {
 			rz_diff_ctx_set_type(ctx, DIFF_TYPE_LINES);
 		} else if (!strcmp(type, "functions")) {
@@ -1378,6 +1382,130 @@ static RzDiff *rz_diff_command_new(DiffContext *ctx) {
 	return diff;
 }
 
+/**************************************** blocks ****************************************/
+
+#define DIFF_BLOCKS_HEX_WIDTH 16
+
+typedef struct diff_blocks_t {
+	const ut8 *a;
+	const ut8 *b;
+	bool colors;
+	bool first; ///< no json op has been printed yet
+	PJ *pj;
+} DiffBlocks;
+
+static ut8 *diff_blocks_load(const char *file, ut64 *size, RzMmap **map) {
+	// big files are mapped, thus the OS loads only the compared pages
+	*map = rz_file_mmap(file, O_RDONLY, 0, 0);
+	if (*map && (*map)->buf) {
+		*size = (*map)->len;
+		return (*map)->buf;
+	}
+	rz_file_mmap_free(*map);
+	*map = NULL;
+
+	size_t slurp_size = 0;
+	ut8 *buffer = rz_diff_slurp_file(file, &slurp_size);
+	*size = slurp_size;
+	return buffer;
+}
+
+static void diff_blocks_print_hex(const ut8 *buffer, ut64 beg, ut64 end, char prefix, const char *color, const char *reset) {
+	for (ut64 i = beg; i < end; i += DIFF_BLOCKS_HEX_WIDTH) {
+		ut64 n = RZ_MIN(end - i, DIFF_BLOCKS_HEX_WIDTH);
+		printf("%s%c0x%08" PFMT64x " ", color, prefix, i);
+		for (ut64 j = 0; j < n; j++) {
+			printf(" %02x", buffer[i + j]);
+		}
+		printf("%s\n", reset);
+	}
+}
+
+static bool diff_blocks_print_op(const RzDiffBytesOp *op, void *user) {
+	DiffBlocks *db = (DiffBlocks *)user;
+	if (op->type == RZ_DIFF_OP_EQUAL) {
+		return true;
+	}
+	ut64 a_len = op->a_end - op->a_beg;
+	ut64 b_len = op->b_end - op->b_beg;
+	if (db->pj) {
+		PJ *pj = db->pj;
+		pj_reset(pj);
+		pj_o(pj);
+		pj_ks(pj, "op", op->type == RZ_DIFF_OP_REPLACE ? "replace" : (op->type == RZ_DIFF_OP_DELETE ? "delete" : "insert"));
+		pj_kn(pj, "a_offset", op->a_beg);
+		pj_kn(pj, "a_size", a_len);
+		pj_kn(pj, "b_offset", op->b_beg);
+		pj_kn(pj, "b_size", b_len);
+		pj_end(pj);
+		printf("%s%s", db->first ? "" : ",", pj_string(pj));
+		db->first = false;
+		return true;
+	}
+
+	const char *reset = db->colors ? Color_RESET : "";
+	printf("%s@@ -0x%" PFMT64x ",0x%" PFMT64x " +0x%" PFMT64x ",0x%" PFMT64x " @@%s\n",
+		db->colors ? Color_BBLUE : "", op->a_beg, a_len, op->b_beg, b_len, reset);
+	diff_blocks_print_hex(db->a, op->a_beg, op->a_end, '-', db->colors ? Color_BRED : "", reset);
+	diff_blocks_print_hex(db->b, op->b_beg, op->b_end, '+', db->colors ? Color_BGREEN : "", reset);
+	return true;
+}
+
+static bool rz_diff_blocks_files(DiffContext *ctx) {
+	RzMmap *map_a = NULL;
+	RzMmap *map_b = NULL;
+	ut64 a_size = 0;
+	ut64 b_size = 0;
+	bool result = false;
+	DiffBlocks db = { .colors = ctx->colors };
+
+	db.a = diff_blocks_load(ctx->file_a, &a_size, &map_a);
+	if (!db.a) {
+		goto rz_diff_blocks_files_bad;
+	}
+	db.b = diff_blocks_load(ctx->file_b, &b_size, &map_b);
+	if (!db.b) {
+		goto rz_diff_blocks_files_bad;
+	}
+
+	if (ctx->mode == DIFF_MODE_JSON) {
+		if (!(db.pj = pj_new())) {
+			goto rz_diff_blocks_files_bad;
+		}
+		// the ops are printed as soon as they are found, thus the json is written by pieces
+		pj_o(db.pj);
+		pj_ks(db.pj, "from", ctx->file_a);
+		pj_ks(db.pj, "to", ctx->file_b);
+		pj_ka(db.pj, "diff");
+		printf("%s", pj_string(db.pj));
+		db.first = true;
+	} else {
+		const char *reset = ctx->colors ? Color_RESET : "";
+		printf("%s--- %s%s\n", ctx->colors ? Color_BRED : "", ctx->file_a, reset);
+		printf("%s+++ %s%s\n", ctx->colors ? Color_BGREEN : "", ctx->file_b, reset);
+	}
+
+	result = rz_diff_bytes_stream(db.a, a_size, db.b, b_size, 0, diff_blocks_print_op, &db);
+
+	if (db.pj) {
+		printf("]}\n");
+	}
+
+rz_diff_blocks_files_bad:
+	pj_free(db.pj);
+	if (map_a) {
+		rz_file_mmap_free(map_a);
+	} else {
+		free((ut8 *)db.a);
+	}
+	if (map_b) {
+		rz_file_mmap_free(map_b);
+	} else {
+		free((ut8 *)db.b);
+	}
+	return result;
+}
+
 /**************************************** unified ***************************************/
 
 static bool rz_diff_unified_files(DiffContext *ctx) {
@@ -1390,6 +1518,10 @@ static bool rz_diff_unified_files(DiffContext *ctx) {
 	RzDiff *diff = NULL;
 	bool result = false;
 
+	if (ctx->type == DIFF_TYPE_BLOCKS) {
+		return rz_diff_blocks_files(ctx);
+	}
+
 	if (ctx->type == DIFF_TYPE_BYTES ||
 		ctx->type == DIFF_TYPE_LINES) {
 		if (!(a_buffer = rz_diff_slurp_file(ctx->file_a, &a_size))) {
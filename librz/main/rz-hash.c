@@ -12,6 +12,8 @@
 #include <rz_lib.h>
 
 #define RZ_HASH_DEFAULT_BLOCK_SIZE 0x1000
+#define RZ_HASH_STREAM_CHUNK_SIZE  0x1000000
+#define RZ_HASH_MAX_CHUNK_BLOCKS   0x1000
 
 typedef struct {
 	ut8 *buf;
@@ -745,16 +747,9 @@ static void hash_print_crypto(RzHashContext *ctx, const char *hname, const ut8 *
 	free(value);
 }
 
-static void hash_print_digest(RzHashContext *ctx, RzHashCfg *md, const char *hname, ut64 from, ut64 to, const char *filename) {
-	RzHashSize len = 0;
-	char *value = NULL;
+static void hash_print_value(RzHashContext *ctx, const char *hname, const ut8 *buffer, RzHashSize len, const char *value, ut64 from, ut64 to, const char *filename) {
 	char *rndart = NULL;
-	const ut8 *buffer;
-
-	buffer = rz_hash_cfg_get_result(md, hname, &len);
-	value = rz_hash_cfg_get_result_string(md, hname, NULL, ctx->little_endian);
 	if (!value || !buffer) {
-		free(value);
 		return;
 	}
 
@@ -784,10 +779,17 @@ static void hash_print_digest(RzHashContext *ctx, RzHashCfg *md, const char *hna
 		puts(value);
 		break;
 	}
-	free(value);
 	free(rndart);
 }
 
+static void hash_print_digest(RzHashContext *ctx, RzHashCfg *md, const char *hname, ut64 from, ut64 to, const char *filename) {
+	RzHashSize len = 0;
+	const ut8 *buffer = rz_hash_cfg_get_result(md, hname, &len);
+	char *value = rz_hash_cfg_get_result_string(md, hname, NULL, ctx->little_endian);
+	hash_print_value(ctx, hname, buffer, len, value, from, to, filename);
+	free(value);
+}
+
 static void hash_context_compare_hashes(RzHashContext *ctx, size_t filesize, bool result, const char *hname, const char *filename) {
 	ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
 	const char *hmac = ctx->key.len > 0 ? "hmac-" : "";
@@ -839,15 +841,263 @@ static RzList /*<char *>*/ *parse_hash_algorithms(RzHashContext *ctx) {
 	return list;
 }
 
+static RzHashCfg *hash_cfg_setup(RzHashContext *ctx, RzList /*<char *>*/ *algorithms) {
+	const char *algorithm;
+	RzListIter *it;
+	RzHashCfg *md = rz_hash_cfg_new(ctx->rh);
+	if (!md) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate hash context memory\n");
+		return NULL;
+	}
+
+	rz_list_foreach (algorithms, it, algorithm) {
+		if (!rz_hash_cfg_configure(md, algorithm)) {
+			goto hash_cfg_setup_fail;
+		}
+	}
+
+	if (ctx->key.len > 0 && !rz_hash_cfg_hmac(md, ctx->key.buf, ctx->key.len)) {
+		goto hash_cfg_setup_fail;
+	}
+	return md;
+
+hash_cfg_setup_fail:
+	rz_hash_cfg_free(md);
+	return NULL;
+}
+
+/**
+ * \brief Hashes [from, to) as a single message
+ *
+ * The input is read in chunks of at least RZ_HASH_STREAM_CHUNK_SIZE bytes and
+ * each chunk is read only once and consumed by all the algorithms in parallel.
+ */
+static bool hash_stream(RzHashContext *ctx, RzIO *io, RzHashCfg *md, ut64 from, ut64 to) {
+	bool result = false;
+	ut64 chunk_size = RZ_MAX(ctx->block_size, RZ_HASH_STREAM_CHUNK_SIZE);
+	if (to > from && to - from < chunk_size) {
+		chunk_size = to - from;
+	}
+	ut8 *chunk = malloc(chunk_size);
+	if (!chunk) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
+		return false;
+	}
+
+	if (!rz_hash_cfg_init(md)) {
+		goto hash_stream_end;
+	}
+
+	if (ctx->as_prefix && ctx->seed.buf &&
+		!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
+		goto hash_stream_end;
+	}
+
+	for (ut64 j = from; j < to; j += chunk_size) {
+		int read = rz_io_pread_at(io, j, chunk, to - j > chunk_size ? chunk_size : (to - j));
+		if (!rz_hash_cfg_update_mt(md, chunk, read, RZ_THREAD_N_CORES_ALL_AVAILABLE)) {
+			goto hash_stream_end;
+		}
+	}
+
+	if (!ctx->as_prefix && ctx->seed.buf &&
+		!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
+		goto hash_stream_end;
+	}
+
+	result = rz_hash_cfg_final(md) && rz_hash_cfg_iterate(md, ctx->iterate);
+
+hash_stream_end:
+	free(chunk);
+	return result;
+}
+
+typedef struct {
+	char *value;
+	ut8 *digest;
+	RzHashSize size;
+} HashBlockDigest;
+
+typedef struct {
+	RzHashCfg *md;
+	RzList /*<char *>*/ *algorithms; ///< borrowed from hash_blocks()
+	const ut8 *data; ///< first block of the stripe
+	ut64 size; ///< bytes read from the first block on
+	ut64 block_size;
+	size_t n_blocks;
+	size_t iterate;
+	bool little_endian;
+	HashBlockDigest *digests; ///< n_blocks times the algorithms, in block order
+	bool success;
+} HashStripeJob;
+
+static void hash_stripe_job_free(HashStripeJob *job) {
+	if (!job) {
+		return;
+	}
+	if (job->md) {
+		rz_hash_cfg_free(job->md);
+	}
+	free(job);
+}
+
+static void hash_block_digests_clear(HashBlockDigest *digests, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		free(digests[i].value);
+		free(digests[i].digest);
+	}
+	memset(digests, 0, count * sizeof(HashBlockDigest));
+}
+
+/**
+ * Hashes each block of the stripe on the same RzHashCfg and keeps a copy
+ * of the digests, which are printed once all the stripes are done.
+ */
+static void hash_stripe_job_run(HashStripeJob *job, void *user) {
+	const char *algorithm;
+	RzListIter *it;
+	HashBlockDigest *d = job->digests;
+	for (size_t i = 0; i < job->n_blocks; i++) {
+		ut64 offset = i * job->block_size;
+		ut64 size = job->size > offset ? RZ_MIN(job->block_size, job->size - offset) : 0;
+		if (!rz_hash_cfg_init(job->md) ||
+			!rz_hash_cfg_update(job->md, job->data + offset, size) ||
+			!rz_hash_cfg_final(job->md) ||
+			!rz_hash_cfg_iterate(job->md, job->iterate)) {
+			job->success = false;
+			return;
+		}
+		rz_list_foreach (job->algorithms, it, algorithm) {
+			const ut8 *digest = rz_hash_cfg_get_result(job->md, algorithm, &d->size);
+			d->digest = digest ? rz_mem_dup(digest, d->size) : NULL;
+			d->value = rz_hash_cfg_get_result_string(job->md, algorithm, NULL, job->little_endian);
+			d++;
+		}
+	}
+	job->success = true;
+}
+
+/**
+ * \brief Hashes each block of [from, to) as a separate message
+ *
+ * Consecutive blocks are read with a single read and split in one stripe
+ * per thread, so that the threads are started once per read. The digests
+ * are printed following the order of the blocks.
+ */
+static bool hash_blocks(RzHashContext *ctx, RzIO *io, RzList /*<char *>*/ *algorithms, const char *filename, ut64 from, ut64 to) {
+	bool result = false;
+	const char *algorithm;
+	RzListIter *it;
+	ut64 bsize = ctx->block_size;
+	if (from >= to) {
+		return true;
+	}
+
+	ut64 n_blocks = ((to - from) + bsize - 1) / bsize;
+	size_t chunk_blocks = RZ_MIN(RZ_HASH_STREAM_CHUNK_SIZE / bsize, RZ_HASH_MAX_CHUNK_BLOCKS);
+	chunk_blocks = RZ_MAX(RZ_MIN(chunk_blocks, n_blocks), 1);
+	size_t n_jobs = RZ_MIN((size_t)rz_th_max_threads(RZ_THREAD_N_CORES_ALL_AVAILABLE), chunk_blocks);
+	size_t n_algorithms = rz_list_length(algorithms);
+	size_t n_digests = chunk_blocks * n_algorithms;
+
+	ut8 *chunk = NULL;
+	HashBlockDigest *digests = NULL;
+	RzPVector *batch = NULL;
+	RzPVector *jobs = rz_pvector_new((RzPVectorFree)hash_stripe_job_free);
+	if (!jobs || !(batch = rz_pvector_new(NULL)) ||
+		!(chunk = malloc(chunk_blocks * bsize)) ||
+		!(digests = RZ_NEWS0(HashBlockDigest, n_digests))) {
+		RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
+		goto hash_blocks_end;
+	}
+
+	for (size_t i = 0; i < n_jobs; i++) {
+		HashStripeJob *job = RZ_NEW0(HashStripeJob);
+		if (!job || !rz_pvector_push(jobs, job)) {
+			RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
+			free(job);
+			goto hash_blocks_end;
+		}
+		job->md = hash_cfg_setup(ctx, algorithms);
+		if (!job->md) {
+			goto hash_blocks_end;
+		}
+		job->algorithms = algorithms;
+		job->block_size = bsize;
+		job->iterate = ctx->iterate;
+		job->little_endian = ctx->little_endian;
+	}
+
+	for (ut64 j = from; j < to; j += chunk_blocks * bsize) {
+		ut64 len = RZ_MIN(chunk_blocks * bsize, to - j);
+		int read = rz_io_pread_at(io, j, chunk, len);
+		ut64 available = read > 0 ? read : 0;
+		size_t blocks = (len + bsize - 1) / bsize;
+		size_t stripe = (blocks + n_jobs - 1) / n_jobs;
+
+		rz_pvector_clear(batch);
+		for (size_t i = 0; i < n_jobs && i * stripe < blocks; i++) {
+			HashStripeJob *job = rz_pvector_at(jobs, i);
+			ut64 offset = i * stripe * bsize;
+			job->data = chunk + offset;
+			job->size = available > offset ? available - offset : 0;
+			job->n_blocks = RZ_MIN(stripe, blocks - i * stripe);
+			job->digests = digests + i * stripe * n_algorithms;
+			rz_pvector_push(batch, job);
+		}
+
+		if (rz_pvector_len(batch) > 1) {
+			if (!rz_th_iterate_pvector(batch, (RzThreadIterator)hash_stripe_job_run, (RzThreadNCores)rz_pvector_len(batch), NULL)) {
+				goto hash_blocks_end;
+			}
+		} else {
+			hash_stripe_job_run(rz_pvector_at(batch, 0), NULL);
+		}
+
+		void **vit;
+		rz_pvector_foreach (batch, vit) {
+			HashStripeJob *job = *vit;
+			if (!job->success) {
+				goto hash_blocks_end;
+			}
+		}
+
+		HashBlockDigest *d = digests;
+		for (size_t i = 0; i < blocks; i++) {
+			ut64 block_from = j + i * bsize;
+			rz_list_foreach (algorithms, it, algorithm) {
+				if (ctx->mode == RZ_HASH_MODE_JSON) {
+					pj_o(ctx->pj);
+				}
+				hash_print_value(ctx, algorithm, d->digest, d->size, d->value, block_from, block_from + bsize, filename);
+				if (ctx->mode == RZ_HASH_MODE_JSON) {
+					pj_end(ctx->pj);
+				}
+				d++;
+			}
+		}
+		hash_block_digests_clear(digests, n_digests);
+	}
+	result = true;
+
+hash_blocks_end:
+	if (digests) {
+		hash_block_digests_clear(digests, n_digests);
+		free(digests);
+	}
+	free(chunk);
+	rz_pvector_free(batch);
+	rz_pvector_free(jobs);
+	return result;
+}
+
 static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
 	bool result = false;
 	const char *algorithm;
 	RzList *algorithms = NULL;
 	RzListIter *it;
 	RzHashCfg *md = NULL;
-	ut64 bsize = 0;
 	ut64 filesize;
-	ut8 *block = NULL;
 	ut8 *cmphash = NULL;
 	const ut8 *digest = NULL;
 	RzHashSize digest_size = 0;
@@ -860,12 +1110,6 @@ static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
 
 	filesize = rz_io_desc_size(io->desc);
 
-	md = rz_hash_cfg_new(ctx->rh);
-	if (!md) {
-		RZ_LOG_ERROR("rz-hash: error, cannot allocate hash context memory\n");
-		goto calculate_hash_end;
-	}
-
 	if (ctx->offset.to > filesize) {
 		RZ_LOG_ERROR("rz-hash: error, -t value is greater than file size\n");
 		goto calculate_hash_end;
@@ -876,25 +1120,18 @@ static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
 		goto calculate_hash_end;
 	}
 
-	bsize = ctx->block_size;
-	block = malloc(bsize);
-	if (!block) {
-		RZ_LOG_ERROR("rz-hash: error, cannot allocate block memory\n");
+	ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
+	if (ctx->show_blocks) {
+		result = hash_blocks(ctx, io, algorithms, filename, ctx->offset.from, to);
 		goto calculate_hash_end;
 	}
 
-	rz_list_foreach (algorithms, it, algorithm) {
-		if (!rz_hash_cfg_configure(md, algorithm)) {
-			goto calculate_hash_end;
-		}
-	}
-
-	if (ctx->key.len > 0 && !rz_hash_cfg_hmac(md, ctx->key.buf, ctx->key.len)) {
+	md = hash_cfg_setup(ctx, algorithms);
+	if (!md) {
 		goto calculate_hash_end;
 	}
 
 	if (ctx->compare) {
-		ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
 		size_t cmphashlen = 0;
 		bool result = false;
 
@@ -903,28 +1140,7 @@ static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
 			goto calculate_hash_end;
 		}
 
-		if (!rz_hash_cfg_init(md)) {
-			goto calculate_hash_end;
-		}
-
-		if (ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
-		}
-
-		for (ut64 j = ctx->offset.from; j < to; j += bsize) {
-			int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
-			if (!rz_hash_cfg_update(md, block, read)) {
-				goto calculate_hash_end;
-			}
-		}
-
-		if (!ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
-		}
-		if (!rz_hash_cfg_final(md) ||
-			!rz_hash_cfg_iterate(md, ctx->iterate)) {
+		if (!hash_stream(ctx, io, md, ctx->offset.from, to)) {
 			goto calculate_hash_end;
 		}
 
@@ -944,59 +1160,12 @@ static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
 				pj_end(ctx->pj);
 			}
 		}
-	} else if (ctx->show_blocks) {
-		ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
-		for (ut64 j = ctx->offset.from; j < to; j += bsize) {
-			int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
-			if (!rz_hash_cfg_init(md) ||
-				!rz_hash_cfg_update(md, block, read) ||
-				!rz_hash_cfg_final(md) ||
-				!rz_hash_cfg_iterate(md, ctx->iterate)) {
-				goto calculate_hash_end;
-			}
-
-			rz_list_foreach (algorithms, it, algorithm) {
-				digest = rz_hash_cfg_get_result(md, algorithm, &digest_size);
-				if (ctx->mode == RZ_HASH_MODE_JSON) {
-					pj_o(ctx->pj);
-				}
-				hash_print_digest(ctx, md, algorithm, j, j + bsize, filename);
-				if (ctx->mode == RZ_HASH_MODE_JSON) {
-					pj_end(ctx->pj);
-				}
-			}
-		}
 	} else {
-		ut64 to = ctx->offset.to ? ctx->offset.to : filesize;
-		if (!rz_hash_cfg_init(md)) {
-			goto calculate_hash_end;
-		}
-
-		if (ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
-		}
-
-		for (ut64 j = ctx->offset.from; j < to; j += bsize) {
-			int read = rz_io_pread_at(io, j, block, to - j > bsize ? bsize : (to - j));
-			if (!rz_hash_cfg_update(md, block, read)) {
-				goto calculate_hash_end;
-			}
-		}
-
-		if (!ctx->as_prefix && ctx->seed.buf &&
-			!rz_hash_cfg_update(md, ctx->seed.buf, ctx->seed.len)) {
-			goto calculate_hash_end;
-		}
-
-		if (!rz_hash_cfg_final(md) ||
-			!rz_hash_cfg_iterate(md, ctx->iterate)) {
+		if (!hash_stream(ctx, io, md, ctx->offset.from, to)) {
 			goto calculate_hash_end;
 		}
 
 		rz_list_foreach (algorithms, it, algorithm) {
-			digest = rz_hash_cfg_get_result(md, algorithm, &digest_size);
-
 			if (ctx->mode == RZ_HASH_MODE_JSON) {
 				pj_o(ctx->pj);
 			}
@@ -1010,9 +1179,10 @@ static bool calculate_hash(RzHashContext *ctx, RzIO *io, const char *filename) {
 
 calculate_hash_end:
 	rz_list_free(algorithms);
-	free(block);
 	free(cmphash);
-	rz_hash_cfg_free(md);
+	if (md) {
+		rz_hash_cfg_free(md);
+	}
 	return result;
 }
 
@@ -439,6 +439,7 @@ RZ_API bool rz_reg_set_profile_string(RZ_NONNULL RzReg *reg, RZ_NONNULL const ch
 		return true;
 	}
 
+	reg->profile_gen++;
 	// we should reset all the arenas before setting the new reg profile
 	rz_reg_arena_pop(reg);
 	// Purge the old registers
@@ -0,0 +1,380 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/** \file automaton.c
+ * Aho-Corasick automaton used to find all the keywords of a search with
+ * a single pass over the buffer.
+ *
+ * Binmask and icase keywords cannot be directly encoded in the automaton,
+ * thus each keyword is represented by its anchor: the longest run of bytes
+ * not affected by the binmask. The automaton is built over the lowercase
+ * anchors and the buffer is lowercased while scanned, so it only reports
+ * candidate positions which must still be verified against the complete
+ * keyword. Keywords without any anchor (fully masked) are not part of the
+ * automaton and must be searched without it.
+ */
+
+#include <ctype.h>
+#include "search_private.h"
+
+#define AC_NONE UT32_MAX
+#define AC_ROOT 0
+
+typedef struct {
+	ut32 fail; ///< longest proper suffix of this state which is also a state
+	ut32 dict; ///< nearest state in the fail chain which has outputs
+	ut32 out; ///< first output of this state, index in RzSearchAutomaton.outs
+	ut32 child; ///< first child while building, first transition afterwards
+	ut32 sibling; ///< next sibling (only used while building)
+	ut32 n_trans; ///< number of transitions
+	ut8 byte; ///< byte of the edge from the parent to this state
+} AcState;
+
+typedef struct {
+	ut32 kw; ///< keyword index
+	ut32 next; ///< next output of the same state, AC_NONE when last
+} AcOutput;
+
+typedef struct {
+	ut8 byte;
+	ut32 state;
+} AcTransition;
+
+typedef struct {
+	ut32 offset; ///< offset of the anchor within the keyword
+	ut32 length; ///< length of the anchor, 0 when the keyword has no anchor
+} AcAnchor;
+
+struct rz_search_automaton_t {
+	RzVector /*<AcState>*/ states;
+	RzVector /*<AcOutput>*/ outs;
+	AcTransition *trans; ///< transitions of all the states, sorted by byte
+	ut32 root[256]; ///< complete transition table of the root
+	RzSearchKeyword **kws;
+	AcAnchor *anchors;
+	ut32 n_kws;
+	RzVector /*<ut64>*/ *slots[RZ_SEARCH_AUTOMATON_SLOTS]; ///< n_kws candidate vectors per slot
+};
+
+static inline ut8 ac_fold(ut8 b) {
+	return (ut8)tolower(b);
+}
+
+static inline AcState *ac_state(RzSearchAutomaton *ac, ut32 idx) {
+	return rz_vector_index_ptr(&ac->states, idx);
+}
+
+static AcAnchor find_anchor(const RzSearchKeyword *kw) {
+	AcAnchor best = { 0 };
+	ut32 start = 0;
+	for (ut32 j = 0; j <= kw->keyword_length; j++) {
+		bool full = j < kw->keyword_length &&
+			(!kw->binmask_length || kw->bin_binmask[j % kw->binmask_length] == 0xff);
+		if (full) {
+			continue;
+		}
+		if (j - start > best.length) {
+			best.offset = start;
+			best.length = j - start;
+		}
+		start = j + 1;
+	}
+	return best;
+}
+
+static ut32 ac_state_new(RzSearchAutomaton *ac, ut8 byte) {
+	AcState *st = rz_vector_push(&ac->states, NULL);
+	if (!st) {
+		return AC_NONE;
+	}
+	st->fail = AC_ROOT;
+	st->dict = AC_NONE;
+	st->out = AC_NONE;
+	st->child = AC_NONE;
+	st->sibling = AC_NONE;
+	st->n_trans = 0;
+	st->byte = byte;
+	return rz_vector_len(&ac->states) - 1;
+}
+
+static ut32 ac_child_find(RzSearchAutomaton *ac, ut32 state, ut8 byte) {
+	for (ut32 c = ac_state(ac, state)->child; c != AC_NONE; c = ac_state(ac, c)->sibling) {
+		if (ac_state(ac, c)->byte == byte) {
+			return c;
+		}
+	}
+	return AC_NONE;
+}
+
+static bool ac_insert(RzSearchAutomaton *ac, ut32 kw_idx) {
+	const RzSearchKeyword *kw = ac->kws[kw_idx];
+	const AcAnchor *anchor = &ac->anchors[kw_idx];
+	ut32 state = AC_ROOT;
+	for (ut32 j = 0; j < anchor->length; j++) {
+		ut8 byte = ac_fold(kw->bin_keyword[anchor->offset + j]);
+		ut32 next = ac_child_find(ac, state, byte);
+		if (next == AC_NONE) {
+			next = ac_state_new(ac, byte);
+			if (next == AC_NONE) {
+				return false;
+			}
+			AcState *parent = ac_state(ac, state);
+			ac_state(ac, next)->sibling = parent->child;
+			parent->child = next;
+			parent->n_trans++;
+		}
+		state = next;
+	}
+	AcOutput *out = rz_vector_push(&ac->outs, NULL);
+	if (!out) {
+		return false;
+	}
+	AcState *st = ac_state(ac, state);
+	out->kw = kw_idx;
+	out->next = st->out;
+	st->out = rz_vector_len(&ac->outs) - 1;
+	return true;
+}
+
+static int trans_cmp(const void *a, const void *b) {
+	const AcTransition *ta = a, *tb = b;
+	return (int)ta->byte - (int)tb->byte;
+}
+
+static inline ut32 ac_goto(const RzSearchAutomaton *ac, ut32 state, ut8 byte) {
+	if (state == AC_ROOT) {
+		return ac->root[byte];
+	}
+	const AcState *st = rz_vector_index_ptr((RzVector *)&ac->states, state);
+	const AcTransition *t = ac->trans + st->child;
+	ut32 lo = 0, hi = st->n_trans;
+	while (lo < hi) {
+		ut32 mid = (lo + hi) / 2;
+		if (t[mid].byte < byte) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo < st->n_trans && t[lo].byte == byte ? t[lo].state : AC_NONE;
+}
+
+/**
+ * Converts the children lists into sorted transition arrays and computes
+ * the fail and dictionary links with a BFS visit of the trie.
+ */
+static bool ac_finalize(RzSearchAutomaton *ac) {
+	ut32 n_states = rz_vector_len(&ac->states);
+	ut32 *queue = RZ_NEWS(ut32, n_states);
+	ac->trans = RZ_NEWS0(AcTransition, RZ_MAX(n_states, 1));
+	if (!queue || !ac->trans) {
+		free(queue);
+		return false;
+	}
+
+	ut32 n_trans = 0;
+	for (ut32 i = 0; i < n_states; i++) {
+		AcState *st = ac_state(ac, i);
+		ut32 first = n_trans;
+		for (ut32 c = st->child; c != AC_NONE; c = ac_state(ac, c)->sibling) {
+			ac->trans[n_trans].byte = ac_state(ac, c)->byte;
+			ac->trans[n_trans].state = c;
+			n_trans++;
+		}
+		qsort(ac->trans + first, st->n_trans, sizeof(AcTransition), trans_cmp);
+		st->child = first;
+	}
+
+	for (ut32 b = 0; b < 256; b++) {
+		ac->root[b] = AC_ROOT;
+	}
+	ut32 head = 0, tail = 0;
+	const AcState *root = ac_state(ac, AC_ROOT);
+	for (ut32 t = 0; t < root->n_trans; t++) {
+		const AcTransition *tr = ac->trans + root->child + t;
+		ac->root[tr->byte] = tr->state;
+		queue[tail++] = tr->state;
+	}
+
+	while (head < tail) {
+		ut32 cur = queue[head++];
+		AcState *st = ac_state(ac, cur);
+		ut32 first = st->child, count = st->n_trans;
+		for (ut32 t = 0; t < count; t++) {
+			const AcTransition *tr = ac->trans + first + t;
+			ut32 child = tr->state;
+			ut32 f = ac_state(ac, cur)->fail;
+			ut32 next;
+			while ((next = ac_goto(ac, f, tr->byte)) == AC_NONE) {
+				f = ac_state(ac, f)->fail;
+			}
+			AcState *cst = ac_state(ac, child);
+			cst->fail = next == child ? AC_ROOT : next;
+			const AcState *fst = ac_state(ac, cst->fail);
+			cst->dict = fst->out != AC_NONE ? cst->fail : fst->dict;
+			queue[tail++] = child;
+		}
+	}
+	free(queue);
+	return true;
+}
+
+/**
+ * \brief Builds the automaton for the given keywords.
+ *
+ * The indexes used by the other functions are the positions of the
+ * keywords within \p kws.
+ */
+RZ_IPI RzSearchAutomaton *rz_search_automaton_new(RZ_NONNULL RzList /*<RzSearchKeyword *>*/ *kws) {
+	rz_return_val_if_fail(kws, NULL);
+	RzSearchAutomaton *ac = RZ_NEW0(RzSearchAutomaton);
+	if (!ac) {
+		return NULL;
+	}
+	rz_vector_init(&ac->states, sizeof(AcState), NULL, NULL);
+	rz_vector_init(&ac->outs, sizeof(AcOutput), NULL, NULL);
+	ac->n_kws = rz_list_length(kws);
+	ac->kws = RZ_NEWS0(RzSearchKeyword *, RZ_MAX(ac->n_kws, 1));
+	ac->anchors = RZ_NEWS0(AcAnchor, RZ_MAX(ac->n_kws, 1));
+	if (!ac->kws || !ac->anchors || ac_state_new(ac, 0) != AC_ROOT) {
+		goto fail;
+	}
+	for (ut32 s = 0; s < RZ_SEARCH_AUTOMATON_SLOTS; s++) {
+		ac->slots[s] = RZ_NEWS0(RzVector, RZ_MAX(ac->n_kws, 1));
+		if (!ac->slots[s]) {
+			goto fail;
+		}
+		for (ut32 i = 0; i < ac->n_kws; i++) {
+			rz_vector_init(&ac->slots[s][i], sizeof(ut64), NULL, NULL);
+		}
+	}
+
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	ut32 idx = 0;
+	rz_list_foreach (kws, iter, kw) {
+		ac->kws[idx] = kw;
+		ac->anchors[idx] = find_anchor(kw);
+		if (ac->anchors[idx].length && !ac_insert(ac, idx)) {
+			goto fail;
+		}
+		idx++;
+	}
+	if (!ac_finalize(ac)) {
+		goto fail;
+	}
+	return ac;
+
+fail:
+	rz_search_automaton_free(ac);
+	return NULL;
+}
+
+RZ_IPI void rz_search_automaton_free(RZ_NULLABLE RzSearchAutomaton *ac) {
+	if (!ac) {
+		return;
+	}
+	for (ut32 s = 0; s < RZ_SEARCH_AUTOMATON_SLOTS; s++) {
+		if (!ac->slots[s]) {
+			continue;
+		}
+		for (ut32 i = 0; i < ac->n_kws; i++) {
+			rz_vector_fini(&ac->slots[s][i]);
+		}
+		free(ac->slots[s]);
+	}
+	rz_vector_fini(&ac->states);
+	rz_vector_fini(&ac->outs);
+	free(ac->trans);
+	free(ac->kws);
+	free(ac->anchors);
+	free(ac);
+}
+
+/**
+ * \brief Returns true if the keyword at \p kw_idx can be found via the automaton.
+ */
+RZ_IPI bool rz_search_automaton_has_anchor(RZ_NONNULL const RzSearchAutomaton *ac, ut32 kw_idx) {
+	rz_return_val_if_fail(ac, false);
+	return kw_idx < ac->n_kws && ac->anchors[kw_idx].length > 0;
+}
+
+/**
+ * \brief Returns the keyword at \p kw_idx used to build the automaton.
+ */
+RZ_IPI RZ_BORROW RzSearchKeyword *rz_search_automaton_keyword(RZ_NONNULL const RzSearchAutomaton *ac, ut32 kw_idx) {
+	rz_return_val_if_fail(ac, NULL);
+	return kw_idx < ac->n_kws ? ac->kws[kw_idx] : NULL;
+}
+
+static void ac_scan(const RzSearchAutomaton *ac, const ut8 *buf, ut64 len, RzVector /*<ut64>*/ *cands) {
+	const AcOutput *outs = (const AcOutput *)ac->outs.a;
+	const AcState *states = (const AcState *)ac->states.a;
+	ut32 state = AC_ROOT;
+	for (ut64 t = 0; t < len; t++) {
+		ut8 byte = ac_fold(buf[t]);
+		ut32 next;
+		while ((next = ac_goto(ac, state, byte)) == AC_NONE) {
+			state = states[state].fail;
+		}
+		state = next;
+		const AcState *st = &states[state];
+		ut32 o = st->out != AC_NONE ? state : st->dict;
+		while (o != AC_NONE) {
+			const AcState *ost = &states[o];
+			for (ut32 i = ost->out; i != AC_NONE; i = outs[i].next) {
+				ut32 kw_idx = outs[i].kw;
+				const AcAnchor *anchor = &ac->anchors[kw_idx];
+				ut64 end = t + 1 - anchor->length; // start of the anchor
+				if (end < anchor->offset) {
+					continue;
+				}
+				ut64 pos = end - anchor->offset;
+				if (len - pos < ac->kws[kw_idx]->keyword_length) {
+					continue;
+				}
+				rz_vector_push(&cands[kw_idx], &pos);
+			}
+			o = ost->dict;
+		}
+	}
+}
+
+/**
+ * \brief Scans the buffer and collects the candidate positions of every keyword.
+ *
+ * A position is a candidate when the anchor of the keyword matches there
+ * (ignoring the case) and the whole keyword fits within the buffer.
+ *
+ * \param ac    The automaton
+ * \param slot  Which set of vectors to fill (< RZ_SEARCH_AUTOMATON_SLOTS)
+ * \param buf   The buffer to scan
+ * \param len   The length of the buffer
+ *
+ * \return An array of vectors, one per keyword, with the sorted candidate positions
+ */
+RZ_IPI RZ_BORROW RzVector /*<ut64>*/ *rz_search_automaton_scan(RZ_NONNULL RzSearchAutomaton *ac, ut32 slot, RZ_NONNULL const ut8 *buf, ut64 len) {
+	rz_return_val_if_fail(ac && buf && slot < RZ_SEARCH_AUTOMATON_SLOTS, NULL);
+	RzVector *cands = ac->slots[slot];
+	for (ut32 i = 0; i < ac->n_kws; i++) {
+		rz_vector_clear(&cands[i]);
+	}
+	ac_scan(ac, buf, len, cands);
+	return cands;
+}
+
+/**
+ * \brief Same as rz_search_automaton_scan() but fills the vectors of the caller
+ *
+ * The automaton is not modified, so multiple threads can scan different
+ * buffers with the same automaton at the same time.
+ *
+ * \param cands  One vector of ut64 per keyword, cleared before the scan
+ */
+RZ_IPI void rz_search_automaton_scan_into(RZ_NONNULL const RzSearchAutomaton *ac, RZ_NONNULL const ut8 *buf, ut64 len, RZ_NONNULL RZ_OUT RzVector /*<ut64>*/ *cands) {
+	rz_return_if_fail(ac && buf && cands);
+	for (ut32 i = 0; i < ac->n_kws; i++) {
+		rz_vector_clear(&cands[i]);
+	}
+	ac_scan(ac, buf, len, cands);
+}
@@ -4,6 +4,7 @@
 #include <rz_search.h>
 #include <rz_list.h>
 #include <ctype.h>
+#include "search_private.h"
 
 // Experimental search engine (fails, because stops at first hit of every block read
 #define USE_BMH 0
@@ -55,6 +56,7 @@ RZ_API RzSearch *rz_search_free(RzSearch *s) {
 	}
 	rz_list_free(s->hits);
 	rz_list_free(s->kws);
+	rz_search_automaton_free(s->automaton);
 	// rz_io_free(s->iob.io); this is supposed to be a weak reference
 	free(s->data);
 	free(s);
@@ -288,7 +290,7 @@ RZ_API int rz_search_deltakey_update(RzSearch *s, ut64 from, const ut8 *buf, int
 	return s->nhits - old_nhits;
 }
 
-static bool brute_force_match(RzSearch *s, RzSearchKeyword *kw, const ut8 *buf, int i) {
+static bool brute_force_match(const RzSearch *s, const RzSearchKeyword *kw, const ut8 *buf, int i) {
 	int j = 0;
 	if (s->distance) { // slow path, more work in the loop
 		int dist = 0;
@@ -345,6 +347,70 @@ static bool brute_force_match(RzSearch *s, RzSearchKeyword *kw, const ut8 *buf,
 	return j == kw->keyword_length;
 }
 
+/**
+ * Searches \p kw within data[i, end) and reports the hits.
+ * When \p cands is given only the positions it contains are checked.
+ *
+ * \return 0 to continue, 1 when the search must stop, -1 on error
+ */
+static int kw_search_range(RzSearch *s, RzSearchKeyword *kw, ut64 from, const ut8 *data, ut64 data_len, ut64 i, ut64 end, ut64 shift, RZ_NULLABLE RzVector /*<ut64>*/ *cands) {
+	const ut64 *cand = cands ? (const ut64 *)cands->a : NULL;
+	ut64 n_cands = cands ? rz_vector_len(cands) : 0;
+	ut64 c = 0;
+	while (true) {
+		if (cands) {
+			while (c < n_cands && cand[c] < i) {
+				c++;
+			}
+			if (c == n_cands) {
+				break;
+			}
+			i = cand[c++];
+		}
+		if (i + kw->keyword_length > data_len || i >= end) {
+			break;
+		}
+		if (brute_force_match(s, kw, data, i) != s->inverse) {
+			int t = rz_search_hit_new(s, kw, s->bckwrds ? from - kw->keyword_length - i + shift : from + i - shift);
+			if (!t) {
+				return -1;
+			}
+			if (t > 1) {
+				return 1;
+			}
+			if (!s->overlap) {
+				i += kw->keyword_length - 1;
+			}
+		}
+		i++;
+	}
+	return 0;
+}
+
+static bool search_use_automaton(const RzSearch *s) {
+	// the automaton only reports exact matches of the keywords
+	return !s->inverse && !s->distance && rz_list_length(s->kws) >= 2;
+}
+
+static bool search_automaton_is_valid(const RzSearch *s) {
+	ut32 n = rz_list_length(s->kws);
+	return s->automaton && rz_search_automaton_keyword(s->automaton, n - 1) == rz_list_last(s->kws) && !rz_search_automaton_keyword(s->automaton, n);
+}
+
+static RzSearchAutomaton *search_automaton(RzSearch *s) {
+	if (!search_use_automaton(s)) {
+		return NULL;
+	}
+	if (s->automaton && !search_automaton_is_valid(s)) {
+		rz_search_automaton_free(s->automaton);
+		s->automaton = NULL;
+	}
+	if (!s->automaton) {
+		s->automaton = rz_search_automaton_new(s->kws);
+	}
+	return s->automaton;
+}
+
 // Supported search variants: backward, binmask, icase, inverse, overlap
 RZ_API int rz_search_mybinparse_update(RzSearch *s, ut64 from, const ut8 *buf, int len) {
 	RzSearchKeyword *kw;
@@ -384,41 +450,36 @@ RZ_API int rz_search_mybinparse_update(RzSearch *s, ut64 from, const ut8 *buf, i
 
 	ut64 len1 = left->len + RZ_MIN(longest - 1, len);
 	memcpy(left->data + left->len, buf, len1 - left->len);
+
+	// find the candidates of all the keywords with a single pass per buffer
+	RzSearchAutomaton *ac = search_automaton(s);
+	RzVector *left_cands = NULL, *buf_cands = NULL;
+	if (ac) {
+		left_cands = rz_search_automaton_scan(ac, 0, left->data, len1);
+		buf_cands = rz_search_automaton_scan(ac, 1, buf, len);
+	}
+	ut32 kw_idx = 0;
 	rz_list_foreach (s->kws, iter, kw) {
+		bool use_ac = ac && left_cands && buf_cands && rz_search_automaton_has_anchor(ac, kw_idx);
 		i = s->overlap || !kw->count ? 0 : s->bckwrds ? kw->last - from < left->len ? from + left->len - kw->last : 0
 			: from - kw->last < left->len         ? kw->last + left->len - from
 							      : 0;
-		for (; i + kw->keyword_length <= len1 && i < left->len; i++) {
-			if (brute_force_match(s, kw, left->data, i) != s->inverse) {
-				int t = rz_search_hit_new(s, kw, s->bckwrds ? from - kw->keyword_length - i + left->len : from + i - left->len);
-				if (!t) {
-					return -1;
-				}
-				if (t > 1) {
-					return s->nhits - old_nhits;
-				}
-				if (!s->overlap) {
-					i += kw->keyword_length - 1;
-				}
-			}
+		// the hits ending within the leftover were found with the previous buffer
+		if (left->len >= kw->keyword_length) {
+			i = RZ_MAX(i, left->len - kw->keyword_length + 1);
+		}
+		int r = kw_search_range(s, kw, from, left->data, len1, i, left->len, left->len, use_ac ? &left_cands[kw_idx] : NULL);
+		if (r) {
+			return r < 0 ? -1 : s->nhits - old_nhits;
 		}
 		i = s->overlap || !kw->count ? 0 : s->bckwrds ? from > kw->last ? from - kw->last : 0
 			: from < kw->last                     ? kw->last - from
 							      : 0;
-		for (; i + kw->keyword_length <= len; i++) {
-			if (brute_force_match(s, kw, buf, i) != s->inverse) {
-				int t = rz_search_hit_new(s, kw, s->bckwrds ? from - kw->keyword_length - i : from + i);
-				if (!t) {
-					return -1;
-				}
-				if (t > 1) {
-					return s->nhits - old_nhits;
-				}
-				if (!s->overlap) {
-					i += kw->keyword_length - 1;
-				}
-			}
+		r = kw_search_range(s, kw, from, buf, len, i, len, 0, use_ac ? &buf_cands[kw_idx] : NULL);
+		if (r) {
+			return r < 0 ? -1 : s->nhits - old_nhits;
 		}
+		kw_idx++;
 	}
 	if (len < longest - 1) {
 		if (len1 < longest) {
@@ -436,6 +497,151 @@ RZ_API int rz_search_mybinparse_update(RzSearch *s, ut64 from, const ut8 *buf, i
 	return s->nhits - old_nhits;
 }
 
+/**
+ * \brief Checks if a keyword matches the buffer at a given index.
+ *
+ * Unlike rz_search_update() this does not update any state of \p s or
+ * \p kw and it doesn't handle the hit, so it is safe to be called from
+ * multiple threads at the same time on the same search and keyword.
+ * The search settings (distance and inverse) are honored.
+ *
+ * \param s    The search containing the settings to use
+ * \param kw   The keyword to match
+ * \param buf  The buffer to check
+ * \param len  The length of the buffer
+ * \param idx  The index within the buffer where to check the keyword
+ *
+ * \return true when the keyword matches at \p idx, otherwise false
+ */
+RZ_API bool rz_search_keyword_match_at(RZ_NONNULL const RzSearch *s, RZ_NONNULL const RzSearchKeyword *kw, RZ_NONNULL const ut8 *buf, ut64 len, ut64 idx) {
+	rz_return_val_if_fail(s && kw && buf, false);
+	if (!kw->keyword_length || idx >= len || len - idx < kw->keyword_length) {
+		return false;
+	}
+	return brute_force_match(s, kw, buf + idx, 0) != s->inverse;
+}
+
+/**
+ * \brief Builds the data shared by rz_search_keywords_find() for the current keywords
+ *
+ * Must be called again whenever the keywords or the settings of \p s change,
+ * otherwise rz_search_keywords_find() is still correct but slower.
+ */
+RZ_API void rz_search_keywords_prepare(RZ_NONNULL RzSearch *s) {
+	rz_return_if_fail(s);
+	search_automaton(s);
+}
+
+/**
+ * \brief Finds all the matches of the keywords within a buffer
+ *
+ * The matches are reported keyword after keyword, in the order of
+ * RzSearch.kws, and by increasing position for each keyword. Overlapping
+ * matches are all reported and no hit is recorded, thus the callback is
+ * in charge of search.overlap, search.align and search.maxhits.
+ *
+ * Neither \p s nor its keywords are modified, so multiple threads can search
+ * different buffers with the same search at the same time, once
+ * rz_search_keywords_prepare() has been called.
+ *
+ * \param s     The search containing the keywords and the settings to use
+ * \param buf   The buffer to search
+ * \param len   The length of the buffer
+ * \param cb    The callback called with each match, return false to stop
+ * \param user  The user pointer passed to \p cb
+ * \return false when stopped by \p cb or on allocation failure, otherwise true
+ */
+RZ_API bool rz_search_keywords_find(RZ_NONNULL const RzSearch *s, RZ_NONNULL const ut8 *buf, ut64 len, RZ_NONNULL RzSearchMatchCallback cb, RZ_NULLABLE void *user) {
+	rz_return_val_if_fail(s && buf && cb, false);
+	const RzSearchAutomaton *ac = search_use_automaton(s) && search_automaton_is_valid(s) ? s->automaton : NULL;
+	ut32 n_kws = rz_list_length(s->kws);
+	RzVector *cands = NULL;
+	if (ac) {
+		cands = RZ_NEWS0(RzVector, n_kws);
+		if (!cands) {
+			return false;
+		}
+		for (ut32 i = 0; i < n_kws; i++) {
+			rz_vector_init(&cands[i], sizeof(ut64), NULL, NULL);
+		}
+		rz_search_automaton_scan_into(ac, buf, len, cands);
+	}
+	bool ret = true;
+	ut32 kw_idx = 0;
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	rz_list_foreach (s->kws, iter, kw) {
+		if (!kw->keyword_length || len < kw->keyword_length) {
+			kw_idx++;
+			continue;
+		}
+		if (ac && rz_search_automaton_has_anchor(ac, kw_idx)) {
+			ut64 *pos;
+			rz_vector_foreach (&cands[kw_idx], pos) {
+				if (brute_force_match(s, kw, buf, *pos) && !cb(kw, kw_idx, *pos, user)) {
+					ret = false;
+					goto end;
+				}
+			}
+		} else {
+			for (ut64 i = 0; i + kw->keyword_length <= len; i++) {
+				if (brute_force_match(s, kw, buf, i) != s->inverse && !cb(kw, kw_idx, i, user)) {
+					ret = false;
+					goto end;
+				}
+			}
+		}
+		kw_idx++;
+	}
+end:
+	if (cands) {
+		for (ut32 i = 0; i < n_kws; i++) {
+			rz_vector_fini(&cands[i]);
+		}
+		free(cands);
+	}
+	return ret;
+}
+
+/**
+ * \brief Sets the bytes ending at \p end which were searched last
+ *
+ * A keyword search which does not go through rz_search_update() must call
+ * this with the bytes it searched last, so the next rz_search_update()
+ * starting at \p end finds the hits across the two buffers, as if \p buf
+ * had been searched with rz_search_update().
+ *
+ * \param s    The search
+ * \param end  The address following the last byte of \p buf
+ * \param buf  The last searched bytes, only the ones a hit can start with are kept
+ * \param len  The length of \p buf
+ * \return false on allocation failure
+ */
+RZ_API bool rz_search_set_leftover(RZ_NONNULL RzSearch *s, ut64 end, RZ_NONNULL const ut8 *buf, ut64 len) {
+	rz_return_val_if_fail(s && buf, false);
+	RzListIter *iter;
+	RzSearchKeyword *kw;
+	int longest = 0;
+	rz_list_foreach (s->kws, iter, kw) {
+		longest = RZ_MAX(longest, kw->keyword_length);
+	}
+	if (!longest) {
+		return true;
+	}
+	RzSearchLeftover *left = s->data;
+	if (!left) {
+		left = malloc(sizeof(RzSearchLeftover) + (size_t)2 * (longest - 1));
+		if (!left) {
+			return false;
+		}
+		s->data = left;
+	}
+	left->len = RZ_MIN(len, longest - 1);
+	memcpy(left->data, buf + len - left->len, left->len);
+	left->end = end;
+	return true;
+}
+
 RZ_API void rz_search_set_distance(RzSearch *s, int dist) {
 	if (dist >= RZ_SEARCH_DISTANCE_MAX) {
 		eprintf("Invalid distance\n");
@@ -499,6 +705,8 @@ RZ_API int rz_search_kw_add(RzSearch *s, RzSearchKeyword *kw) {
 	}
 	kw->kwidx = s->n_kws++;
 	rz_list_append(s->kws, kw);
+	rz_search_automaton_free(s->automaton);
+	s->automaton = NULL;
 	return true;
 }
 
@@ -507,6 +715,8 @@ RZ_API void rz_search_string_prepare_backward(RzSearch *s) {
 	RzListIter *iter;
 	RzSearchKeyword *kw;
 	// Precondition: !kw->binmask_length || kw->keyword_length % kw->binmask_length == 0
+	rz_search_automaton_free(s->automaton);
+	s->automaton = NULL;
 	rz_list_foreach (s->kws, iter, kw) {
 		ut8 *i = kw->bin_keyword, *j = kw->bin_keyword + kw->keyword_length;
 		while (i < j) {
@@ -535,4 +745,6 @@ RZ_API void rz_search_kw_reset(RzSearch *s) {
 	rz_list_purge(s->kws);
 	rz_list_purge(s->hits);
 	RZ_FREE(s->data);
+	rz_search_automaton_free(s->automaton);
+	s->automaton = NULL;
 }
@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef RZ_SEARCH_PRIVATE_H
+#define RZ_SEARCH_PRIVATE_H
+
+#include <rz_search.h>
+
+/* automaton.c */
+#define RZ_SEARCH_AUTOMATON_SLOTS 2
+
+RZ_IPI RzSearchAutomaton *rz_search_automaton_new(RZ_NONNULL RzList /*<RzSearchKeyword *>*/ *kws);
+RZ_IPI void rz_search_automaton_free(RZ_NULLABLE RzSearchAutomaton *ac);
+RZ_IPI bool rz_search_automaton_has_anchor(RZ_NONNULL const RzSearchAutomaton *ac, ut32 kw_idx);
+RZ_IPI RZ_BORROW RzSearchKeyword *rz_search_automaton_keyword(RZ_NONNULL const RzSearchAutomaton *ac, ut32 kw_idx);
+RZ_IPI RZ_BORROW RzVector /*<ut64>*/ *rz_search_automaton_scan(RZ_NONNULL RzSearchAutomaton *ac, ut32 slot, RZ_NONNULL const ut8 *buf, ut64 len);
+RZ_IPI void rz_search_automaton_scan_into(RZ_NONNULL const RzSearchAutomaton *ac, RZ_NONNULL const ut8 *buf, ut64 len, RZ_NONNULL RZ_OUT RzVector /*<ut64>*/ *cands);
+
+#endif /* RZ_SEARCH_PRIVATE_H */
@@ -347,7 +347,7 @@ static bool is_pattern_matching(ut32 p_size, const ut8 *pattern, const ut8 *mask
 	return true;
 }
 
-static bool check_crc16(const RzFlirtModule *module, ut8 *b, ut32 b_size) {
+static bool check_crc16(const RzFlirtModule *module, const ut8 *b, ut32 b_size) {
 	if (!module->crc_length) {
 		return true;
 	} else if ((b_size - RZ_FLIRT_MAX_PRELUDE_SIZE) < module->crc_length) {
@@ -356,6 +356,28 @@ static bool check_crc16(const RzFlirtModule *module, ut8 *b, ut32 b_size) {
 	return module->crc16 == flirt_crc16(b + RZ_FLIRT_MAX_PRELUDE_SIZE, module->crc_length);
 }
 
+/**
+ * \brief Checks if the crc16 and the tail bytes of the module match the buffer
+ */
+static bool module_match_buffer(const RzFlirtModule *module, const ut8 *b, ut32 buf_size) {
+	RzListIter *it = NULL;
+	RzFlirtTailByte *tail_byte = NULL;
+
+	if (!check_crc16(module, b, buf_size)) {
+		return false;
+	}
+	if (module->tail_bytes) {
+		size_t begin = RZ_FLIRT_MAX_PRELUDE_SIZE + module->crc_length;
+		rz_list_foreach (module->tail_bytes, it, tail_byte) {
+			if ((begin + tail_byte->offset) < buf_size &&
+				b[begin + tail_byte->offset] != tail_byte->value) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 static bool try_rename_function(RzAnalysis *analysis, RzAnalysisFunction *fcn, const char *name) {
 	if (fcn->type == RZ_ANALYSIS_FCN_TYPE_SYM) {
 		// do not rename if is a symbol but check if
@@ -366,36 +388,20 @@ static bool try_rename_function(RzAnalysis *analysis, RzAnalysisFunction *fcn, c
 }
 
 /**
- * \brief Checks if the module matches the buffer and renames the matched functions
+ * \brief Renames (and resizes) the functions described by a module which matched at the given address
  *
  * \param analysis  The RzAnalysis struct from where to fetch and modify the functions
- * \param module    The FLIRT module to match against the buffer
- * \param b         Buffer to check
+ * \param module    The FLIRT module which matched
  * \param address   Function address
- * \param buf_size  Size of the buffer to check
  *
- * \return True if pattern does match, false otherwise.
+ * \return False on allocation failure, otherwise true.
  */
-static int module_match_buffer(RzAnalysis *analysis, const RzFlirtModule *module, ut8 *b, ut64 address, ut32 buf_size) {
+static bool module_apply(RzAnalysis *analysis, const RzFlirtModule *module, ut64 address) {
 	RzFlirtFunction *flirt_func = NULL;
 	RzAnalysisFunction *next_module_function = NULL;
 	RzListIter *it = NULL;
-	RzFlirtTailByte *tail_byte = NULL;
 	ut32 name_index = 0;
 
-	if (!check_crc16(module, b, buf_size)) {
-		return false;
-	}
-	if (module->tail_bytes) {
-		size_t begin = RZ_FLIRT_MAX_PRELUDE_SIZE + module->crc_length;
-		rz_list_foreach (module->tail_bytes, it, tail_byte) {
-			if ((begin + tail_byte->offset) < buf_size &&
-				b[begin + tail_byte->offset] != tail_byte->value) {
-				return false;
-			}
-		}
-	}
-
 	rz_list_foreach (module->public_functions, it, flirt_func) {
 		if (next_module_function && (address + flirt_func->offset) == next_module_function->addr) {
 			// ensures that the next function is an actual function not pointing to the same offset
@@ -478,79 +484,259 @@ static int module_match_buffer(RzAnalysis *analysis, const RzFlirtModule *module
 	return true;
 }
 
-static int node_match_buffer(RzAnalysis *analysis, const RzFlirtNode *node, ut8 *b, ut64 address, ut32 buf_size, ut32 buf_idx) {
-	RzListIter *node_child_it, *module_it;
-	RzFlirtNode *child;
-	RzFlirtModule *module;
+/**
+ * The FLIRT tree is flattened into its leaves: each leaf holds the whole
+ * prelude pattern from the root to a node with modules, in the same order
+ * as the depth first walk done by IDA. The leaves are then indexed by their
+ * first two bytes, so a function is compared only against the leaves which
+ * can match its first bytes plus the ones starting with variant bytes.
+ */
+#define FLIRT_INDEX_PREFIX_WORDS (RZ_FLIRT_MAX_PRELUDE_SIZE / sizeof(ut64))
+#define FLIRT_INDEX_JOBS_BATCH   4096
+#define FLIRT_KEY_CMP(x, y)      ((int)(x) - (int)(y).key)
+
+typedef struct flirt_leaf_t {
+	ut64 prefix_bytes[FLIRT_INDEX_PREFIX_WORDS]; ///< first pattern bytes, the variant ones set to zero
+	ut64 prefix_mask[FLIRT_INDEX_PREFIX_WORDS]; ///< mask of the first pattern bytes
+	ut32 length; ///< full pattern length
+	ut8 *bytes; ///< full pattern bytes
+	ut8 *mask; ///< full pattern mask
+	const RzList /*<RzFlirtModule *>*/ *modules;
+} FlirtLeaf;
+
+typedef struct flirt_key_t {
+	ut16 key; ///< first two bytes of the pattern
+	ut32 leaf; ///< index of the leaf
+} FlirtKey;
+
+struct rz_flirt_index_t {
+	RzFlirtNode *root;
+	RzVector /*<FlirtLeaf>*/ leaves;
+	RzVector /*<FlirtKey>*/ keys; ///< leaves with the first two bytes fixed, sorted by key and leaf
+	RzVector /*<ut32>*/ wildcards; ///< leaves with variant bytes within the first two
+};
+
+typedef struct flirt_path_t {
+	ut8 *bytes;
+	ut8 *mask;
+	ut32 length;
+	ut32 size;
+} FlirtPath;
+
+static void flirt_leaf_fini(void *e, void *user) {
+	FlirtLeaf *leaf = e;
+	free(leaf->bytes);
+	free(leaf->mask);
+}
 
-	if (is_pattern_matching(node->length, node->pattern_bytes, node->pattern_mask, b + buf_idx, buf_size - buf_idx)) {
-		if (node->child_list) {
-			rz_list_foreach (node->child_list, node_child_it, child) {
-				if (node_match_buffer(analysis, child, b, address, buf_size, buf_idx + node->length)) {
-					return true;
-				}
-			}
-		} else if (node->module_list) {
-			rz_list_foreach (node->module_list, module_it, module) {
-				if (module_match_buffer(analysis, module, b, address, buf_size)) {
-					return true;
-				}
+static bool index_add_leaf(RzFlirtIndex *index, const FlirtPath *path, const RzList *modules) {
+	FlirtLeaf *leaf = rz_vector_push(&index->leaves, NULL);
+	if (!leaf) {
+		return false;
+	}
+	memset(leaf, 0, sizeof(FlirtLeaf));
+	leaf->length = path->length;
+	leaf->modules = modules;
+	if (path->length) {
+		leaf->bytes = rz_mem_dup(path->bytes, path->length);
+		leaf->mask = rz_mem_dup(path->mask, path->length);
+		if (!leaf->bytes || !leaf->mask) {
+			return false;
+		}
+	}
+	ut8 prefix_bytes[RZ_FLIRT_MAX_PRELUDE_SIZE] = { 0 };
+	ut8 prefix_mask[RZ_FLIRT_MAX_PRELUDE_SIZE] = { 0 };
+	for (ut32 i = 0; i < path->length && i < RZ_FLIRT_MAX_PRELUDE_SIZE; i++) {
+		prefix_mask[i] = path->mask[i] == 0xFF ? 0xFF : 0;
+		prefix_bytes[i] = path->bytes[i] & prefix_mask[i];
+	}
+	memcpy(leaf->prefix_bytes, prefix_bytes, sizeof(prefix_bytes));
+	memcpy(leaf->prefix_mask, prefix_mask, sizeof(prefix_mask));
+
+	ut32 leaf_idx = rz_vector_len(&index->leaves) - 1;
+	if (path->length >= 2 && prefix_mask[0] && prefix_mask[1]) {
+		FlirtKey key = { .key = rz_read_le16(prefix_bytes), .leaf = leaf_idx };
+		return rz_vector_push(&index->keys, &key) != NULL;
+	}
+	return rz_vector_push(&index->wildcards, &leaf_idx) != NULL;
+}
+
+static bool index_add_node(RzFlirtIndex *index, const RzFlirtNode *node, FlirtPath *path) {
+	ut32 length = path->length;
+	if (path->length + node->length > path->size) {
+		ut32 size = RZ_MAX(path->size * 2, path->length + node->length);
+		ut8 *bytes = realloc(path->bytes, size);
+		if (!bytes) {
+			return false;
+		}
+		path->bytes = bytes;
+		ut8 *mask = realloc(path->mask, size);
+		if (!mask) {
+			return false;
+		}
+		path->mask = mask;
+		path->size = size;
+	}
+	if (node->length) {
+		memcpy(path->bytes + path->length, node->pattern_bytes, node->length);
+		memcpy(path->mask + path->length, node->pattern_mask, node->length);
+		path->length += node->length;
+	}
+
+	bool ret = true;
+	RzListIter *it;
+	RzFlirtNode *child;
+	if (node->child_list) {
+		rz_list_foreach (node->child_list, it, child) {
+			if (!(ret = index_add_node(index, child, path))) {
+				break;
 			}
 		}
+	} else if (node->module_list) {
+		ret = index_add_leaf(index, path, node->module_list);
 	}
+	path->length = length;
+	return ret;
+}
 
-	return false;
+static int flirt_key_cmp(const void *a, const void *b, void *user) {
+	const FlirtKey *ka = a;
+	const FlirtKey *kb = b;
+	if (ka->key != kb->key) {
+		return ka->key < kb->key ? -1 : 1;
+	}
+	return ka->leaf < kb->leaf ? -1 : (ka->leaf > kb->leaf);
 }
 
 /**
- * \brief Tries to find matching functions between the signature infos in root_node and the analyzed functions in analysis
+ * \brief Builds the matching index of a FLIRT tree
  *
- * \param analysis   The analysis
- * \param root_node  The root node
- *
- * \return False on error, otherwise true
+ * \param  root  The root node of the FLIRT tree; on success the index owns it
+ * \return The index or NULL on failure
  */
-static bool node_match_functions(RzAnalysis *analysis, const RzFlirtNode *root_node) {
-	bool ret = true;
+RZ_API RZ_OWN RzFlirtIndex *rz_sign_flirt_index_new(RZ_NONNULL RZ_OWN RzFlirtNode *root) {
+	rz_return_val_if_fail(root, NULL);
+	RzFlirtIndex *index = RZ_NEW0(RzFlirtIndex);
+	if (!index) {
+		return NULL;
+	}
+	rz_vector_init(&index->leaves, sizeof(FlirtLeaf), flirt_leaf_fini, NULL);
+	rz_vector_init(&index->keys, sizeof(FlirtKey), NULL, NULL);
+	rz_vector_init(&index->wildcards, sizeof(ut32), NULL, NULL);
+
+	FlirtPath path = { 0 };
+	bool ok = true;
+	RzListIter *it;
+	RzFlirtNode *child;
+	rz_list_foreach (root->child_list, it, child) {
+		if (!(ok = index_add_node(index, child, &path))) {
+			break;
+		}
+	}
+	free(path.bytes);
+	free(path.mask);
+	if (!ok) {
+		RZ_LOG_ERROR("FLIRT: cannot allocate the signature index\n");
+		rz_sign_flirt_index_free(index);
+		return NULL;
+	}
+	rz_vector_sort(&index->keys, flirt_key_cmp, false, NULL);
+	index->root = root;
+	return index;
+}
 
-	if (rz_list_length(analysis->fcns) == 0) {
-		RZ_LOG_ERROR("FLIRT: There are no analyzed functions. Have you run 'aa'?\n");
-		return ret;
+/**
+ * \brief Frees a FLIRT index and its tree
+ */
+RZ_API void rz_sign_flirt_index_free(RZ_NULLABLE RzFlirtIndex *index) {
+	if (!index) {
+		return;
 	}
+	rz_vector_fini(&index->leaves);
+	rz_vector_fini(&index->keys);
+	rz_vector_fini(&index->wildcards);
+	rz_sign_flirt_node_free(index->root);
+	free(index);
+}
 
-	analysis->flb.push_fs(analysis->flb.f, "flirt");
-	RzListIter *it_func;
-	RzAnalysisFunction *func;
-	rz_list_foreach (analysis->fcns, it_func, func) {
-		if (func->name && !strncmp(func->name, "flirt.", strlen("flirt."))) {
-			continue;
+static inline bool leaf_match_buffer(const FlirtLeaf *leaf, const ut8 *b, ut32 b_size) {
+	if (b_size < leaf->length) {
+		return false;
+	}
+	if (b_size < RZ_FLIRT_MAX_PRELUDE_SIZE) {
+		return is_pattern_matching(leaf->length, leaf->bytes, leaf->mask, b, b_size);
+	}
+	for (ut32 i = 0; i < FLIRT_INDEX_PREFIX_WORDS; i++) {
+		ut64 word;
+		memcpy(&word, b + i * sizeof(ut64), sizeof(ut64));
+		if ((word & leaf->prefix_mask[i]) != leaf->prefix_bytes[i]) {
+			return false;
 		}
+	}
+	if (leaf->length <= RZ_FLIRT_MAX_PRELUDE_SIZE) {
+		return true;
+	}
+	ut32 skip = RZ_FLIRT_MAX_PRELUDE_SIZE;
+	return is_pattern_matching(leaf->length - skip, leaf->bytes + skip, leaf->mask + skip, b + skip, b_size - skip);
+}
 
-		ut64 func_size = rz_analysis_function_linear_size(func);
-		ut64 malloc_size = RZ_MAX(func_size, RZ_FLIRT_MAX_PRELUDE_SIZE);
-		ut8 *func_buf = calloc(1, malloc_size);
-		if (!func_buf) {
-			ret = false;
-			break;
+static const RzFlirtModule *leaf_match_modules(const FlirtLeaf *leaf, const ut8 *b, ut32 b_size) {
+	if (!leaf_match_buffer(leaf, b, b_size)) {
+		return NULL;
+	}
+	RzListIter *it;
+	RzFlirtModule *module;
+	rz_list_foreach (leaf->modules, it, module) {
+		if (module_match_buffer(module, b, b_size)) {
+			return module;
 		}
-		if (!analysis->iob.read_at(analysis->iob.io, func->addr, func_buf, (int)func_size)) {
-			RZ_LOG_ERROR("FLIRT: Couldn't read function %s at 0x%" PFMT64x "\n", func->name, func->addr);
-			RZ_FREE(func_buf);
-			ret = false;
+	}
+	return NULL;
+}
+
+/**
+ * \brief Finds the first module of the index which matches the buffer
+ *
+ * The result is the same of walking the whole FLIRT tree, but only the
+ * leaves which can match the first two bytes of the buffer are checked.
+ *
+ * \param  index   The FLIRT index
+ * \param  b       The function bytes, zero padded to RZ_FLIRT_MAX_PRELUDE_SIZE bytes
+ * \param  b_size  The size of the buffer
+ * \return The matching module or NULL
+ */
+RZ_API RZ_BORROW const RzFlirtModule *rz_sign_flirt_index_match(RZ_NONNULL const RzFlirtIndex *index, RZ_NONNULL const ut8 *b, ut32 b_size) {
+	rz_return_val_if_fail(index && b, NULL);
+	const FlirtLeaf *leaves = index->leaves.a;
+	const FlirtKey *keys = index->keys.a;
+	const ut32 *wildcards = index->wildcards.a;
+	size_t n_keys = rz_vector_len(&index->keys);
+	size_t n_wildcards = rz_vector_len(&index->wildcards);
+	size_t k = n_keys, w = 0;
+	ut16 key = 0;
+	if (b_size >= 2) {
+		key = rz_read_le16(b);
+		rz_array_lower_bound(keys, n_keys, key, k, FLIRT_KEY_CMP);
+	}
+
+	// visit the candidates in tree order, merging the keyed and the wildcard leaves
+	while (true) {
+		bool has_key = k < n_keys && keys[k].key == key;
+		bool has_wildcard = w < n_wildcards;
+		ut32 leaf;
+		if (has_key && (!has_wildcard || keys[k].leaf < wildcards[w])) {
+			leaf = keys[k++].leaf;
+		} else if (has_wildcard) {
+			leaf = wildcards[w++];
+		} else {
 			break;
 		}
-		RzListIter *node_child_it;
-		RzFlirtNode *child;
-		rz_list_foreach (root_node->child_list, node_child_it, child) {
-			if (node_match_buffer(analysis, child, func_buf, func->addr, malloc_size, 0)) {
-				break;
-			}
+		const RzFlirtModule *module = leaf_match_modules(&leaves[leaf], b, b_size);
+		if (module) {
+			return module;
 		}
-		RZ_FREE(func_buf);
 	}
-	analysis->flb.pop_fs(analysis->flb.f);
-
-	return ret;
+	return NULL;
 }
 
 static ut8 read_module_tail_bytes(RzFlirtModule *module, ParseStatus *b) {
@@ -1303,32 +1489,193 @@ exit:
 	return ret;
 }
 
+typedef struct flirt_match_job_t {
+	ut64 addr; ///< function address
+	ut64 size; ///< function linear size when the bytes were read
+	ut8 *buf; ///< function bytes, zero padded to RZ_FLIRT_MAX_PRELUDE_SIZE
+	ut32 buf_size;
+	const RzFlirtModule *module; ///< first matching module
+} FlirtMatchJob;
+
+static const RzFlirtModule *indexes_match_buffer(const RzPVector /*<RzFlirtIndex *>*/ *indexes, const ut8 *b, ut32 b_size) {
+	void **it;
+	rz_pvector_foreach (indexes, it) {
+		const RzFlirtModule *module = rz_sign_flirt_index_match(*it, b, b_size);
+		if (module) {
+			return module;
+		}
+	}
+	return NULL;
+}
+
+static void match_job(void *element, void *user) {
+	FlirtMatchJob *job = element;
+	if (!job->buf) {
+		// not read or already matched
+		return;
+	}
+	job->module = indexes_match_buffer(user, job->buf, job->buf_size);
+	RZ_FREE(job->buf);
+}
+
+static bool match_job_read(RzAnalysis *analysis, FlirtMatchJob *job, RzAnalysisFunction *func) {
+	job->size = rz_analysis_function_linear_size(func);
+	ut64 malloc_size = RZ_MAX(job->size, RZ_FLIRT_MAX_PRELUDE_SIZE);
+	if (malloc_size > UT32_MAX || !(job->buf = calloc(1, malloc_size))) {
+		return false;
+	}
+	job->buf_size = (ut32)malloc_size;
+	if (!analysis->iob.read_at(analysis->iob.io, func->addr, job->buf, (int)job->size)) {
+		RZ_LOG_ERROR("FLIRT: Couldn't read function %s at 0x%" PFMT64x "\n", func->name, func->addr);
+		RZ_FREE(job->buf);
+		return false;
+	}
+	return true;
+}
+
+static inline bool is_flirt_function(const RzAnalysisFunction *func) {
+	return func->name && !strncmp(func->name, "flirt.", strlen("flirt."));
+}
+
 /**
- * \brief Parses the FLIRT file and applies the signatures
+ * Reads the bytes of a batch of functions, matches them in parallel and then
+ * renames them in order. Renaming may resize and merge the functions, thus
+ * before applying a match the function is checked again and its bytes are
+ * matched once more when its size has changed.
+ */
+static bool match_jobs_batch(RzAnalysis *analysis, const RzPVector /*<RzFlirtIndex *>*/ *indexes, RzPVector /*<FlirtMatchJob *>*/ *batch) {
+	RzPVector read;
+	rz_pvector_init(&read, NULL);
+	void **it;
+	rz_pvector_foreach (batch, it) {
+		FlirtMatchJob *job = *it;
+		RzAnalysisFunction *func = rz_analysis_get_function_at(analysis, job->addr);
+		if (!func || is_flirt_function(func)) {
+			continue;
+		}
+		if (!match_job_read(analysis, job, func) || !rz_pvector_push(&read, job)) {
+			rz_pvector_fini(&read);
+			return false;
+		}
+	}
+
+	if (!rz_th_iterate_pvector(&read, match_job, RZ_THREAD_N_CORES_ALL_AVAILABLE, (void *)indexes)) {
+		RZ_LOG_WARN("FLIRT: Couldn't match the functions in parallel, matching them serially\n");
+		rz_pvector_foreach (&read, it) {
+			match_job(*it, (void *)indexes);
+		}
+	}
+	rz_pvector_fini(&read);
+
+	rz_pvector_foreach (batch, it) {
+		FlirtMatchJob *job = *it;
+		if (!job->module) {
+			continue;
+		}
+		RzAnalysisFunction *func = rz_analysis_get_function_at(analysis, job->addr);
+		if (!func || is_flirt_function(func)) {
+			continue;
+		}
+		if (rz_analysis_function_linear_size(func) != job->size) {
+			if (!match_job_read(analysis, job, func)) {
+				return false;
+			}
+			match_job(job, (void *)indexes);
+			if (!job->module) {
+				continue;
+			}
+		}
+		if (!module_apply(analysis, job->module, job->addr)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Tries to find matching functions between the FLIRT indexes and the analyzed functions
  *
- * \param  analysis    The RzAnalysis structure
- * \param  flirt_file  The FLIRT file to parse
- * \return true if the signatures were sucessfully applied to the file
+ * Every function is matched against the indexes in order and gets the name of
+ * the first matching module. The matching runs on all the available cores.
+ *
+ * \param  analysis  The RzAnalysis structure
+ * \param  indexes   The FLIRT indexes to apply
+ * \return False on error, otherwise true
  */
-RZ_API bool rz_sign_flirt_apply(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const char *flirt_file, ut8 expected_arch) {
-	rz_return_val_if_fail(analysis && RZ_STR_ISNOTEMPTY(flirt_file), false);
+RZ_API bool rz_sign_flirt_apply_indexes(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const RzPVector /*<RzFlirtIndex *>*/ *indexes) {
+	rz_return_val_if_fail(analysis && indexes, false);
+	if (rz_list_length(analysis->fcns) == 0) {
+		RZ_LOG_ERROR("FLIRT: There are no analyzed functions. Have you run 'aa'?\n");
+		return true;
+	} else if (rz_pvector_empty(indexes)) {
+		return true;
+	}
+
+	// the function list changes while renaming, thus only the addresses are kept
+	RzVector jobs;
+	rz_vector_init(&jobs, sizeof(FlirtMatchJob), NULL, NULL);
+	if (!rz_vector_reserve(&jobs, rz_list_length(analysis->fcns))) {
+		return false;
+	}
+	RzListIter *it;
+	RzAnalysisFunction *func;
+	rz_list_foreach (analysis->fcns, it, func) {
+		if (is_flirt_function(func)) {
+			continue;
+		}
+		FlirtMatchJob job = { .addr = func->addr };
+		rz_vector_push(&jobs, &job);
+	}
+
+	bool ret = true;
+	RzPVector batch;
+	rz_pvector_init(&batch, NULL);
+	analysis->flb.push_fs(analysis->flb.f, "flirt");
+	for (size_t i = 0; ret && i < rz_vector_len(&jobs); i += FLIRT_INDEX_JOBS_BATCH) {
+		rz_pvector_clear(&batch);
+		size_t end = RZ_MIN(i + FLIRT_INDEX_JOBS_BATCH, rz_vector_len(&jobs));
+		for (size_t j = i; j < end; j++) {
+			rz_pvector_push(&batch, rz_vector_index_ptr(&jobs, j));
+		}
+		ret = match_jobs_batch(analysis, indexes, &batch);
+	}
+	analysis->flb.pop_fs(analysis->flb.f);
+
+	FlirtMatchJob *job;
+	rz_vector_foreach (&jobs, job) {
+		free(job->buf);
+	}
+	rz_pvector_fini(&batch);
+	rz_vector_fini(&jobs);
+	return ret;
+}
+
+/**
+ * \brief Parses a FLIRT file (.sig or .pat) and builds its index
+ *
+ * \param  flirt_file     The FLIRT file to parse
+ * \param  expected_arch  The expected architecture (RZ_FLIRT_SIG_ARCH_*)
+ * \return The index or NULL on failure
+ */
+RZ_API RZ_OWN RzFlirtIndex *rz_sign_flirt_index_load(RZ_NONNULL const char *flirt_file, ut8 expected_arch) {
+	rz_return_val_if_fail(RZ_STR_ISNOTEMPTY(flirt_file), NULL);
 	RzBuffer *flirt_buf = NULL;
 	RzFlirtNode *node = NULL;
 
 	if (expected_arch > RZ_FLIRT_SIG_ARCH_ANY) {
 		RZ_LOG_ERROR("FLIRT: unknown architecture %u\n", expected_arch);
-		return false;
+		return NULL;
 	}
 
 	const char *extension = rz_str_lchr(flirt_file, '.');
 	if (RZ_STR_ISEMPTY(extension) || (strcmp(extension, ".sig") != 0 && strcmp(extension, ".pat") != 0)) {
 		RZ_LOG_ERROR("FLIRT: unknown extension '%s'\n", extension);
-		return false;
+		return NULL;
 	}
 
 	if (!(flirt_buf = rz_buf_new_slurp(flirt_file))) {
 		RZ_LOG_ERROR("FLIRT: Can't open %s\n", flirt_file);
-		return false;
+		return NULL;
 	}
 
 	if (!strcmp(extension, ".pat")) {
@@ -1336,17 +1683,119 @@ RZ_API bool rz_sign_flirt_apply(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL cons
 	} else {
 		node = rz_sign_flirt_parse_compressed_pattern_from_buffer(flirt_buf, expected_arch, NULL);
 	}
-
 	rz_buf_free(flirt_buf);
-	if (node) {
-		if (!node_match_functions(analysis, node)) {
-			RZ_LOG_ERROR("FLIRT: Error while scanning the file %s\n", flirt_file);
-		}
+
+	if (!node) {
+		RZ_LOG_ERROR("FLIRT: We encountered an error while parsing the file %s. Sorry.\n", flirt_file);
+		return NULL;
+	}
+	RzFlirtIndex *index = rz_sign_flirt_index_new(node);
+	if (!index) {
 		rz_sign_flirt_node_free(node);
-		return true;
 	}
-	RZ_LOG_ERROR("FLIRT: We encountered an error while parsing the file %s. Sorry.\n", flirt_file);
-	return false;
+	return index;
+}
+
+/**
+ * \brief Parses the FLIRT file and applies the signatures
+ *
+ * \param  analysis    The RzAnalysis structure
+ * \param  flirt_file  The FLIRT file to parse
+ * \return true if the signatures were sucessfully applied to the file
+ */
+RZ_API bool rz_sign_flirt_apply(RZ_NONNULL RzAnalysis *analysis, RZ_NONNULL const char *flirt_file, ut8 expected_arch) {
+	rz_return_val_if_fail(analysis && RZ_STR_ISNOTEMPTY(flirt_file), false);
+	RzFlirtIndex *index = rz_sign_flirt_index_load(flirt_file, expected_arch);
+	if (!index) {
+		return false;
+	}
+	RzPVector indexes;
+	rz_pvector_init(&indexes, NULL);
+	rz_pvector_push(&indexes, index);
+	if (!rz_sign_flirt_apply_indexes(analysis, &indexes)) {
+		RZ_LOG_ERROR("FLIRT: Error while scanning the file %s\n", flirt_file);
+	}
+	rz_pvector_fini(&indexes);
+	rz_sign_flirt_index_free(index);
+	return true;
+}
+
+typedef struct flirt_cache_entry_t {
+	RzFlirtIndex *index;
+	ut64 file_size; ///< size of the file when the index was built
+	ut8 arch;
+} FlirtCacheEntry;
+
+struct rz_flirt_cache_t {
+	HtSP /*<char *, FlirtCacheEntry *>*/ *entries;
+};
+
+static void flirt_cache_entry_free(FlirtCacheEntry *entry) {
+	if (!entry) {
+		return;
+	}
+	rz_sign_flirt_index_free(entry->index);
+	free(entry);
+}
+
+/**
+ * \brief Creates a cache of FLIRT indexes, to parse and index each file only once
+ */
+RZ_API RZ_OWN RzFlirtCache *rz_sign_flirt_cache_new(void) {
+	RzFlirtCache *cache = RZ_NEW0(RzFlirtCache);
+	if (!cache) {
+		return NULL;
+	}
+	cache->entries = ht_sp_new(HT_STR_DUP, NULL, (HtSPFreeValue)flirt_cache_entry_free);
+	if (!cache->entries) {
+		free(cache);
+		return NULL;
+	}
+	return cache;
+}
+
+RZ_API void rz_sign_flirt_cache_free(RZ_NULLABLE RzFlirtCache *cache) {
+	if (!cache) {
+		return;
+	}
+	ht_sp_free(cache->entries);
+	free(cache);
+}
+
+/**
+ * \brief Returns the index of a FLIRT file, building it only when not cached or when the file has changed
+ *
+ * \param  cache          The FLIRT cache
+ * \param  flirt_file     The FLIRT file to parse
+ * \param  expected_arch  The expected architecture (RZ_FLIRT_SIG_ARCH_*)
+ * \return The index owned by the cache or NULL on failure
+ */
+RZ_API RZ_BORROW RzFlirtIndex *rz_sign_flirt_cache_get(RZ_NONNULL RzFlirtCache *cache, RZ_NONNULL const char *flirt_file, ut8 expected_arch) {
+	rz_return_val_if_fail(cache && RZ_STR_ISNOTEMPTY(flirt_file), NULL);
+	ut64 file_size = rz_file_size(flirt_file);
+	FlirtCacheEntry *entry = ht_sp_find(cache->entries, flirt_file, NULL);
+	if (entry && entry->arch == expected_arch && entry->file_size == file_size) {
+		return entry->index;
+	}
+
+	RzFlirtIndex *index = rz_sign_flirt_index_load(flirt_file, expected_arch);
+	if (!index) {
+		return NULL;
+	}
+	entry = RZ_NEW0(FlirtCacheEntry);
+	if (!entry) {
+		rz_sign_flirt_index_free(index);
+		return NULL;
+	}
+	entry->index = index;
+	entry->file_size = file_size;
+	entry->arch = expected_arch;
+	if (!ht_sp_update(cache->entries, flirt_file, entry)) {
+		rz_sign_flirt_index_free(index);
+		free(entry);
+		return NULL;
+	}
+	return index;
 }
 
 /**
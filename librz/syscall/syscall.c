@@ -108,14 +108,16 @@ static bool load_sdb(Sdb **db, const char *name) {
 	free(file_name);
 	free(sdb_path);
 	if (rz_file_exists(file)) {
+		// the databases are only read, possibly by several threads
 		if (*db) {
 			sdb_reset(*db);
 			sdb_open(*db, file);
+			sdb_config(*db, (*db)->options | SDB_OPTION_READONLY);
 		} else {
-			*db = sdb_new(0, file, 0);
+			*db = sdb_new_readonly(file);
 		}
 		free(file);
-		return true;
+		return *db != NULL;
 	}
 	free(file);
 	return false;
@@ -177,7 +179,10 @@ static bool sdb_load_sysregs(RzSysregsDB *sysregdb, Sdb *sdb) {
 }
 
 static bool sdb_load_by_path(RZ_NONNULL RzSysregsDB *sysregdb, const char *path) {
-	Sdb *db = sdb_new(0, path, 0);
+	Sdb *db = sdb_new_readonly(path);
+	if (!db) {
+		return false;
+	}
 	bool result = sdb_load_sysregs(sysregdb, db);
 	sdb_close(db);
 	sdb_free(db);
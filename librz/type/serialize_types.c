@@ -620,7 +620,10 @@ static bool sdb_load_by_path(RZ_NONNULL RzTypeDB *typedb, RZ_NONNULL const char
 	if (RZ_STR_ISEMPTY(path)) {
 		return false;
 	}
-	Sdb *db = sdb_new(0, path, 0);
+	Sdb *db = sdb_new_readonly(path);
+	if (!db) {
+		return false;
+	}
 	bool result = types_load_sdb(db, typedb);
 	sdb_close(db);
 	sdb_free(db);
@@ -332,3 +332,71 @@ int cdb_findnext(struct cdb *c, ut32 u, const char *key, ut32 len) {
 	}
 	return 0;
 }
+
+/**
+ * \brief Find the first occurence of \p key in a mapped \ref cdb structure.
+ * \param u The hash of the \p key to search for.
+ * \param key The key, a NUL-terminated string.
+ * \param len The string length of \p key.
+ * \param[out] dpos The position of the data, if found.
+ * \param[out] dlen The length of the data, if found.
+ * \return The function returns 1 when the key is matched, 0 when not
+ * found and -1 on error.
+ *
+ * Unlike \ref cdb_findnext, the search state is kept on the stack and
+ * the file is only read through \ref cdb.map, so any number of threads
+ * may search the same \ref cdb structure at the same time.
+ */
+int cdb_find(const struct cdb *c, ut32 u, const char *key, ut32 len, ut32 *dpos, ut32 *dlen) {
+	const ut8 *map = (const ut8 *)c->map;
+	if (!map || c->size < 1024) {
+		return -1;
+	}
+	len++; // To include the \0 byte.
+	/* Read the hash table position and the end of the table. */
+	ut32 tpos = (u << 2) & 1023;
+	ut32 hpos = rz_read_at_le32(map, tpos);
+	ut32 hend = ((u + 1) & 0xFF) ? rz_read_at_le32(map, tpos + 4) : c->size;
+	if (hend < hpos || hend > c->size) {
+		return -1;
+	}
+	ut32 hslots = (hend - hpos) / (2 * sizeof(ut32));
+	if (!hslots) {
+		return 0;
+	}
+	ut32 kpos = hpos + (((u >> 8) % hslots) << 3);
+	for (ut32 loop = 0; loop < hslots; loop++) {
+		ut32 khash = rz_read_at_le32(map, kpos);
+		ut32 pos = rz_read_at_le32(map, kpos + 4);
+		if (!pos) {
+			return 0;
+		}
+		kpos += 2 * sizeof(ut32);
+		if (kpos == hpos + (hslots << 3)) {
+			kpos = hpos;
+		}
+		if (khash != u) {
+			continue;
+		}
+		/* The hashes match, compare the strings. */
+		if (pos > c->size - KVLSZ) {
+			return -1;
+		}
+		ut32 klen = map[pos];
+		ut32 vlen = map[pos + 1] | ((ut32)map[pos + 2] << 8) | ((ut32)map[pos + 3] << 16);
+		if (!klen) {
+			return -1;
+		}
+		if (klen != len || c->size - pos - KVLSZ < len || memcmp(map + pos + KVLSZ, key, len)) {
+			continue;
+		}
+		pos += KVLSZ + len;
+		if (c->size - pos < vlen) {
+			return -1;
+		}
+		*dpos = pos;
+		*dlen = vlen;
+		return 1;
+	}
+	return 0;
+}
@@ -58,6 +58,7 @@ bool cdb_init(struct cdb *, int fd);
 void cdb_findstart(struct cdb *);
 bool cdb_read(struct cdb *, char *, unsigned int, ut32);
 int cdb_findnext(struct cdb *, ut32 u, const char *, ut32);
+int cdb_find(const struct cdb *c, ut32 u, const char *key, ut32 len, ut32 *dpos, ut32 *dlen);
 
 #define cdb_datapos(c) ((c)->dpos)
 #define cdb_datalen(c) ((c)->dlen)
@@ -100,6 +100,32 @@ fail:
 	return NULL;
 }
 
+/**
+ * \brief Opens the database \p file in read-only mode
+ *
+ * The file is mapped in memory and the values are returned straight from
+ * the mapping, without parsing or copying the database. Since lookups
+ * keep no state in the Sdb, any number of threads can read the returned
+ * database concurrently without locking, as long as nobody frees it.
+ * Every modification fails.
+ *
+ * \param file Path of the database
+ * \return The database, or NULL if \p file cannot be opened
+ */
+RZ_API RZ_OWN Sdb *sdb_new_readonly(RZ_NONNULL const char *file) {
+	rz_return_val_if_fail(file, NULL);
+	Sdb *s = sdb_new(NULL, file, 0);
+	if (!s) {
+		return NULL;
+	}
+	if (s->fd == -1) {
+		sdb_free(s);
+		return NULL;
+	}
+	s->options |= SDB_OPTION_READONLY;
+	return s;
+}
+
 // XXX: this is wrong. stuff not stored in memory is lost
 RZ_API void sdb_file(Sdb *s, const char *dir) {
 	if (s->lock) {
@@ -193,8 +219,35 @@ RZ_API bool sdb_free(Sdb *s) {
 	return false;
 }
 
-RZ_API const char *sdb_const_get_len(Sdb *s, const char *key, int *vlen) {
+/* Returns the value of key in the file, pointing inside the mapping */
+static const char *disk_get(Sdb *s, const char *key, ut32 *vlen) {
 	ut32 pos, len;
+	if (s->fd == -1) {
+		return NULL;
+	}
+	ut32 keylen = strlen(key);
+	ut32 hash = s->ht->opt.hashfn(key);
+	if (s->db.map) {
+		// reentrant search, see sdb_new_readonly()
+		if (cdb_find(&s->db, hash, key, keylen, &pos, &len) < 1) {
+			return NULL;
+		}
+	} else {
+		(void)cdb_findstart(&s->db);
+		if (cdb_findnext(&s->db, hash, key, keylen) < 1) {
+			return NULL;
+		}
+		pos = cdb_datapos(&s->db);
+		len = cdb_datalen(&s->db);
+	}
+	if (len < SDB_CDB_MIN_VALUE || len >= SDB_CDB_MAX_VALUE || !s->db.map) {
+		return NULL;
+	}
+	*vlen = len;
+	return s->db.map + pos;
+}
+
+RZ_API const char *sdb_const_get_len(Sdb *s, const char *key, int *vlen) {
 	bool found;
 
 	if (vlen) {
@@ -203,37 +256,27 @@ RZ_API const char *sdb_const_get_len(Sdb *s, const char *key, int *vlen) {
 	if (!s || !key) {
 		return NULL;
 	}
-	// TODO: optimize, iterate once
-	size_t keylen = strlen(key);
 
 	/* search in memory */
-	SdbKv *kv = (SdbKv *)sdb_ht_find_kvp(s->ht, key, &found);
-	if (found) {
-		if (!sdbkv_value(kv) || !*sdbkv_value(kv)) {
-			return NULL;
-		}
-		if (vlen) {
-			*vlen = sdbkv_value_len(kv);
+	if (!(s->options & SDB_OPTION_READONLY)) {
+		SdbKv *kv = (SdbKv *)sdb_ht_find_kvp(s->ht, key, &found);
+		if (found) {
+			if (!sdbkv_value(kv) || !*sdbkv_value(kv)) {
+				return NULL;
+			}
+			if (vlen) {
+				*vlen = sdbkv_value_len(kv);
+			}
+			return sdbkv_value(kv);
 		}
-		return sdbkv_value(kv);
 	}
 	/* search in disk */
-	if (s->fd == -1) {
-		return NULL;
-	}
-	(void)cdb_findstart(&s->db);
-	if (cdb_findnext(&s->db, s->ht->opt.hashfn(key), key, keylen) < 1) {
-		return NULL;
-	}
-	len = cdb_datalen(&s->db);
-	if (len < SDB_CDB_MIN_VALUE || len >= SDB_CDB_MAX_VALUE) {
-		return NULL;
-	}
-	if (vlen) {
+	ut32 len;
+	const char *value = disk_get(s, key, &len);
+	if (value && vlen) {
 		*vlen = len;
 	}
-	pos = cdb_datapos(&s->db);
-	return s->db.map + pos;
+	return value;
 }
 
 RZ_API const char *sdb_const_get(Sdb *s, const char *key) {
@@ -257,6 +300,9 @@ RZ_API int sdb_unset(Sdb *s, const char *key) {
 
 /* remove from memory */
 RZ_API bool sdb_remove(Sdb *s, const char *key) {
+	if (s->options & SDB_OPTION_READONLY) {
+		return false;
+	}
 	return sdb_ht_delete(s->ht, key);
 }
 
@@ -315,28 +361,20 @@ RZ_API bool sdb_add(Sdb *s, const char *key, const char *val) {
 }
 
 RZ_API bool sdb_exists(Sdb *s, const char *key) {
-	ut32 pos;
-	char ch;
 	bool found;
-	int klen = strlen(key) + 1;
-	if (!s) {
-		return false;
-	}
-	SdbKv *kv = (SdbKv *)sdb_ht_find_kvp(s->ht, key, &found);
-	if (found && kv) {
-		const char *v = sdbkv_value(kv);
-		return v && *v;
-	}
-	if (s->fd == -1) {
+	ut32 vlen;
+	if (!s || !key) {
 		return false;
 	}
-	(void)cdb_findstart(&s->db);
-	if (cdb_findnext(&s->db, sdb_hash(key), key, klen)) {
-		pos = cdb_datapos(&s->db);
-		cdb_read(&s->db, &ch, 1, pos);
-		return ch != 0;
+	if (!(s->options & SDB_OPTION_READONLY)) {
+		SdbKv *kv = (SdbKv *)sdb_ht_find_kvp(s->ht, key, &found);
+		if (found && kv) {
+			const char *v = sdbkv_value(kv);
+			return v && *v;
+		}
 	}
-	return false;
+	const char *v = disk_get(s, key, &vlen);
+	return v && *v;
 }
 
 RZ_API int sdb_open(Sdb *s, const char *file) {
@@ -507,6 +545,12 @@ static bool sdb_set_internal(Sdb *s, const char *key, char *val, int owned) {
 	if (!s || !key) {
 		return false;
 	}
+	if (s->options & SDB_OPTION_READONLY) {
+		if (owned) {
+			free(val);
+		}
+		return false;
+	}
 	if (!val) {
 		if (owned) {
 			val = strdup("");
@@ -696,6 +740,56 @@ RZ_API RZ_OWN RzPVector /*<SdbKv *>*/ *sdb_get_items_match(RZ_NONNULL Sdb *s, RZ
 	return vec;
 }
 
+/* Sets the position of the first record of the file and the end of the records */
+static bool dump_range(Sdb *s, ut32 *pos, ut32 *end) {
+	*pos = 0;
+	*end = 0;
+	if (s->fd == -1) {
+		return false;
+	}
+	ut8 buf[4];
+	if (!cdb_read(&s->db, (char *)buf, 4, 0)) {
+		return false;
+	}
+	*end = rz_read_le32(buf);
+	*pos = sizeof(((struct cdb_make *)0)->final);
+	return true;
+}
+
+/* Reads the record at *pos from the mapping and moves *pos to the next one */
+static bool dump_next(Sdb *s, ut32 *pos, ut32 end, SdbKv *kv) {
+	if (!s->db.map || *pos >= end) {
+		return false;
+	}
+	// klen/vlen include trailing NUL
+	ut32 klen, vlen;
+	if (!cdb_getkvlen(&s->db, &klen, &vlen, *pos)) {
+		return false;
+	}
+	if (klen < SDB_CDB_MIN_KEY || vlen < SDB_CDB_MIN_VALUE) {
+		return false;
+	}
+	*pos += 4;
+
+	char *key = s->db.map + *pos;
+	*pos += klen;
+	if (*pos > end || key[klen - 1] != '\0') {
+		rz_return_val_if_reached(false);
+	}
+
+	char *value = s->db.map + *pos;
+	*pos += vlen;
+	if (*pos > end || value[vlen - 1] != '\0') {
+		rz_return_val_if_reached(false);
+	}
+
+	kv->base.key = key;
+	kv->base.key_len = klen - 1;
+	kv->base.value = value;
+	kv->base.value_len = vlen - 1;
+	return true;
+}
+
 static bool sdb_foreach_end(Sdb *s, bool result) {
 	s->depth--;
 	return result;
@@ -707,9 +801,12 @@ static bool sdb_foreach_end(Sdb *s, bool result) {
  */
 static bool sdb_foreach_cdb(Sdb *s, SdbForeachCallback cb, void *user) {
 	SdbKv it = { 0 };
-	sdb_dump_begin(s);
-	while (sdb_dump_next(s, &it)) {
-		if (sdb_ht_find_kvp(s->ht, sdbkv_key(&it), NULL)) {
+	ut32 pos, end;
+	bool readonly = s->options & SDB_OPTION_READONLY;
+	// the cursor is local, so that the iteration is reentrant
+	dump_range(s, &pos, &end);
+	while (dump_next(s, &pos, end, &it)) {
+		if (!readonly && sdb_ht_find_kvp(s->ht, sdbkv_key(&it), NULL)) {
 			continue;
 		}
 		if (!cb(user, &it)) {
@@ -728,6 +825,10 @@ static bool sdb_foreach_cdb(Sdb *s, SdbForeachCallback cb, void *user) {
 RZ_API bool sdb_foreach(RZ_NONNULL Sdb *s, RZ_NONNULL SdbForeachCallback cb, RZ_NULLABLE void *user) {
 	rz_return_val_if_fail(s && cb, false);
 
+	if (s->options & SDB_OPTION_READONLY) {
+		// nothing in memory, and nothing to modify in s
+		return sdb_foreach_cdb(s, cb, user);
+	}
 	s->depth++;
 	bool result = sdb_foreach_cdb(s, cb, user);
 	if (!result) {
@@ -763,7 +864,7 @@ RZ_API bool sdb_sync(Sdb *s) {
 	bool result;
 	ut32 i;
 
-	if (!s || !sdb_disk_create(s)) {
+	if (!s || s->options & SDB_OPTION_READONLY || !sdb_disk_create(s)) {
 		return false;
 	}
 	result = sdb_foreach_cdb(s, _insert_into_disk, s);
@@ -793,18 +894,9 @@ RZ_API bool sdb_sync(Sdb *s) {
 RZ_API void sdb_dump_begin(RZ_NONNULL Sdb *s) {
 	rz_return_if_fail(s);
 
-	s->pos = 0;
-	s->dump_end_pos = 0;
-	if (s->fd == -1) {
-		return;
-	}
-	ut8 buf[4];
-	if (!cdb_read(&s->db, (char *)buf, 4, 0)) {
-		return;
+	if (dump_range(s, &s->pos, &s->dump_end_pos)) {
+		seek_set(s->fd, s->pos);
 	}
-	s->dump_end_pos = rz_read_le32(buf);
-	s->pos = sizeof(((struct cdb_make *)0)->final);
-	seek_set(s->fd, s->pos);
 }
 
 RZ_API bool sdb_stats(Sdb *s, ut32 *disk, ut32 *mem) {
@@ -835,37 +927,7 @@ RZ_API bool sdb_stats(Sdb *s, ut32 *disk, ut32 *mem) {
  */
 RZ_API bool sdb_dump_next(RZ_NONNULL Sdb *s, RZ_OUT RZ_NONNULL SdbKv *kv) {
 	rz_return_val_if_fail(s && kv, false);
-
-	if (!s->db.map || s->pos >= s->dump_end_pos) {
-		return false;
-	}
-	// klen/vlen include trailing NUL
-	ut32 klen, vlen;
-	if (!cdb_getkvlen(&s->db, &klen, &vlen, s->pos)) {
-		return false;
-	}
-	if (klen < SDB_CDB_MIN_KEY || vlen < SDB_CDB_MIN_VALUE) {
-		return false;
-	}
-	s->pos += 4;
-
-	char *key = s->db.map + s->pos;
-	s->pos += klen;
-	if (s->pos > s->dump_end_pos || key[klen - 1] != '\0') {
-		rz_return_val_if_reached(false);
-	}
-
-	char *value = s->db.map + s->pos;
-	s->pos += vlen;
-	if (s->pos > s->dump_end_pos || value[vlen - 1] != '\0') {
-		rz_return_val_if_reached(false);
-	}
-
-	kv->base.key = key;
-	kv->base.key_len = klen - 1;
-	kv->base.value = value;
-	kv->base.value_len = vlen - 1;
-	return true;
+	return dump_next(s, &s->pos, s->dump_end_pos, kv);
 }
 
 RZ_API void sdb_config(Sdb *s, int options) {
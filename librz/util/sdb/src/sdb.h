@@ -51,11 +51,12 @@ extern char *strdup(const char *);
 #define SDB_NUM_BASE  16
 #define SDB_NUM_BUFSZ 64
 
-#define SDB_OPTION_NONE    0
-#define SDB_OPTION_ALL     0xff
-#define SDB_OPTION_SYNC    (1 << 0)
-#define SDB_OPTION_NOSTAMP (1 << 1)
-#define SDB_OPTION_FS      (1 << 2)
+#define SDB_OPTION_NONE     0
+#define SDB_OPTION_ALL      0xff
+#define SDB_OPTION_SYNC     (1 << 0)
+#define SDB_OPTION_NOSTAMP  (1 << 1)
+#define SDB_OPTION_FS       (1 << 2)
+#define SDB_OPTION_READONLY (1 << 3) ///< see sdb_new_readonly()
 
 #define SDB_LIST_UNSORTED 0
 #define SDB_LIST_SORTED   1
@@ -91,6 +92,7 @@ typedef struct sdb_ns_t {
 
 RZ_API Sdb *sdb_new0(void);
 RZ_API Sdb *sdb_new(const char *path, const char *file, int lock);
+RZ_API RZ_OWN Sdb *sdb_new_readonly(RZ_NONNULL const char *file);
 
 RZ_API int sdb_open(Sdb *s, const char *file);
 RZ_API void sdb_close(Sdb *s);
@@ -197,6 +197,63 @@ RZ_API RzSkipListNode *rz_skiplist_insert(RzSkipList *list, void *data) {
 	return x;
 }
 
+// Inserts \p count elements, sorted in ascending order, in a single pass.
+// Instead of searching every insertion point from the head, the walk of each
+// level continues from the insertion point of the previous element, thus
+// the whole merge costs O(length + count) instead of O(count * lg length).
+// When an element is already in the list, the one in the list is kept and it
+// replaces the corresponding entry of \p data, so that the caller can tell
+// which elements were not inserted. If an allocation fails, the entries of
+// the elements that could not be inserted are set to NULL.
+// Returns the number of inserted elements.
+RZ_API size_t rz_skiplist_insert_sorted(RzSkipList *list, void **data, size_t count) {
+	RzSkipListNode *update[SKIPLIST_MAX_DEPTH + 1];
+	int i, x_level;
+	size_t n, inserted = 0;
+
+	if (!list || !data) {
+		return 0;
+	}
+	for (i = 0; i <= SKIPLIST_MAX_DEPTH; i++) {
+		update[i] = list->head;
+	}
+	for (n = 0; n < count; n++) {
+		// the insertion points of the previous element precede this one
+		for (i = 0; i <= list->list_level; i++) {
+			RzSkipListNode *x = update[i];
+			while (x->forward[i] != list->head && list->compare(x->forward[i]->data, data[n], NULL) < 0) {
+				x = x->forward[i];
+			}
+			update[i] = x;
+		}
+		RzSkipListNode *next = update[0]->forward[0];
+		if (next != list->head && !list->compare(next->data, data[n], NULL)) {
+			data[n] = next->data;
+			continue;
+		}
+
+		for (x_level = 0; rand() < RAND_MAX / 2 && x_level < SKIPLIST_MAX_DEPTH; x_level++) {
+			;
+		}
+		RzSkipListNode *x = rz_skiplist_node_new(data[n], x_level);
+		if (!x) {
+			memset(data + n, 0, (count - n) * sizeof(void *));
+			break;
+		}
+		for (i = 0; i <= x_level; i++) {
+			x->forward[i] = update[i]->forward[i];
+			update[i]->forward[i] = x;
+			update[i] = x;
+		}
+		if (x_level > list->list_level) {
+			list->list_level = x_level;
+		}
+		list->size++;
+		inserted++;
+	}
+	return inserted;
+}
+
 // Delete node with data as it's payload.
 RZ_API bool rz_skiplist_delete(RzSkipList *list, void *data) {
 	return delete_element(list, data, true);
@@ -7,6 +7,14 @@
 #include <rz_util/rz_utf32.h>
 #include <rz_util/rz_ebcdic.h>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STR_SEARCH_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define STR_SEARCH_NEON 1
+#endif
+
 typedef enum {
 	SKIP_STRING,
 	RETRY_ASCII,
@@ -347,6 +355,104 @@ static inline bool can_be_ebcdic(const ut8 *buf, ut64 size) {
 	return buf[0] < 0x20 || buf[0] > 0x3f;
 }
 
+/**
+ * Checks if the code point of the byte \p b ends a string, both in ASCII
+ * and in IBM037: the C0 controls which are not C escape sequences.
+ */
+static inline bool is_end_byte(ut8 b) {
+	return b < 0x20 && (b < 0x07 || b > 0x0d) && b != 0x1b;
+}
+
+/**
+ * Checks if no string can start at \p i, whatever encoding is guessed.
+ *
+ * The first code point decoded at such position ends the string for every
+ * decoder: the wide little endian ones are chosen only when the bytes after
+ * the first one are zero, while a zero can start a big endian string whose
+ * first code point is the byte at i + 1 (UTF-16) or at i + 3 (UTF-32).
+ * 0xff is neither valid UTF-8 nor printable in IBM037.
+ */
+static inline bool is_dead_position(const ut8 *buf, ut64 size, ut64 i) {
+	ut8 b = buf[i];
+	if (b) {
+		return b == 0xff || is_end_byte(b);
+	}
+	return i + 3 < size && is_end_byte(buf[i + 1]) && is_end_byte(buf[i + 3]);
+}
+
+#if STR_SEARCH_SSE2
+static inline __m128i sse2_end_bytes(__m128i v) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i ctrl = _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8((char)0xe0)), zero);
+	// 0x07 <= v <= 0x0d
+	__m128i fmt = _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(v, _mm_set1_epi8(0x07)), _mm_set1_epi8(0x06)), zero);
+	__m128i esc = _mm_cmpeq_epi8(v, _mm_set1_epi8(0x1b));
+	return _mm_andnot_si128(_mm_or_si128(fmt, esc), ctrl);
+}
+#elif STR_SEARCH_NEON
+static inline uint8x16_t neon_end_bytes(uint8x16_t v) {
+	uint8x16_t ctrl = vcltq_u8(v, vdupq_n_u8(0x20));
+	// 0x07 <= v <= 0x0d
+	uint8x16_t fmt = vcleq_u8(vsubq_u8(v, vdupq_n_u8(0x07)), vdupq_n_u8(0x06));
+	return vbicq_u8(vbicq_u8(ctrl, fmt), vceqq_u8(v, vdupq_n_u8(0x1b)));
+}
+#endif
+
+/**
+ * Returns the amount of positions at the beginning of \p buf which can be
+ * skipped without changing the result of the scan, since no string can
+ * start there (see is_dead_position()). 16 positions are checked at a time
+ * when SIMD instructions are available.
+ */
+static ut64 skip_dead_positions(const ut8 *buf, ut64 size) {
+	ut64 i = 0;
+#if STR_SEARCH_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 19 <= size; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+		__m128i z = _mm_cmpeq_epi8(v, zero);
+		__m128i wide = _mm_and_si128(sse2_end_bytes(_mm_loadu_si128((const __m128i *)(buf + i + 1))),
+			sse2_end_bytes(_mm_loadu_si128((const __m128i *)(buf + i + 3))));
+		__m128i dead = _mm_or_si128(_mm_andnot_si128(z, sse2_end_bytes(v)), _mm_cmpeq_epi8(v, _mm_set1_epi8((char)0xff)));
+		dead = _mm_or_si128(dead, _mm_and_si128(z, wide));
+		if (_mm_movemask_epi8(dead) != 0xffff) {
+			break;
+		}
+	}
+#elif STR_SEARCH_NEON
+	for (; i + 19 <= size; i += 16) {
+		uint8x16_t v = vld1q_u8(buf + i);
+		uint8x16_t z = vceqq_u8(v, vdupq_n_u8(0));
+		uint8x16_t wide = vandq_u8(neon_end_bytes(vld1q_u8(buf + i + 1)), neon_end_bytes(vld1q_u8(buf + i + 3)));
+		uint8x16_t dead = vorrq_u8(vbicq_u8(neon_end_bytes(v), z), vceqq_u8(v, vdupq_n_u8(0xff)));
+		dead = vorrq_u8(dead, vandq_u8(z, wide));
+		if (vminvq_u8(dead) != 0xff) {
+			break;
+		}
+	}
+#endif
+	while (i < size && is_dead_position(buf, size, i)) {
+		i++;
+	}
+	return i;
+}
+
+static inline bool can_skip_dead_positions(const RzUtilStrScanOptions *opt, RzStrEnc type) {
+	if (opt->min_str_length < 1) {
+		// an empty string can start anywhere
+		return false;
+	}
+	switch (type) {
+	case RZ_STRING_ENC_GUESS:
+	case RZ_STRING_ENC_8BIT:
+	case RZ_STRING_ENC_UTF8:
+	case RZ_STRING_ENC_IBM037:
+		return true;
+	default:
+		return false;
+	}
+}
+
 /**
  * \brief Look for strings in a byte array, but returns only the first result.
  *
@@ -409,9 +515,23 @@ RZ_API int rz_scan_strings_raw(RZ_NONNULL const ut8 *buf, RZ_NONNULL RzList /*<R
 	const ut8 *ptr = NULL;
 	ut64 size = 0;
 	int skip_ibm037 = 0;
+	const bool skip_dead = can_skip_dead_positions(opt, type);
 	while (needle < to) {
 		ptr = buf + needle - from;
 		size = to - needle;
+		if (skip_dead) {
+			ut64 dead = skip_dead_positions(ptr, size);
+			if (dead) {
+				// every skipped position would have decremented the counter, down to 0
+				skip_ibm037 = skip_ibm037 > 0 && (ut64)skip_ibm037 > dead ? skip_ibm037 - (int)dead : 0;
+				needle += dead;
+				if (needle >= to) {
+					break;
+				}
+				ptr = buf + needle - from;
+				size = to - needle;
+			}
+		}
 		--skip_ibm037;
 		if (type == RZ_STRING_ENC_GUESS) {
 			if (can_be_utf32_le(ptr, size)) {
@@ -446,10 +446,126 @@ bool test_dwarf2_big_endian(void) {
 	mu_end;
 }
 
+/**
+ * Checks that \p info holds \p copies times the units of \p serial, each
+ * copy shifted by \p size bytes.
+ */
+static bool check_info_copies(const RzBinDwarfInfo *serial, const RzBinDwarfInfo *info, size_t copies, ut64 size, RzBinDWARF *dw) {
+	size_t n_units = rz_vector_len(&serial->units);
+	mu_assert_eq(rz_vector_len(&info->units), n_units * copies, "Wrong number of units");
+	mu_assert_eq(info->die_count, serial->die_count * copies, "Wrong number of DIEs");
+	for (size_t i = 0; i < rz_vector_len(&info->units); i++) {
+		const RzBinDwarfCompUnit *exp = rz_vector_index_ptr(&serial->units, i % n_units);
+		const RzBinDwarfCompUnit *cu = rz_vector_index_ptr(&info->units, i);
+		const ut64 shift = (i / n_units) * size;
+		mu_assert_eq(cu->index, i, "Wrong unit index");
+		mu_assert_eq(cu->offset, exp->offset + shift, "Wrong unit offset");
+		mu_assert_eq(cu->hdr.length, exp->hdr.length, "Wrong header length information");
+		mu_assert_eq(cu->hdr.abbrev_offset, exp->hdr.abbrev_offset, "Wrong header abbrev_offset information");
+		mu_assert_eq(cu->hdr.header_size, exp->hdr.header_size, "Wrong header size information");
+		mu_assert_eq(cu->hdr.encoding.version, exp->hdr.encoding.version, "Wrong header version information");
+		mu_assert_eq(cu->hdr.encoding.address_size, exp->hdr.encoding.address_size, "Wrong header address_size information");
+		mu_assert_nullable_streq(cu->name, exp->name, "Wrong unit name");
+		mu_assert_nullable_streq(cu->comp_dir, exp->comp_dir, "Wrong unit comp_dir");
+		mu_assert_nullable_streq(cu->producer, exp->producer, "Wrong unit producer");
+		mu_assert_eq(cu->language, exp->language, "Wrong unit language");
+		mu_assert_eq(cu->low_pc, exp->low_pc, "Wrong unit low_pc");
+		mu_assert_eq(cu->high_pc, exp->high_pc, "Wrong unit high_pc");
+		mu_assert_eq(cu->stmt_list, exp->stmt_list, "Wrong unit stmt_list");
+		mu_assert_eq(rz_vector_len(&cu->dies), rz_vector_len(&exp->dies), "Wrong number of DIEs in the unit");
+		for (size_t j = 0; j < rz_vector_len(&cu->dies); j++) {
+			const RzBinDwarfDie *exp_die = rz_vector_index_ptr(&exp->dies, j);
+			const RzBinDwarfDie *die = rz_vector_index_ptr(&cu->dies, j);
+			mu_assert_eq(die->offset, exp_die->offset + shift, "Wrong DIE offset");
+			mu_assert_eq(die->unit_offset, exp_die->unit_offset + shift, "Wrong DIE unit offset");
+			mu_assert_eq(die->tag, exp_die->tag, "Wrong DIE tag");
+			mu_assert_eq(die->abbrev_code, exp_die->abbrev_code, "Wrong abbrev code");
+			mu_assert_eq(die->depth, exp_die->depth, "Wrong DIE depth");
+			mu_assert_eq(die->sibling, exp_die->sibling ? exp_die->sibling + shift : 0, "Wrong DIE sibling");
+			mu_assert_eq(rz_vector_len(&die->attrs), rz_vector_len(&exp_die->attrs), "Wrong DIE length information");
+			for (size_t k = 0; k < rz_vector_len(&die->attrs); k++) {
+				const RzBinDwarfAttr *exp_attr = rz_vector_index_ptr(&exp_die->attrs, k);
+				const RzBinDwarfAttr *attr = rz_vector_index_ptr(&die->attrs, k);
+				mu_assert_eq(attr->at, exp_attr->at, "Wrong attribute name");
+				mu_assert_eq(attr->form, exp_attr->form, "Wrong attribute form");
+				mu_assert_eq(attr->value.kind, exp_attr->value.kind, "Wrong attribute kind");
+				switch (attr->value.kind) {
+				case RzBinDwarfAttr_UnitRef:
+					mu_assert_eq(attr->value.u64, exp_attr->value.u64 + shift, "Wrong attribute reference");
+					break;
+				case RzBinDwarfAttr_Block:
+				case RzBinDwarfAttr_Exprloc:
+					mu_assert_eq(attr->value.block.length, exp_attr->value.block.length, "Wrong attribute block length");
+					mu_assert_memeq(rz_bin_dwarf_block_data(&attr->value.block), rz_bin_dwarf_block_data(&exp_attr->value.block),
+						attr->value.block.length, "Wrong attribute block data");
+					break;
+				case RzBinDwarfAttr_String:
+				case RzBinDwarfAttr_StrRef:
+				case RzBinDwarfAttr_StrOffsetIndex:
+				case RzBinDwarfAttr_LineStrRef:
+					mu_assert_nullable_streq(rz_bin_dwarf_attr_string(attr, dw, cu->str_offsets_base),
+						rz_bin_dwarf_attr_string(exp_attr, dw, exp->str_offsets_base), "Wrong string attribute information");
+					break;
+				default:
+					mu_assert_eq(attr->value.u64, exp_attr->value.u64, "Wrong attribute data");
+					break;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * The units of a .debug_info section big enough are parsed in parallel,
+ * which must give the same units and DIEs as the serial parse.
+ */
+bool test_dwarf_info_parallel(void) {
+	RzBin *bin = rz_bin_new();
+	RzIO *io = rz_io_new();
+	rz_io_bind(io, &bin->iob);
+
+	RzBinOptions opt = { 0 };
+	rz_bin_options_init(&opt, 0, 0, 0, false);
+	RzBinFile *bf = rz_bin_open(bin, "bins/elf/dwarf4_many_comp_units.elf", &opt);
+	mu_assert_notnull(bf, "couldn't open file");
+
+	RzBinDWARF *dw = rz_bin_dwarf_from_file(bf);
+	mu_assert_notnull(dw, "couldn't parse DWARF");
+	mu_assert_notnull(dw->info, "Failed parsing of debug_info");
+	const RzBinDwarfInfo *serial = dw->info;
+	mu_assert_eq(rz_vector_len(&serial->units), 2, "Incorrect number of info compilation units");
+
+	// the units repeated over more than 1 MiB, the size of the parallel parse
+	const RzBinEndianReader *section = serial->R;
+	const size_t copies = (1 << 20) / section->length + 1;
+	RzBinEndianReader *R = RZ_NEW0(RzBinEndianReader);
+	mu_assert_notnull(R, "reader");
+	R->data = malloc(copies * section->length);
+	mu_assert_notnull(R->data, "section data");
+	for (size_t i = 0; i < copies; i++) {
+		memcpy(R->data + i * section->length, section->data, section->length);
+	}
+	R->length = copies * section->length;
+	R->big_endian = section->big_endian;
+	R->owned = true;
+
+	RzBinDwarfInfo *info = rz_bin_dwarf_info_from_buf(R, dw);
+	mu_assert_notnull(info, "Failed parsing of the repeated debug_info");
+	mu_assert_true(check_info_copies(serial, info, copies, section->length, dw), "same units as the serial parse");
+
+	rz_bin_dwarf_info_free(info);
+	rz_bin_dwarf_free(dw);
+	rz_bin_free(bin);
+	rz_io_free(io);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_dwarf3_c);
 	mu_run_test(test_dwarf4_cpp_multiple_modules);
 	mu_run_test(test_dwarf2_big_endian);
+	mu_run_test(test_dwarf_info_parallel);
 	return tests_passed != tests_run;
 }
 
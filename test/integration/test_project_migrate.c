@@ -608,6 +608,47 @@ static bool test_migrate_v17_v18_rop_config() {
 }
 
 
+static bool test_migrate_file_binary() {
+	RzSerializeResultInfo *res = rz_serialize_result_info_new();
+	RzProjectErr err = rz_project_migrate_file("prj/v17-rop-config.rzdb", ".tmp_migrate_binary.rzdb", RZ_PROJECT_FORMAT_BINARY, res);
+	mu_assert_eq(err, RZ_PROJECT_ERR_SUCCESS, "migrate file");
+	mu_assert_eq(rz_list_length(res), RZ_PROJECT_VERSION - 17, "migration log");
+	rz_serialize_result_info_free(res);
+	mu_assert_true(rz_project_bin_check(".tmp_migrate_binary.rzdb"), "binary format");
+
+	RzProjectBin *pb = rz_project_bin_open(".tmp_migrate_binary.rzdb");
+	mu_assert_notnull(pb, "open binary project");
+	char version[32];
+	mu_assert_streq(rz_project_bin_get(pb, "", "version"), rz_strf(version, "%u", RZ_PROJECT_VERSION), "version");
+	mu_assert_streq(rz_project_bin_get(pb, "core/config", "rop.cache"), "false", "config");
+	mu_assert_null(rz_project_bin_get(pb, "core/config", "rop.sdb"), "config");
+	rz_project_bin_close(pb);
+
+	// swap the first two entries of the root, their keys are not sorted anymore
+	size_t size;
+	ut8 *buf = (ut8 *)rz_file_slurp(".tmp_migrate_binary.rzdb", &size);
+	mu_assert_notnull(buf, "read binary project");
+	ut64 root = rz_read_le64(buf + rz_read_le64(buf + 16));
+	ut8 entry[16];
+	memcpy(entry, buf + root, sizeof(entry));
+	memcpy(buf + root, buf + root + sizeof(entry), sizeof(entry));
+	memcpy(buf + root + sizeof(entry), entry, sizeof(entry));
+	mu_assert_true(rz_file_dump(".tmp_migrate_unsorted.rzdb", buf, size, false), "write unsorted project");
+	free(buf);
+	mu_assert_null(rz_project_bin_open(".tmp_migrate_unsorted.rzdb"), "unsorted keys rejected");
+	mu_assert_null(rz_project_load_file_raw(".tmp_migrate_unsorted.rzdb"), "unsorted keys rejected");
+	rz_file_rm(".tmp_migrate_unsorted.rzdb");
+
+	RzProject *prj = rz_project_load_file_raw(".tmp_migrate_binary.rzdb");
+	mu_assert_notnull(prj, "load raw project");
+	Sdb *config_db = sdb_ns_path(prj, "core/config", false);
+	mu_assert_notnull(config_db, "config ns");
+	mu_assert_streq_free(sdb_get(config_db, "rop.cache"), "false", "config");
+	rz_project_free(prj);
+	rz_file_rm(".tmp_migrate_binary.rzdb");
+	mu_end;
+}
+
 /// Load project of given version from file into core and check the log for migration success messages
 #define BEGIN_LOAD_TEST(core, version, file) \
 	do { \
@@ -1024,6 +1065,7 @@ int all_tests() {
 	mu_run_test(test_migrate_v15_v16_str_config);
 	mu_run_test(test_migrate_v16_v17_flags_base);
 	mu_run_test(test_migrate_v17_v18_rop_config);
+	mu_run_test(test_migrate_file_binary);
 	mu_run_test(test_load_v1_noreturn);
 	mu_run_test(test_load_v1_noreturn_empty);
 	mu_run_test(test_load_v1_unknown_type);
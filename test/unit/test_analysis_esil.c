@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_analysis.h>
+#include "minunit.h"
+
+// same as ESIL_PARSE_CACHE_MAX in esil.c
+#define PARSE_CACHE_MAX (1 << 14)
+
+static const char *profile =
+	"=PC	pc\n"
+	"gpr	pc	.64	0	0\n"
+	"gpr	r0	.64	8	0\n"
+	"gpr	r1	.64	16	0\n";
+
+static RzAnalysisEsil *esil_new(RzAnalysis *analysis) {
+	rz_reg_set_profile_string(analysis->reg, profile);
+	RzAnalysisEsil *esil = rz_analysis_esil_new(32, 0, 64);
+	if (esil) {
+		rz_analysis_esil_setup(esil, analysis, false, false, false);
+	}
+	return esil;
+}
+
+static size_t cache_count(RzAnalysisEsil *esil) {
+	return esil->parse_cache ? esil->parse_cache->count : 0;
+}
+
+bool test_esil_parse_cache_hit(void) {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisEsil *esil = esil_new(analysis);
+	mu_assert_notnull(esil, "esil");
+
+	for (int i = 0; i < 3; i++) {
+		mu_assert_true(rz_analysis_esil_parse(esil, "2,r0,+="), "parse");
+		mu_assert_eq(cache_count(esil), 1, "expression cached once");
+	}
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), 6, "expression run every time");
+
+	mu_assert_true(rz_analysis_esil_parse(esil, "r0,r1,="), "parse");
+	mu_assert_eq(cache_count(esil), 2, "other expression cached");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r1"), 6, "r1");
+
+	// run by the character scanner, which is remembered as well
+	ut64 regs[2][2];
+	for (int i = 0; i < 2; i++) {
+		rz_reg_setv(analysis->reg, "r0", 1);
+		rz_reg_setv(analysis->reg, "r1", 2);
+		rz_analysis_esil_parse(esil, "1,r0,+=,,r0,r1,+=");
+		rz_analysis_esil_stack_free(esil);
+		regs[i][0] = rz_reg_getv(analysis->reg, "r0");
+		regs[i][1] = rz_reg_getv(analysis->reg, "r1");
+	}
+	mu_assert_eq(cache_count(esil), 3, "fallback expression cached");
+	mu_assert_eq(regs[0][0], 2, "r0 with two separators");
+	mu_assert_eq(regs[1][0], regs[0][0], "same r0 when cached");
+	mu_assert_eq(regs[1][1], regs[0][1], "same r1 when cached");
+
+	rz_analysis_esil_free(esil);
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+static bool esil_double(RzAnalysisEsil *esil) {
+	ut64 num;
+	char *src = rz_analysis_esil_pop(esil);
+	bool ret = src && rz_analysis_esil_get_parm(esil, src, &num) && rz_analysis_esil_pushnum(esil, num * 2);
+	free(src);
+	return ret;
+}
+
+bool test_esil_parse_cache_changed(void) {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisEsil *esil = esil_new(analysis);
+	mu_assert_notnull(esil, "esil");
+
+	// the same buffer with a different expression
+	char expr[32];
+	rz_strf(expr, "1,r0,=");
+	mu_assert_true(rz_analysis_esil_parse(esil, expr), "parse");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), 1, "first expression");
+	rz_strf(expr, "0x20,r0,=,r0,r1,=");
+	mu_assert_true(rz_analysis_esil_parse(esil, expr), "parse");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), 0x20, "changed expression");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r1"), 0x20, "changed expression with more words");
+	rz_strf(expr, "1,r0,=");
+	mu_assert_true(rz_analysis_esil_parse(esil, expr), "parse");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), 1, "first expression again");
+	mu_assert_eq(cache_count(esil), 2, "both expressions cached");
+
+	// a new operation flushes the cache, since the word was compiled as a value
+	rz_analysis_esil_parse(esil, "3,DOUBLE,r0,=");
+	rz_analysis_esil_stack_free(esil);
+	mu_assert_eq(cache_count(esil), 3, "expression with an unknown word cached");
+	mu_assert_true(rz_analysis_esil_set_op(esil, "DOUBLE", esil_double, 1, 1, RZ_ANALYSIS_ESIL_OP_TYPE_MATH), "set op");
+	mu_assert_eq(cache_count(esil), 0, "cache flushed by the new op");
+	mu_assert_true(rz_analysis_esil_parse(esil, "3,DOUBLE,r0,="), "parse");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), 6, "new op run");
+
+	rz_analysis_esil_free(esil);
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+bool test_esil_parse_cache_evict(void) {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisEsil *esil = esil_new(analysis);
+	mu_assert_notnull(esil, "esil");
+
+	char expr[32];
+	for (size_t i = 0; i < PARSE_CACHE_MAX; i++) {
+		rz_strf(expr, "%" PFMTSZu ",r0,=", i);
+		mu_assert_true(rz_analysis_esil_parse(esil, expr), "parse");
+	}
+	mu_assert_eq(cache_count(esil), PARSE_CACHE_MAX, "cache full");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), PARSE_CACHE_MAX - 1, "last expression");
+
+	// a cached expression does not evict anything
+	mu_assert_true(rz_analysis_esil_parse(esil, "0,r0,="), "parse");
+	mu_assert_eq(cache_count(esil), PARSE_CACHE_MAX, "hit on a full cache");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), 0, "cached expression");
+
+	mu_assert_true(rz_analysis_esil_parse(esil, "r0,r1,="), "parse");
+	mu_assert_eq(cache_count(esil), 1, "cache flushed at the cap");
+	mu_assert_true(rz_analysis_esil_parse(esil, "1,r0,="), "parse");
+	mu_assert_eq(cache_count(esil), 2, "evicted expression cached again");
+	mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), 1, "evicted expression");
+
+	rz_analysis_esil_free(esil);
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+typedef struct {
+	const char *expr;
+	ut64 r0;
+	ut64 r1;
+} EsilCase;
+
+bool test_esil_parse_cache_control_flow(void) {
+	static const EsilCase cases[] = {
+		// nested conditionals
+		{ "1,?{,2,r0,=,0,?{,3,r0,=,}{,4,r1,=,},}{,5,r0,=,}", 2, 4 },
+		{ "0,?{,2,r0,=,1,?{,3,r0,=,}{,4,r1,=,},}{,5,r0,=,}", 5, 0 },
+		{ "1,?{,1,?{,3,r0,=,},6,r1,=,}{,5,r0,=,}", 3, 6 },
+		{ "0,?{,1,?{,3,r0,=,}{,7,r0,=,},6,r1,=,}{,5,r0,=,},8,r1,+=", 5, 8 },
+		// sum of 3 + 2 + 1, jumping back to the 7th word
+		{ "3,r0,=,0,r1,=,r0,r1,+=,1,r0,-=,r0,?{,6,GOTO,}", 0, 6 },
+		// jumping forward over the assignment of r0
+		{ "1,r1,=,8,GOTO,7,r0,=,2,r1,+=", 0, 3 },
+		// words after ';' are not run
+		{ "1,r0,=;2,r1,=", 1, 0 },
+		{ "4,r0,=,BREAK,5,r1,=", 4, 0 },
+	};
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisEsil *esil = esil_new(analysis);
+	mu_assert_notnull(esil, "esil");
+
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(cases); i++) {
+		// the first run compiles the expression, the second one runs it from the cache
+		for (int run = 0; run < 2; run++) {
+			rz_reg_setv(analysis->reg, "r0", 0);
+			rz_reg_setv(analysis->reg, "r1", 0);
+			rz_analysis_esil_parse(esil, cases[i].expr);
+			rz_analysis_esil_stack_free(esil);
+			mu_assert_eq(rz_reg_getv(analysis->reg, "r0"), cases[i].r0, cases[i].expr);
+			mu_assert_eq(rz_reg_getv(analysis->reg, "r1"), cases[i].r1, cases[i].expr);
+		}
+	}
+	mu_assert_eq(cache_count(esil), RZ_ARRAY_SIZE(cases), "every expression cached");
+
+	rz_analysis_esil_free(esil);
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_esil_parse_cache_hit);
+	mu_run_test(test_esil_parse_cache_changed);
+	mu_run_test(test_esil_parse_cache_evict);
+	mu_run_test(test_esil_parse_cache_control_flow);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
@@ -106,6 +106,197 @@ bool test_rz_analysis_op_val() {
 	mu_end;
 }
 
+bool test_rz_analysis_op_cache() {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisOp op;
+	SWITCH_TO_ARCH_BITS("x86", 64);
+	rz_analysis_op_cache_set_size(analysis, 16);
+	mu_assert_eq(analysis->opcache.size, 16, "cache size");
+
+	// mov rax, [rbx+rcx+4]
+	for (int i = 0; i < 2; i++) {
+		rz_analysis_op_init(&op);
+		int len = rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\x8b\x44\x0b\x04", 5, RZ_ANALYSIS_OP_MASK_VAL);
+		mu_assert_eq(len, 5, "Op is of size 5");
+		mu_assert_eq(op.addr, 0x1000, "Op addr");
+		mu_assert_eq(op.dst->type, RZ_ANALYSIS_VAL_REG, "Destination should be reg");
+		mu_assert_streq(op.dst->reg->name, "rax", "Dst reg should be rax");
+		mu_assert_streq(op.src[0]->regdelta->name, "rcx", "Source reg delta should be rcx");
+		rz_analysis_op_fini(&op);
+	}
+	mu_assert_eq(analysis->opcache.misses, 1, "first decoding misses");
+	mu_assert_eq(analysis->opcache.hits, 1, "second decoding hits");
+
+	// different bytes at the same address
+	rz_analysis_op_init(&op);
+	int len = rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\xc7\xc0\x04\x00\x00\x00", 7, RZ_ANALYSIS_OP_MASK_VAL);
+	mu_assert_eq(len, 7, "Op is of size 7");
+	mu_assert_eq(op.src[0]->imm, 4, "Source imm should be 4");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.misses, 2, "changed bytes miss");
+
+	// a wider mask than the cached one
+	rz_analysis_op_init(&op);
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\xc7\xc0\x04\x00\x00\x00", 7, RZ_ANALYSIS_OP_MASK_VAL | RZ_ANALYSIS_OP_MASK_ESIL);
+	mu_assert_streq(rz_strbuf_get(&op.esil), "4,rax,=", "esil");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.misses, 3, "wider mask misses");
+
+	// a narrower one can be served from the cache
+	rz_analysis_op_init(&op);
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\xc7\xc0\x04\x00\x00\x00", 7, RZ_ANALYSIS_OP_MASK_ESIL);
+	mu_assert_streq(rz_strbuf_get(&op.esil), "4,rax,=", "esil");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.hits, 2, "narrower mask hits");
+
+	// changing the bits invalidates the entry
+	rz_analysis_set_bits(analysis, 32);
+	rz_analysis_op_init(&op);
+	len = rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x48\xc7\xc0\x04\x00\x00\x00", 7, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(len, 1, "dec eax");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.misses, 4, "changed bits miss");
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+static ut64 stateful_counter;
+
+static int stateful_op(RzAnalysis *a, RzAnalysisOp *op, ut64 addr, const ut8 *data, int len, RzAnalysisOpMask mask) {
+	// the decoding depends on the previously decoded instructions
+	op->type = RZ_ANALYSIS_OP_TYPE_NOP;
+	op->size = 1;
+	op->val = stateful_counter++;
+	return 1;
+}
+
+static RzAnalysisPlugin stateful_plugin = {
+	.name = "stateful",
+	.arch = "stateful",
+	.bits = 32,
+	.op = stateful_op,
+};
+
+bool test_rz_analysis_op_cache_stateful() {
+	RzAnalysis *analysis = rz_analysis_new();
+	rz_analysis_op_cache_set_size(analysis, 16);
+	rz_analysis_plugin_add(analysis, &stateful_plugin);
+	mu_assert_true(rz_analysis_use(analysis, "stateful"), "use stateful plugin");
+	RzAnalysisOp op;
+	stateful_counter = 0;
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x00", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(op.val, 0, "first decoding");
+	rz_analysis_op_fini(&op);
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x00", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(op.val, 1, "the state changed, the op is decoded again");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.hits, 0, "not cacheable plugin never hits");
+	mu_assert_null(analysis->opcache.entries, "nothing cached");
+
+	// the same plugin declared cacheable reuses the first op
+	stateful_plugin.cacheable = true;
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x00", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(op.val, 2, "decoded");
+	rz_analysis_op_fini(&op);
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x00", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(op.val, 2, "cached");
+	rz_analysis_op_fini(&op);
+	stateful_plugin.cacheable = false;
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+bool test_rz_analysis_op_cache_hints() {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisOp op;
+	SWITCH_TO_ARCH_BITS("x86", 64);
+	rz_analysis_op_cache_set_size(analysis, 16);
+	const ut64 addrs[] = { 0x1000, 0x1001, 0x2008 };
+	for (int round = 0; round < 2; round++) {
+		for (size_t i = 0; i < RZ_ARRAY_SIZE(addrs); i++) {
+			rz_analysis_op(analysis, &op, addrs[i], (const ut8 *)"\x90", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+			rz_analysis_op_fini(&op);
+		}
+	}
+	mu_assert_eq(analysis->opcache.misses, 3, "first round misses");
+	mu_assert_eq(analysis->opcache.hits, 3, "second round hits");
+
+	// a hint only drops the op at its address
+	rz_analysis_hint_set_immbase(analysis, 0x1001, 10);
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x90", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	rz_analysis_op(analysis, &op, 0x2008, (const ut8 *)"\x90", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.hits, 5, "other addresses still hit");
+	rz_analysis_op(analysis, &op, 0x1001, (const ut8 *)"\x90", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.misses, 4, "hinted address misses");
+
+	// deleting the hints of a range drops the ops of the range
+	rz_analysis_hint_del(analysis, 0x1000, 0x10);
+	rz_analysis_op(analysis, &op, 0x2008, (const ut8 *)"\x90", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.hits, 6, "out of the range hits");
+	rz_analysis_op(analysis, &op, 0x1000, (const ut8 *)"\x90", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	rz_analysis_op(analysis, &op, 0x1001, (const ut8 *)"\x90", 1, RZ_ANALYSIS_OP_MASK_BASIC);
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.misses, 6, "in the range misses");
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+static ut8 call_memory[0x20];
+
+static bool call_memory_read(RzAnalysis *analysis, ut64 addr, ut8 *buf, int len) {
+	if (len < 0 || addr + len > sizeof(call_memory)) {
+		return false;
+	}
+	memcpy(buf, call_memory + addr, len);
+	return true;
+}
+
+bool test_rz_analysis_op_cache_outside_bytes() {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzAnalysisOp op;
+	SWITCH_TO_ARCH_BITS("x86", 32);
+	rz_analysis_op_cache_set_size(analysis, 16);
+	analysis->read_at = call_memory_read;
+
+	// call 0x10, which is decoded again once a get-pc thunk is written at the target
+	memset(call_memory, 0, sizeof(call_memory));
+	rz_analysis_op(analysis, &op, 0, (const ut8 *)"\xe8\x0b\x00\x00\x00", 5, RZ_ANALYSIS_OP_MASK_ESIL);
+	mu_assert_eq(op.type, RZ_ANALYSIS_OP_TYPE_CALL, "call");
+	mu_assert_false(rz_str_startswith(rz_strbuf_get(&op.esil), "0x5,ebx,="), "plain call");
+	rz_analysis_op_fini(&op);
+	// mov ebx, dword [esp]; ret
+	memcpy(call_memory + 0x10, "\x8b\x1c\x24\xc3", 4);
+	rz_analysis_op(analysis, &op, 0, (const ut8 *)"\xe8\x0b\x00\x00\x00", 5, RZ_ANALYSIS_OP_MASK_ESIL);
+	mu_assert_streq(rz_strbuf_get(&op.esil), "0x5,ebx,=", "call to the thunk");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.hits, 0, "calls are not cached");
+
+	// ljmp 0x10:0, whose target depends on the segment granularity
+	analysis->seggrn = 4;
+	rz_analysis_op(analysis, &op, 0, (const ut8 *)"\xea\x00\x00\x00\x00\x10\x00", 7, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(op.jump, 0x100, "far jump");
+	rz_analysis_op_fini(&op);
+	analysis->seggrn = 8;
+	rz_analysis_op(analysis, &op, 0, (const ut8 *)"\xea\x00\x00\x00\x00\x10\x00", 7, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(op.jump, 0x1000, "far jump with another granularity");
+	rz_analysis_op_fini(&op);
+	rz_analysis_op(analysis, &op, 0, (const ut8 *)"\xea\x00\x00\x00\x00\x10\x00", 7, RZ_ANALYSIS_OP_MASK_BASIC);
+	mu_assert_eq(op.jump, 0x1000, "cached far jump");
+	rz_analysis_op_fini(&op);
+	mu_assert_eq(analysis->opcache.hits, 1, "same granularity hits");
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
 bool test_rz_core_analysis_bytes() {
 	RzCore *core = rz_core_new();
 	rz_core_set_asm_configs(core, "x86", 64, 0);
@@ -181,6 +372,10 @@ bool test_rz_core_print_disasm() {
 
 int all_tests() {
 	mu_run_test(test_rz_analysis_op_val);
+	mu_run_test(test_rz_analysis_op_cache);
+	mu_run_test(test_rz_analysis_op_cache_stateful);
+	mu_run_test(test_rz_analysis_op_cache_hints);
+	mu_run_test(test_rz_analysis_op_cache_outside_bytes);
 	mu_run_test(test_rz_core_analysis_bytes);
 	mu_run_test(test_rz_core_print_disasm);
 	return tests_passed != tests_run;
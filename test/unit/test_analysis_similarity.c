@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_analysis.h>
+#include <rz_io.h>
+#include "minunit.h"
+
+// more functions than the candidates compared exhaustively, so the LSH index is used
+#define N_FUNCTIONS 80
+#define N_UNIQUE    8
+#define FCN_SIZE    48
+#define ADDR_A      0x1000
+#define ADDR_B      0x100000
+#define FCN_SPACING 0x100
+
+// more functions of B than the ones compared when no candidate is similar enough
+#define N_MANY_FUNCTIONS 700
+#define N_MANY_UNIQUE    100
+#define N_FALLBACK       256
+
+static ut32 seed = 0x1234;
+
+static ut8 next_byte(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+static RzAnalysisFunction *function_new(RzAnalysis *analysis, RzIO *io, ut64 addr, const ut8 *data, ut32 size) {
+	char name[32];
+	rz_strf(name, "fcn.%08" PFMT64x, addr);
+	RzAnalysisFunction *fcn = rz_analysis_create_function(analysis, name, addr, RZ_ANALYSIS_FCN_TYPE_FCN);
+	// two blocks, which are joined when computing the similarity
+	RzAnalysisBlock *bb = rz_analysis_create_block(analysis, addr, size / 2);
+	rz_analysis_function_add_block(fcn, bb);
+	rz_analysis_block_unref(bb);
+	bb = rz_analysis_create_block(analysis, addr + size / 2, size / 2);
+	rz_analysis_function_add_block(fcn, bb);
+	rz_analysis_block_unref(bb);
+	rz_io_write_at(io, addr, data, size);
+	return fcn;
+}
+
+static RzAnalysisMatchPair *match_find(RzAnalysisMatchResult *result, RzAnalysisFunction *fcn_a) {
+	RzAnalysisMatchPair *pair;
+	RzListIter *it;
+	rz_list_foreach (result->matches, it, pair) {
+		if (pair->pair_a == fcn_a) {
+			return pair;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Same selection as the matching loop when every function of B is a candidate.
+ */
+static RzAnalysisFunction *exhaustive_match(RzAnalysis *analysis, RzAnalysisFunction *fcn_a, RzList /*<RzAnalysisFunction *>*/ *list_b, double *similarity) {
+	RzAnalysisFunction *match = NULL, *fcn_b;
+	RzListIter *it;
+	double max = 0.0;
+	rz_list_foreach (list_b, it, fcn_b) {
+		double sim = rz_analysis_similarity_function(analysis, fcn_a, fcn_b);
+		if (sim < RZ_ANALYSIS_SIMILARITY_THRESHOLD && sim <= max) {
+			continue;
+		}
+		max = sim;
+		match = fcn_b;
+		if (max >= 1.0) {
+			break;
+		}
+	}
+	*similarity = max;
+	return match;
+}
+
+bool test_analysis_match_functions_lsh(void) {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzIO *io = rz_io_new();
+	io->va = true;
+	rz_io_open_at(io, "malloc://0x200000", RZ_PERM_RW, 0644, 0, NULL);
+	rz_io_bind(io, &analysis->iob);
+
+	RzList *list_a = rz_list_new();
+	RzList *list_b = rz_list_new();
+	ut8 data[FCN_SIZE];
+	for (size_t i = 0; i < N_FUNCTIONS; i++) {
+		for (size_t j = 0; j < FCN_SIZE; j++) {
+			data[j] = next_byte();
+		}
+		rz_list_append(list_a, function_new(analysis, io, ADDR_A + i * FCN_SPACING, data, FCN_SIZE));
+		if (i >= N_FUNCTIONS - N_UNIQUE) {
+			// no counterpart in B
+			continue;
+		}
+		// identical, or with a few bytes changed
+		for (size_t j = 0; j < i % 4; j++) {
+			data[(i * 7 + j * 13) % FCN_SIZE] ^= 0x5a;
+		}
+		// B is in a different order than A
+		rz_list_prepend(list_b, function_new(analysis, io, ADDR_B + i * FCN_SPACING, data, FCN_SIZE));
+	}
+	mu_assert_eq(rz_list_length(list_b), N_FUNCTIONS - N_UNIQUE, "functions of B");
+
+	RzAnalysisMatchOpt opt = {
+		.analysis_a = analysis,
+		.analysis_b = analysis,
+	};
+	RzAnalysisMatchResult *result = rz_analysis_match_functions(list_a, list_b, &opt);
+	mu_assert_notnull(result, "match result");
+
+	size_t n_expected = 0, n_similar = 0;
+	RzListIter *it;
+	RzAnalysisFunction *fcn_a;
+	rz_list_foreach (list_a, it, fcn_a) {
+		double similarity;
+		RzAnalysisFunction *expected = exhaustive_match(analysis, fcn_a, list_b, &similarity);
+		RzAnalysisMatchPair *found = match_find(result, fcn_a);
+		if (!expected) {
+			mu_assert_null(found, "no match");
+			mu_assert_notnull(rz_list_find_ptr(result->unmatch_a, fcn_a), "unmatched function of A");
+			continue;
+		}
+		n_expected++;
+		if (similarity >= RZ_ANALYSIS_SIMILARITY_THRESHOLD) {
+			n_similar++;
+		}
+		mu_assert_notnull(found, "match");
+		mu_assert_ptreq(found->pair_b, expected, "same best match as the exhaustive search");
+		mu_assert_eqf(found->similarity, similarity, "same similarity as the exhaustive search");
+	}
+	// B is small enough for the functions without a counterpart to get their closest function of B
+	mu_assert_eq(n_similar, N_FUNCTIONS - N_UNIQUE, "every function with a counterpart is matched");
+	mu_assert_eq(rz_list_length(result->matches), n_expected, "matches");
+	mu_assert_eq(rz_list_length(result->unmatch_a), N_FUNCTIONS - n_expected, "unmatched functions of A");
+
+	rz_analysis_match_result_free(result);
+	rz_list_free(list_a);
+	rz_list_free(list_b);
+	rz_analysis_free(analysis);
+	rz_io_free(io);
+	mu_end;
+}
+
+bool test_analysis_match_functions_unmatched(void) {
+	RzAnalysis *analysis = rz_analysis_new();
+	RzIO *io = rz_io_new();
+	io->va = true;
+	rz_io_open_at(io, "malloc://0x200000", RZ_PERM_RW, 0644, 0, NULL);
+	rz_io_bind(io, &analysis->iob);
+
+	RzList *list_a = rz_list_new();
+	RzList *list_b = rz_list_new();
+	RzAnalysisFunction **counterparts = RZ_NEWS0(RzAnalysisFunction *, N_MANY_FUNCTIONS);
+	ut8 data[FCN_SPACING];
+	for (size_t i = 0; i < N_MANY_FUNCTIONS; i++) {
+		ut32 size = 16 + (i % 32) * 4;
+		for (size_t j = 0; j < size; j++) {
+			data[j] = next_byte();
+		}
+		rz_list_append(list_a, function_new(analysis, io, ADDR_A + i * FCN_SPACING, data, size));
+		if (i % (N_MANY_FUNCTIONS / N_MANY_UNIQUE)) {
+			counterparts[i] = function_new(analysis, io, ADDR_B + i * FCN_SPACING, data, size);
+			rz_list_prepend(list_b, counterparts[i]);
+		}
+	}
+	mu_assert_eq(rz_list_length(list_b), N_MANY_FUNCTIONS - N_MANY_UNIQUE, "functions of B");
+
+	RzAnalysisMatchOpt opt = {
+		.analysis_a = analysis,
+		.analysis_b = analysis,
+	};
+	RzAnalysisMatchResult *result = rz_analysis_match_functions(list_a, list_b, &opt);
+	mu_assert_notnull(result, "match result");
+	mu_assert_eq(rz_list_length(result->matches), N_MANY_FUNCTIONS, "every function matched");
+
+	size_t i = 0;
+	RzListIter *it;
+	RzAnalysisFunction *fcn_a;
+	rz_list_foreach (list_a, it, fcn_a) {
+		RzAnalysisMatchPair *found = match_find(result, fcn_a);
+		mu_assert_notnull(found, "match");
+		RzAnalysisFunction *counterpart = counterparts[i++];
+		if (counterpart) {
+			mu_assert_ptreq(found->pair_b, counterpart, "identical function");
+			mu_assert_eqf(found->similarity, 1.0, "identical similarity");
+			continue;
+		}
+		// the closest function is searched only among the ones closest in size
+		mu_assert_true(found->similarity < RZ_ANALYSIS_SIMILARITY_THRESHOLD, "not similar");
+		st64 size_a = rz_analysis_function_linear_size(fcn_a);
+		st64 delta = RZ_ABS((st64)rz_analysis_function_linear_size((RzAnalysisFunction *)found->pair_b) - size_a);
+		size_t n_closer = 0;
+		RzListIter *it2;
+		RzAnalysisFunction *fcn_b;
+		rz_list_foreach (list_b, it2, fcn_b) {
+			if (RZ_ABS((st64)rz_analysis_function_linear_size(fcn_b) - size_a) < delta) {
+				n_closer++;
+			}
+		}
+		mu_assert_true(n_closer < N_FALLBACK, "match among the functions closest in size");
+	}
+
+	rz_analysis_match_result_free(result);
+	free(counterparts);
+	rz_list_free(list_a);
+	rz_list_free(list_b);
+	rz_analysis_free(analysis);
+	rz_io_free(io);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_analysis_match_functions_lsh);
+	mu_run_test(test_analysis_match_functions_unmatched);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
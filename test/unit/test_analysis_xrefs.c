@@ -21,8 +21,133 @@ bool test_rz_analysis_xrefs_count() {
 	mu_end;
 }
 
+bool test_rz_analysis_xrefs_get() {
+	RzAnalysis *analysis = rz_analysis_new();
+
+	rz_analysis_xrefs_set(analysis, 0x30, 0x100, RZ_ANALYSIS_XREF_TYPE_CALL);
+	rz_analysis_xrefs_set(analysis, 0x10, 0x100, RZ_ANALYSIS_XREF_TYPE_CODE);
+	rz_analysis_xrefs_set(analysis, 0x20, 0x100, RZ_ANALYSIS_XREF_TYPE_DATA);
+	rz_analysis_xrefs_set(analysis, 0x10, 0x200, RZ_ANALYSIS_XREF_TYPE_DATA);
+	// same pair, the type is replaced
+	rz_analysis_xrefs_set(analysis, 0x20, 0x100, RZ_ANALYSIS_XREF_TYPE_STRING);
+	mu_assert_eq(rz_analysis_xrefs_count(analysis), 4, "xrefs count");
+
+	RzList *xrefs = rz_analysis_xrefs_get_to(analysis, 0x100);
+	mu_assert_eq(rz_list_length(xrefs), 3, "xrefs to count");
+	RzAnalysisXRef *xref = rz_list_get_n(xrefs, 0);
+	mu_assert_eq(xref->from, 0x10, "sorted by from");
+	mu_assert_eq(xref->type, RZ_ANALYSIS_XREF_TYPE_CODE, "xref type");
+	xref = rz_list_get_n(xrefs, 1);
+	mu_assert_eq(xref->from, 0x20, "sorted by from");
+	mu_assert_eq(xref->type, RZ_ANALYSIS_XREF_TYPE_STRING, "replaced xref type");
+	xref = rz_list_get_n(xrefs, 2);
+	mu_assert_eq(xref->from, 0x30, "sorted by from");
+	rz_list_free(xrefs);
+
+	RzIterator *it = rz_analysis_xrefs_get_from_iter(analysis, 0x10);
+	xref = rz_iterator_next(it);
+	mu_assert_eq(xref->to, 0x100, "sorted by to");
+	xref = rz_iterator_next(it);
+	mu_assert_eq(xref->to, 0x200, "sorted by to");
+	mu_assert_eq(xref->type, RZ_ANALYSIS_XREF_TYPE_DATA, "xref type");
+	mu_assert_null(rz_iterator_next(it), "end of iteration");
+	rz_iterator_free(it);
+
+	rz_analysis_xref_del(analysis, 0x20, 0x100);
+	mu_assert_eq(rz_analysis_xrefs_count(analysis), 3, "xrefs count");
+	xrefs = rz_analysis_xrefs_get_to(analysis, 0x100);
+	mu_assert_eq(rz_list_length(xrefs), 2, "xrefs to count");
+	rz_list_free(xrefs);
+	mu_assert_null(rz_analysis_xrefs_get_from(analysis, 0x20), "deleted xref");
+	mu_assert_null(rz_analysis_xrefs_get_to(analysis, 0x300), "no xref");
+
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+static int xref_cmp(const void *a, const void *b) {
+	const RzAnalysisXRef *x = a, *y = b;
+	if (x->from != y->from) {
+		return x->from < y->from ? -1 : 1;
+	}
+	return x->to < y->to ? -1 : (x->to > y->to ? 1 : 0);
+}
+
+bool test_rz_analysis_xrefs_many() {
+	RzAnalysis *analysis = rz_analysis_new();
+
+	// enough xrefs to merge many runs, half of them set one by one, half in bulk
+	const size_t n = 5000;
+	RzAnalysisXRef *expect = RZ_NEWS(RzAnalysisXRef, n);
+	for (size_t i = 0; i < n; i++) {
+		expect[i].from = (i * 7919) % n + 1;
+		expect[i].to = (i * 104729) % 37 + 0x10000;
+		expect[i].type = i % 2 ? RZ_ANALYSIS_XREF_TYPE_CALL : RZ_ANALYSIS_XREF_TYPE_DATA;
+	}
+	for (size_t i = 0; i < n / 2; i++) {
+		mu_assert_true(rz_analysis_xrefs_set(analysis, expect[i].from, expect[i].to, expect[i].type), "set xref");
+	}
+	mu_assert_eq(rz_analysis_xrefs_set_bulk(analysis, expect + n / 2, n - n / 2), n - n / 2, "bulk set");
+	mu_assert_eq(rz_analysis_xrefs_count(analysis), n, "xrefs count");
+	mu_assert_true(rz_analysis_xrefs_memory_usage(analysis) >= 2 * n * sizeof(RzAnalysisXRef), "memory usage");
+
+	qsort(expect, n, sizeof(RzAnalysisXRef), xref_cmp);
+	RzIterator *it = rz_analysis_xrefs_iter(analysis);
+	RzAnalysisXRef *xref;
+	size_t i = 0;
+	rz_iterator_foreach(it, xref) {
+		mu_assert_true(i < n, "too many xrefs");
+		mu_assert_eq(xref->from, expect[i].from, "xref from");
+		mu_assert_eq(xref->to, expect[i].to, "xref to");
+		mu_assert_eq(xref->type, expect[i].type, "xref type");
+		i++;
+	}
+	rz_iterator_free(it);
+	mu_assert_eq(i, n, "all xrefs iterated");
+
+	ut64 prev = 0;
+	size_t count = 0;
+	it = rz_analysis_xrefs_get_to_iter(analysis, 0x10005);
+	rz_iterator_foreach(it, xref) {
+		mu_assert_eq(xref->to, 0x10005, "xref to");
+		mu_assert_true(xref->from > prev, "sorted by from");
+		prev = xref->from;
+		count++;
+	}
+	rz_iterator_free(it);
+	size_t expect_count = 0;
+	for (i = 0; i < n; i++) {
+		expect_count += expect[i].to == 0x10005;
+	}
+	mu_assert_eq(count, expect_count, "xrefs to count");
+
+	for (i = 0; i < n; i += 2) {
+		rz_analysis_xrefs_deln(analysis, expect[i].from, expect[i].to, expect[i].type);
+	}
+	mu_assert_eq(rz_analysis_xrefs_count(analysis), n / 2, "xrefs count");
+	RzList *xrefs = rz_analysis_xrefs_list(analysis);
+	mu_assert_eq(rz_list_length(xrefs), n / 2, "xrefs list");
+	rz_list_free(xrefs);
+	for (i = 0; i < n; i++) {
+		xrefs = rz_analysis_xrefs_get_from(analysis, expect[i].from);
+		RzListIter *lit;
+		bool found = false;
+		rz_list_foreach (xrefs, lit, xref) {
+			found |= xref->to == expect[i].to;
+		}
+		rz_list_free(xrefs);
+		mu_assert_eq(found, i % 2, "deleted xref");
+	}
+
+	free(expect);
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_rz_analysis_xrefs_count);
+	mu_run_test(test_rz_analysis_xrefs_get);
+	mu_run_test(test_rz_analysis_xrefs_many);
 	return tests_passed != tests_run;
 }
 
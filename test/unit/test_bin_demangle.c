@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_bin.h>
+#include <rz_demangler.h>
+#include "minunit.h"
+
+// more names than the ones demangled on the calling thread
+#define N_NAMES 1500
+
+static RzBinObject *object_new(void) {
+	RzBinObject *o = RZ_NEW0(RzBinObject);
+	if (!o) {
+		return NULL;
+	}
+	o->lang = RZ_BIN_LANGUAGE_CXX;
+	o->symbols = rz_pvector_new((RzPVectorFree)rz_bin_symbol_free);
+	o->imports = rz_pvector_new((RzPVectorFree)rz_bin_import_free);
+	o->relocs = rz_bin_reloc_storage_new(rz_pvector_new(NULL));
+	return o;
+}
+
+static void object_free(RzBinObject *o) {
+	rz_pvector_free(o->symbols);
+	rz_pvector_free(o->imports);
+	rz_bin_reloc_storage_free(o->relocs);
+	free(o);
+}
+
+/**
+ * Adds \p name as symbol and as import, so every name is looked up twice.
+ */
+static void object_add_name(RzBinObject *o, const char *name) {
+	rz_pvector_push(o->symbols, rz_bin_symbol_new(name, 0, 0));
+	RzBinImport *imp = RZ_NEW0(RzBinImport);
+	imp->name = rz_str_dup(name);
+	rz_pvector_push(o->imports, imp);
+}
+
+/**
+ * Demangles the names of \p o with rz_bin_demangle_with_flags(), which goes
+ * through the cache of the demangled names.
+ */
+static void demangle_object(RzBin *bin, RzBinObject *o) {
+	RzBinFile *bf = RZ_NEW0(RzBinFile);
+	bf->o = o;
+	rz_list_append(bin->binfiles, bf);
+	bin->demangle = true;
+	rz_demangler_set_flags(bin->demangler, RZ_DEMANGLER_FLAG_BASE);
+	rz_bin_demangle_with_flags(bin, RZ_DEMANGLER_FLAG_ENABLE_ALL);
+	rz_list_pop(bin->binfiles);
+	free(bf);
+}
+
+static int calls = 0;
+static int active = 0;
+static bool concurrent = false;
+
+static char *counting_demangle(const char *symbol, RzDemanglerFlag flags) {
+	if (active++) {
+		concurrent = true;
+	}
+	calls++;
+	rz_th_yield();
+	char *ret = rz_str_startswith(symbol, "_Znull") ? NULL : rz_str_newf("demangled(%s)", symbol);
+	active--;
+	return ret;
+}
+
+static RzDemanglerPlugin counting_plugin = {
+	.language = "c++",
+	.author = "test",
+	.license = "LGPL3",
+	.demangle = counting_demangle,
+};
+
+bool test_bin_demangle_cache_plugin(void) {
+	RzBin *bin = rz_bin_new();
+	mu_assert_true(rz_demangler_plugin_add(bin->demangler, &counting_plugin), "plugin added");
+	mu_assert_false(rz_demangler_plugin_is_static(&counting_plugin), "added plugin is not static");
+	mu_assert_true(rz_demangler_plugin_is_static(rz_demangler_plugin_get(bin->demangler, "rust")), "static plugin");
+
+	RzBinObject *o = object_new();
+	char name[32];
+	for (size_t i = 0; i < N_NAMES; i++) {
+		// every fifth name has no demangled name
+		rz_strf(name, "%s%" PFMTSZu, i % 5 ? "_Zname" : "_Znull", i);
+		object_add_name(o, name);
+	}
+	calls = 0;
+	demangle_object(bin, o);
+	mu_assert_false(concurrent, "added plugin run on a single thread");
+	mu_assert_eq(calls, N_NAMES, "each name demangled once, even without a result");
+
+	void **it;
+	rz_pvector_foreach (o->symbols, it) {
+		RzBinSymbol *sym = *it;
+		if (rz_str_startswith(sym->name, "_Znull")) {
+			mu_assert_null(sym->dname, "no demangled symbol");
+			continue;
+		}
+		char *expected = rz_str_newf("demangled(%s)", sym->name);
+		mu_assert_nullable_streq(sym->dname, expected, "demangled symbol");
+		free(expected);
+	}
+	rz_pvector_foreach (o->imports, it) {
+		RzBinImport *imp = *it;
+		if (rz_str_startswith(imp->name, "_Znull")) {
+			mu_assert_null(imp->dname, "no demangled import");
+			continue;
+		}
+		char *expected = rz_str_newf("demangled(%s)", imp->name);
+		mu_assert_nullable_streq(imp->dname, expected, "demangled import");
+		free(expected);
+	}
+
+	object_free(o);
+	rz_bin_free(bin);
+	mu_end;
+}
+
+bool test_bin_demangle_cache_parallel(void) {
+	RzBin *bin = rz_bin_new();
+	RzBinObject *o = object_new();
+	char name[32];
+	for (size_t i = 0; i < N_NAMES; i++) {
+		if (i % 7) {
+			rz_strf(name, "_Z5f%04" PFMTSZu "v", i);
+		} else {
+			// wrong length, not a valid mangled name
+			rz_strf(name, "_Z9f%04" PFMTSZu "v", i);
+		}
+		object_add_name(o, name);
+	}
+	// the same names again, already in the cache
+	for (size_t i = 0; i < N_NAMES; i += 3) {
+		rz_strf(name, "_Z5f%04" PFMTSZu "v", i);
+		object_add_name(o, name);
+	}
+	demangle_object(bin, o);
+
+	void **it;
+	rz_pvector_foreach (o->symbols, it) {
+		RzBinSymbol *sym = *it;
+		char *expected = rz_demangler_cxx(sym->name, RZ_DEMANGLER_FLAG_ENABLE_ALL);
+		mu_assert_nullable_streq(sym->dname, expected, "same symbol as the serial demangling");
+		free(expected);
+	}
+	rz_pvector_foreach (o->imports, it) {
+		RzBinImport *imp = *it;
+		char *expected = rz_demangler_cxx(imp->name, RZ_DEMANGLER_FLAG_ENABLE_ALL);
+		mu_assert_nullable_streq(imp->dname, expected, "same import as the serial demangling");
+		free(expected);
+	}
+	RzBinSymbol *sym = rz_pvector_at(o->symbols, 1);
+	mu_assert_nullable_streq(sym->dname, "f0001()", "demangled symbol");
+
+	object_free(o);
+	rz_bin_free(bin);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_bin_demangle_cache_plugin);
+	mu_run_test(test_bin_demangle_cache_parallel);
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
@@ -362,6 +362,90 @@ bool test_line_undo(void) {
 	mu_end;
 }
 
+static char *stream_output(RzCons *cons, const char *grep, int n_lines, const char *tail, size_t *max_buffer_len) {
+	char path[] = "/tmp/rz_cons_streamXXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		return NULL;
+	}
+	int fdout = cons->fdout;
+	cons->fdout = fd;
+	bool parsed = grep && rz_cons_grep_stream_begin(grep);
+	*max_buffer_len = 0;
+	for (int i = 0; i < n_lines; i++) {
+		rz_cons_printf("0x%08x line %s\n", i, i % 3 ? "bar" : "foo");
+		*max_buffer_len = RZ_MAX(*max_buffer_len, rz_cons_get_buffer_len());
+		rz_cons_stream_flush();
+	}
+	if (tail) {
+		rz_cons_print(tail);
+	} else {
+		// the command flushes its output before ending
+		rz_cons_flush();
+	}
+	rz_cons_grep_stream_end(parsed);
+	if (grep && !parsed) {
+		rz_cons_grep_process(strdup(grep));
+	}
+	rz_cons_flush();
+	cons->fdout = fdout;
+	close(fd);
+	char *out = rz_file_slurp(path, NULL);
+	unlink(path);
+	return out;
+}
+
+bool test_cons_stream(void) {
+	RzCons *cons = rz_cons_new();
+	rz_cons_set_interactive(false);
+	cons->stream = true;
+	size_t max_len;
+
+	char *out = stream_output(cons, NULL, 100000, "incomplete", &max_len);
+	mu_assert_notnull(out, "output");
+	mu_assert_eq(strlen(out), 100000 * 20 + strlen("incomplete"), "whole output");
+	mu_assert_true(rz_str_startswith(out, "0x00000000 line foo\n0x00000001 line bar\n"), "begin of the output");
+	mu_assert_true(rz_str_endswith(out, "0x0001869f line foo\nincomplete"), "end of the output");
+	mu_assert_true(max_len < 128 * 1024, "bounded buffer");
+	free(out);
+
+	out = stream_output(cons, "foo", 100000, "incomplete", &max_len);
+	mu_assert_notnull(out, "output");
+	mu_assert_eq(strlen(out), 33334 * 20, "grepped output");
+	mu_assert_true(rz_str_endswith(out, "0x0001869f line foo\n"), "end of the grepped output");
+	mu_assert_true(max_len < 128 * 1024, "bounded buffer");
+	free(out);
+
+	out = stream_output(cons, "bar?", 100000, "incomplete", &max_len);
+	mu_assert_streq(out, "66666\n", "counter");
+	mu_assert_true(max_len < 128 * 1024, "bounded buffer");
+	free(out);
+
+	// nothing left in the buffer when the command ends
+	out = stream_output(cons, "bar?", 100000, NULL, &max_len);
+	mu_assert_streq(out, "66666\n", "counter after a flushed line");
+	free(out);
+
+	out = stream_output(cons, "foo", 100000, NULL, &max_len);
+	mu_assert_notnull(out, "output");
+	mu_assert_eq(strlen(out), 33334 * 20, "grepped output after a flushed line");
+	free(out);
+
+	out = stream_output(cons, "foo[0]:2", 1000, "incomplete", &max_len);
+	mu_assert_streq(out, "0x00000006\n", "line and column");
+	free(out);
+
+	// sorting needs the whole output
+	out = stream_output(cons, "$!0foo", 100000, "incomplete", &max_len);
+	mu_assert_notnull(out, "output");
+	mu_assert_true(rz_str_startswith(out, "0x0001869f line foo\n0x0001869c line foo\n"), "sorted output");
+	mu_assert_true(max_len > 1000000, "buffered output");
+	free(out);
+
+	rz_cons_free();
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_rz_cons);
 	mu_run_test(test_cons_to_html);
@@ -370,6 +454,7 @@ bool all_tests() {
 	mu_run_test(test_line_multicompletion);
 	mu_run_test(test_line_kill_word);
 	mu_run_test(test_line_undo);
+	mu_run_test(test_cons_stream);
 	return tests_passed != tests_run;
 }
 
@@ -87,6 +87,31 @@ static RzPVector *maps(RzBinFile *bf) {
 	return ret;
 }
 
+static int fields_count = 0;
+
+static RzPVector *fields(RzBinFile *bf) {
+	fields_count++;
+	RzPVector *ret = rz_pvector_new((RzPVectorFree)rz_bin_field_free);
+	rz_pvector_push(ret, rz_bin_field_new(0, 0, 2, "magic", NULL, "x", false));
+	return ret;
+}
+
+static int strings_count = 0;
+
+static RzPVector *strings(RzBinFile *bf) {
+	strings_count++;
+	RzPVector *ret = rz_pvector_new(rz_bin_string_free);
+	RzBinString *str = RZ_NEW0(RzBinString);
+	str->string = strdup("BB");
+	str->vaddr = 0x100;
+	str->paddr = 2;
+	str->size = 2;
+	str->length = 2;
+	str->type = RZ_STRING_ENC_8BIT;
+	rz_pvector_push(ret, str);
+	return ret;
+}
+
 RzBinPlugin mock_plugin = {
 	.name = "mock",
 	.desc = "Testing Plugin",
@@ -95,6 +120,8 @@ RzBinPlugin mock_plugin = {
 	.check_buffer = check_buffer,
 	.virtual_files = &virtual_files,
 	.maps = maps,
+	.fields = fields,
+	.strings = strings,
 	.info = info,
 };
 
@@ -223,6 +250,47 @@ bool test_map(void) {
 	mu_end;
 }
 
+bool test_lazy(void) {
+	RzCore *core = rz_core_new();
+	rz_bin_plugin_add(core->bin, &mock_plugin);
+	rz_config_set_b(core->config, "bin.lazy", true);
+	RzCoreFile *f = rz_core_file_open(core, "hex://424213374242", RZ_PERM_R, 0);
+	mu_assert_notnull(f, "load core file");
+	fields_count = 0;
+	strings_count = 0;
+	bool r = rz_core_bin_load(core, NULL, 0);
+	mu_assert_true(r, "core bin load");
+	RzBinFile *bf = rz_bin_file_find_by_fd(core->bin, f->fd);
+	mu_assert_notnull(bf, "binfile");
+	mu_assert_eq(fields_count, 0, "fields not loaded");
+	mu_assert_null(bf->o->fields, "fields not loaded");
+	mu_assert_true(rz_config_get_b(core->config, "bin.strings"), "bin.strings");
+	mu_assert_eq(strings_count, 0, "strings not loaded");
+	mu_assert_null(bf->o->strings, "strings not loaded");
+	mu_assert_null(rz_flag_get(core->flags, "str.BB"), "strings not flagged");
+
+	const RzPVector *v = rz_bin_object_get_fields(bf->o);
+	mu_assert_notnull(v, "fields");
+	mu_assert_eq(rz_pvector_len(v), 1, "fields count");
+	mu_assert_eq(fields_count, 1, "fields loaded");
+	mu_assert_ptreq(rz_bin_object_get_fields(bf->o), v, "fields loaded once");
+	mu_assert_eq(fields_count, 1, "fields loaded once");
+
+	const RzPVector *strs = rz_bin_object_get_strings(bf->o);
+	mu_assert_notnull(strs, "strings");
+	mu_assert_eq(rz_pvector_len(strs), 1, "strings count");
+	mu_assert_eq(strings_count, 1, "strings loaded");
+	RzBinString *str = rz_bin_object_get_string_at(bf->o, 0x100, true);
+	mu_assert_notnull(str, "string at");
+	mu_assert_streq(str->string, "BB", "string");
+	mu_assert_eq(strings_count, 1, "strings loaded once");
+	mu_assert_true(rz_core_bin_apply_strings(core, bf), "apply strings");
+	mu_assert_notnull(rz_flag_get(core->flags, "str.BB"), "strings flagged on request");
+
+	rz_core_free(core);
+	mu_end;
+}
+
 /// test behavior after closing a single RzCoreFile
 bool test_cfile_close(void) {
 	RzCore *core = rz_core_new();
@@ -604,6 +672,7 @@ bool test_cfile_close_manual_cfile_map_multiple(void) {
 
 bool all_tests() {
 	mu_run_test(test_map);
+	mu_run_test(test_lazy);
 	mu_run_test(test_cfile_close);
 	mu_run_test(test_cfile_close_multiple);
 	mu_run_test(test_cfile_close_manual_maps);
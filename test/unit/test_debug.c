@@ -760,6 +760,83 @@ static bool test_debug_hw_watch(void) {
 	mu_end;
 }
 
+/**
+ * \brief Basic block coverage test
+ * Trace some blocks, only some of which are reached, and check that each trap
+ * stops the inferior only once and that the code is left untouched.
+ */
+static bool test_debug_coverage(void) {
+	RzDebug *dbg;
+	RzIO *io;
+	SETUP_DEBUG(&dbg_mock_plugin, &bp_mock_plugin, &bp_ctx);
+
+	rz_io_open_at(io, "malloc://0x1000", RZ_PERM_RW, 0644, 0x0, NULL);
+	rz_io_write_at(io, 0x50, (const ut8 *)"PRNT", 4);
+	rz_io_write_at(io, 0x80, (const ut8 *)"PRNT", 4);
+	ut8 code[0x100];
+	rz_io_read_at(io, 0, code, sizeof(code));
+
+	int r = rz_debug_attach(dbg, 42);
+	mu_assert_false(dbg_mock_failed, "global failure");
+	mu_assert_true(r, "attach");
+
+	mu_assert_true(rz_debug_coverage_add(dbg, 0x80, 0x10), "add block");
+	mu_assert_true(rz_debug_coverage_add(dbg, 0x40, 0x10), "add block");
+	mu_assert_true(rz_debug_coverage_add(dbg, 0x50, 0x30), "add block");
+	mu_assert_true(rz_debug_coverage_add(dbg, 0x52, 0x2e), "add block with overlapping trap");
+	mu_assert_true(rz_debug_coverage_add(dbg, 0x800, 0x10), "add unreachable block");
+	ut64 blocks, covered;
+	mu_assert_true(rz_debug_coverage_stats(dbg, &blocks, &covered), "stats");
+	mu_assert_eq(blocks, 4, "blocks with overlapping traps are dropped");
+	mu_assert_eq(covered, 0, "nothing covered");
+
+	// runs until the fuel of the mock is over, 0x400 bytes after the last trap
+	r = rz_debug_continue(dbg);
+	mu_assert_false(dbg_mock_failed, "global failure");
+	mu_assert_true(r, "continue");
+	rz_debug_reg_sync(dbg, RZ_REG_TYPE_ANY, false);
+	ut64 pc = rz_reg_get_value_by_role(dbg->reg, RZ_REG_NAME_PC);
+	mu_assert_eq(pc, 0x480, "traps do not stop the inferior");
+
+	DebugMockCtx *ctx = dbg->plugin_data;
+	mu_assert_streq(rz_strbuf_get(&ctx->output), "PRNT with next pc = 0x54\nPRNT with next pc = 0x84\n",
+		"blocks executed once");
+	ut8 data[0x100];
+	rz_io_read_at(io, 0, data, sizeof(data));
+	mu_assert_memeq(data, code, sizeof(data), "restored original bytes");
+	rz_io_read_at(io, 0x800, data, 4);
+	mu_assert_memeq(data, (const ut8 *)"\x00\x00\x00\x00", 4, "removed unreached trap");
+
+	rz_debug_coverage_stats(dbg, &blocks, &covered);
+	mu_assert_eq(covered, 3, "covered blocks");
+	RzPVector *hits = rz_debug_coverage_covered(dbg);
+	mu_assert_notnull(hits, "covered blocks");
+	mu_assert_eq(rz_pvector_len(hits), 3, "covered blocks");
+	RzDebugCoverageBlock *b = rz_pvector_at(hits, 0);
+	mu_assert_eq(b->addr, 0x40, "covered block");
+	b = rz_pvector_at(hits, 1);
+	mu_assert_eq(b->addr, 0x50, "covered block");
+	mu_assert_eq(b->size, 0x30, "covered block size");
+	b = rz_pvector_at(hits, 2);
+	mu_assert_eq(b->addr, 0x80, "covered block");
+	rz_pvector_free(hits);
+
+	// blocks added later keep the state of the old ones
+	mu_assert_true(rz_debug_coverage_add(dbg, 0x600, 0x10), "add block");
+	r = rz_debug_continue(dbg);
+	mu_assert_false(dbg_mock_failed, "global failure");
+	mu_assert_true(r, "continue");
+	rz_debug_coverage_stats(dbg, &blocks, &covered);
+	mu_assert_eq(blocks, 5, "blocks");
+	mu_assert_eq(covered, 5, "covered blocks");
+
+	rz_debug_coverage_reset(dbg);
+	mu_assert_null(dbg->coverage, "reset");
+	rz_debug_free(dbg);
+	rz_io_free(io);
+	mu_end;
+}
+
 int all_tests() {
 	rz_cons_new(); // there is some windows-specific code in debug that accesses the cons singleton
 	mu_run_test(test_rz_debug_use);
@@ -768,6 +845,7 @@ int all_tests() {
 	mu_run_test(test_debug_sw_bp_multibits);
 	mu_run_test(test_debug_hw_bp);
 	mu_run_test(test_debug_hw_watch);
+	mu_run_test(test_debug_coverage);
 	rz_cons_free();
 	return tests_passed != tests_run;
 }
@@ -4,6 +4,7 @@
 #include <rz_debug.h>
 #include <rz_util.h>
 #include <rz_reg.h>
+#include <rz_io.h>
 #include "minunit.h"
 
 Sdb *ref_db() {
@@ -74,9 +75,10 @@ RzDebugSession *ref_session() {
 	snap->perm = 7;
 	snap->user = 0;
 	snap->shared = true;
-	snap->data = malloc(snap->size);
-	memset(snap->data, 0xf0, snap->size);
 	rz_list_append(checkpoint.snaps, snap);
+	ut8 data[0x100];
+	memset(data, 0xf0, sizeof(data));
+	rz_debug_checkpoint_add_memory(s, &checkpoint, snap->addr, data, sizeof(data));
 	rz_vector_push(s->checkpoints, &checkpoint);
 
 	return s;
@@ -156,7 +158,31 @@ static bool snap_eq(RzDebugSnap *actual, RzDebugSnap *expected) {
 	mu_assert_eq(actual->perm, expected->perm, "snap perm");
 	mu_assert_eq(actual->user, expected->user, "snap user");
 	mu_assert_eq(actual->shared, expected->shared, "snap shared");
-	mu_assert_memeq(actual->data, expected->data, expected->size, "snap data");
+	return true;
+}
+
+static bool checkpoint_eq(RzDebugCheckpoint *actual, RzDebugCheckpoint *expected) {
+	size_t i;
+	mu_assert_eq(actual->cnum, expected->cnum, "checkpoint cnum");
+	for (i = 0; i < RZ_REG_TYPE_LAST; i++) {
+		arena_eq(actual->arena[i], expected->arena[i]);
+	}
+	RzListIter *actual_snaps_iter = rz_list_iterator(actual->snaps);
+	RzListIter *expected_snaps_iter = rz_list_iterator(expected->snaps);
+	while (actual_snaps_iter && expected_snaps_iter) {
+		RzDebugSnap *actual_snap = rz_list_iter_get(actual_snaps_iter);
+		RzDebugSnap *expected_snap = rz_list_iter_get(expected_snaps_iter);
+		snap_eq(actual_snap, expected_snap);
+
+		ut8 *actual_data = malloc(expected_snap->size);
+		ut8 *expected_data = malloc(expected_snap->size);
+		mu_assert("snap data", rz_debug_checkpoint_read(actual, actual_snap->addr, actual_data, actual_snap->size));
+		mu_assert("snap data", rz_debug_checkpoint_read(expected, expected_snap->addr, expected_data, expected_snap->size));
+		mu_assert_memeq(actual_data, expected_data, expected_snap->size, "snap data");
+		free(actual_data);
+		free(expected_data);
+	}
+	mu_assert("snaps length", !actual_snaps_iter && !expected_snaps_iter);
 	return true;
 }
 
@@ -172,23 +198,11 @@ static bool test_session_load(void) {
 	// Memory
 	ht_up_foreach(s->memory, compare_memory_cb, ref->memory);
 	// Checkpoints
-	size_t i, chkpt_idx;
-	RzDebugCheckpoint *chkpt, *ref_chkpt;
+	size_t chkpt_idx;
+	RzDebugCheckpoint *chkpt;
 	mu_assert_eq(s->checkpoints->len, ref->checkpoints->len, "checkpoints length");
 	rz_vector_enumerate (s->checkpoints, chkpt, chkpt_idx) {
-		ref_chkpt = rz_vector_index_ptr(ref->checkpoints, chkpt_idx);
-		// Registers
-		for (i = 0; i < RZ_REG_TYPE_LAST; i++) {
-			arena_eq(chkpt->arena[i], ref_chkpt->arena[i]);
-		}
-		// Snaps
-		RzListIter *actual_snaps_iter = rz_list_iterator(chkpt->snaps);
-		RzListIter *expected_snaps_iter = rz_list_iterator(ref_chkpt->snaps);
-		while (actual_snaps_iter && expected_snaps_iter) {
-			RzDebugSnap *actual_snap = rz_list_iter_get(actual_snaps_iter);
-			RzDebugSnap *expected_snap = rz_list_iter_get(expected_snaps_iter);
-			snap_eq(actual_snap, expected_snap);
-		}
+		checkpoint_eq(chkpt, rz_vector_index_ptr(ref->checkpoints, chkpt_idx));
 	}
 
 	sdb_free(db);
@@ -197,9 +211,159 @@ static bool test_session_load(void) {
 	mu_end;
 }
 
+static bool test_checkpoint_pages(void) {
+	RzDebugSession *s = rz_debug_session_new();
+	s->compress_pages = true;
+	ut8 *buf = malloc(4 * RZ_DEBUG_SESSION_PAGE_SIZE);
+	ut8 *out = malloc(4 * RZ_DEBUG_SESSION_PAGE_SIZE);
+	memset(buf, 0, 4 * RZ_DEBUG_SESSION_PAGE_SIZE);
+	memset(buf + RZ_DEBUG_SESSION_PAGE_SIZE, 0x41, RZ_DEBUG_SESSION_PAGE_SIZE);
+	size_t i;
+	for (i = 2 * RZ_DEBUG_SESSION_PAGE_SIZE; i < 4 * RZ_DEBUG_SESSION_PAGE_SIZE; i++) {
+		buf[i] = (i * 0x9e3779b1) >> 13;
+	}
+
+	RzDebugCheckpoint a = { 0 };
+	RzDebugCheckpoint b = { 0 };
+	mu_assert("add memory", rz_debug_checkpoint_add_memory(s, &a, 0x10000, buf, 4 * RZ_DEBUG_SESSION_PAGE_SIZE));
+	mu_assert_eq(a.pages->len, 4, "pages");
+	// pages with the same content are shared
+	buf[3 * RZ_DEBUG_SESSION_PAGE_SIZE] ^= 0xff;
+	mu_assert("add memory", rz_debug_checkpoint_add_memory(s, &b, 0x10000, buf, 4 * RZ_DEBUG_SESSION_PAGE_SIZE));
+	mu_assert_eq(s->pages->count, 5, "deduplicated pages");
+	RzDebugCheckpointPage *pa = rz_vector_index_ptr(a.pages, 1);
+	RzDebugCheckpointPage *pb = rz_vector_index_ptr(b.pages, 1);
+	mu_assert_ptreq(pa->page, pb->page, "shared page");
+	mu_assert_eq(pa->page->refs, 2, "shared page refs");
+	mu_assert("compressed", pa->page->compressed && pa->page->size < RZ_DEBUG_SESSION_PAGE_SIZE);
+
+	mu_assert("read", rz_debug_checkpoint_read(&b, 0x10000, out, 4 * RZ_DEBUG_SESSION_PAGE_SIZE));
+	mu_assert_memeq(out, buf, 4 * RZ_DEBUG_SESSION_PAGE_SIZE, "content");
+	mu_assert("read unaligned", rz_debug_checkpoint_read(&b, 0x10ff0, out, 0x20));
+	mu_assert_memeq(out, buf + 0xff0, 0x20, "unaligned content");
+	mu_assert("read outside", !rz_debug_checkpoint_read(&b, 0xfff0, out, 0x20));
+	mu_assert_memeq(out + 0x10, buf, 0x10, "partial content");
+
+	rz_vector_push(s->checkpoints, &a);
+	rz_vector_push(s->checkpoints, &b);
+	rz_debug_session_free(s);
+	free(buf);
+	free(out);
+	mu_end;
+}
+
+static bool test_session_binary(void) {
+	RzDebugSession *ref = ref_session();
+	RzDebugCheckpoint *ref_chkpt = rz_vector_index_ptr(ref->checkpoints, 0);
+	ref_chkpt->cnum = 0;
+	RzDebugCheckpoint copy = { 0 };
+	size_t i;
+	for (i = 0; i < RZ_REG_TYPE_LAST; i++) {
+		copy.arena[i] = rz_reg_arena_new(0x10);
+	}
+	copy.cnum = 1;
+	copy.snaps = rz_list_newf((RzListFree)rz_debug_snap_free);
+	ut8 data[0x100];
+	mu_assert("read", rz_debug_checkpoint_read(ref_chkpt, 0x7fffffde000, data, sizeof(data)));
+	rz_debug_checkpoint_add_memory(ref, &copy, 0x7fffffde000, data, sizeof(data));
+	rz_vector_push(ref->checkpoints, &copy);
+
+	RzBuffer *b = rz_buf_new_empty(0);
+	mu_assert("write", rz_debug_session_write(ref, b));
+	rz_buf_seek(b, 0, RZ_BUF_SET);
+	RzDebugSession *s = rz_debug_session_new();
+	mu_assert("read", rz_debug_session_read(s, b));
+
+	mu_assert_eq(s->maxcnum, ref->maxcnum, "maxcnum");
+	ht_up_foreach(s->registers, compare_registers_cb, ref->registers);
+	ht_up_foreach(s->memory, compare_memory_cb, ref->memory);
+	mu_assert_eq(s->checkpoints->len, 2, "checkpoints length");
+	for (i = 0; i < 2; i++) {
+		checkpoint_eq(rz_vector_index_ptr(s->checkpoints, i), rz_vector_index_ptr(ref->checkpoints, i));
+	}
+	// the page shared by the two checkpoints is stored once
+	mu_assert_eq(s->pages->count, 1, "pages");
+
+	// truncated input
+	ut64 size = rz_buf_size(b);
+	ut8 *bytes = malloc(size);
+	rz_buf_read_at(b, 0, bytes, size);
+	RzBuffer *t = rz_buf_new_with_bytes(bytes, size - 1);
+	RzDebugSession *bad = rz_debug_session_new();
+	mu_assert("truncated", !rz_debug_session_read(bad, t));
+
+	rz_debug_session_free(bad);
+	rz_buf_free(t);
+	free(bytes);
+	rz_buf_free(b);
+	rz_debug_session_free(s);
+	rz_debug_session_free(ref);
+	mu_end;
+}
+
+static bool check_memory(RzIO *io, const ut8 *expected, ut64 size) {
+	ut8 *buf = malloc(size);
+	mu_assert_notnull(buf, "buffer");
+	mu_assert_true(rz_io_read_at(io, 0x10000, buf, size), "read memory");
+	mu_assert_memeq(buf, expected, size, "memory");
+	free(buf);
+	return true;
+}
+
+static bool test_session_restore_external_write(void) {
+	RzBreakpointContext bp_ctx = { 0 };
+	RzDebug *dbg = rz_debug_new(&bp_ctx);
+	mu_assert_notnull(dbg, "debug");
+	RzIO *io = rz_io_new();
+	io->va = true;
+	rz_io_bind(io, &dbg->iob);
+	mu_assert_notnull(rz_io_open_at(io, "malloc://0x3000", RZ_PERM_RW, 0644, 0x10000, NULL), "open");
+	ut8 mem[3 * RZ_DEBUG_SESSION_PAGE_SIZE];
+	size_t i;
+	for (i = 0; i < sizeof(mem); i++) {
+		mem[i] = i * 7;
+	}
+	rz_io_write_at(io, 0x10000, mem, sizeof(mem));
+
+	dbg->session = rz_debug_session_new();
+	RzDebugSession *s = dbg->session;
+	RzDebugCheckpoint checkpoint = { 0 };
+	for (i = 0; i < RZ_REG_TYPE_LAST; i++) {
+		checkpoint.arena[i] = rz_reg_arena_new(dbg->reg->regset[i].arena->size);
+	}
+	checkpoint.snaps = rz_list_newf((RzListFree)rz_debug_snap_free);
+	mu_assert_true(rz_debug_checkpoint_add_memory(s, &checkpoint, 0x10000, mem, sizeof(mem)), "add memory");
+	rz_vector_push(s->checkpoints, &checkpoint);
+
+	// one step writing the first page
+	s->cnum++;
+	s->maxcnum++;
+	rz_debug_session_add_mem_change(s, 0x10010, 0x77);
+	ut8 b = 0x77;
+	rz_io_write_at(io, 0x10010, &b, 1);
+
+	// written behind the session, in the changed page and in an unchanged one
+	rz_io_write_at(io, 0x10020, (const ut8 *)"XX", 2);
+	rz_io_write_at(io, 0x11100, (const ut8 *)"YY", 2);
+	mu_assert_true(rz_debug_goto_cnum(dbg, 0), "step back");
+	mu_assert_true(check_memory(io, mem, sizeof(mem)), "memory at cnum 0");
+
+	rz_io_write_at(io, 0x12000, (const ut8 *)"ZZ", 2);
+	mu_assert_true(rz_debug_goto_cnum(dbg, 1), "step forward");
+	mem[0x10] = 0x77;
+	mu_assert_true(check_memory(io, mem, sizeof(mem)), "memory at cnum 1");
+
+	rz_debug_free(dbg);
+	rz_io_free(io);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_session_save);
 	mu_run_test(test_session_load);
+	mu_run_test(test_checkpoint_pages);
+	mu_run_test(test_session_binary);
+	mu_run_test(test_session_restore_external_write);
 	return tests_passed != tests_run;
 }
 
@@ -4,6 +4,7 @@
 
 #include <math.h>
 #include <rz_diff.h>
+#include <rz_vector.h>
 #include "minunit.h"
 
 #define R(a, b, c, d) \
@@ -257,10 +258,80 @@ bool test_rz_diff_unified_bytes(void) {
 	mu_end;
 }
 
+static bool collect_bytes_op(const RzDiffBytesOp *op, void *user) {
+	rz_vector_push((RzVector *)user, (void *)op);
+	return true;
+}
+
+bool test_rz_diff_bytes_stream(void) {
+	const ut64 size = 0x10000;
+	ut8 *a = malloc(size);
+	ut8 *b = malloc(size + 0x100);
+	mu_assert_true(a && b, "buffers");
+	ut32 seed = 0x1337;
+	for (ut64 i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		a[i] = seed >> 16;
+	}
+	// b = a with 10 bytes changed at 0x1000, 0x100 bytes inserted at 0x5000 and 0x80 bytes removed at 0xa000
+	ut64 bs = 0;
+	memcpy(b, a, 0x5000);
+	memset(b + 0x1000, 0xff, 10);
+	bs += 0x5000;
+	memset(b + bs, 0x41, 0x100);
+	bs += 0x100;
+	memcpy(b + bs, a + 0x5000, 0xa000 - 0x5000);
+	bs += 0xa000 - 0x5000;
+	memcpy(b + bs, a + 0xa080, size - 0xa080);
+	bs += size - 0xa080;
+
+	RzVector ops;
+	rz_vector_init(&ops, sizeof(RzDiffBytesOp), NULL, NULL);
+	mu_assert_true(rz_diff_bytes_stream(a, size, b, bs, 0, collect_bytes_op, &ops), "stream diff");
+
+	ut64 pa = 0, pb = 0, changed = 0;
+	RzDiffBytesOp *op;
+	rz_vector_foreach (&ops, op) {
+		mu_assert_eq(op->a_beg, pa, "ops are contiguous in a");
+		mu_assert_eq(op->b_beg, pb, "ops are contiguous in b");
+		if (op->type == RZ_DIFF_OP_EQUAL) {
+			mu_assert_eq(op->a_end - op->a_beg, op->b_end - op->b_beg, "equal op sizes");
+			mu_assert_memeq(a + op->a_beg, b + op->b_beg, op->a_end - op->a_beg, "equal op content");
+		} else {
+			changed += (op->a_end - op->a_beg) + (op->b_end - op->b_beg);
+		}
+		pa = op->a_end;
+		pb = op->b_end;
+	}
+	mu_assert_eq(pa, size, "ops cover a");
+	mu_assert_eq(pb, bs, "ops cover b");
+	mu_assert_eq(changed, 10 * 2 + 0x100 + 0x80, "only the changed bytes are reported");
+
+	op = rz_vector_index_ptr(&ops, 1);
+	mu_assert_eq(op->type, RZ_DIFF_OP_REPLACE, "first change");
+	mu_assert_eq(op->a_beg, 0x1000, "first change offset");
+
+	// identical and empty buffers
+	rz_vector_clear(&ops);
+	mu_assert_true(rz_diff_bytes_stream(a, size, a, size, 0, collect_bytes_op, &ops), "same buffers");
+	mu_assert_eq(rz_vector_len(&ops), 1, "single equal op");
+	rz_vector_clear(&ops);
+	mu_assert_true(rz_diff_bytes_stream(a, 0, b, 0x20, 0, collect_bytes_op, &ops), "empty a");
+	mu_assert_eq(rz_vector_len(&ops), 1, "single insert op");
+	op = rz_vector_index_ptr(&ops, 0);
+	mu_assert_eq(op->type, RZ_DIFF_OP_INSERT, "insert op");
+
+	rz_vector_fini(&ops);
+	free(a);
+	free(b);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_rz_diff_distances);
 	mu_run_test(test_rz_diff_unified_lines);
 	mu_run_test(test_rz_diff_unified_bytes);
+	mu_run_test(test_rz_diff_bytes_stream);
 	return tests_passed != tests_run;
 }
 
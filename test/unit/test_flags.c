@@ -169,11 +169,104 @@ bool test_rz_flag_set_next() {
 	mu_end;
 }
 
+static void bulk_push(RzVector *items, const char *name, const char *realname, ut64 offset, ut64 size) {
+	RzFlagBulkItem *item = rz_vector_push(items, NULL);
+	item->name = rz_str_dup(name);
+	item->realname = rz_str_dup(realname);
+	item->demangled = false;
+	item->offset = offset;
+	item->size = size;
+	item->space = NULL;
+}
+
+static void bulk_item_fini(void *e, void *user) {
+	RzFlagBulkItem *item = e;
+	free(item->name);
+	free(item->realname);
+}
+
+bool test_rz_flag_set_bulk() {
+	RzFlag *flag = rz_flag_new();
+	RzFlagItem *old = rz_flag_set(flag, "old", 0x200, 4);
+	RzFlagItem *moved = rz_flag_set(flag, "moved", 0x300, 4);
+
+	RzVector items;
+	rz_vector_init(&items, sizeof(RzFlagBulkItem), bulk_item_fini, NULL);
+	bulk_push(&items, "sym.c", "c", 0x300, 1);
+	bulk_push(&items, "sym.a", "a", 0x100, 2);
+	bulk_push(&items, "sym.b", NULL, 0x200, 3);
+	bulk_push(&items, "sym.a2", "a2", 0x100, 0);
+	bulk_push(&items, "moved", NULL, 0x400, 8);
+	bulk_push(&items, "sym.dup", NULL, 0x500, 0);
+	bulk_push(&items, "sym.dup", "dup", 0x600, 5);
+	bulk_push(&items, "sym with spaces", NULL, 0x700, 0);
+	mu_assert_true(rz_flag_set_bulk(flag, &items), "bulk set");
+	rz_vector_fini(&items);
+
+	mu_assert_eq(rz_flag_count(flag, NULL), 8, "flags count");
+	RzFlagItem *fi = rz_flag_get(flag, "sym.a");
+	mu_assert_notnull(fi, "sym.a");
+	mu_assert_eq(fi->offset, 0x100, "sym.a offset");
+	mu_assert_eq(fi->size, 2, "sym.a size");
+	mu_assert_streq(fi->realname, "a", "sym.a realname");
+	fi = rz_flag_get(flag, "sym.b");
+	mu_assert_notnull(fi, "sym.b");
+	mu_assert_ptreq(fi->realname, fi->name, "realname shares the name");
+	mu_assert_notnull(rz_flag_get(flag, "sym_with_spaces"), "name is filtered");
+
+	const RzList *list = rz_flag_get_list(flag, 0x100);
+	mu_assert_eq(rz_list_length(list), 2, "flags at 0x100");
+	mu_assert_streq(((RzFlagItem *)rz_list_get_n(list, 0))->name, "sym.a", "input order at the same offset");
+	mu_assert_streq(((RzFlagItem *)rz_list_get_n(list, 1))->name, "sym.a2", "input order at the same offset");
+	list = rz_flag_get_list(flag, 0x200);
+	mu_assert_eq(rz_list_length(list), 2, "flags at 0x200");
+	mu_assert_ptreq(rz_list_first(list), old, "existing flag comes first");
+	mu_assert_null(rz_flag_get_list(flag, 0x500), "duplicated name moved");
+	fi = rz_flag_get_i(flag, 0x600);
+	mu_assert_notnull(fi, "sym.dup at 0x600");
+	mu_assert_streq(fi->name, "sym.dup", "sym.dup at 0x600");
+	mu_assert_streq(fi->realname, "dup", "sym.dup realname");
+	mu_assert_eq(fi->size, 5, "sym.dup size");
+
+	mu_assert_ptreq(rz_flag_get(flag, "moved"), moved, "existing flag is kept");
+	mu_assert_eq(moved->offset, 0x400, "existing flag is moved");
+	mu_assert_ptreq(rz_flag_get_i(flag, 0x400), moved, "existing flag is moved");
+	list = rz_flag_get_list(flag, 0x300);
+	mu_assert_eq(rz_list_length(list), 1, "flags at 0x300");
+	mu_assert_streq(((RzFlagItem *)rz_list_first(list))->name, "sym.c", "sym.c");
+
+	RzList *all = rz_flag_all_list(flag, false);
+	ut64 prev = 0;
+	RzListIter *it;
+	rz_list_foreach (all, it, fi) {
+		mu_assert_true(fi->offset >= prev, "flags sorted by offset");
+		prev = fi->offset;
+	}
+	rz_list_free(all);
+
+	// unset items are reused
+	fi = rz_flag_get(flag, "sym.c");
+	rz_flag_unset(flag, fi);
+	mu_assert_null(rz_flag_get_i(flag, 0x300), "sym.c unset");
+	RzFlagItem *reused = rz_flag_set(flag, "new", 0x800, 0);
+	mu_assert_ptreq(reused, fi, "item reused");
+	mu_assert_streq(reused->name, "new", "reused name");
+	mu_assert_null(reused->comment, "reused item is clean");
+
+	rz_flag_unset_all(flag);
+	mu_assert_eq(rz_flag_count(flag, NULL), 0, "no flags");
+	mu_assert_notnull(rz_flag_set(flag, "again", 0x100, 0), "set after unset all");
+
+	rz_flag_free(flag);
+	mu_end;
+}
+
 int all_tests(void) {
 	mu_run_test(test_rz_flag_get_set);
 	mu_run_test(test_rz_flag_by_spaces);
 	mu_run_test(test_rz_flag_get_at);
 	mu_run_test(test_rz_flag_set_next);
+	mu_run_test(test_rz_flag_set_bulk);
 	return tests_passed != tests_run;
 }
 
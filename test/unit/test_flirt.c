@@ -48,6 +48,38 @@ test_flirt_pat_def(parse_multiline, 5,
 	"31C04885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C777 13 9867 0033 :0000 Curl_memrchr \n"
 	"---\n");
 
+static const char *index_match_name(const RzFlirtIndex *index, const char *hex) {
+	ut8 buf[RZ_FLIRT_MAX_PRELUDE_SIZE] = { 0 };
+	rz_hex_str2bin(hex, buf);
+	const RzFlirtModule *module = rz_sign_flirt_index_match(index, buf, sizeof(buf));
+	if (!module) {
+		return NULL;
+	}
+	RzFlirtFunction *func = rz_list_first(module->public_functions);
+	return func ? func->name : NULL;
+}
+
+bool test_flirt_index_match(void) {
+	RzBuffer *buffer = rz_buf_new_with_string(
+		"31C04885D2741F48........4839C77610EB1D0F1F4400004883E8014839C777 00 0000 0033 :0000 fixed_prefix\n"
+		"....4885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C777 00 0000 0033 :0000 variant_prefix\n"
+		"31C04885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C7.. 00 0000 0033 :0000 shadowed\n"
+		"---\n");
+	RzFlirtNode *node = rz_sign_flirt_parse_string_pattern_from_buffer(buffer, RZ_FLIRT_NODE_OPTIMIZE_NONE, NULL);
+	rz_buf_free(buffer);
+	mu_assert_notnull(node, "node is not null");
+	RzFlirtIndex *index = rz_sign_flirt_index_new(node);
+	mu_assert_notnull(index, "index is not null");
+
+	mu_assert_streq(index_match_name(index, "31C04885D2741F48AABBCCDD4839C77610EB1D0F1F4400004883E8014839C777"), "fixed_prefix", "first pattern in tree order");
+	mu_assert_streq(index_match_name(index, "FFFF4885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C777"), "variant_prefix", "variant first bytes");
+	mu_assert_streq(index_match_name(index, "31C04885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C700"), "shadowed", "keyed pattern");
+	mu_assert_null(index_match_name(index, "00004885D2741F488D4417FF4839C77610EB1D0F1F4400004883E8014839C700"), "no match");
+
+	rz_sign_flirt_index_free(index);
+	mu_end;
+}
+
 int all_tests() {
 	test_flirt_pat_run(parse_signature);
 	test_flirt_pat_run(parse_comment);
@@ -55,6 +87,7 @@ int all_tests() {
 	test_flirt_pat_run(parse_large_function);
 	test_flirt_pat_run(parse_large_offset);
 	test_flirt_pat_run(parse_multiline);
+	mu_run_test(test_flirt_index_match);
 	return tests_passed != tests_run;
 }
 
@@ -240,11 +240,55 @@ bool test_message_digest_small_block_stringified() {
 	mu_end;
 }
 
+bool test_message_digest_update_mt() {
+	char message[256];
+	char *result = NULL;
+	bool boolean;
+	RzHashSize size;
+	RzHash *rh = rz_hash_new();
+	RzHashCfg *md = rz_hash_cfg_new(rh);
+	mu_assert_notnull(md, "rz_hash_cfg_new");
+
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(hashes_to_test); ++i) {
+		hash_data_t *hd = &hashes_to_test[i];
+		snprintf(message, sizeof(message), "rz_hash_cfg_configure %s", hd->algo);
+		mu_assert_true(rz_hash_cfg_configure(md, hd->algo), message);
+	}
+
+	boolean = rz_hash_cfg_init(md);
+	mu_assert_true(boolean, "rz_hash_cfg_init");
+
+	// all the inputs are the same, split it to check that the contexts are kept between the updates
+	const ut8 *input = hashes_to_test[0].input;
+	size_t input_size = hashes_to_test[0].input_size;
+	boolean = rz_hash_cfg_update_mt(md, input, 3, 4);
+	mu_assert_true(boolean, "rz_hash_cfg_update_mt first chunk");
+	boolean = rz_hash_cfg_update_mt(md, input + 3, input_size - 3, 4);
+	mu_assert_true(boolean, "rz_hash_cfg_update_mt second chunk");
+
+	boolean = rz_hash_cfg_final(md);
+	mu_assert_true(boolean, "rz_hash_cfg_final");
+
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(hashes_to_test); ++i) {
+		hash_data_t *hd = &hashes_to_test[i];
+		result = rz_hash_cfg_get_result_string(md, hd->algo, &size, false);
+		snprintf(message, sizeof(message), "rz_hash_cfg_update_mt %s digest", hd->algo);
+		mu_assert_streq(result, hd->expected, message);
+		free(result);
+		result = NULL;
+	}
+	rz_hash_cfg_free(md);
+	rz_hash_free(rh);
+
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_message_digest_configure);
 	mu_run_test(test_message_digest_api_stringified);
 	mu_run_test(test_message_digest_hmac_stringified);
 	mu_run_test(test_message_digest_small_block_stringified);
+	mu_run_test(test_message_digest_update_mt);
 	return tests_passed != tests_run;
 }
 
@@ -3,6 +3,7 @@
 
 #include <rz_il.h>
 #include <rz_util.h>
+#include <rz_analysis.h>
 #include "minunit.h"
 
 static bool test_rzil_vm_init() {
@@ -1086,6 +1087,201 @@ static bool test_rzil_vm_op_fexcept() {
 	mu_end;
 }
 
+#include <rz_il/rz_il_opbuilder_begin.h>
+
+static RzILVM *bytecode_vm_new(ut8 *mem, size_t mem_size) {
+	RzILVM *vm = rz_il_vm_new(0x40, 16, false);
+	rz_il_vm_create_global_var(vm, "r0", rz_il_sort_pure_bv(32));
+	rz_il_vm_create_global_var(vm, "r1", rz_il_sort_pure_bv(32));
+	rz_il_vm_create_global_var(vm, "r2", rz_il_sort_pure_bv(8));
+	rz_il_vm_create_global_var(vm, "zf", rz_il_sort_pure_bool());
+	rz_il_vm_set_global_var(vm, "r0", rz_il_value_new_bitv(rz_bv_new_from_ut64(32, 0x80000005)));
+	rz_il_vm_set_global_var(vm, "r1", rz_il_value_new_bitv(rz_bv_new_from_ut64(32, 3)));
+	RzBuffer *buf = rz_buf_new_with_pointers(mem, mem_size, false);
+	rz_il_vm_add_mem(vm, 0, rz_il_mem_new(buf, 16));
+	rz_buf_free(buf);
+	return vm;
+}
+
+static char *events_str(RzILVM *vm) {
+	RzStrBuf sb;
+	rz_strbuf_init(&sb);
+	void **it;
+	rz_pvector_foreach (vm->events, it) {
+		rz_il_event_stringify(*it, &sb);
+		rz_strbuf_append(&sb, "\n");
+	}
+	return rz_strbuf_drain_nofree(&sb);
+}
+
+static bool test_rzil_vm_bytecode() {
+	ut8 mem_tree[16] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17 };
+	ut8 mem_bc[16] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17 };
+	RzILVM *vm_tree = bytecode_vm_new(mem_tree, sizeof(mem_tree));
+	RzILVM *vm_bc = bytecode_vm_new(mem_bc, sizeof(mem_bc));
+
+	RzILOpEffect *op = SEQ9(
+		SETL("t", MUL(VARG("r0"), U32(3))),
+		SETG("r1", LET("x", SDIV(VARL("t"), S32(-7)), LOGXOR(VARLP("x"), SMOD(VARL("t"), VARG("r1"))))),
+		SETG("zf", OR(IS_ZERO(VARG("r1")), SLE(VARG("r0"), S32(-1)))),
+		SETG("r2", LOGOR(APPEND(CAST(4, IL_TRUE, SHIFTRA(VARG("r0"), U8(3))), UNSIGNED(4, SHIFTL(MSB(VARG("r1")), VARG("r1"), U8(5)))), U8(0x21))),
+		STOREW(U16(2), VARG("r1")),
+		STORE(ADD(U16(8), LOGAND(UNSIGNED(16, VARG("r2")), U16(7))), UNSIGNED(8, DIV(VARG("r0"), U32(0)))),
+		BRANCH(VARG("zf"),
+			SETG("r0", LOADW(32, U16(1))),
+			SETG("r0", ADD(VARG("r0"), UNSIGNED(32, LOAD(U16(3)))))),
+		REPEAT(NON_ZERO(VARG("r2")),
+			SEQ2(SETG("r2", SHIFTR0(VARG("r2"), U8(1))), SETG("r0", SUB(VARG("r0"), MOD(VARL("t"), U32(5)))))),
+		JMP(ITE(VARG("zf"), U16(0x100), UNSIGNED(16, VARL("t")))));
+
+	RzILBytecode *bc = rz_il_bytecode_compile(vm_bc, op);
+	mu_assert_notnull(bc, "compile");
+	for (int i = 0; i < 4; i++) {
+		ut64 next = rz_bv_to_ut64(vm_tree->pc) + 4;
+		mu_assert_true(rz_il_vm_step(vm_tree, op, next), "tree step");
+		mu_assert_true(rz_il_bytecode_bind(vm_bc, bc), "bind");
+		mu_assert_true(rz_il_vm_step_bytecode(vm_bc, bc, next), "bytecode step");
+		char *ev_tree = events_str(vm_tree);
+		char *ev_bc = events_str(vm_bc);
+		mu_assert_streq(ev_bc, ev_tree, "events");
+		free(ev_tree);
+		free(ev_bc);
+		mu_assert_true(rz_bv_eq(vm_bc->pc, vm_tree->pc), "pc");
+		const char *names[] = { "r0", "r1", "r2", "zf" };
+		for (size_t j = 0; j < RZ_ARRAY_SIZE(names); j++) {
+			RzILVal *a = rz_il_vm_get_var_value(vm_tree, RZ_IL_VAR_KIND_GLOBAL, names[j]);
+			RzILVal *b = rz_il_vm_get_var_value(vm_bc, RZ_IL_VAR_KIND_GLOBAL, names[j]);
+			mu_assert_true(rz_il_value_eq(a, b), names[j]);
+		}
+		mu_assert_memeq(mem_bc, mem_tree, sizeof(mem_tree), "mem");
+	}
+	rz_il_bytecode_free(bc);
+	rz_il_op_effect_free(op);
+
+	// values that don't fit into 64 bits and floats are left to the tree evaluator
+	op = SETG("r0", UNSIGNED(32, UN(128, 1)));
+	mu_assert_null(rz_il_bytecode_compile(vm_bc, op), "bv128");
+	rz_il_op_effect_free(op);
+	op = SETG("r0", F2BV(F32(1.0f)));
+	mu_assert_null(rz_il_bytecode_compile(vm_bc, op), "float");
+	rz_il_op_effect_free(op);
+	op = SETG("r0", U8(1));
+	mu_assert_null(rz_il_bytecode_compile(vm_bc, op), "mis-sorted");
+	rz_il_op_effect_free(op);
+	op = SETG("r0", VARL("undefined"));
+	mu_assert_null(rz_il_bytecode_compile(vm_bc, op), "undefined local");
+	rz_il_op_effect_free(op);
+
+	rz_il_vm_free(vm_tree);
+	rz_il_vm_free(vm_bc);
+	mu_end;
+}
+
+static void hook_bytecode(RzILVM *vm, RzILOpEffect *op) {
+	RzILVal *t = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_LOCAL, "t");
+	rz_il_vm_set_global_var(vm, "r1", rz_il_value_dup(t));
+	rz_il_vm_set_local_var(vm, "t", rz_il_value_new_bitv(rz_bv_new_from_ut64(32, 0x1234)));
+}
+
+static bool test_rzil_vm_bytecode_hook() {
+	ut8 mem[4] = { 0 };
+	RzILVM *vm = bytecode_vm_new(mem, sizeof(mem));
+	RzILEffectLabel *label = rz_il_vm_create_label_lazy(vm, "hook");
+	label->type = EFFECT_LABEL_HOOK;
+	label->hook = hook_bytecode;
+
+	RzILOpEffect *op = SEQ3(
+		SETL("t", ADD(VARG("r0"), U32(1))),
+		GOTO("hook"),
+		SETG("r0", VARL("t")));
+	RzILBytecode *bc = rz_il_bytecode_compile(vm, op);
+	mu_assert_notnull(bc, "compile");
+	mu_assert_true(rz_il_bytecode_bind(vm, bc), "bind");
+	mu_assert_true(rz_il_vm_step_bytecode(vm, bc, 0x44), "step");
+	RzILVal *val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_GLOBAL, "r1");
+	mu_assert_eq(rz_bv_to_ut64(val->data.bv), 0x80000006, "local passed to the hook");
+	val = rz_il_vm_get_var_value(vm, RZ_IL_VAR_KIND_GLOBAL, "r0");
+	mu_assert_eq(rz_bv_to_ut64(val->data.bv), 0x1234, "local set by the hook");
+	mu_assert_eq(rz_bv_to_ut64(vm->pc), 0x44, "pc");
+	rz_il_bytecode_free(bc);
+	rz_il_op_effect_free(op);
+	rz_il_vm_free(vm);
+	mu_end;
+}
+
+static ut32 lifter_state;
+
+static int stateful_lifter_op(RzAnalysis *a, RzAnalysisOp *op, ut64 addr, const ut8 *data, int len, RzAnalysisOpMask mask) {
+	op->size = 1;
+	if (mask & RZ_ANALYSIS_OP_MASK_IL) {
+		// the lifted op depends on the previously lifted ones
+		op->il_op = SEQ2(SETG("r0", U32(lifter_state++)), JMP(U32(0)));
+	}
+	return 1;
+}
+
+static char *stateful_lifter_reg_profile(RzAnalysis *a) {
+	return rz_str_dup(
+		"=PC	pc\n"
+		"gpr	pc	.32	0	0\n"
+		"gpr	r0	.32	4	0\n");
+}
+
+static RzAnalysisILConfig *stateful_lifter_il_config(RzAnalysis *a) {
+	return rz_analysis_il_config_new(32, false, 32);
+}
+
+static bool stateful_lifter_read_at(RzAnalysis *a, ut64 addr, ut8 *buf, int len) {
+	memset(buf, 0, len);
+	return true;
+}
+
+static RzAnalysisPlugin stateful_lifter_plugin = {
+	.name = "stateful_lifter",
+	.arch = "stateful_lifter",
+	.bits = 32,
+	.op = stateful_lifter_op,
+	.get_reg_profile = stateful_lifter_reg_profile,
+	.il_config = stateful_lifter_il_config,
+};
+
+static ut64 analysis_vm_r0(RzAnalysisILVM *vm) {
+	RzILVal *val = rz_il_vm_get_var_value(vm->vm, RZ_IL_VAR_KIND_GLOBAL, "r0");
+	return val ? rz_bv_to_ut64(val->data.bv) : UT64_MAX;
+}
+
+static bool test_rzil_vm_bytecode_stateful_lifter() {
+	RzAnalysis *analysis = rz_analysis_new();
+	rz_analysis_plugin_add(analysis, &stateful_lifter_plugin);
+	mu_assert_true(rz_analysis_use(analysis, "stateful_lifter"), "use plugin");
+	analysis->read_at = stateful_lifter_read_at;
+	RzAnalysisILVM *vm = rz_analysis_il_vm_new(analysis, NULL);
+	mu_assert_notnull(vm, "vm");
+
+	// every step at 0 must call the lifter again, not run a stale compiled op
+	lifter_state = 0;
+	for (ut64 i = 0; i < 3; i++) {
+		mu_assert_eq(rz_analysis_il_vm_step(analysis, vm, NULL), RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS, "step");
+		mu_assert_eq(analysis_vm_r0(vm), i, "lifted again");
+	}
+	mu_assert_eq(lifter_state, 3, "lifter called at every step");
+
+	// the ops of a stateless lifter are compiled once and run again
+	stateful_lifter_plugin.cacheable = true;
+	for (ut64 i = 0; i < 3; i++) {
+		mu_assert_eq(rz_analysis_il_vm_step(analysis, vm, NULL), RZ_ANALYSIS_IL_STEP_RESULT_SUCCESS, "step");
+		mu_assert_eq(analysis_vm_r0(vm), 3, "compiled op run again");
+	}
+	mu_assert_eq(lifter_state, 4, "lifter called once");
+	stateful_lifter_plugin.cacheable = false;
+
+	rz_analysis_il_vm_free(vm);
+	rz_analysis_free(analysis);
+	mu_end;
+}
+
+#include <rz_il/rz_il_opbuilder_end.h>
+
 bool all_tests() {
 	mu_run_test(test_rzil_vm_init);
 	mu_run_test(test_rzil_vm_global_vars);
@@ -1115,6 +1311,9 @@ bool all_tests() {
 	mu_run_test(test_rzil_vm_op_float);
 	mu_run_test(test_rzil_vm_op_fcast);
 	mu_run_test(test_rzil_vm_op_fexcept);
+	mu_run_test(test_rzil_vm_bytecode);
+	mu_run_test(test_rzil_vm_bytecode_hook);
+	mu_run_test(test_rzil_vm_bytecode_stateful_lifter);
 	return tests_passed != tests_run;
 }
 
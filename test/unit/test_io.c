@@ -165,6 +165,47 @@ bool test_rz_io_pcache(void) {
 	mu_end;
 }
 
+bool test_rz_io_rcache(void) {
+	RzIO *io = rz_io_new();
+	RzIODesc *desc = rz_io_open(io, "malloc://0x3000", RZ_PERM_RW, 0);
+	mu_assert_notnull(desc, "open malloc");
+	ut8 buf[0x10];
+	memset(buf, 'A', sizeof(buf));
+	rz_io_write_at(io, 0, buf, sizeof(buf));
+	memset(buf, 'B', sizeof(buf));
+	rz_io_write_at(io, 0x1ff8, buf, sizeof(buf));
+
+	rz_io_rcache_set_max_pages(io, 2);
+	memset(buf, 0, sizeof(buf));
+	mu_assert_true(rz_io_read_at(io, 0, buf, 4), "read at 0");
+	mu_assert_memeq(buf, (ut8 *)"AAAA", 4, "read at 0 content");
+	mu_assert_eq(io->rcache.misses, 1, "first read is a miss");
+	mu_assert_eq(io->rcache.hits, 0, "first read is not a hit");
+	mu_assert_true(rz_io_read_at(io, 4, buf, 4), "read at 4");
+	mu_assert_eq(io->rcache.hits, 1, "second read is a hit");
+	mu_assert_eq(io->rcache.n_pages, 1, "one page cached");
+
+	// spans two pages, the first one gets evicted
+	mu_assert_true(rz_io_read_at(io, 0x1ff8, buf, sizeof(buf)), "read across pages");
+	mu_assert_memeq(buf, (ut8 *)"BBBBBBBBBBBBBBBB", sizeof(buf), "read across pages content");
+	mu_assert_eq(io->rcache.misses, 3, "two more misses");
+	mu_assert_eq(io->rcache.n_pages, 2, "cache is bounded");
+
+	// writes invalidate the cached pages
+	rz_io_write_at(io, 0x1ffc, (ut8 *)"CCCC", 4);
+	mu_assert_eq(io->rcache.n_pages, 1, "written page dropped");
+	mu_assert_true(rz_io_read_at(io, 0x1ff8, buf, sizeof(buf)), "read after write");
+	mu_assert_memeq(buf, (ut8 *)"BBBBCCCCBBBBBBBB", sizeof(buf), "read after write content");
+
+	// reading past the end of the desc
+	mu_assert_eq(rz_io_fd_read_at(io, desc->fd, 0x2ff8, buf, sizeof(buf)), 8, "short read at the end");
+
+	rz_io_rcache_set_max_pages(io, 0);
+	mu_assert_eq(io->rcache.n_pages, 0, "disabling drops the pages");
+	rz_io_free(io);
+	mu_end;
+}
+
 bool test_rz_io_desc_exchange(void) {
 	RzIO *io = rz_io_new();
 	int fd = rz_io_fd_open(io, "malloc://3", RZ_PERM_R, 0),
@@ -637,6 +678,7 @@ bool all_tests(void) {
 	mu_run_test(test_rz_io_mapsplit3);
 	mu_run_test(test_rz_io_maps_vector);
 	mu_run_test(test_rz_io_pcache);
+	mu_run_test(test_rz_io_rcache);
 	mu_run_test(test_rz_io_desc_exchange);
 	mu_run_test(test_rz_io_priority);
 	mu_run_test(test_rz_io_priority2);
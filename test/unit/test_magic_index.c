@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_userconf.h>
+#include <rz_magic.h>
+#include <rz_util.h>
+#include "test_config.h"
+#include "minunit.h"
+
+// the index needs the rules of the embedded libmagic
+#if !USE_LIB_MAGIC
+
+#define BUF_SIZE 0x3000
+
+static const char *custom_rules =
+	"0\tbyte&0xf0\t0x40\tnibble four\n"
+	"0\tleshort&0xff0f\t0x0102\tmasked short\n"
+	"2\tbelong\t0x01020304\tbe long\n"
+	"1\tstring/c\tab\tcaseless ab\n"
+	"3\tbyte\t>0x7a\tbigger\n"
+	">4\tbyte\t1\tone\n"
+	"0\tbyte\t<3\n"
+	">0\tbyte\t1\tlt3 one\n"
+	">0\tbyte\t2\tlt3 two\n"
+	"5\tbyte\t&0x81\tflags set\n"
+	"0\tbyte\t3\n"
+	">1\tbyte\t3\tthree three\n"
+	">2\tbyte\tx\tany\n"
+	"6\tlequad\t0x0403020100000000\tquad\n"
+	"0\tstring\t\\0\\0\\1\tzeroes then one\n";
+
+static const ut8 elf_header[] = {
+	0x7f, 'E', 'L', 'F', 0x02, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x02, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00
+};
+static const ut8 gzip_header[] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03 };
+static const ut8 zip_header[] = { 'P', 'K', 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00 };
+
+/**
+ * Random data with some known signatures, the last one close to the end
+ * to check the offsets with less than a window of data.
+ */
+static ut8 *mixed_buffer(void) {
+	ut8 *buf = malloc(BUF_SIZE);
+	if (!buf) {
+		return NULL;
+	}
+	ut32 seed = 0x1234;
+	for (size_t i = 0; i < BUF_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+	// runs of zeroes and small values, matched by many rules
+	memset(buf + 0x80, 0, 0x40);
+	for (size_t i = 0; i < 0x40; i++) {
+		buf[0xc0 + i] = i % 4;
+	}
+	memcpy(buf + 0x100, elf_header, sizeof(elf_header));
+	memcpy(buf + 0x401, gzip_header, sizeof(gzip_header));
+	memcpy(buf + 0x800, zip_header, sizeof(zip_header));
+	memcpy(buf + BUF_SIZE - 6, zip_header, 6);
+
+	// a ustar record with a valid checksum
+	ut8 *tar = buf + 0x1000;
+	memset(tar, 0, 512);
+	strcpy((char *)tar, "file.txt");
+	memcpy(tar + 100, "0000644", 8);
+	memcpy(tar + 108, "0001750", 8);
+	memcpy(tar + 116, "0001750", 8);
+	memcpy(tar + 124, "00000000004", 12);
+	memcpy(tar + 136, "14562324572", 12);
+	tar[156] = '0';
+	memcpy(tar + 257, "ustar  ", 8);
+	memset(tar + 148, ' ', 8);
+	ut32 sum = 0;
+	for (size_t i = 0; i < 512; i++) {
+		sum += tar[i];
+	}
+	snprintf((char *)tar + 148, 8, "%06o", sum);
+	return buf;
+}
+
+static bool mark_candidate(void *user, size_t offset) {
+	ut8 *candidates = user;
+	candidates[offset] = 1;
+	return true;
+}
+
+/**
+ * Checks that every offset matched by rz_magic_buffer() is reported by the index.
+ */
+static bool check_no_miss(RzMagic *m, const ut8 *buf, size_t len, size_t window) {
+	RzMagicIndex *idx = rz_magic_index_new(m);
+	mu_assert_notnull(idx, "index");
+	ut8 *candidates = calloc(len, 1);
+	mu_assert_notnull(candidates, "candidates");
+	mu_assert_true(rz_magic_index_scan(idx, buf, len, len, window, mark_candidate, candidates), "scan");
+	size_t count = 0;
+	for (size_t i = 0; i < len; i++) {
+		count += candidates[i];
+		const char *str = rz_magic_buffer(m, buf + i, RZ_MIN(window, len - i));
+		if (str && strcmp(str, "data") && !candidates[i]) {
+			char msg[128];
+			snprintf(msg, sizeof(msg), "match \"%s\" at 0x%" PFMTSZx " with window %" PFMTSZu " not reported", str, i, window);
+			mu_fail(msg);
+		}
+	}
+	mu_assert_true(count < len, "some offsets are skipped");
+	free(candidates);
+	rz_magic_index_free(idx);
+	return true;
+}
+
+static bool stop_at_first(void *user, size_t offset) {
+	*(size_t *)user = offset;
+	return false;
+}
+
+static char *write_rules(const char *rules) {
+	char *path = NULL;
+	int fd = rz_file_mkstemp("magic", &path);
+	if (fd == -1) {
+		return NULL;
+	}
+	close(fd);
+	if (!rz_file_dump(path, (const ut8 *)rules, -1, false)) {
+		rz_file_rm(path);
+		free(path);
+		return NULL;
+	}
+	return path;
+}
+
+bool test_magic_index_default(void) {
+	RzMagic *m = rz_magic_new(0);
+	mu_assert_true(rz_magic_load(m, TEST_SOURCE_MAGIC_DIR), "load default database");
+	ut8 *buf = mixed_buffer();
+	mu_assert_notnull(buf, "buffer");
+
+	mu_assert_true(rz_str_startswith(rz_magic_buffer(m, buf + 0x100, 0x1000), "ELF 64-bit"), "ELF matched");
+	mu_assert_true(rz_str_startswith(rz_magic_buffer(m, buf + 0x401, 0x1000), "gzip"), "gzip matched");
+	mu_assert_true(rz_str_startswith(rz_magic_buffer(m, buf + 0x800, 0x1000), "ZIP Zip"), "Zip matched");
+	mu_assert_notnull(strstr(rz_magic_buffer(m, buf + 0x1000, 0x1000), "tar archive"), "tar matched");
+
+	mu_assert_true(check_no_miss(m, buf, BUF_SIZE, 4096), "window of 4096");
+	mu_assert_true(check_no_miss(m, buf, BUF_SIZE, 64), "window of 64");
+	// the tar record does not fit anymore
+	mu_assert_true(check_no_miss(m, buf, 0x1000 + 0x100, 4096), "truncated tar");
+
+	RzMagicIndex *idx = rz_magic_index_new(m);
+	size_t first = SIZE_MAX;
+	mu_assert_false(rz_magic_index_scan(idx, buf, BUF_SIZE, BUF_SIZE, 4096, stop_at_first, &first), "stopped by the callback");
+	mu_assert_true(first <= 0x100, "stopped at the first candidate");
+	rz_magic_index_free(idx);
+	free(buf);
+	rz_magic_free(m);
+	mu_end;
+}
+
+bool test_magic_index_custom(void) {
+	char *path = write_rules(custom_rules);
+	mu_assert_notnull(path, "rules file");
+	RzMagic *m = rz_magic_new(0);
+	mu_assert_true(rz_magic_load(m, path), "load rules");
+	ut8 *buf = mixed_buffer();
+	mu_assert_notnull(buf, "buffer");
+	static const ut8 hits[] = { 0, 0, 1, 0x42, 'a', 'B', 0x80 };
+	memcpy(buf + 0x20, hits, sizeof(hits));
+	mu_assert_streq(rz_magic_buffer(m, buf + 0x20, 3), "zeroes then one", "custom rule matched");
+
+	mu_assert_true(check_no_miss(m, buf, BUF_SIZE, 3), "window of 3");
+	mu_assert_true(check_no_miss(m, buf, BUF_SIZE, 7), "window of 7");
+	mu_assert_true(check_no_miss(m, buf, BUF_SIZE, 64), "window of 64");
+	free(buf);
+	rz_magic_free(m);
+	rz_file_rm(path);
+	free(path);
+	mu_end;
+}
+
+bool test_magic_index_fallback(void) {
+	static const char *unindexable[] = {
+		// patterns with control characters are binary tests, the text ones are skipped
+		"0\tsearch/16\t\\x01\\x02\tsearched\n",
+		"(4.l)\tbyte\t1\tindirect\n",
+	};
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(unindexable); i++) {
+		char *rules = rz_str_newf("%s%s", custom_rules, unindexable[i]);
+		char *path = write_rules(rules);
+		mu_assert_notnull(path, "rules file");
+		RzMagic *m = rz_magic_new(0);
+		mu_assert_true(rz_magic_load(m, path), "load rules");
+		mu_assert_null(rz_magic_index_new(m), "rule cannot be indexed");
+		rz_magic_free(m);
+		rz_file_rm(path);
+		free(path);
+		free(rules);
+	}
+
+	// the MIME type is printed even without a match
+	RzMagic *m = rz_magic_new(RZ_MAGIC_MIME);
+	mu_assert_true(rz_magic_load(m, TEST_SOURCE_MAGIC_DIR), "load default database");
+	mu_assert_null(rz_magic_index_new(m), "no index for MIME types");
+	rz_magic_free(m);
+	mu_end;
+}
+
+#endif
+
+int all_tests() {
+#if !USE_LIB_MAGIC
+	mu_run_test(test_magic_index_default);
+	mu_run_test(test_magic_index_custom);
+	mu_run_test(test_magic_index_fallback);
+#endif
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
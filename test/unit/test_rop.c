@@ -140,8 +140,176 @@ bool test_rz_direct_solver() {
 	mu_end;
 }
 
+static char *rop_search_quiet(RzCore *core, ut64 from, ut64 to) {
+	RzCmdStateOutput state = { 0 };
+	rz_cmd_state_output_init(&state, RZ_OUTPUT_MODE_QUIET);
+	RzRopSearchContext *context = rz_core_rop_search_context_new(core, NULL, false, RZ_ROP_GADGET_PRINT, &state);
+	context->ret_val = true;
+	context->from = from;
+	context->to = to;
+	rz_core_rop_search(core, context);
+	char *out = rz_str_dup(rz_strbuf_get(context->buf));
+	rz_core_rop_search_context_free(context);
+	rz_cmd_state_output_fini(&state);
+	return out;
+}
+
+bool test_rz_rop_search_parallel() {
+	const ut64 size = 0x40000;
+	RzCore *core = rz_core_new();
+	mu_assert_notnull(core, "rz_core_new failed");
+	rz_io_open_at(core->io, "malloc://0x40000", RZ_PERM_RX, 0644, 0, NULL);
+	rz_core_set_asm_configs(core, "x86", 64, 0);
+	// mov eax, <i>; pop rdi; ret; nop
+	ut8 *buf = malloc(size);
+	mu_assert_notnull(buf, "malloc failed");
+	for (ut32 i = 0; i < size / 8; i++) {
+		ut8 *p = buf + i * 8;
+		p[0] = 0xb8;
+		rz_write_le32(p + 1, i);
+		p[5] = 0x5f;
+		p[6] = 0xc3;
+		p[7] = 0x90;
+	}
+	rz_io_write_at(core->io, 0, buf, size);
+	free(buf);
+
+	rz_config_set_i(core->config, "search.max.threads", 1);
+	char *serial = rop_search_quiet(core, 0, size);
+	// an explicit count, so that the pool is used on single core machines too
+	rz_config_set_i(core->config, "search.max.threads", 4);
+	char *parallel = rop_search_quiet(core, 0, size);
+	mu_assert_notnull(serial, "serial search failed");
+	mu_assert_true(strstr(serial, "0x00000008: mov eax, 1; pop rdi; ret;") != NULL, "gadget found");
+	mu_assert_streq(parallel, serial, "parallel search reports the gadgets of the serial one");
+	free(serial);
+	free(parallel);
+	rz_core_free(core);
+	mu_end;
+}
+
+static char *rop_search_detail(RzCore *core, ut64 from, ut64 to) {
+	RzCmdStateOutput state = { 0 };
+	rz_cmd_state_output_init(&state, RZ_OUTPUT_MODE_JSON);
+	RzRopSearchContext *context = rz_core_rop_search_context_new(core, NULL, false, RZ_ROP_GADGET_PRINT_DETAIL | RZ_ROP_GADGET_ANALYZE, &state);
+	context->from = from;
+	context->to = to;
+	rz_core_rop_search(core, context);
+	char *out = rz_str_dup(pj_string(state.d.pj));
+	rz_core_rop_search_context_free(context);
+	rz_cmd_state_output_fini(&state);
+	return out;
+}
+
+static void rop_semantics_reset(RzCore *core) {
+	ht_up_free(core->analysis->ht_rop_semantics);
+	core->analysis->ht_rop_semantics = NULL;
+}
+
+static char *rop_index_file(const char *dir) {
+	RzList *files = rz_sys_dir(dir);
+	char *path = NULL;
+	RzListIter *it;
+	char *file;
+	rz_list_foreach (files, it, file) {
+		if (rz_str_endswith(file, ".idx")) {
+			path = rz_file_path_join(dir, file);
+			break;
+		}
+	}
+	rz_list_free(files);
+	return path;
+}
+
+bool test_rz_rop_search_cache() {
+	char *home = NULL;
+	int fd = rz_file_mkstemp("rop", &home);
+	mu_assert_neq((ut64)fd, (ut64)-1, "mkstemp failed");
+	close(fd);
+	rz_file_rm(home);
+	mu_assert_true(rz_sys_mkdir(home), "mkdir failed");
+	char *old_home = rz_sys_getenv(RZ_SYS_HOME);
+	rz_sys_setenv(RZ_SYS_HOME, home);
+	char *cache = rz_path_home_cache();
+	char *dir = rz_file_path_join(cache, "rop");
+
+	RzCore *core = setup_rz_core("x86", 64);
+	mu_assert_notnull(core, "setup_rz_core failed");
+	rz_config_set_b(core->config, "rop.cache", true);
+	int addr = 0;
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(x86_64_buf_str); i++) {
+		ut8 buf[ROP_GADGET_MAX_SIZE] = { 0 };
+		int len = rz_hex_str2bin(x86_64_buf_str[i], buf);
+		rz_io_write_at(core->io, addr, buf, len);
+		addr += len + 1;
+	}
+
+	// the first search discovers the gadgets and stores them
+	char *fresh = rop_search_detail(core, 0, 0x100);
+	mu_assert_notnull(fresh, "search failed");
+	mu_assert_true(strstr(fresh, "\"address\":0") != NULL, "gadget at 0 analyzed");
+	mu_assert_notnull(core->analysis->ht_rop_semantics, "semantics computed");
+	const ut32 n_semantics = core->analysis->ht_rop_semantics->count;
+	mu_assert_eq(n_semantics, 2, "semantics of both gadgets");
+	char *path = rop_index_file(dir);
+	mu_assert_notnull(path, "index stored in the cache directory");
+
+	// a plain search loads the semantics back from the index
+	rop_semantics_reset(core);
+	char *listed = rop_search_quiet(core, 0, 0x100);
+	mu_assert_notnull(listed, "search failed");
+	mu_assert_true(strstr(listed, "0x00000000: mov rbx, 1; ret;") != NULL, "gadget listed from the index");
+	mu_assert_notnull(core->analysis->ht_rop_semantics, "semantics loaded");
+	mu_assert_eq(core->analysis->ht_rop_semantics->count, n_semantics, "all the semantics loaded");
+	rop_semantics_reset(core);
+	char *reloaded = rop_search_detail(core, 0, 0x100);
+	mu_assert_streq(reloaded, fresh, "reloaded gadgets and semantics match the discovered ones");
+
+	// a truncated index does not leave the semantics read so far in the session
+	size_t index_size = 0;
+	char *index_data = rz_file_slurp(path, &index_size);
+	mu_assert_notnull(index_data, "read index");
+	mu_assert_true(rz_file_dump(path, (const ut8 *)index_data, index_size - 4, false), "truncate index");
+	free(index_data);
+	rop_semantics_reset(core);
+	char *truncated = rop_search_quiet(core, 0, 0x100);
+	mu_assert_streq(truncated, listed, "truncated index falls back to the discovery");
+	mu_assert_true(!core->analysis->ht_rop_semantics || !core->analysis->ht_rop_semantics->count, "no semantics from the truncated index");
+	free(truncated);
+
+	// a corrupted index is ignored and written again
+	const ut8 garbage[] = "RZROPIDX\x01\x00\x00\x00\xff\xff\xff\xff";
+	mu_assert_true(rz_file_dump(path, garbage, sizeof(garbage) - 1, false), "corrupt index");
+	rop_semantics_reset(core);
+	char *rediscovered = rop_search_detail(core, 0, 0x100);
+	mu_assert_streq(rediscovered, fresh, "corrupted index falls back to the discovery");
+	mu_assert_true(rz_file_size(path) > sizeof(garbage) - 1, "index stored again");
+
+	free(fresh);
+	free(listed);
+	free(reloaded);
+	free(rediscovered);
+	rz_core_free(core);
+	rz_file_rm(path);
+	rz_file_rm(dir);
+	rz_file_rm(cache);
+	char *dot_cache = rz_file_path_join(home, ".cache");
+	rz_file_rm(dot_cache);
+	rz_file_rm(home);
+	rz_sys_setenv(RZ_SYS_HOME, old_home);
+	free(dot_cache);
+	free(path);
+	free(dir);
+	free(cache);
+	free(old_home);
+	free(home);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_rz_direct_solver);
+	mu_run_test(test_rz_rop_search_parallel);
+	mu_run_test(test_rz_rop_search_cache);
 	return tests_passed != tests_run;
 }
 
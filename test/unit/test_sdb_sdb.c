@@ -6,6 +6,7 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <rz_util/rz_file.h>
+#include <rz_th.h>
 
 bool test_sdb_kv_list(void) {
 	Sdb *db = sdb_new(NULL, NULL, false);
@@ -602,6 +603,82 @@ bool test_sdb_sync_disk() {
 	mu_end;
 }
 
+static bool count_cb(void *user, const SdbKv *kv) {
+	(*(int *)user)++;
+	return true;
+}
+
+static bool nested_count_cb(void *user, const SdbKv *kv) {
+	void **args = user;
+	int n = 0;
+	sdb_foreach(args[0], count_cb, &n);
+	*(int *)args[1] += n;
+	return true;
+}
+
+static void *readonly_reader(void *user) {
+	Sdb *db = user;
+	char key[32], value[32];
+	for (int i = 0; i < 10000; i++) {
+		int k = i % 500;
+		snprintf(key, sizeof(key), "key%d", k);
+		snprintf(value, sizeof(value), "value%d", k * 3);
+		const char *v = sdb_const_get(db, key);
+		if (!v || strcmp(v, value)) {
+			return NULL;
+		}
+	}
+	return db;
+}
+
+bool test_sdb_readonly() {
+	Sdb *db = sdb_new(NULL, ".readonly_db", 0);
+	char key[32], value[32];
+	for (int i = 0; i < 500; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		snprintf(value, sizeof(value), "value%d", i * 3);
+		sdb_set(db, key, value);
+	}
+	sdb_sync(db);
+	sdb_free(db);
+
+	db = sdb_new_readonly(".readonly_db");
+	mu_assert_notnull(db, "open read-only");
+	mu_assert_streq(sdb_const_get(db, "key42"), "value126", "value from the file");
+	mu_assert_null(sdb_const_get(db, "nope"), "missing key");
+	mu_assert_true(sdb_exists(db, "key499"), "key exists");
+	mu_assert_false(sdb_exists(db, "key500"), "key does not exist");
+	mu_assert_false(sdb_set(db, "key42", "foo"), "set fails");
+	mu_assert_false(sdb_set_owned(db, "key43", strdup("foo")), "set fails");
+	mu_assert_false(sdb_remove(db, "key42"), "remove fails");
+	mu_assert_false(sdb_sync(db), "sync fails");
+	mu_assert_streq(sdb_const_get(db, "key42"), "value126", "value is not modified");
+
+	int n = 0;
+	sdb_foreach(db, count_cb, &n);
+	mu_assert_eq(n, 500, "foreach");
+	n = 0;
+	void *args[] = { db, &n };
+	sdb_foreach(db, nested_count_cb, args);
+	mu_assert_eq(n, 500 * 500, "nested foreach");
+
+	RzThread *th[4];
+	for (int i = 0; i < RZ_ARRAY_SIZE(th); i++) {
+		th[i] = rz_th_new(readonly_reader, db);
+		mu_assert_notnull(th[i], "thread");
+	}
+	for (int i = 0; i < RZ_ARRAY_SIZE(th); i++) {
+		rz_th_wait(th[i]);
+		mu_assert_ptreq(rz_th_get_retv(th[i]), db, "concurrent lookups");
+		rz_th_free(th[i]);
+	}
+
+	sdb_free(db);
+	unlink(".readonly_db");
+	mu_assert_null(sdb_new_readonly(".readonly_db"), "missing file");
+	mu_end;
+}
+
 int all_tests() {
 	// XXX two bugs found with crash
 	mu_run_test(test_sdb_kv_list);
@@ -625,6 +702,7 @@ int all_tests() {
 	mu_run_test(test_sdb_text_load_path_last_line);
 	mu_run_test(test_sdb_text_load_file);
 	mu_run_test(test_sdb_sync_disk);
+	mu_run_test(test_sdb_readonly);
 	return tests_passed != tests_run;
 }
 
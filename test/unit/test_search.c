@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2024 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include <rz_search.h>
+#include "minunit.h"
+
+typedef struct {
+	int kwidx;
+	ut64 addr;
+} SearchHit;
+
+static int hit_cb(RzSearchKeyword *kw, void *user, ut64 addr) {
+	SearchHit hit = { kw->kwidx, addr };
+	rz_vector_push(user, &hit);
+	return 1;
+}
+
+static int hit_cmp(const void *a, const void *b, void *user) {
+	const SearchHit *ha = a, *hb = b;
+	if (ha->kwidx != hb->kwidx) {
+		return ha->kwidx - hb->kwidx;
+	}
+	return ha->addr < hb->addr ? -1 : ha->addr > hb->addr;
+}
+
+static void search_blocks(RzSearch *s, const ut8 *data, ut64 size, ut64 bsize, RzVector *hits) {
+	rz_search_set_callback(s, hit_cb, hits);
+	rz_search_begin(s);
+	ut8 *block = malloc(bsize);
+	for (ut64 at = 0; at < size; at += bsize) {
+		ut64 n = RZ_MIN(bsize, size - at);
+		memcpy(block, data + at, n);
+		rz_search_update(s, 0x1000 + at, block, n);
+	}
+	free(block);
+}
+
+bool test_rz_search_multi_keyword(void) {
+	const char *text = "xxabcdabcDABCdaxcab";
+	const SearchHit expected[] = {
+		{ 0, 0x1002 }, { 0, 0x1006 },
+		{ 1, 0x1003 }, { 1, 0x1007 }, { 1, 0x100b },
+		{ 2, 0x1002 }, { 2, 0x1006 }, { 2, 0x100e },
+		{ 3, 0x1001 }, { 3, 0x1005 }, { 3, 0x100d }, { 3, 0x1010 },
+	};
+	ut64 bsizes[] = { 3, 4, 7, 0x100 };
+	for (size_t b = 0; b < RZ_ARRAY_SIZE(bsizes); b++) {
+		RzVector hits;
+		rz_vector_init(&hits, sizeof(SearchHit), NULL, NULL);
+		RzSearch *s = rz_search_new(RZ_SEARCH_KEYWORD);
+		rz_search_kw_add(s, rz_search_keyword_new_str("abc", NULL, NULL, false));
+		rz_search_kw_add(s, rz_search_keyword_new_str("BCD", NULL, NULL, true));
+		rz_search_kw_add(s, rz_search_keyword_new_hexmask("61..63", NULL));
+		// fully masked, can't be found through the automaton
+		rz_search_kw_add(s, rz_search_keyword_new_hexmask("..61", NULL));
+		search_blocks(s, (const ut8 *)text, strlen(text), bsizes[b], &hits);
+		mu_assert_notnull(s->automaton, "automaton built");
+		rz_search_free(s);
+
+		rz_vector_sort(&hits, hit_cmp, false, NULL);
+		mu_assert_eq(rz_vector_len(&hits), RZ_ARRAY_SIZE(expected), "hits count");
+		for (size_t i = 0; i < rz_vector_len(&hits); i++) {
+			SearchHit *hit = rz_vector_index_ptr(&hits, i);
+			mu_assert_eq(hit->kwidx, expected[i].kwidx, "hit keyword");
+			mu_assert_eq(hit->addr, expected[i].addr, "hit address");
+		}
+		rz_vector_fini(&hits);
+	}
+	mu_end;
+}
+
+bool test_rz_search_multi_keyword_hits(void) {
+	const ut8 data[] = "..abc..ABC.a.c..cdab";
+	RzSearch *s = rz_search_new(RZ_SEARCH_KEYWORD);
+	rz_search_kw_add(s, rz_search_keyword_new_str("abc", NULL, NULL, false));
+	rz_search_kw_add(s, rz_search_keyword_new_str("abc", NULL, NULL, true));
+	rz_search_kw_add(s, rz_search_keyword_new_hexmask("61..63", NULL));
+	rz_search_kw_add(s, rz_search_keyword_new_str("cdab", NULL, NULL, false));
+	RzList *hits = rz_search_find(s, 0, data, sizeof(data) - 1);
+	mu_assert_notnull(hits, "hits");
+	ut64 expected[][2] = { { 0, 2 }, { 1, 2 }, { 1, 7 }, { 2, 2 }, { 2, 11 }, { 3, 16 } };
+	mu_assert_eq(rz_list_length(hits), RZ_ARRAY_SIZE(expected), "hits count");
+	RzListIter *it;
+	RzSearchHit *hit;
+	size_t i = 0;
+	rz_list_foreach (hits, it, hit) {
+		mu_assert_eq(hit->kw->kwidx, expected[i][0], "hit keyword");
+		mu_assert_eq(hit->addr, expected[i][1], "hit address");
+		i++;
+	}
+	hits->free = free;
+	rz_list_free(hits);
+	rz_search_free(s);
+	mu_end;
+}
+
+static bool find_cb(RzSearchKeyword *kw, ut32 kw_idx, ut64 idx, void *user) {
+	SearchHit hit = { kw_idx, 0x1000 + idx };
+	rz_vector_push(user, &hit);
+	return true;
+}
+
+static bool stop_cb(RzSearchKeyword *kw, ut32 kw_idx, ut64 idx, void *user) {
+	(*(int *)user)++;
+	return false;
+}
+
+/**
+ * Checks that rz_search_keywords_find() reports the same hits as the block
+ * search, keyword after keyword and by increasing address.
+ */
+static bool check_keywords_find(RzSearch *s, const ut8 *data, ut64 size) {
+	RzVector expected, hits;
+	rz_vector_init(&expected, sizeof(SearchHit), NULL, NULL);
+	rz_vector_init(&hits, sizeof(SearchHit), NULL, NULL);
+	mu_assert_true(rz_search_keywords_find(s, data, size, find_cb, &hits), "find");
+	// every hit is reported
+	s->overlap = true;
+	s->contiguous = 1;
+	search_blocks(s, data, size, 5, &expected);
+	rz_vector_sort(&expected, hit_cmp, false, NULL);
+	mu_assert_eq(rz_vector_len(&hits), rz_vector_len(&expected), "hits count");
+	for (size_t i = 0; i < rz_vector_len(&hits); i++) {
+		SearchHit *hit = rz_vector_index_ptr(&hits, i);
+		SearchHit *exp = rz_vector_index_ptr(&expected, i);
+		mu_assert_eq(hit->kwidx, exp->kwidx, "hit keyword");
+		mu_assert_eq(hit->addr, exp->addr, "hit address");
+	}
+	int calls = 0;
+	mu_assert_false(rz_search_keywords_find(s, data, size, stop_cb, &calls), "stopped");
+	mu_assert_eq(calls, 1, "stopped at the first hit");
+	rz_vector_fini(&hits);
+	rz_vector_fini(&expected);
+	return true;
+}
+
+bool test_rz_search_keywords_find(void) {
+	const ut8 data[] = "xxabcdabcDABCdaxcabbcababcaabc";
+	RzSearch *s = rz_search_new(RZ_SEARCH_KEYWORD);
+	rz_search_kw_add(s, rz_search_keyword_new_str("abc", NULL, NULL, false));
+	rz_search_kw_add(s, rz_search_keyword_new_str("BCD", NULL, NULL, true));
+	rz_search_kw_add(s, rz_search_keyword_new_hexmask("61..63", NULL));
+	rz_search_kw_add(s, rz_search_keyword_new_hexmask("..61", NULL));
+	rz_search_kw_add(s, rz_search_keyword_new_str("bcab", NULL, NULL, false));
+
+	mu_assert_true(check_keywords_find(s, data, sizeof(data) - 1), "not prepared");
+	rz_search_keywords_prepare(s);
+	mu_assert_notnull(s->automaton, "automaton built");
+	mu_assert_true(check_keywords_find(s, data, sizeof(data) - 1), "prepared");
+
+	// the automaton is outdated, the keywords are searched one by one
+	rz_search_kw_add(s, rz_search_keyword_new_str("ca", NULL, NULL, false));
+	RzVector hits;
+	rz_vector_init(&hits, sizeof(SearchHit), NULL, NULL);
+	mu_assert_true(rz_search_keywords_find(s, data, sizeof(data) - 1, find_cb, &hits), "find");
+	SearchHit *last = rz_vector_tail(&hits);
+	mu_assert_eq(last->kwidx, 5, "new keyword found");
+	mu_assert_eq(last->addr, 0x1019, "new keyword address");
+	rz_vector_fini(&hits);
+	mu_assert_true(check_keywords_find(s, data, sizeof(data) - 1), "outdated automaton");
+
+	rz_search_set_distance(s, 1);
+	mu_assert_true(check_keywords_find(s, data, sizeof(data) - 1), "distance");
+	rz_search_free(s);
+	mu_end;
+}
+
+bool test_rz_search_set_leftover(void) {
+	RzVector hits;
+	rz_vector_init(&hits, sizeof(SearchHit), NULL, NULL);
+	RzSearch *s = rz_search_new(RZ_SEARCH_KEYWORD);
+	rz_search_kw_add(s, rz_search_keyword_new_str("abcdef", NULL, NULL, false));
+	rz_search_set_callback(s, hit_cb, &hits);
+	rz_search_begin(s);
+
+	// the first bytes were searched without rz_search_update()
+	mu_assert_true(rz_search_set_leftover(s, 0x1007, (const ut8 *)"xxxxabc", 7), "set leftover");
+	rz_search_update(s, 0x1007, (const ut8 *)"defxx", 5);
+	mu_assert_eq(rz_vector_len(&hits), 1, "hit across the leftover");
+	SearchHit *hit = rz_vector_index_ptr(&hits, 0);
+	mu_assert_eq(hit->addr, 0x1004, "hit address");
+
+	// the leftover is not joined with a buffer starting elsewhere
+	mu_assert_true(rz_search_set_leftover(s, 0x2003, (const ut8 *)"abc", 3), "set leftover");
+	rz_search_update(s, 0x3000, (const ut8 *)"defxx", 5);
+	mu_assert_eq(rz_vector_len(&hits), 1, "no hit with a leftover elsewhere");
+
+	rz_search_free(s);
+	rz_vector_fini(&hits);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test(test_rz_search_multi_keyword);
+	mu_run_test(test_rz_search_multi_keyword_hits);
+	mu_run_test(test_rz_search_keywords_find);
+	mu_run_test(test_rz_search_set_leftover);
+
+	return tests_passed != tests_run;
+}
+
+mu_main(all_tests)
@@ -95,6 +95,44 @@ bool test_insert_existing(void) {
 	mu_end;
 }
 
+bool test_insert_sorted(void) {
+	RzSkipList *list = rz_skiplist_new(NULL, (RzListComparator)cmp_int);
+	rz_skiplist_insert(list, (void *)(intptr_t)5);
+	rz_skiplist_insert(list, (void *)(intptr_t)20);
+	rz_skiplist_insert(list, (void *)(intptr_t)40);
+
+	void *data[100];
+	for (int i = 0; i < 100; i++) {
+		data[i] = (void *)(intptr_t)i;
+	}
+	size_t inserted = rz_skiplist_insert_sorted(list, data, 100);
+	mu_assert_eq(inserted, 97, "elements already in the list should not be inserted");
+	mu_assert_eq(rz_skiplist_length(list), 100, "list should contain 100 elements");
+
+	RzSkipListNode *it;
+	void *x;
+	int expected = 0;
+	rz_skiplist_foreach (list, it, x) {
+		mu_assert_eq((int)(intptr_t)x, expected, "elements should be sorted");
+		expected++;
+	}
+	mu_assert_eq(expected, 100, "all the elements should be visited");
+	mu_assert_notnull(rz_skiplist_find(list, (void *)(intptr_t)99), "99 should be in the list");
+	mu_assert_null(rz_skiplist_find(list, (void *)(intptr_t)100), "100 shouldn't be in the list");
+
+	data[0] = (void *)(intptr_t)(-1);
+	data[1] = (void *)(intptr_t)20;
+	data[2] = (void *)(intptr_t)200;
+	inserted = rz_skiplist_insert_sorted(list, data, 3);
+	mu_assert_eq(inserted, 2, "only the new elements should be inserted");
+	mu_assert_eq(rz_skiplist_length(list), 102, "list should contain 102 elements");
+	mu_assert_eq((int)(intptr_t)rz_skiplist_get_first(list), -1, "-1 should be the first element");
+	mu_assert_notnull(rz_skiplist_find(list, (void *)(intptr_t)200), "200 should be in the list");
+
+	rz_skiplist_free(list);
+	mu_end;
+}
+
 bool test_purge(void) {
 	RzSkipList *list = rz_skiplist_new(NULL, (RzListComparator)cmp_int);
 	rz_skiplist_insert(list, (void *)(intptr_t)3);
@@ -168,6 +206,7 @@ int all_tests() {
 	mu_run_test(test_oneelement);
 	mu_run_test(test_insert);
 	mu_run_test(test_insert_existing);
+	mu_run_test(test_insert_sorted);
 	mu_run_test(test_purge);
 	mu_run_test(test_delete);
 	mu_run_test(test_join);
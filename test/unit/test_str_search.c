@@ -343,6 +343,42 @@ bool test_rz_scan_strings_extended_ascii(void) {
 	mu_end;
 }
 
+bool test_rz_scan_strings_padding(void) {
+	// strings surrounded by the padding skipped by the pre-pass
+	ut8 str[256];
+	memset(str, 0, sizeof(str));
+	memset(str + 0x30, 0xff, 0x30);
+	memcpy(str + 0x21, "ASCII after zeros", 17);
+	memcpy(str + 0x60, "\x01\x02\x03\x1f\x00\x00\x00\x0e" "after controls", 22);
+	memcpy(str + 0x80, "W\0i\0d\0e\0", 8);
+	memcpy(str + 0xc0, "A\0\0\0B\0\0\0C\0\0\0D\0\0\0", 16);
+	RzBuffer *buf = rz_buf_new_with_bytes(str, sizeof(str));
+
+	g_opt.prefer_big_endian = false;
+	RzList *str_list = rz_list_newf((RzListFree)rz_detected_string_free);
+	int n = rz_scan_strings(buf, str_list, &g_opt, 0, sizeof(str), RZ_STRING_ENC_GUESS);
+	mu_assert_eq(n, 4, "rz_scan_strings padding, number of strings");
+
+	RzDetectedString *s = rz_list_get_n(str_list, 0);
+	mu_assert_streq(s->string, "ASCII after zeros", "rz_scan_strings padding, ascii string");
+	mu_assert_eq(s->addr, 0x21, "rz_scan_strings padding, ascii address");
+	s = rz_list_get_n(str_list, 1);
+	mu_assert_streq(s->string, "after controls", "rz_scan_strings padding, controls string");
+	mu_assert_eq(s->addr, 0x68, "rz_scan_strings padding, controls address");
+	s = rz_list_get_n(str_list, 2);
+	mu_assert_streq(s->string, "Wide", "rz_scan_strings padding, utf16le string");
+	mu_assert_eq(s->addr, 0x80, "rz_scan_strings padding, utf16le address");
+	mu_assert_eq(s->type, RZ_STRING_ENC_UTF16LE, "rz_scan_strings padding, utf16le type");
+	s = rz_list_get_n(str_list, 3);
+	mu_assert_streq(s->string, "ABCD", "rz_scan_strings padding, utf32le string");
+	mu_assert_eq(s->addr, 0xc0, "rz_scan_strings padding, utf32le address");
+	mu_assert_eq(s->type, RZ_STRING_ENC_UTF32LE, "rz_scan_strings padding, utf32le type");
+
+	rz_list_free(str_list);
+	rz_buf_free(buf);
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test(test_rz_scan_strings_detect_ascii);
 	mu_run_test(test_rz_scan_strings_detect_ibm037);
@@ -354,6 +390,7 @@ bool all_tests() {
 	mu_run_test(test_rz_scan_strings_detect_utf32_be);
 	mu_run_test(test_rz_scan_strings_utf16_be);
 	mu_run_test(test_rz_scan_strings_extended_ascii);
+	mu_run_test(test_rz_scan_strings_padding);
 
 	return tests_passed != tests_run;
 }